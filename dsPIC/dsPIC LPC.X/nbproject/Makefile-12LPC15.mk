@@ -57,17 +57,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=../src/inverter.c ../src/main.c ../src/ui.c ../src/task_dev.c ../src/task_temp.c ../src/task_main.c ../src/common/analog.c ../src/common/analog_dsPIC33F.c ../src/common/batt_temp.c ../src/common/CAN/dsPIC33_CAN.c ../src/common/CAN/J1939.c ../src/common/CAN/rv_can.c ../src/common/CAN/sensata_can.c ../src/common/charger.c ../src/common/charger_3step.c ../src/common/charger_cmds.c ../src/common/charger_isr.c ../src/common/charger_liion.c ../src/common/config.c ../src/common/converter_cmds.c ../src/common/dac.c ../src/common/dsPIC_serial.c ../src/common/hs_temp.c ../src/common/inverter_cmds.c ../src/common/inv_check_supply.c ../src/common/itoa.c ../src/common/log.c ../src/common/nvm.c ../src/common/options.c ../src/common/pwm.c ../src/common/rom.c ../src/common/signal_capture.c ../src/common/sine_table.c ../src/common/spi.c ../src/common/sqrt.c ../src/common/ssr.c ../src/common/tasker.c ../src/common/timer1.c ../src/common/timer3.c ../src/common/traps.c ../src/common/fan_ctrl_lpc.c ../src/common/getErrLoc.s
+SOURCEFILES_QUOTED_IF_SPACED=../src/inverter.c ../src/main.c ../src/ui.c ../src/task_dev.c ../src/task_temp.c ../src/task_main.c ../src/common/analog.c ../src/common/analog_dsPIC33F.c ../src/common/batt_temp.c ../src/common/CAN/dsPIC33_CAN.c ../src/common/CAN/J1939.c ../src/common/CAN/rv_can.c ../src/common/CAN/sensata_can.c ../src/common/charger.c ../src/common/charger_3step.c ../src/common/charger_cmds.c ../src/common/charger_isr.c ../src/common/charger_liion.c ../src/common/config.c ../src/common/converter_cmds.c ../src/common/dac.c ../src/common/dsPIC_serial.c ../src/common/hs_temp.c ../src/common/inverter_cmds.c ../src/common/inv_check_supply.c ../src/common/inv_deadtime.c ../src/common/inv_harmonic.c ../src/common/inv_thermal.c ../src/common/load_sense.c ../src/common/duty_table.c ../src/common/itoa.c ../src/common/log.c ../src/common/nvm.c ../src/common/options.c ../src/common/pwm.c ../src/common/pll.c ../src/common/xfer.c ../src/common/rom.c ../src/common/signal_capture.c ../src/common/sine_table.c ../src/common/spi.c ../src/common/sqrt.c ../src/common/ssr.c ../src/common/tasker.c ../src/common/telemetry.c ../src/common/crc.c ../src/common/evlog.c ../src/common/fwupdate.c ../src/common/timer1.c ../src/common/timer3.c ../src/common/traps.c ../src/common/fan_ctrl_lpc.c ../src/common/getErrLoc.s
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/1360937237/inverter.o ${OBJECTDIR}/_ext/1360937237/main.o ${OBJECTDIR}/_ext/1360937237/ui.o ${OBJECTDIR}/_ext/1360937237/task_dev.o ${OBJECTDIR}/_ext/1360937237/task_temp.o ${OBJECTDIR}/_ext/1360937237/task_main.o ${OBJECTDIR}/_ext/394045403/analog.o ${OBJECTDIR}/_ext/394045403/analog_dsPIC33F.o ${OBJECTDIR}/_ext/394045403/batt_temp.o ${OBJECTDIR}/_ext/919134522/dsPIC33_CAN.o ${OBJECTDIR}/_ext/919134522/J1939.o ${OBJECTDIR}/_ext/919134522/rv_can.o ${OBJECTDIR}/_ext/919134522/sensata_can.o ${OBJECTDIR}/_ext/394045403/charger.o ${OBJECTDIR}/_ext/394045403/charger_3step.o ${OBJECTDIR}/_ext/394045403/charger_cmds.o ${OBJECTDIR}/_ext/394045403/charger_isr.o ${OBJECTDIR}/_ext/394045403/charger_liion.o ${OBJECTDIR}/_ext/394045403/config.o ${OBJECTDIR}/_ext/394045403/converter_cmds.o ${OBJECTDIR}/_ext/394045403/dac.o ${OBJECTDIR}/_ext/394045403/dsPIC_serial.o ${OBJECTDIR}/_ext/394045403/hs_temp.o ${OBJECTDIR}/_ext/394045403/inverter_cmds.o ${OBJECTDIR}/_ext/394045403/inv_check_supply.o ${OBJECTDIR}/_ext/394045403/itoa.o ${OBJECTDIR}/_ext/394045403/log.o ${OBJECTDIR}/_ext/394045403/nvm.o ${OBJECTDIR}/_ext/394045403/options.o ${OBJECTDIR}/_ext/394045403/pwm.o ${OBJECTDIR}/_ext/394045403/rom.o ${OBJECTDIR}/_ext/394045403/signal_capture.o ${OBJECTDIR}/_ext/394045403/sine_table.o ${OBJECTDIR}/_ext/394045403/spi.o ${OBJECTDIR}/_ext/394045403/sqrt.o ${OBJECTDIR}/_ext/394045403/ssr.o ${OBJECTDIR}/_ext/394045403/tasker.o ${OBJECTDIR}/_ext/394045403/timer1.o ${OBJECTDIR}/_ext/394045403/timer3.o ${OBJECTDIR}/_ext/394045403/traps.o ${OBJECTDIR}/_ext/394045403/fan_ctrl_lpc.o ${OBJECTDIR}/_ext/394045403/getErrLoc.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/1360937237/inverter.o.d ${OBJECTDIR}/_ext/1360937237/main.o.d ${OBJECTDIR}/_ext/1360937237/ui.o.d ${OBJECTDIR}/_ext/1360937237/task_dev.o.d ${OBJECTDIR}/_ext/1360937237/task_temp.o.d ${OBJECTDIR}/_ext/1360937237/task_main.o.d ${OBJECTDIR}/_ext/394045403/analog.o.d ${OBJECTDIR}/_ext/394045403/analog_dsPIC33F.o.d ${OBJECTDIR}/_ext/394045403/batt_temp.o.d ${OBJECTDIR}/_ext/919134522/dsPIC33_CAN.o.d ${OBJECTDIR}/_ext/919134522/J1939.o.d ${OBJECTDIR}/_ext/919134522/rv_can.o.d ${OBJECTDIR}/_ext/919134522/sensata_can.o.d ${OBJECTDIR}/_ext/394045403/charger.o.d ${OBJECTDIR}/_ext/394045403/charger_3step.o.d ${OBJECTDIR}/_ext/394045403/charger_cmds.o.d ${OBJECTDIR}/_ext/394045403/charger_isr.o.d ${OBJECTDIR}/_ext/394045403/charger_liion.o.d ${OBJECTDIR}/_ext/394045403/config.o.d ${OBJECTDIR}/_ext/394045403/converter_cmds.o.d ${OBJECTDIR}/_ext/394045403/dac.o.d ${OBJECTDIR}/_ext/394045403/dsPIC_serial.o.d ${OBJECTDIR}/_ext/394045403/hs_temp.o.d ${OBJECTDIR}/_ext/394045403/inverter_cmds.o.d ${OBJECTDIR}/_ext/394045403/inv_check_supply.o.d ${OBJECTDIR}/_ext/394045403/itoa.o.d ${OBJECTDIR}/_ext/394045403/log.o.d ${OBJECTDIR}/_ext/394045403/nvm.o.d ${OBJECTDIR}/_ext/394045403/options.o.d ${OBJECTDIR}/_ext/394045403/pwm.o.d ${OBJECTDIR}/_ext/394045403/rom.o.d ${OBJECTDIR}/_ext/394045403/signal_capture.o.d ${OBJECTDIR}/_ext/394045403/sine_table.o.d ${OBJECTDIR}/_ext/394045403/spi.o.d ${OBJECTDIR}/_ext/394045403/sqrt.o.d ${OBJECTDIR}/_ext/394045403/ssr.o.d ${OBJECTDIR}/_ext/394045403/tasker.o.d ${OBJECTDIR}/_ext/394045403/timer1.o.d ${OBJECTDIR}/_ext/394045403/timer3.o.d ${OBJECTDIR}/_ext/394045403/traps.o.d ${OBJECTDIR}/_ext/394045403/fan_ctrl_lpc.o.d ${OBJECTDIR}/_ext/394045403/getErrLoc.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/1360937237/inverter.o ${OBJECTDIR}/_ext/1360937237/main.o ${OBJECTDIR}/_ext/1360937237/ui.o ${OBJECTDIR}/_ext/1360937237/task_dev.o ${OBJECTDIR}/_ext/1360937237/task_temp.o ${OBJECTDIR}/_ext/1360937237/task_main.o ${OBJECTDIR}/_ext/394045403/analog.o ${OBJECTDIR}/_ext/394045403/analog_dsPIC33F.o ${OBJECTDIR}/_ext/394045403/batt_temp.o ${OBJECTDIR}/_ext/919134522/dsPIC33_CAN.o ${OBJECTDIR}/_ext/919134522/J1939.o ${OBJECTDIR}/_ext/919134522/rv_can.o ${OBJECTDIR}/_ext/919134522/sensata_can.o ${OBJECTDIR}/_ext/394045403/charger.o ${OBJECTDIR}/_ext/394045403/charger_3step.o ${OBJECTDIR}/_ext/394045403/charger_cmds.o ${OBJECTDIR}/_ext/394045403/charger_isr.o ${OBJECTDIR}/_ext/394045403/charger_liion.o ${OBJECTDIR}/_ext/394045403/config.o ${OBJECTDIR}/_ext/394045403/converter_cmds.o ${OBJECTDIR}/_ext/394045403/dac.o ${OBJECTDIR}/_ext/394045403/dsPIC_serial.o ${OBJECTDIR}/_ext/394045403/hs_temp.o ${OBJECTDIR}/_ext/394045403/inverter_cmds.o ${OBJECTDIR}/_ext/394045403/inv_check_supply.o ${OBJECTDIR}/_ext/394045403/inv_deadtime.o ${OBJECTDIR}/_ext/394045403/inv_harmonic.o ${OBJECTDIR}/_ext/394045403/inv_thermal.o ${OBJECTDIR}/_ext/394045403/load_sense.o ${OBJECTDIR}/_ext/394045403/duty_table.o ${OBJECTDIR}/_ext/394045403/itoa.o ${OBJECTDIR}/_ext/394045403/log.o ${OBJECTDIR}/_ext/394045403/nvm.o ${OBJECTDIR}/_ext/394045403/options.o ${OBJECTDIR}/_ext/394045403/pwm.o ${OBJECTDIR}/_ext/394045403/pll.o ${OBJECTDIR}/_ext/394045403/xfer.o ${OBJECTDIR}/_ext/394045403/rom.o ${OBJECTDIR}/_ext/394045403/signal_capture.o ${OBJECTDIR}/_ext/394045403/sine_table.o ${OBJECTDIR}/_ext/394045403/spi.o ${OBJECTDIR}/_ext/394045403/sqrt.o ${OBJECTDIR}/_ext/394045403/ssr.o ${OBJECTDIR}/_ext/394045403/tasker.o ${OBJECTDIR}/_ext/394045403/telemetry.o ${OBJECTDIR}/_ext/394045403/crc.o ${OBJECTDIR}/_ext/394045403/evlog.o ${OBJECTDIR}/_ext/394045403/fwupdate.o ${OBJECTDIR}/_ext/394045403/timer1.o ${OBJECTDIR}/_ext/394045403/timer3.o ${OBJECTDIR}/_ext/394045403/traps.o ${OBJECTDIR}/_ext/394045403/fan_ctrl_lpc.o ${OBJECTDIR}/_ext/394045403/getErrLoc.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/1360937237/inverter.o.d ${OBJECTDIR}/_ext/1360937237/main.o.d ${OBJECTDIR}/_ext/1360937237/ui.o.d ${OBJECTDIR}/_ext/1360937237/task_dev.o.d ${OBJECTDIR}/_ext/1360937237/task_temp.o.d ${OBJECTDIR}/_ext/1360937237/task_main.o.d ${OBJECTDIR}/_ext/394045403/analog.o.d ${OBJECTDIR}/_ext/394045403/analog_dsPIC33F.o.d ${OBJECTDIR}/_ext/394045403/batt_temp.o.d ${OBJECTDIR}/_ext/919134522/dsPIC33_CAN.o.d ${OBJECTDIR}/_ext/919134522/J1939.o.d ${OBJECTDIR}/_ext/919134522/rv_can.o.d ${OBJECTDIR}/_ext/919134522/sensata_can.o.d ${OBJECTDIR}/_ext/394045403/charger.o.d ${OBJECTDIR}/_ext/394045403/charger_3step.o.d ${OBJECTDIR}/_ext/394045403/charger_cmds.o.d ${OBJECTDIR}/_ext/394045403/charger_isr.o.d ${OBJECTDIR}/_ext/394045403/charger_liion.o.d ${OBJECTDIR}/_ext/394045403/config.o.d ${OBJECTDIR}/_ext/394045403/converter_cmds.o.d ${OBJECTDIR}/_ext/394045403/dac.o.d ${OBJECTDIR}/_ext/394045403/dsPIC_serial.o.d ${OBJECTDIR}/_ext/394045403/hs_temp.o.d ${OBJECTDIR}/_ext/394045403/inverter_cmds.o.d ${OBJECTDIR}/_ext/394045403/inv_check_supply.o.d ${OBJECTDIR}/_ext/394045403/inv_deadtime.o.d ${OBJECTDIR}/_ext/394045403/inv_harmonic.o.d ${OBJECTDIR}/_ext/394045403/inv_thermal.o.d ${OBJECTDIR}/_ext/394045403/load_sense.o.d ${OBJECTDIR}/_ext/394045403/duty_table.o.d ${OBJECTDIR}/_ext/394045403/itoa.o.d ${OBJECTDIR}/_ext/394045403/log.o.d ${OBJECTDIR}/_ext/394045403/nvm.o.d ${OBJECTDIR}/_ext/394045403/options.o.d ${OBJECTDIR}/_ext/394045403/pwm.o.d ${OBJECTDIR}/_ext/394045403/pll.o.d ${OBJECTDIR}/_ext/394045403/xfer.o.d ${OBJECTDIR}/_ext/394045403/rom.o.d ${OBJECTDIR}/_ext/394045403/signal_capture.o.d ${OBJECTDIR}/_ext/394045403/sine_table.o.d ${OBJECTDIR}/_ext/394045403/spi.o.d ${OBJECTDIR}/_ext/394045403/sqrt.o.d ${OBJECTDIR}/_ext/394045403/ssr.o.d ${OBJECTDIR}/_ext/394045403/tasker.o.d ${OBJECTDIR}/_ext/394045403/telemetry.o.d ${OBJECTDIR}/_ext/394045403/crc.o.d ${OBJECTDIR}/_ext/394045403/evlog.o.d ${OBJECTDIR}/_ext/394045403/fwupdate.o.d ${OBJECTDIR}/_ext/394045403/timer1.o.d ${OBJECTDIR}/_ext/394045403/timer3.o.d ${OBJECTDIR}/_ext/394045403/traps.o.d ${OBJECTDIR}/_ext/394045403/fan_ctrl_lpc.o.d ${OBJECTDIR}/_ext/394045403/getErrLoc.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/_ext/1360937237/inverter.o ${OBJECTDIR}/_ext/1360937237/main.o ${OBJECTDIR}/_ext/1360937237/ui.o ${OBJECTDIR}/_ext/1360937237/task_dev.o ${OBJECTDIR}/_ext/1360937237/task_temp.o ${OBJECTDIR}/_ext/1360937237/task_main.o ${OBJECTDIR}/_ext/394045403/analog.o ${OBJECTDIR}/_ext/394045403/analog_dsPIC33F.o ${OBJECTDIR}/_ext/394045403/batt_temp.o ${OBJECTDIR}/_ext/919134522/dsPIC33_CAN.o ${OBJECTDIR}/_ext/919134522/J1939.o ${OBJECTDIR}/_ext/919134522/rv_can.o ${OBJECTDIR}/_ext/919134522/sensata_can.o ${OBJECTDIR}/_ext/394045403/charger.o ${OBJECTDIR}/_ext/394045403/charger_3step.o ${OBJECTDIR}/_ext/394045403/charger_cmds.o ${OBJECTDIR}/_ext/394045403/charger_isr.o ${OBJECTDIR}/_ext/394045403/charger_liion.o ${OBJECTDIR}/_ext/394045403/config.o ${OBJECTDIR}/_ext/394045403/converter_cmds.o ${OBJECTDIR}/_ext/394045403/dac.o ${OBJECTDIR}/_ext/394045403/dsPIC_serial.o ${OBJECTDIR}/_ext/394045403/hs_temp.o ${OBJECTDIR}/_ext/394045403/inverter_cmds.o ${OBJECTDIR}/_ext/394045403/inv_check_supply.o ${OBJECTDIR}/_ext/394045403/itoa.o ${OBJECTDIR}/_ext/394045403/log.o ${OBJECTDIR}/_ext/394045403/nvm.o ${OBJECTDIR}/_ext/394045403/options.o ${OBJECTDIR}/_ext/394045403/pwm.o ${OBJECTDIR}/_ext/394045403/rom.o ${OBJECTDIR}/_ext/394045403/signal_capture.o ${OBJECTDIR}/_ext/394045403/sine_table.o ${OBJECTDIR}/_ext/394045403/spi.o ${OBJECTDIR}/_ext/394045403/sqrt.o ${OBJECTDIR}/_ext/394045403/ssr.o ${OBJECTDIR}/_ext/394045403/tasker.o ${OBJECTDIR}/_ext/394045403/timer1.o ${OBJECTDIR}/_ext/394045403/timer3.o ${OBJECTDIR}/_ext/394045403/traps.o ${OBJECTDIR}/_ext/394045403/fan_ctrl_lpc.o ${OBJECTDIR}/_ext/394045403/getErrLoc.o
+OBJECTFILES=${OBJECTDIR}/_ext/1360937237/inverter.o ${OBJECTDIR}/_ext/1360937237/main.o ${OBJECTDIR}/_ext/1360937237/ui.o ${OBJECTDIR}/_ext/1360937237/task_dev.o ${OBJECTDIR}/_ext/1360937237/task_temp.o ${OBJECTDIR}/_ext/1360937237/task_main.o ${OBJECTDIR}/_ext/394045403/analog.o ${OBJECTDIR}/_ext/394045403/analog_dsPIC33F.o ${OBJECTDIR}/_ext/394045403/batt_temp.o ${OBJECTDIR}/_ext/919134522/dsPIC33_CAN.o ${OBJECTDIR}/_ext/919134522/J1939.o ${OBJECTDIR}/_ext/919134522/rv_can.o ${OBJECTDIR}/_ext/919134522/sensata_can.o ${OBJECTDIR}/_ext/394045403/charger.o ${OBJECTDIR}/_ext/394045403/charger_3step.o ${OBJECTDIR}/_ext/394045403/charger_cmds.o ${OBJECTDIR}/_ext/394045403/charger_isr.o ${OBJECTDIR}/_ext/394045403/charger_liion.o ${OBJECTDIR}/_ext/394045403/config.o ${OBJECTDIR}/_ext/394045403/converter_cmds.o ${OBJECTDIR}/_ext/394045403/dac.o ${OBJECTDIR}/_ext/394045403/dsPIC_serial.o ${OBJECTDIR}/_ext/394045403/hs_temp.o ${OBJECTDIR}/_ext/394045403/inverter_cmds.o ${OBJECTDIR}/_ext/394045403/inv_check_supply.o ${OBJECTDIR}/_ext/394045403/inv_deadtime.o ${OBJECTDIR}/_ext/394045403/inv_harmonic.o ${OBJECTDIR}/_ext/394045403/inv_thermal.o ${OBJECTDIR}/_ext/394045403/load_sense.o ${OBJECTDIR}/_ext/394045403/duty_table.o ${OBJECTDIR}/_ext/394045403/itoa.o ${OBJECTDIR}/_ext/394045403/log.o ${OBJECTDIR}/_ext/394045403/nvm.o ${OBJECTDIR}/_ext/394045403/options.o ${OBJECTDIR}/_ext/394045403/pwm.o ${OBJECTDIR}/_ext/394045403/pll.o ${OBJECTDIR}/_ext/394045403/xfer.o ${OBJECTDIR}/_ext/394045403/rom.o ${OBJECTDIR}/_ext/394045403/signal_capture.o ${OBJECTDIR}/_ext/394045403/sine_table.o ${OBJECTDIR}/_ext/394045403/spi.o ${OBJECTDIR}/_ext/394045403/sqrt.o ${OBJECTDIR}/_ext/394045403/ssr.o ${OBJECTDIR}/_ext/394045403/tasker.o ${OBJECTDIR}/_ext/394045403/telemetry.o ${OBJECTDIR}/_ext/394045403/crc.o ${OBJECTDIR}/_ext/394045403/evlog.o ${OBJECTDIR}/_ext/394045403/fwupdate.o ${OBJECTDIR}/_ext/394045403/timer1.o ${OBJECTDIR}/_ext/394045403/timer3.o ${OBJECTDIR}/_ext/394045403/traps.o ${OBJECTDIR}/_ext/394045403/fan_ctrl_lpc.o ${OBJECTDIR}/_ext/394045403/getErrLoc.o
 
 # Source Files
-SOURCEFILES=../src/inverter.c ../src/main.c ../src/ui.c ../src/task_dev.c ../src/task_temp.c ../src/task_main.c ../src/common/analog.c ../src/common/analog_dsPIC33F.c ../src/common/batt_temp.c ../src/common/CAN/dsPIC33_CAN.c ../src/common/CAN/J1939.c ../src/common/CAN/rv_can.c ../src/common/CAN/sensata_can.c ../src/common/charger.c ../src/common/charger_3step.c ../src/common/charger_cmds.c ../src/common/charger_isr.c ../src/common/charger_liion.c ../src/common/config.c ../src/common/converter_cmds.c ../src/common/dac.c ../src/common/dsPIC_serial.c ../src/common/hs_temp.c ../src/common/inverter_cmds.c ../src/common/inv_check_supply.c ../src/common/itoa.c ../src/common/log.c ../src/common/nvm.c ../src/common/options.c ../src/common/pwm.c ../src/common/rom.c ../src/common/signal_capture.c ../src/common/sine_table.c ../src/common/spi.c ../src/common/sqrt.c ../src/common/ssr.c ../src/common/tasker.c ../src/common/timer1.c ../src/common/timer3.c ../src/common/traps.c ../src/common/fan_ctrl_lpc.c ../src/common/getErrLoc.s
+SOURCEFILES=../src/inverter.c ../src/main.c ../src/ui.c ../src/task_dev.c ../src/task_temp.c ../src/task_main.c ../src/common/analog.c ../src/common/analog_dsPIC33F.c ../src/common/batt_temp.c ../src/common/CAN/dsPIC33_CAN.c ../src/common/CAN/J1939.c ../src/common/CAN/rv_can.c ../src/common/CAN/sensata_can.c ../src/common/charger.c ../src/common/charger_3step.c ../src/common/charger_cmds.c ../src/common/charger_isr.c ../src/common/charger_liion.c ../src/common/config.c ../src/common/converter_cmds.c ../src/common/dac.c ../src/common/dsPIC_serial.c ../src/common/hs_temp.c ../src/common/inverter_cmds.c ../src/common/inv_check_supply.c ../src/common/inv_deadtime.c ../src/common/inv_harmonic.c ../src/common/inv_thermal.c ../src/common/load_sense.c ../src/common/duty_table.c ../src/common/itoa.c ../src/common/log.c ../src/common/nvm.c ../src/common/options.c ../src/common/pwm.c ../src/common/pll.c ../src/common/xfer.c ../src/common/rom.c ../src/common/signal_capture.c ../src/common/sine_table.c ../src/common/spi.c ../src/common/sqrt.c ../src/common/ssr.c ../src/common/tasker.c ../src/common/telemetry.c ../src/common/crc.c ../src/common/evlog.c ../src/common/fwupdate.c ../src/common/timer1.c ../src/common/timer3.c ../src/common/traps.c ../src/common/fan_ctrl_lpc.c ../src/common/getErrLoc.s
 
 
 CFLAGS=
@@ -286,6 +286,41 @@ ${OBJECTDIR}/_ext/394045403/inv_check_supply.o: ../src/common/inv_check_supply.c
 	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/inv_check_supply.c  -o ${OBJECTDIR}/_ext/394045403/inv_check_supply.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/inv_check_supply.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/inv_check_supply.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
+${OBJECTDIR}/_ext/394045403/inv_deadtime.o: ../src/common/inv_deadtime.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_deadtime.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_deadtime.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/inv_deadtime.c  -o ${OBJECTDIR}/_ext/394045403/inv_deadtime.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/inv_deadtime.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/inv_deadtime.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/inv_harmonic.o: ../src/common/inv_harmonic.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_harmonic.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_harmonic.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/inv_harmonic.c  -o ${OBJECTDIR}/_ext/394045403/inv_harmonic.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/inv_harmonic.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/inv_harmonic.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/inv_thermal.o: ../src/common/inv_thermal.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_thermal.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_thermal.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/inv_thermal.c  -o ${OBJECTDIR}/_ext/394045403/inv_thermal.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/inv_thermal.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/inv_thermal.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/load_sense.o: ../src/common/load_sense.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/load_sense.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/load_sense.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/load_sense.c  -o ${OBJECTDIR}/_ext/394045403/load_sense.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/load_sense.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/load_sense.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/duty_table.o: ../src/common/duty_table.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/duty_table.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/duty_table.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/duty_table.c  -o ${OBJECTDIR}/_ext/394045403/duty_table.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/duty_table.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/duty_table.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
 ${OBJECTDIR}/_ext/394045403/itoa.o: ../src/common/itoa.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
 	@${RM} ${OBJECTDIR}/_ext/394045403/itoa.o.d 
@@ -321,6 +356,20 @@ ${OBJECTDIR}/_ext/394045403/pwm.o: ../src/common/pwm.c  nbproject/Makefile-${CND
 	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/pwm.c  -o ${OBJECTDIR}/_ext/394045403/pwm.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/pwm.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/pwm.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
+${OBJECTDIR}/_ext/394045403/pll.o: ../src/common/pll.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/pll.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/pll.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/pll.c  -o ${OBJECTDIR}/_ext/394045403/pll.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/pll.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/pll.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/xfer.o: ../src/common/xfer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/xfer.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/xfer.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/xfer.c  -o ${OBJECTDIR}/_ext/394045403/xfer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/xfer.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/xfer.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
 ${OBJECTDIR}/_ext/394045403/rom.o: ../src/common/rom.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
 	@${RM} ${OBJECTDIR}/_ext/394045403/rom.o.d 
@@ -370,6 +419,34 @@ ${OBJECTDIR}/_ext/394045403/tasker.o: ../src/common/tasker.c  nbproject/Makefile
 	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/tasker.c  -o ${OBJECTDIR}/_ext/394045403/tasker.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/tasker.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/tasker.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
+${OBJECTDIR}/_ext/394045403/telemetry.o: ../src/common/telemetry.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/telemetry.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/telemetry.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/telemetry.c  -o ${OBJECTDIR}/_ext/394045403/telemetry.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/telemetry.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/telemetry.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/crc.o: ../src/common/crc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/crc.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/crc.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/crc.c  -o ${OBJECTDIR}/_ext/394045403/crc.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/crc.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/crc.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/evlog.o: ../src/common/evlog.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/evlog.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/evlog.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/evlog.c  -o ${OBJECTDIR}/_ext/394045403/evlog.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/evlog.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/evlog.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/fwupdate.o: ../src/common/fwupdate.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/fwupdate.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/fwupdate.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/fwupdate.c  -o ${OBJECTDIR}/_ext/394045403/fwupdate.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/fwupdate.o.d"      -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1    -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/fwupdate.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
 ${OBJECTDIR}/_ext/394045403/timer1.o: ../src/common/timer1.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
 	@${RM} ${OBJECTDIR}/_ext/394045403/timer1.o.d 
@@ -574,6 +651,41 @@ ${OBJECTDIR}/_ext/394045403/inv_check_supply.o: ../src/common/inv_check_supply.c
 	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/inv_check_supply.c  -o ${OBJECTDIR}/_ext/394045403/inv_check_supply.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/inv_check_supply.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/inv_check_supply.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
+${OBJECTDIR}/_ext/394045403/inv_deadtime.o: ../src/common/inv_deadtime.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_deadtime.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_deadtime.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/inv_deadtime.c  -o ${OBJECTDIR}/_ext/394045403/inv_deadtime.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/inv_deadtime.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/inv_deadtime.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/inv_harmonic.o: ../src/common/inv_harmonic.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_harmonic.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_harmonic.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/inv_harmonic.c  -o ${OBJECTDIR}/_ext/394045403/inv_harmonic.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/inv_harmonic.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/inv_harmonic.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/inv_thermal.o: ../src/common/inv_thermal.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_thermal.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/inv_thermal.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/inv_thermal.c  -o ${OBJECTDIR}/_ext/394045403/inv_thermal.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/inv_thermal.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/inv_thermal.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/load_sense.o: ../src/common/load_sense.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/load_sense.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/load_sense.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/load_sense.c  -o ${OBJECTDIR}/_ext/394045403/load_sense.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/load_sense.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/load_sense.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/duty_table.o: ../src/common/duty_table.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/duty_table.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/duty_table.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/duty_table.c  -o ${OBJECTDIR}/_ext/394045403/duty_table.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/duty_table.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/duty_table.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
 ${OBJECTDIR}/_ext/394045403/itoa.o: ../src/common/itoa.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
 	@${RM} ${OBJECTDIR}/_ext/394045403/itoa.o.d 
@@ -609,6 +721,20 @@ ${OBJECTDIR}/_ext/394045403/pwm.o: ../src/common/pwm.c  nbproject/Makefile-${CND
 	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/pwm.c  -o ${OBJECTDIR}/_ext/394045403/pwm.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/pwm.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/pwm.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
+${OBJECTDIR}/_ext/394045403/pll.o: ../src/common/pll.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/pll.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/pll.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/pll.c  -o ${OBJECTDIR}/_ext/394045403/pll.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/pll.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/pll.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/xfer.o: ../src/common/xfer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/xfer.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/xfer.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/xfer.c  -o ${OBJECTDIR}/_ext/394045403/xfer.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/xfer.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/xfer.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
 ${OBJECTDIR}/_ext/394045403/rom.o: ../src/common/rom.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
 	@${RM} ${OBJECTDIR}/_ext/394045403/rom.o.d 
@@ -658,6 +784,34 @@ ${OBJECTDIR}/_ext/394045403/tasker.o: ../src/common/tasker.c  nbproject/Makefile
 	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/tasker.c  -o ${OBJECTDIR}/_ext/394045403/tasker.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/tasker.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
 	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/tasker.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
 	
+${OBJECTDIR}/_ext/394045403/telemetry.o: ../src/common/telemetry.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/telemetry.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/telemetry.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/telemetry.c  -o ${OBJECTDIR}/_ext/394045403/telemetry.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/telemetry.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/telemetry.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/crc.o: ../src/common/crc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/crc.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/crc.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/crc.c  -o ${OBJECTDIR}/_ext/394045403/crc.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/crc.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/crc.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/evlog.o: ../src/common/evlog.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/evlog.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/evlog.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/evlog.c  -o ${OBJECTDIR}/_ext/394045403/evlog.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/evlog.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/evlog.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
+${OBJECTDIR}/_ext/394045403/fwupdate.o: ../src/common/fwupdate.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
+	@${RM} ${OBJECTDIR}/_ext/394045403/fwupdate.o.d 
+	@${RM} ${OBJECTDIR}/_ext/394045403/fwupdate.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ../src/common/fwupdate.c  -o ${OBJECTDIR}/_ext/394045403/fwupdate.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MMD -MF "${OBJECTDIR}/_ext/394045403/fwupdate.o.d"        -g -omf=elf -DMODEL_12LPC15_FW0058 -DXPRJ_12LPC15=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mlarge-code -O0 -I"../src" -I"../src/common" -I"../src/common/Cals" -I"../src/common/CAN" -I"../src/common/Models" -DMODEL_12LPC15 -msmart-io=1 -Wall -msfr-warn=off -finline 
+	@${FIXDEPS} "${OBJECTDIR}/_ext/394045403/fwupdate.o.d" $(SILENT)  -rsi ${MP_CC_DIR}../ 
+	
 ${OBJECTDIR}/_ext/394045403/timer1.o: ../src/common/timer1.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}/_ext/394045403" 
 	@${RM} ${OBJECTDIR}/_ext/394045403/timer1.o.d 
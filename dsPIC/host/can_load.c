@@ -0,0 +1,582 @@
+// <><><><><><><><><><><><><> can_load.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host load test of a CAN node (can_load)
+//
+//  Runs against can_node (host_can_node.c), or a unit, on a SocketCAN
+//  interface (CAN_IFNAME, default "vcan0"):
+//
+//      can_load [seconds]
+//
+//  Each pass listens for the given time (default CANLOAD_LISTEN_SEC) and
+//  then times CANLOAD_COMMANDS RV-C INVERTER_COMMANDs, each turning load
+//  sense on or off, to the INVERTER_STATUS that shows it. That status is
+//  requested, so it is not held back by the broadcast rate limit.
+//    pass 1  quiet bus
+//    pass 2  with telemetry streaming every PWM interrupt, three signals
+//
+//  Between the two it times a service tool screen refresh: the first
+//  CANLOAD_SCREEN_FIELDS numeric fields the node has (found with range
+//  GET_FIELDS requests) read with one GET_FIELD round trip each, then with
+//  one GET_FIELDS batch. It fails if the batch does not return every field
+//  or is not CANLOAD_BATCH_GAIN times faster. Then a SET_FIELDS batch with
+//  a read only field in it must be NAKed and leave the other field as it
+//  was, and the same batch without it must be ACKed and applied.
+//
+//  Each pass reports, for every DGN the node sent: frames, frames/sec and
+//  the shortest and longest gap between them; then the total frames/sec,
+//  the bus load at RV-C's 250 kbit/s and the command round trip mean and
+//  max. It fails if
+//    - a status DGN went out closer than CANLOAD_MIN_GAP_MSEC,
+//    - one went longer than its RVC_BCAST_STATE_MSEC refresh,
+//    - a measurement DGN's mean period is off RVC_BCAST_MEAS_MSEC by more
+//      than CANLOAD_MEAS_PCT,
+//    - a command went unanswered for CANLOAD_RTT_TIMEOUT_MSEC or the max
+//      round trip is over CANLOAD_MAX_RTT_MSEC,
+//    - the screen refresh or set batch checks above failed.
+//  Returns the number of failures. 'make vcan_check' runs it.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "J1939.h"
+#include "rv_can.h"
+#include "sensata_can.h"
+#include "telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+// ---------
+// constants
+// ---------
+#define CANLOAD_LISTEN_SEC          (12)    // > 2 x RVC_BCAST_STATE_MSEC
+#define CANLOAD_COMMANDS            (200)
+#define CANLOAD_MY_SA               (0xF9)  // service tool
+#define CANLOAD_INSTANCE            (1)
+#define CANLOAD_MIN_GAP_MSEC        (19)    // smallest min interval in rv_can.c, less 1 msec tick
+#define CANLOAD_MEAS_PCT            (5.0)
+#define CANLOAD_RTT_TIMEOUT_MSEC    (100)
+#define CANLOAD_MAX_RTT_MSEC        (20)
+#define CANLOAD_MAX_DGNS            (64)
+#define CANLOAD_BITS_PER_FRAME      (131)   // 29 bit id, 8 data bytes, with typical stuffing
+#define CANLOAD_BIT_RATE            (250000.0)
+#define CANLOAD_SCREEN_FIELDS       (60)    // one service tool screen
+#define CANLOAD_BATCH_GAIN          (3.0)   // the node here answers a GET_FIELD in ~2 msec; a
+                                            // tool's own latency adds to each round trip
+#define CANLOAD_FIELD_TIMEOUT_MSEC  (200)
+#define CANLOAD_SET_FIELD           (SENFLD_INV_LOADSENSE_DELAY)
+#define CANLOAD_READONLY_FIELD      (SENFLD_INV_SUPPLY_LOW_HYSTER)
+
+// ----------
+// data types
+// ----------
+typedef struct
+{
+    uint32_t dgn;
+    uint32_t frames;
+    double   first, last;   // msec
+    double   minGap, maxGap;
+} CANLOAD_DGN_t;
+
+// ----------
+// local data
+// ----------
+static int           s_sock = -1;
+static int           s_nodeSa = -1;     // learnt from the first status; -1=not yet
+static CANLOAD_DGN_t s_dgn[CANLOAD_MAX_DGNS];
+static int           s_ndgn;
+static uint32_t      s_frames;
+
+// DGNs sent every RVC_BCAST_MEAS_MSEC (rv_can.c s_bcast[])
+static const uint32_t s_measDgn[] =
+{
+    RVC_DGN_DC_SOURCE_STATUS_1, RVC_DGN_DC_SOURCE_STATUS_2, RVC_DGN_INVERTER_AC_STATUS_1,
+    RVC_DGN_INVERTER_DC_STATUS, RVC_DGN_CHARGER_AC_STATUS_1, RVC_DGN_CHARGER_AC_STATUS_2,
+};
+
+// ------------------------------------------------------------------------------------
+static double canload_Msec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return(ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0);
+}
+
+// ------------------------------------------------------------------------------------
+static int canload_Open(void)
+{
+    struct sockaddr_can addr;
+    struct ifreq        ifr;
+    const char* ifname = getenv("CAN_IFNAME");
+
+    if (ifname == 0 || *ifname == 0) ifname = "vcan0";
+    s_sock = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (s_sock < 0)
+    {
+        printf("can_load: no SocketCAN, errno=%d\n", errno);
+        return(1);
+    }
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ-1);
+    if (ioctl(s_sock, SIOCGIFINDEX, &ifr) < 0)
+    {
+        printf("can_load: no interface '%s'\n", ifname);
+        return(1);
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family  = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(s_sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        printf("can_load: bind '%s' failed, errno=%d\n", ifname, errno);
+        return(1);
+    }
+    return(0);
+}
+
+// ------------------------------------------------------------------------------------
+static void canload_Send(uint32_t dgn, const uint8_t* data)
+{
+    struct can_frame cf;
+
+    memset(&cf, 0, sizeof(cf));
+    cf.can_id  = CAN_EFF_FLAG | (6UL << 26) | ((dgn & 0x1FFFF) << 8) | CANLOAD_MY_SA;
+    cf.can_dlc = 8;
+    memcpy(cf.data, data, 8);
+    if (write(s_sock, &cf, sizeof(cf)) != (ssize_t)sizeof(cf))
+    {
+        printf("can_load: write failed, errno=%d\n", errno);
+    }
+}
+
+// ------------------------------------------------------------------------------------
+// next frame from the node, counted; waits up to waitMsec
+// returns its DGN, 0=none
+static uint32_t canload_Receive(double waitMsec, struct can_frame* cf)
+{
+    struct pollfd pfd = { .fd = s_sock, .events = POLLIN };
+    uint32_t dgn;
+    double   now, gap;
+    int      i;
+
+    if (poll(&pfd, 1, (int)(waitMsec + 0.999)) <= 0) return(0);
+    if (read(s_sock, cf, sizeof(*cf)) != (ssize_t)sizeof(*cf)) return(0);
+    if (!(cf->can_id & CAN_EFF_FLAG) || (cf->can_id & (CAN_ERR_FLAG | CAN_RTR_FLAG))) return(0);
+
+    dgn = (cf->can_id >> 8) & 0x1FFFF;
+    if (s_nodeSa < 0 && dgn == RVC_DGN_INVERTER_STATUS) s_nodeSa = cf->can_id & 0xFF;
+    if ((int)(cf->can_id & 0xFF) != s_nodeSa) return(0);
+
+    now = canload_Msec();
+    s_frames++;
+    for (i = 0; i < s_ndgn && s_dgn[i].dgn != dgn; i++) ;
+    if (i == s_ndgn)
+    {
+        if (s_ndgn >= CANLOAD_MAX_DGNS) return(dgn);
+        s_ndgn++;
+        memset(&s_dgn[i], 0, sizeof(s_dgn[i]));
+        s_dgn[i].dgn    = dgn;
+        s_dgn[i].first  = now;
+        s_dgn[i].minGap = 1e9;
+    }
+    else
+    {
+        gap = now - s_dgn[i].last;
+        if (gap < s_dgn[i].minGap) s_dgn[i].minGap = gap;
+        if (gap > s_dgn[i].maxGap) s_dgn[i].maxGap = gap;
+    }
+    s_dgn[i].last = now;
+    s_dgn[i].frames++;
+    return(dgn);
+}
+
+// ------------------------------------------------------------------------------------
+static int canload_IsMeas(uint32_t dgn)
+{
+    int i;
+    for (i = 0; i < (int)(sizeof(s_measDgn)/sizeof(s_measDgn[0])); i++)
+    {
+        if (s_measDgn[i] == dgn) return(1);
+    }
+    return(0);
+}
+
+// ------------------------------------------------------------------------------------
+// listen, then report and check the broadcasts; returns the number of failures
+static int canload_Broadcasts(const char* name, int seconds)
+{
+    struct can_frame cf;
+    double start = canload_Msec();
+    double end   = start + seconds * 1000.0;
+    double period;
+    int    nfail = 0;
+    int    i;
+
+    s_ndgn = 0;
+    s_frames = 0;
+    while (canload_Msec() < end) canload_Receive(end - canload_Msec(), &cf);
+
+    printf("can_load: %s, node %02Xh, %d sec\n", name, s_nodeSa, seconds);
+    printf("    DGN    frames  per sec  min gap  max gap  msec\n");
+    for (i = 0; i < s_ndgn; i++)
+    {
+        CANLOAD_DGN_t* d = &s_dgn[i];
+        int status = (d->dgn >= 0x1FE00) && (d->dgn != SENSATA_CUSTOM_TELEMETRY_DATA_DGN);
+        const char* why = "";
+
+        if (d->frames < 2) d->minGap = d->maxGap = 0;
+        if (status && d->frames >= 2 && d->minGap < CANLOAD_MIN_GAP_MSEC) why = "  sent too often";
+        if (status && d->maxGap > RVC_BCAST_STATE_MSEC + 100) why = "  not refreshed";
+        if (status && d->frames >= 2 && canload_IsMeas(d->dgn))
+        {
+            period = (d->last - d->first) / (d->frames - 1);
+            if (period < RVC_BCAST_MEAS_MSEC * (1.0 - CANLOAD_MEAS_PCT/100) ||
+                period > RVC_BCAST_MEAS_MSEC * (1.0 + CANLOAD_MEAS_PCT/100)) why = "  off its period";
+        }
+        if (*why) nfail++;
+        printf("    %05X %7u %8.1f %8.1f %8.1f%s\n", d->dgn, d->frames,
+               d->frames * 1000.0 / (seconds * 1000.0), d->minGap, d->maxGap, why);
+    }
+    printf("    total %u frames, %.1f per sec, bus load %.1f%% at 250 kbit/s\n", s_frames,
+           s_frames / (double)seconds, 100.0 * s_frames * CANLOAD_BITS_PER_FRAME / (seconds * CANLOAD_BIT_RATE));
+    if (s_ndgn == 0)
+    {
+        printf("can_load: nothing heard from the node\n");
+        nfail++;
+    }
+    return(nfail);
+}
+
+// ------------------------------------------------------------------------------------
+static int canload_CompareMsec(const void* a, const void* b)
+{
+    double d = *(const double*)a - *(const double*)b;
+    return((d > 0) - (d < 0));
+}
+
+// ------------------------------------------------------------------------------------
+// time the commands to the status that shows them; returns the number of failures
+static int canload_RoundTrip(void)
+{
+    struct can_frame cf;
+    uint8_t data[8];
+    double  sent, rtt, sum = 0, timeout;
+    double  rtts[CANLOAD_COMMANDS];
+    int     i, lsense, nlost = 0, nok = 0;
+
+    for (i = 0; i < CANLOAD_COMMANDS; i++)
+    {
+        // load sense on, off, ...; inverter, pass thru and startup flags unchanged
+        lsense = (i & 1) ? 0 : 1;
+        memset(data, 0xFF, sizeof(data));
+        data[0] = CANLOAD_INSTANCE;
+        data[1] = 0xF3 | (lsense << 2);
+        sent = canload_Msec();
+        timeout = sent + CANLOAD_RTT_TIMEOUT_MSEC;
+        canload_Send(RVC_DGN_INVERTER_COMMAND, data);
+        for (;;)
+        {
+            if (canload_Msec() >= timeout)
+            {
+                nlost++;
+                break;
+            }
+            if (canload_Receive(timeout - canload_Msec(), &cf) == RVC_DGN_INVERTER_STATUS &&
+                ((cf.data[2] & 0x04) ? 1 : 0) == lsense)
+            {
+                rtt = canload_Msec() - sent;
+                sum += rtt;
+                rtts[nok++] = rtt;
+                break;
+            }
+        }
+    }
+    if (nok == 0)
+    {
+        printf("    command round trip: none of %d answered\n", CANLOAD_COMMANDS);
+        return(nlost);
+    }
+    qsort(rtts, nok, sizeof(rtts[0]), canload_CompareMsec);
+    printf("    command round trip %.2f msec mean, %.2f 95th pct, %.2f max; %d of %d unanswered\n",
+           sum / nok, rtts[(nok * 95) / 100], rtts[nok-1], nlost, CANLOAD_COMMANDS);
+    return(nlost + (rtts[nok-1] > CANLOAD_MAX_RTT_MSEC));
+}
+
+// ------------------------------------------------------------------------------------
+// one GET_FIELD round trip; returns the field type, -1=no answer
+static int canload_GetField(uint16_t field, uint8_t* value)
+{
+    struct can_frame cf;
+    uint8_t data[8];
+    double  timeout = canload_Msec() + CANLOAD_FIELD_TIMEOUT_MSEC;
+
+    memset(data, 0xFF, sizeof(data));
+    data[0] = CANLOAD_INSTANCE;
+    data[1] = field & 0xFF;
+    data[2] = field >> 8;
+    canload_Send(SENSATA_CUSTOM_GET_FIELD_DGN, data);
+    while (canload_Msec() < timeout)
+    {
+        if (canload_Receive(timeout - canload_Msec(), &cf) == SENSATA_CUSTOM_GET_FIELD_RSP_DGN &&
+            cf.data[1] == data[1] && cf.data[2] == data[2])
+        {
+            if (value) memcpy(value, &cf.data[4], 4);
+            return(cf.data[3]);
+        }
+    }
+    return(-1);
+}
+
+// ------------------------------------------------------------------------------------
+// collect the multi-packet GET_FIELDS response; returns its length, -1=none
+static int canload_GetFieldsRsp(uint8_t* rsp, int size)
+{
+    struct can_frame cf;
+    double  timeout = canload_Msec() + CANLOAD_FIELD_TIMEOUT_MSEC;
+    int     len = -1, npackets = 0, next = 1, at;
+
+    while (canload_Msec() < timeout)
+    {
+        switch (canload_Receive(timeout - canload_Msec(), &cf))
+        {
+        case J1939_DGN_INITIAL_MULTI_PACKET:
+            if (cf.data[0] == J1939_BAM_CONTROL_BYTE &&
+                (cf.data[5] | (cf.data[6] << 8) | ((uint32_t)cf.data[7] << 16)) == SENSATA_CUSTOM_GET_FIELDS_RSP_DGN)
+            {
+                len = cf.data[1] | (cf.data[2] << 8);
+                npackets = cf.data[3];
+                next = 1;
+                if (len > size) return(-1);
+            }
+            break;
+
+        case J1939_DGN_SUBSEQUENT_MULTI_PACKET:
+            if (len < 0 || cf.data[0] != next) break;
+            at = (next - 1) * J1939_TP_PACKET_BYTES;
+            memcpy(&rsp[at], &cf.data[1], (len - at < J1939_TP_PACKET_BYTES) ? len - at : J1939_TP_PACKET_BYTES);
+            if (next++ == npackets) return(len);
+            break;
+        }
+    }
+    return(-1);
+}
+
+// ------------------------------------------------------------------------------------
+// batched get of a list of fields; returns the response length, -1=none
+static int canload_GetFields(const uint16_t* fields, int n, uint8_t* rsp, int size)
+{
+    uint8_t data[8];
+    int     i, k, seq;
+
+    for (i = 0, seq = 0; i < n; seq++)
+    {
+        memset(data, 0xFF, sizeof(data));
+        data[0] = CANLOAD_INSTANCE;
+        data[1] = seq & SEN_BATCH_SEQ_MASK;
+        for (k = 0; k < 3 && i < n; k++, i++)
+        {
+            data[2+k*2] = fields[i] & 0xFF;
+            data[3+k*2] = fields[i] >> 8;
+        }
+        if (i == n) data[1] |= SEN_BATCH_LAST;
+        canload_Send(SENSATA_CUSTOM_GET_FIELDS_DGN, data);
+    }
+    return(canload_GetFieldsRsp(rsp, size));
+}
+
+// ------------------------------------------------------------------------------------
+// numeric fields of the node, found with range requests; returns how many
+static int canload_FindFields(uint16_t* fields, int max)
+{
+    uint8_t  data[8];
+    uint8_t  rsp[SEN_BATCH_RSP_BYTES];
+    uint32_t first = 0, last;
+    int      n = 0, len, pos, nent;
+
+    while (n < max && first <= 0xFFFE)
+    {
+        last = first + SEN_BATCH_RANGE_MAX - 1;
+        if (last > 0xFFFE) last = 0xFFFE;
+        memset(data, 0xFF, sizeof(data));
+        data[0] = CANLOAD_INSTANCE;
+        data[1] = SEN_BATCH_RANGE | SEN_BATCH_LAST;
+        data[2] = first & 0xFF;
+        data[3] = first >> 8;
+        data[4] = last & 0xFF;
+        data[5] = last >> 8;
+        canload_Send(SENSATA_CUSTOM_GET_FIELDS_DGN, data);
+        if ((len = canload_GetFieldsRsp(rsp, sizeof(rsp))) < 2) break;
+
+        // the response may have filled up before the end of the range
+        for (pos = 2, nent = 0; nent < rsp[1] && pos + 4 <= len; nent++)
+        {
+            first = (rsp[pos] | (rsp[pos+1] << 8)) + 1;
+            if (rsp[pos+2] != SENFLD_TYPE_STRING && n < max) fields[n++] = first - 1;
+            pos += 4 + rsp[pos+3];
+        }
+        if (nent == 0 || first <= last) first = last + 1;
+        if (rsp[1] == 0 && last >= 0x0FFF) break;   // well past the field numbers in use
+    }
+    return(n);
+}
+
+// ------------------------------------------------------------------------------------
+// batched set; returns 0=ACK, 1=NAK, -1=no answer
+static int canload_SetFields(const uint16_t* fields, const int16_t* values, int n)
+{
+    struct can_frame cf;
+    uint8_t data[8];
+    double  timeout;
+    int     i;
+
+    for (i = 0; i < n; i++)
+    {
+        memset(data, 0, sizeof(data));
+        data[0] = CANLOAD_INSTANCE;
+        data[1] = fields[i] & 0xFF;
+        data[2] = fields[i] >> 8;
+        data[3] = values[i] & 0xFF;
+        data[4] = (values[i] >> 8) & 0xFF;
+        data[7] = (i & SEN_BATCH_SEQ_MASK) | ((i == n-1) ? SEN_BATCH_LAST : 0);
+        canload_Send(SENSATA_CUSTOM_SET_FIELDS_DGN, data);
+    }
+    timeout = canload_Msec() + CANLOAD_FIELD_TIMEOUT_MSEC;
+    while (canload_Msec() < timeout)
+    {
+        if ((canload_Receive(timeout - canload_Msec(), &cf) & 0x1FF00) == J1939_DGN_ACK &&
+            (cf.data[4] | (cf.data[5] << 8) | ((uint32_t)cf.data[6] << 16)) == SENSATA_CUSTOM_SET_FIELDS_DGN)
+        {
+            return(cf.data[0] == J1939_ACK ? 0 : 1);
+        }
+    }
+    return(-1);
+}
+
+// ------------------------------------------------------------------------------------
+static int16_t canload_FieldInt16(uint16_t field)
+{
+    uint8_t value[4] = { 0xFF, 0xFF };
+
+    canload_GetField(field, value);
+    return((int16_t)(value[0] | (value[1] << 8)));
+}
+
+// ------------------------------------------------------------------------------------
+// time a screen refresh one field at a time and batched, then check a set
+// batch is all or nothing; returns the number of failures
+static int canload_Fields(void)
+{
+    uint16_t fields[CANLOAD_SCREEN_FIELDS];
+    uint16_t setFields[2] = { CANLOAD_SET_FIELD, CANLOAD_READONLY_FIELD };
+    int16_t  setValues[2];
+    int16_t  was;
+    uint8_t  rsp[SEN_BATCH_RSP_BYTES];
+    double   start, single, batched;
+    int      n, i, pos, len, nlost = 0, nwrong = 0, nfail = 0, rc;
+
+    n = canload_FindFields(fields, CANLOAD_SCREEN_FIELDS);
+    printf("can_load: screen refresh, %d numeric fields\n", n);
+    if (n < CANLOAD_SCREEN_FIELDS)
+    {
+        printf("    only %d of %d fields found\n", n, CANLOAD_SCREEN_FIELDS);
+        nfail++;
+    }
+    if (n == 0) return(nfail);
+
+    start = canload_Msec();
+    for (i = 0; i < n; i++)
+    {
+        if (canload_GetField(fields[i], 0) < 0) nlost++;
+    }
+    single = canload_Msec() - start;
+
+    start = canload_Msec();
+    len = canload_GetFields(fields, n, rsp, sizeof(rsp));
+    batched = canload_Msec() - start;
+    if (len < 2 || rsp[1] != n)
+    {
+        nwrong = n;
+    }
+    else
+    {
+        for (i = 0, pos = 2; i < n && pos + 4 <= len; i++)
+        {
+            if ((rsp[pos] | (rsp[pos+1] << 8)) != fields[i] || rsp[pos+3] == 0) nwrong++;
+            pos += 4 + rsp[pos+3];
+        }
+    }
+    printf("    one at a time %.1f msec, %d unanswered\n", single, nlost);
+    printf("    batched       %.1f msec, %d bytes, %d of %d fields wrong or missing; %.1f times faster\n",
+           batched, len, nwrong, n, single / batched);
+    nfail += (nlost != 0) + (nwrong != 0) + (single < batched * CANLOAD_BATCH_GAIN);
+
+    // a refused entry leaves the good one unapplied
+    was = canload_FieldInt16(CANLOAD_SET_FIELD);
+    setValues[0] = was + 1;
+    setValues[1] = 0;
+    rc = canload_SetFields(setFields, setValues, 2);
+    i = canload_FieldInt16(CANLOAD_SET_FIELD);
+    printf("    set batch with a read only field: %s, field %d was %d\n",
+           (rc == 1) ? "NAK" : (rc == 0) ? "ACK" : "no answer", i, was);
+    nfail += (rc != 1) + (i != was);
+
+    rc = canload_SetFields(setFields, setValues, 1);
+    i = canload_FieldInt16(CANLOAD_SET_FIELD);
+    printf("    set batch: %s, field %d was %d\n", (rc == 1) ? "NAK" : (rc == 0) ? "ACK" : "no answer", i, was);
+    nfail += (rc != 0) + (i != was + 1);
+    setValues[0] = was;
+    canload_SetFields(setFields, setValues, 1);
+    return(nfail);
+}
+
+// ------------------------------------------------------------------------------------
+static void canload_Telemetry(uint8_t mask)
+{
+    uint8_t data[8];
+
+    memset(data, 0xFF, sizeof(data));
+    data[0] = CANLOAD_INSTANCE;
+    data[1] = mask;
+    data[2] = 1;    // every PWM interrupt
+    data[3] = 0;
+    canload_Send(SENSATA_CUSTOM_TELEMETRY_DGN, data);
+}
+
+// ------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    int seconds = (argc > 1) ? atoi(argv[1]) : CANLOAD_LISTEN_SEC;
+    int nfail = 0;
+
+    if (seconds <= 0) seconds = CANLOAD_LISTEN_SEC;
+    if (canload_Open()) return(1);
+
+    nfail += canload_Broadcasts("quiet bus", seconds);
+    nfail += canload_RoundTrip();
+    nfail += canload_Fields();
+
+    canload_Telemetry(TLM_SIG_VAC | TLM_SIG_IMEAS | TLM_SIG_VBATT);
+    nfail += canload_Broadcasts("telemetry streaming", seconds);
+    nfail += canload_RoundTrip();
+    canload_Telemetry(0);
+
+    printf("can_load: %s\n", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+// <><><><><><><><><><><><><> can_load.c <><><><><><><><><><><><><><><><><><><><><><>
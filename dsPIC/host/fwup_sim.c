@@ -0,0 +1,354 @@
+// <><><><><><><><><><><><><> fwup_sim.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host program flash and CAN bus simulator for the firmware update
+//  (see fwup_sim.h)
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "bootloader.h"
+#include "crc.h"
+#include "dsPIC33_CAN.h"
+#include "fwupdate.h"
+#include "fwup_sim.h"
+#include "J1939.h"
+#include "sensata_can.h"
+
+// ---------
+// constants
+// ---------
+#define FWSIM_TOOL_ADDRESS  0xF9        // service tool source address
+#define FWSIM_RUN_MSEC      60000       // give up on an update that takes longer
+#define FWSIM_FRAMES        (2 + FWUP_ROW_MSG_BYTES/J1939_TP_PACKET_BYTES)   // one row on the wire
+#define FWSIM_PAGE_XFER_MSEC 5386       // FW_STAGE_MAX_PAGES sent a page per transfer, erasing as they went
+
+// ----------
+// local data
+// ----------
+static uint8_t  s_flash[FW_STAGE_PAGES*FLASH_PAGE_BYTES];  // FW_STAGE_ADDRESS up
+static uint8_t  s_image[FW_STAGE_MAX_PAGES*FLASH_PAGE_BYTES];
+static uint32_t s_imageCrc32;
+static uint32_t s_imageCodeCrc32;   // firmware image check (bootloader.h)
+static uint32_t s_usec;         // simulated time
+static uint32_t s_stallUsec;    // cpu stall of the current poll
+
+// frames on their way to the device
+typedef struct
+{
+    uint32_t  usec;             // arrival
+    uint8_t   lost;             // 1=overwritten in the receive buffer during a stall
+    CAN_DMA   frm;
+} FWSIM_FRAME_t;
+
+static FWSIM_FRAME_t s_frames[FWSIM_FRAMES];
+static uint16_t s_nFrames;      // frames queued
+static uint16_t s_nextFrame;    // next frame to deliver
+static uint16_t s_nLost;
+
+// ------------------------------------------------------------------------------------
+// byte index of a program memory address in s_flash; -1=outside the stage
+static int32_t fwsim_Index(uint32_t addr)
+{
+    if (addr < FW_STAGE_ADDRESS || addr >= FW_BASE_ADDRESS + (uint32_t)FLASH_PAGES_FW*FLASH_PAGE_SIZE)
+    {
+        LOG(SS_SYS, SV_ERR, "SIM: flash address %05lX outside the stage", addr);
+        return(-1);
+    }
+    return((int32_t)((addr - FW_STAGE_ADDRESS)/2) * 3);
+}
+
+// ------------------------------------------------------------------------------------
+// the bootloader's side of the stage contract (bootloader.h)
+static void fwsim_BootloaderClear(void)
+{
+    memset(s_flash, ERASED_BYTE_VALUE, sizeof(s_flash));
+}
+
+// ------------------------------------------------------------------------------------
+// flash bits only go from 1 to 0 without an erase
+void fwsim_WriteRow(uint32_t addr, const uint8_t* src)
+{
+    int32_t  i = fwsim_Index(addr);
+    uint16_t n;
+
+    if (i < 0 || (addr % (FLASH_ROW_INSTR*2))) return;
+    for (n=0; n<FLASH_ROW_INSTR*3; n++) s_flash[i+n] &= src[n];
+    s_stallUsec += FWSIM_ROW_USEC;
+}
+
+// ------------------------------------------------------------------------------------
+void fwsim_Read(uint32_t addr, uint16_t ninstr, uint8_t* buf)
+{
+    int32_t i = fwsim_Index(addr);
+
+    if (i < 0) { memset(buf, 0, ninstr*3); return; }
+    memcpy(buf, &s_flash[i], ninstr*3);
+}
+
+// -----------------------------------------------------------------------------
+//                 S E R V I C E    T O O L
+// -----------------------------------------------------------------------------
+
+// ------------------------------------------------------------------------------------
+static void fwsim_QueueFrame(uint32_t usec, CAN_DGN dgn, CAN_DATA* data)
+{
+    FWSIM_FRAME_t* f = &s_frames[s_nFrames++];
+
+    f->usec = usec;
+    f->lost = 0;
+    can_FrmSetExtID(&f->frm, ((CAN_ID)J1939_TP_CM_PRIORITY << 26) | ((CAN_ID)dgn << 8) | FWSIM_TOOL_ADDRESS, 8);
+    memcpy(can_FrmData(&f->frm), data, 8);
+}
+
+// ------------------------------------------------------------------------------------
+// put row r of the image (page r/FLASH_PAGE_ROWS) on the wire from usec on;
+// gap between the announce and packet 1
+// returns: time the bus is free again
+static uint32_t fwsim_SendRow(uint16_t r, uint32_t usec, uint32_t gapUsec)
+{
+    CAN_DATA msg[FWUP_ROW_MSG_BYTES];
+    CAN_DATA data[8];
+    uint16_t n, i, npackets = (FWUP_ROW_MSG_BYTES + J1939_TP_PACKET_BYTES-1)/J1939_TP_PACKET_BYTES;
+
+    msg[0] = (CAN_DATA)(r / FLASH_PAGE_ROWS);
+    msg[1] = (CAN_DATA)(r % FLASH_PAGE_ROWS);
+    memcpy(&msg[2], &s_image[(uint32_t)r*FLASH_ROW_BYTES], FLASH_ROW_BYTES);
+
+    s_nFrames = s_nextFrame = 0;
+    data[0] = J1939_BAM_CONTROL_BYTE;
+    data[1] = LOBYTE(FWUP_ROW_MSG_BYTES);
+    data[2] = HIBYTE(FWUP_ROW_MSG_BYTES);
+    data[3] = (CAN_DATA)npackets;
+    data[4] = 0xFF;
+    data[5] = (CAN_DATA)(SENSATA_CUSTOM_FWUP_DATA_DGN);
+    data[6] = (CAN_DATA)(SENSATA_CUSTOM_FWUP_DATA_DGN >> 8);
+    data[7] = (CAN_DATA)(SENSATA_CUSTOM_FWUP_DATA_DGN >> 16);
+    usec += FWSIM_FRAME_USEC;
+    fwsim_QueueFrame(usec, J1939_DGN_INITIAL_MULTI_PACKET, data);
+    usec += gapUsec;
+
+    for (n=1; n<=npackets; n++)
+    {
+        i = (n-1)*J1939_TP_PACKET_BYTES;
+        data[0] = (CAN_DATA)n;
+        memset(&data[1], 0xFF, J1939_TP_PACKET_BYTES);
+        memcpy(&data[1], &msg[i], (FWUP_ROW_MSG_BYTES - i < J1939_TP_PACKET_BYTES) ? FWUP_ROW_MSG_BYTES - i : J1939_TP_PACKET_BYTES);
+        usec += FWSIM_FRAME_USEC;
+        fwsim_QueueFrame(usec, J1939_DGN_SUBSEQUENT_MULTI_PACKET, data);
+    }
+    return(usec);
+}
+
+// ------------------------------------------------------------------------------------
+// one can task pass at s_usec; the cpu stall of the flash work delays time
+static void fwsim_DeviceTick(void)
+{
+    uint32_t end;
+    uint8_t  gotOne = 0;
+    uint16_t i;
+
+    // fwup_Poll() runs ahead of the receive driver in the can task
+    s_stallUsec = 0;
+    fwup_Poll();
+    if (s_stallUsec != 0)
+    {
+        // one receive buffer; the first frame to arrive during the stall survives
+        end = s_usec + s_stallUsec;
+        for (i=s_nextFrame; i<s_nFrames && s_frames[i].usec <= end; i++)
+        {
+            if (gotOne) { s_frames[i].lost = 1; s_nLost++; }
+            gotOne = 1;
+        }
+        s_usec = end;
+    }
+
+    // the isr took these into the receive queue
+    while (s_nextFrame < s_nFrames && s_frames[s_nextFrame].usec <= s_usec)
+    {
+        if (!s_frames[s_nextFrame].lost) J1939_Dispatcher(&s_frames[s_nextFrame].frm);
+        s_nextFrame++;
+    }
+}
+
+// ------------------------------------------------------------------------------------
+// made up image of npages with a good header
+static void fwsim_MakeImage(uint8_t npages)
+{
+    uint32_t nbytes = (uint32_t)npages*FLASH_PAGE_BYTES;
+    uint32_t seed = 12345, i;
+    uint16_t ninstr = (uint16_t)(npages*FLASH_PAGE_INSTR - (FW_CODE_ADDRESS-FW_BASE_ADDRESS)/2 - 10);
+    uint8_t* hdr;
+
+    for (i=0; i<nbytes; i++)
+    {
+        seed = seed*1103515245UL + 12345;
+        s_image[i] = (uint8_t)(seed >> 16);
+    }
+    hdr = &s_image[(FW_LENGTH_ADDRESS-FW_BASE_ADDRESS)/2*3];
+    hdr[0] = LOBYTE(ninstr);
+    hdr[1] = HIBYTE(ninstr);
+    s_imageCrc32 = CRC32_FINAL(crc32_Update(CRC32_INIT, s_image, nbytes));
+    s_imageCodeCrc32 = CRC32_FINAL(crc32_Update(CRC32_INIT,
+                                   &s_image[(FW_CODE_ADDRESS-FW_BASE_ADDRESS)/2*3], (uint32_t)ninstr*3));
+}
+
+// ------------------------------------------------------------------------------------
+// run an update of npages; streamed=1 sends rows back to back, 0 waits on each
+// returns: final FWUP_ST_xxx; *msec the update took until verified
+static uint8_t fwsim_Update(uint8_t npages, uint8_t streamed, uint32_t* msec)
+{
+    CAN_DATA cmd[8];
+    uint32_t busFree = 0;
+    uint16_t row = 0;       // next row the tool sends; counted from the start of the image
+    uint16_t nrows = (uint16_t)npages*FLASH_PAGE_ROWS;
+    uint16_t want;          // next row the device asks for
+    uint16_t resends = 0;
+    uint8_t  sent;
+
+    s_usec = s_nFrames = s_nextFrame = s_nLost = 0;
+    _SysTicks = 0;
+
+    cmd[0] = g_can.MyInstance;
+    cmd[1] = FWUP_CMD_START;
+    cmd[2] = npages;
+    cmd[3] = LOBYTE(s_imageCrc32);
+    cmd[4] = HIBYTE(s_imageCrc32);
+    cmd[5] = LOBYTE(s_imageCrc32 >> 16);
+    cmd[6] = HIBYTE(s_imageCrc32 >> 16);
+    cmd[7] = 0xFF;
+    s_usec += FWSIM_FRAME_USEC;
+    fwup_Cmd(cmd);
+
+    while (g_fwup.state == FWUP_ST_RECEIVE || g_fwup.state == FWUP_ST_VERIFY)
+    {
+        fwsim_DeviceTick();
+
+        // tool; the device status says which row it wants next
+        sent = (s_nextFrame >= s_nFrames);
+        want = (uint16_t)g_fwup.next*FLASH_PAGE_ROWS + g_fwup.nextRow;
+        if (g_fwup.state == FWUP_ST_RECEIVE && sent)
+        {
+            // asked again: behind by more than the row in flight, or nothing
+            // taken a while after the bus went quiet
+            if (want < row && (want+1 < row || s_usec > busFree + FWSIM_RESEND_USEC))
+            {
+                row = want;
+                resends++;
+            }
+            if (row < nrows)
+            {
+                if (streamed)
+                {
+                    // back to back; the device works in the announce gap
+                    busFree = fwsim_SendRow(row, (row == 0) ? s_usec + FWSIM_TOOL_USEC : busFree, FWUP_ROW_GAP_MSEC*1000UL);
+                    row++;
+                }
+                else if (want == row && g_fwup.step == FWUP_STEP_NONE)
+                {
+                    // device done with the last row; no gap needed
+                    busFree = fwsim_SendRow(row, s_usec + FWSIM_TOOL_USEC, 0);
+                    row++;
+                }
+            }
+        }
+
+        s_usec += 1000;
+        _SysTicks = s_usec/1000;
+        if (_SysTicks > FWSIM_RUN_MSEC) break;
+    }
+    *msec = s_usec/1000;
+    LOG(SS_SYS, SV_INFO, "SIM: fw update %u pages %s %lu msec; %u frames lost %u rows sent again",
+        npages, streamed ? "streamed" : "stop-and-wait", (unsigned long)*msec, s_nLost, resends);
+    return(g_fwup.state);
+}
+
+// ------------------------------------------------------------------------------------
+// returns: number of failures
+int16_t fwsim_RunUpdateCheck(void)
+{
+    uint8_t  npages = FW_STAGE_MAX_PAGES;
+    uint8_t  swap[6*3];
+    uint32_t msStream, msWait;
+    int16_t  nfail = 0;
+    extern char _sysShutDown;
+
+    fwsim_MakeImage(npages);
+
+  #ifndef BL_HAS_STAGE_SWAP
+    // held until the bootloader keeps the stage contract
+    fwsim_BootloaderClear();
+    if (fwsim_Update(npages, 1, &msStream) != FWUP_ST_ERROR || g_fwup.error != FWUP_ERR_NO_SWAP) nfail++;
+  #else
+    // stop-and-wait; flash work between rows
+    fwsim_BootloaderClear();
+    if (fwsim_Update(npages, 0, &msWait) != FWUP_ST_READY) nfail++;
+
+    // streamed; flash work in the announce gap
+    fwsim_BootloaderClear();
+    if (fwsim_Update(npages, 1, &msStream) != FWUP_ST_READY) nfail++;
+    if (memcmp(s_flash, s_image, (uint32_t)npages*FLASH_PAGE_BYTES))
+    {
+        LOG(SS_SYS, SV_ERR, "SIM: staged image differs");
+        nfail++;
+    }
+    if (g_fwup.imgCrc32 != s_imageCodeCrc32)
+    {
+        LOG(SS_SYS, SV_ERR, "SIM: image code crc %08lX, expected %08lX", g_fwup.imgCrc32, s_imageCodeCrc32);
+        nfail++;
+    }
+    LOG(SS_SYS, SV_INFO, "SIM: %u msec per page streamed, %u stop-and-wait, %u a page per transfer",
+        (uint16_t)(msStream/npages), (uint16_t)(msWait/npages), (uint16_t)(FWSIM_PAGE_XFER_MSEC/npages));
+    if (msStream >= msWait || msStream >= FWSIM_PAGE_XFER_MSEC)
+    {
+        LOG(SS_SYS, SV_ERR, "SIM: streaming rows is no faster than waiting on each or a page per transfer");
+        nfail++;
+    }
+
+    // commit writes the swap record and shuts down
+    {
+        CAN_DATA cmd[8] = { 0, FWUP_CMD_COMMIT, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+        cmd[0] = g_can.MyInstance;
+        _sysShutDown = 0;
+        fwup_Cmd(cmd);
+        fwsim_Read(FW_SWAP_ADDRESS, 6, swap);
+        if (!_sysShutDown || MKWORD(swap[0], swap[1]) != FW_SWAP_MAGIC || swap[3] != npages ||
+            MKWORD(swap[12], swap[13]) != (uint16_t)s_imageCodeCrc32 || MKWORD(swap[15], swap[16]) != (uint16_t)(s_imageCodeCrc32 >> 16))
+        {
+            LOG(SS_SYS, SV_ERR, "SIM: commit did not write the swap record");
+            nfail++;
+        }
+        _sysShutDown = 0;
+    }
+
+    // without the bootloader run in between: the swap record, then a staged row, is not blank
+    if (fwsim_Update(npages, 1, &msStream) != FWUP_ST_ERROR || g_fwup.error != FWUP_ERR_NOT_BLANK) nfail++;
+    memset(&s_flash[(FW_SWAP_ADDRESS - FW_STAGE_ADDRESS)/2*3], ERASED_BYTE_VALUE, FLASH_ROW_BYTES);
+    if (fwsim_Update(npages, 1, &msStream) != FWUP_ST_ERROR || g_fwup.error != FWUP_ERR_NOT_BLANK || g_fwup.next != 0) nfail++;
+
+    // image that does not match the crc-32 the tool announced is refused
+    s_image[(FW_CODE_ADDRESS-FW_BASE_ADDRESS)/2*3 + 100] ^= 0x01;
+    fwsim_BootloaderClear();
+    if (fwsim_Update(npages, 1, &msStream) != FWUP_ST_ERROR || g_fwup.error != FWUP_ERR_CRC) nfail++;
+
+    // image whose header length runs past the staged pages is refused
+    s_image[(FW_LENGTH_ADDRESS-FW_BASE_ADDRESS)/2*3 + 1] = 0xFF;
+    s_imageCrc32 = CRC32_FINAL(crc32_Update(CRC32_INIT, s_image, (uint32_t)npages*FLASH_PAGE_BYTES));
+    fwsim_BootloaderClear();
+    if (fwsim_Update(npages, 1, &msStream) != FWUP_ST_ERROR || g_fwup.error != FWUP_ERR_IMAGE) nfail++;
+  #endif
+
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "SIM: fw update check %s", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> fwup_sim.c <><><><><><><><><><><><><><><><><><><><><><>
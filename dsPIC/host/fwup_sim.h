@@ -0,0 +1,57 @@
+// <><><><><><><><><><><><><> fwup_sim.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host program flash and CAN bus simulator for the firmware update
+//
+//  Stands in for the staging area of program flash so fwupdate.c runs
+//  unchanged on a PC: a row write can only clear bits and stalls the
+//  simulated cpu for the data sheet time. The check clears the stage before
+//  an update, as the bootloader would (the stage contract in bootloader.h).
+//
+//  fwsim_RunUpdateCheck() plays the service tool: it streams a made up image
+//  through J1939_Dispatcher() a frame time apart, runs fwup_Poll() every
+//  msec like the can task, and loses frames the way the single ECAN receive
+//  buffer would when more than one arrives during a stall. It logs the update
+//  time with the tool streaming rows back to back and with the tool waiting
+//  on each row, and fails if streaming is not faster than both and than
+//  FWSIM_PAGE_XFER_MSEC, the page per transfer update it replaced. Then it
+//  checks commit writes the swap record, and that a stage not left erased,
+//  a bad image and an image too long for its pages are refused. Without
+//  BL_HAS_STAGE_SWAP (the host Makefile defines it) it only checks the
+//  update is refused at start. It returns the number of failures. Run by
+//  host/ 'make check' (fwup).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _FWUP_SIM_H_    // include only once
+#define _FWUP_SIM_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ---------
+// constants
+// ---------
+#define FWSIM_ROW_USEC      1600    // row write (data sheet TRW)
+#define FWSIM_FRAME_USEC    540     // 8 byte extended frame at 250 kbit/s with stuffing
+#define FWSIM_TOOL_USEC     2000    // tool reaction to a status frame
+#define FWSIM_RESEND_USEC   100000  // tool sends a row again when not taken by then
+
+// --------------------
+// Function Prototyping
+// --------------------
+void    fwsim_WriteRow(uint32_t addr, const uint8_t* src);
+void    fwsim_Read(uint32_t addr, uint16_t ninstr, uint8_t* buf);
+int16_t fwsim_RunUpdateCheck(void);     // returns number of failures
+
+#endif // __linux__
+
+#endif  //  _FWUP_SIM_H_
+
+// <><><><><><><><><><><><><> fwup_sim.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,77 @@
+// <><><><><><><><><><><><><> host_can_node.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host CAN node (can_node)
+//
+//  Runs the real ECAN driver, J1939, RV-C, the Sensata messages, telemetry,
+//  the event log, the nvm driver on the simulated flash and the firmware
+//  update on a SocketCAN interface, so a PC tool can be tested against
+//  them without a unit:
+//
+//      ip link add dev vcan0 type vcan && ip link set up vcan0
+//      CAN_IFNAME=vcan0 _build/can_node
+//
+//  The unit behind the messages is host_can_state.c. Only the tasks the CAN
+//  stack needs are run, in one loop every msec. The can task takes one
+//  received frame and loads one frame to send a pass, and marks itself
+//  ready again while more wait; the tasker on the unit runs it again well
+//  inside the msec. So the loop runs it again while frames are waiting to
+//  be taken or the wire is free for the one loaded, rather than hold the
+//  node to a frame a msec. 'make vcan_check' runs the
+//  node against can_load.c to measure the broadcast rates and the command
+//  round trip.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "dsPIC33_CAN.h"
+#include "nvm.h"
+#include "socket_can.h"
+#include "tasker.h"
+#include "host_can_state.h"
+#include <unistd.h>
+
+// ------------
+// Global Data
+// ------------
+TASK_ID_t _task_can = -1;
+
+void TASK_can_Driver(void);
+
+// ------------------------------------------------------------------------------------
+// tasker; the loop below runs every task each pass
+TASK_ID_t task_AddToQueue(FUNC_PTR_t taskFunc, char* name) { return(0); }
+void      task_MarkAsReady(TASK_ID_t id)                     { }
+
+// ------------------------------------------------------------------------------------
+int main(void)
+{
+    SYSTICKS last;
+
+    nvm_Config();
+    nvm_Start();
+    hstate_Start();
+    can_Config();
+    can_Start();
+
+    last = GetSysTicks();
+    for (;;)
+    {
+        do TASK_can_Driver(); while (!can_IsRxQueueEmpty() || sockcan_IsTxDue());
+        TASK_nvm_Driver();
+        while (last != GetSysTicks())
+        {
+            hstate_Poll();
+            last++;
+        }
+        usleep(1000);
+    }
+    return(0);
+}
+
+// <><><><><><><><><><><><><> host_can_node.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,141 @@
+// <><><><><><><><><><><><><> host_can_state.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host inverter and charger state for the CAN node (see host_can_state.h)
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "charger.h"
+#include "device.h"
+#include "fan_ctrl.h"
+#include "inverter.h"
+#include "sine_table.h"
+#include "telemetry.h"
+#include "host_can_state.h"
+#include <math.h>
+
+// ---------
+// constants
+// ---------
+// states as task_main.c and inverter.c number them
+#define HSTATE_MS_WAIT      (3)     // MS_CHECK_RELAY_REQUEST
+#define HSTATE_MS_CHARGER   (7)     // MS_CHARGER
+#define HSTATE_MS_INVERTER  (10)    // MS_INVERTER
+#define HSTATE_INV_INIT     (0)     // INV_INIT
+#define HSTATE_INV_NORMAL   (2)     // INV_NORMAL
+
+#define HSTATE_TWO_PI       (6.28318530718)
+
+// ------------
+// Global Data
+// ------------
+volatile unsigned int PDC1;
+volatile unsigned int PDC2;
+
+// ----------
+// local data
+// ----------
+static uint32_t s_msec;
+static int      s_mainState = HSTATE_MS_WAIT;
+static int      s_invState  = HSTATE_INV_INIT;
+static double   s_vbatt     = HSTATE_VBATT;
+static double   s_phase;        // output cycle; radians
+
+// ------------------------------------------------------------------------------------
+// what the firmware modules not built for the node would answer
+int             dev_MainState(void)             { return(s_mainState); }
+int             inv_GetState(void)              { return(s_invState); }
+uint16_t        fan_GetDutyCycle(void)          { return(IsInvOutputting() ? 100 : 0); }
+void            fan_SetOverRide(uint16_t duty)  { }
+CHARGER_STATE_t chgr_InitChargerState(void)     { return(CS_INITIAL); }
+uint16_t        ChgrCfgMaxAcCurrA2D(void)       { return(Chgr.config.amps_limit); }
+
+// ------------------------------------------------------------------------------------
+void hstate_Start(void)
+{
+    Device.status.inv_enabled       = Device.config.inv_enabled;
+    Device.status.pass_thru_enabled = Device.config.pass_thru_enabled;
+    An.AvgValid = 1;
+    s_msec = 0;
+}
+
+// ------------------------------------------------------------------------------------
+// the PWM interrupts of a msec; a sine output for telemetry to stream
+static void hstate_PwmMsec(double vpk, double ipk)
+{
+    int16_t n;
+    double  s;
+
+    for (n = 0; n < FPWM/1000; n++)
+    {
+        s_phase = fmod(s_phase + HSTATE_TWO_PI * OPTION_AC_OUT_HZ / FPWM, HSTATE_TWO_PI);
+        s = sin(s_phase);
+        An.Status.VAC.raw_val   = (ADC10_RDG_t)VAC_VOLTS_ADC(vpk * s);
+        An.Status.IMeas.raw_val = (ADC10_RDG_t)IMEAS_INV_AMPS_ADC(ipk * s);
+        An.Status.VBatt.raw_val = (ADC10_RDG_t)VBATT_VOLTS_ADC(s_vbatt);
+        PDC1 = (s > 0) ? (unsigned int)(s * 3000) : 0;
+        PDC2 = (s < 0) ? (unsigned int)(-s * 3000) : 0;
+        tlm_Sample();
+    }
+}
+
+// ------------------------------------------------------------------------------------
+void hstate_Poll(void)
+{
+    uint8_t lineOn = ((s_msec / HSTATE_LINE_MSEC) & 1) ? 0 : 1;
+    double  wobble = 0.3 * sin(HSTATE_TWO_PI * (s_msec % 1000) / 1000.0);   // volts
+    double  watts  = 0.0;
+    double  vac    = 0.0;
+
+    s_msec++;
+
+    if (lineOn && IsCfgChgrEnabled())
+    {
+        s_mainState = HSTATE_MS_CHARGER;
+        s_invState  = HSTATE_INV_INIT;
+        Inv.status.inv_active     = 0;
+        Inv.status.output_active  = 0;
+        Chgr.status.charger_active = 1;
+        Chgr.status.output_active  = 1;
+        vac = HSTATE_VAC_LINE + wobble;
+        watts = HSTATE_LOAD_WATTS;
+        if (s_vbatt < 14.4) s_vbatt += 0.00005;     // charging up
+    }
+    else if (!lineOn && IsInvEnabled())
+    {
+        s_mainState = HSTATE_MS_INVERTER;
+        s_invState  = HSTATE_INV_NORMAL;
+        Inv.status.inv_active     = 1;
+        Inv.status.output_active  = 1;
+        Chgr.status.charger_active = 0;
+        Chgr.status.output_active  = 0;
+        vac = HSTATE_VAC_OUT + wobble;
+        watts = HSTATE_LOAD_WATTS * (1.0 + sin(HSTATE_TWO_PI * (s_msec % HSTATE_LOAD_MSEC) / HSTATE_LOAD_MSEC));
+        if (s_vbatt > 11.5) s_vbatt -= 0.00005;     // running down
+    }
+    else
+    {
+        s_mainState = HSTATE_MS_WAIT;
+        s_invState  = HSTATE_INV_INIT;
+        Inv.status.inv_active     = 0;
+        Inv.status.output_active  = 0;
+        Chgr.status.charger_active = 0;
+        Chgr.status.output_active  = 0;
+        vac = lineOn ? HSTATE_VAC_LINE + wobble : 0.0;
+    }
+
+    An.Status.VAC.rms.val   = VAC_VOLTS_ADC(vac);
+    An.Status.VBatt.avg.val = VBATT_VOLTS_ADC(s_vbatt + wobble/10);
+    An.AvgWACr.val          = UNITS_TO_ADC(watts, WACR_SLOPE, WACR_INTERCEPT);
+
+    hstate_PwmMsec(vac * 1.41421356, (vac > 0) ? 1.41421356 * watts / vac : 0.0);
+}
+
+// <><><><><><><><><><><><><> host_can_state.c <><><><><><><><><><><><><><><><><><><><><><>
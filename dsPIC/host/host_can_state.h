@@ -0,0 +1,49 @@
+// <><><><><><><><><><><><><> host_can_state.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host inverter and charger state for the CAN node (can_node)
+//
+//  The RV-C and Sensata messages read the unit through the *_cmds.c and
+//  analog.c getters, which read Device, Inv, Chgr and An. The power stage,
+//  main.c, task_main.c and inverter.c are not built for the node, so this
+//  stands in for them: every msec hstate_Poll() sets those structures as a
+//  running unit would.
+//
+//  The a/c line comes and goes every HSTATE_LINE_MSEC. With the line the
+//  unit charges; without it the unit inverts if the inverter is enabled
+//  (RV-C INVERTER_COMMAND), into a load that swings over HSTATE_LOAD_MSEC.
+//  The readings move a little every msec, as measurements do, so the
+//  broadcast scheduler sees changes and its rate limits are what set the
+//  rates. The PWM interrupt is run FPWM/1000 times a msec for telemetry.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _HOST_CAN_STATE_H_    // include only once
+#define _HOST_CAN_STATE_H_
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ---------
+// constants
+// ---------
+#define HSTATE_LINE_MSEC    (15000)     // line on, then off, for this long each
+#define HSTATE_LOAD_MSEC    (6000)      // period of the load swing while inverting
+#define HSTATE_LOAD_WATTS   (200.0)     // load swing; mean and +/-
+#define HSTATE_VAC_OUT      (120.0)     // inverter output
+#define HSTATE_VAC_LINE     (118.0)     // shore power
+#define HSTATE_VBATT        (12.6)      // battery at rest
+
+// --------------------
+// Function Prototyping
+// --------------------
+void hstate_Start(void);        // after nvm_Start(); takes the startup settings
+void hstate_Poll(void);         // every msec
+
+#endif  //  _HOST_CAN_STATE_H_
+
+// <><><><><><><><><><><><><> host_can_state.h <><><><><><><><><><><><><><><><><><><><><><>
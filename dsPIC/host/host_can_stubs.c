@@ -0,0 +1,46 @@
+// <><><><><><><><><><><><><> host_can_stubs.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host stand-in for the ECAN driver and RV-C, for the simulator checks
+//
+//  J1939.c runs as on the target; what it transmits goes into a queue that
+//  is always free and is counted and dropped. The checks put received
+//  frames straight into J1939_Dispatcher(). The CAN node program (can_node)
+//  builds the real driver against socket_can.c instead.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "dsPIC33_CAN.h"
+#include "rv_can.h"
+#include <string.h>
+
+// ------------
+// Global Data
+// ------------
+CAN_STATE g_can = { .MyInstance = 1 };
+uint32_t  g_hostCanTxFrames;    // frames sent
+
+// ----------
+// local data
+// ----------
+static CAN_DMA s_tx;
+
+// ------------------------------------------------------------------------------------
+CAN_DMA* can_TxAlloc(void)          { return(&s_tx); }
+void     can_TxCommit(void)         { g_hostCanTxFrames++; }
+int16_t  can_TxQueueFree(void)      { return(CAN_TX_QUEUE_SIZE); }
+int16_t  can_TxEnqueue(CAN_MSG* m)  { g_hostCanTxFrames++; return(0); }
+void     can_SetID(CAN_ID id)       { }
+void     can_UnpackDma(CAN_DMA* dma, CAN_MSG* msg) { memset(msg, 0, sizeof(*msg)); }
+
+void     rvcan_BroadcastReset(void)                 { }
+void     rvcan_SendProductID(uint8_t* s)            { }
+uint8_t* rvcan_GetProductIdString(void)             { return((uint8_t*)""); }
+
+// <><><><><><><><><><><><><> host_can_stubs.c <><><><><><><><><><><><><><><><><><><><><><>
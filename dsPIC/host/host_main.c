@@ -0,0 +1,102 @@
+// <><><><><><><><><><><><><> host_main.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host check driver
+//
+//  Runs the host simulator checks (the *_sim.c files) and reports each.
+//    sim_check              all of them
+//    sim_check nvm xfer     just those
+//  Exits non-zero if any fails. Built and run by 'make check' in host/.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "fwup_sim.h"
+#include "inv_deadtime_sim.h"
+#include "inv_harmonic_sim.h"
+#include "inv_thermal_sim.h"
+#include "load_sense_sim.h"
+#include "nvm_sim.h"
+#include "pll_sim.h"
+#include "sine_table_sim.h"
+#include "xfer_sim.h"
+#include <stdio.h>
+#include <string.h>
+
+// ----------
+// data types
+// ----------
+typedef struct
+{
+    const char* name;
+    int16_t     (*run)(void);   // returns number of failures
+} HOST_CHECK_t;
+
+// ----------
+// local data
+// ----------
+static const HOST_CHECK_t s_checks[] =
+{
+    { "nvm",      nvmsim_RunPowerFailCheck },
+    { "fwup",     fwsim_RunUpdateCheck     },
+    { "xfer",     xsim_RunTransferCheck    },
+    { "thermal",  tsim_RunOverloadCheck    },
+    { "lsense",   lssim_RunLoadSenseCheck  },
+    { "deadtime", dsim_RunDeadTimeCheck    },
+    { "dds",      stsim_RunIndexCheck      },
+    { "vloop",    vsim_RunHarmonicCheck    },
+    { "pll",      psim_RunLockCheck        },
+};
+#define NUM_CHECKS  (sizeof(s_checks)/sizeof(s_checks[0]))
+
+// ------------------------------------------------------------------------------------
+static int16_t host_Wanted(int argc, char** argv, const char* name)
+{
+    int k;
+
+    if (argc < 2) return(1);
+    for (k = 1; k < argc; k++)
+    {
+        if (0 == strcmp(argv[k], name)) return(1);
+    }
+    return(0);
+}
+
+// ------------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int16_t  nfail[NUM_CHECKS];
+    int16_t  total = 0;
+    uint16_t k, ran = 0;
+
+    for (k = 0; k < NUM_CHECKS; k++)
+    {
+        nfail[k] = -1;
+        if (!host_Wanted(argc, argv, s_checks[k].name)) continue;
+        printf("======== %s\n", s_checks[k].name);
+        _SysTicks = 0;
+        nfail[k] = (*s_checks[k].run)();
+        total += nfail[k];
+        ran++;
+    }
+
+    printf("======== summary\n");
+    for (k = 0; k < NUM_CHECKS; k++)
+    {
+        if (nfail[k] < 0) continue;
+        printf("%-10s %s\n", s_checks[k].name, nfail[k] ? "FAILED" : "passed");
+    }
+    if (0 == ran)
+    {
+        printf("no such check\n");
+        return(2);
+    }
+    return(total ? 1 : 0);
+}
+
+// <><><><><><><><><><><><><> host_main.c <><><><><><><><><><><><><><><><><><><><><><>
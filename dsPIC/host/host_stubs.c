@@ -0,0 +1,72 @@
+// <><><><><><><><><><><><><> host_stubs.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host stand-ins for the parts of the firmware the checks do not build
+//
+//  The globals of main.c, the system tick and the serial log. LOG() goes to
+//  stdout with the tick in front: errors, and the SS_SYS lines the checks
+//  report with. Set HOST_VERBOSE in the environment to see the firmware's
+//  own logging as well.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "charger.h"
+#include "device.h"
+#include "dsPIC33_CAN.h"
+#include "inverter.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ------------
+// Global Data
+// ------------
+DEVICE_STRUCT_t Device;
+INVERTER_t      Inv;
+CHARGER_t       Chgr;
+char            _sysShutDown;
+int16_t         g_hsTempC = 33;
+
+volatile int16_t  _T1TickCount;
+volatile SYSTICKS _SysTicks;
+
+// ------------------------------------------------------------------------------------
+uint32_t ElapsedMsec(SYSTICKS startTicks, SYSTICKS endTicks)
+{
+    return(endTicks - startTicks);
+}
+
+// ------------------------------------------------------------------------------------
+// CPU_Reboot(); the host process carries on
+void host_Reboot(void)
+{
+    LOG(SS_SYS, SV_INFO, "host: reboot requested; ignored");
+}
+
+// ------------------------------------------------------------------------------------
+void _log(SYSTICKS t, LOG_SUBSYS_t ss, LOG_SEVERITY_t sv, char* fmt, ...)
+{
+    va_list args;
+
+    if ((SV_ERR != sv) && (SS_SYS != ss) && !getenv("HOST_VERBOSE")) return;
+    va_start(args, fmt);
+    printf("%7lu ", (unsigned long)t);
+    vprintf(fmt, args);
+    printf("\n");
+    fflush(stdout);
+    va_end(args);
+}
+
+// ------------------------------------------------------------------------------------
+void _logx(LOG_SUBSYS_t ss, LOG_SEVERITY_t sv, char* preText, uint8_t* data, int16_t len)
+{
+}
+
+// <><><><><><><><><><><><><> host_stubs.c <><><><><><><><><><><><><><><><><><><><><><>
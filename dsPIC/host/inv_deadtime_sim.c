@@ -0,0 +1,239 @@
+// <><><><><><><><><><><><><> inv_deadtime_sim.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host THD check of the dead time compensation
+//  (see inv_deadtime_sim.h)
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "hw.h"
+#include "inv_deadtime.h"
+#include "inv_deadtime_sim.h"
+#include "sine_table.h"
+#include <math.h>
+
+// ---------
+// constants
+// ---------
+#define DSIM_TWO_PI         (6.28318530718)
+#define DSIM_CYCLE_SAMPLES  (FPWM / OPTION_AC_OUT_HZ)
+#define DSIM_SUBSTEPS       (8)         // of each PWM period for the filter
+#define DSIM_SETTLE_CYCLES  (40)
+#define DSIM_THD_CYCLES     (4)
+#define DSIM_HARMONICS      (50)        // the output LC rings above
+#define DSIM_ZC_DEGREES     (20.0)      // either side of the zero crossings
+#define DSIM_VOLTS          (120.0)     // for the load ohms
+
+// as inverter.c
+#define DSIM_MAX_DUTY       (((FCY/FPWM) - 1) * 2)
+#define DSIM_MIN_DUTY       (120)
+#define DSIM_MIN_THRES      (DSIM_MIN_DUTY/2)
+#define DSIM_AMPLITUDE      (DSIM_MAX_DUTY * .816)
+#define DSIM_DEAD_COUNTS    (DSIM_DEAD_NSEC * 2.0 * FCY / 1.0e9)
+
+// ----------
+// data types
+// ----------
+typedef struct
+{
+    const char* name;
+    double      watts;      // resistive part at DSIM_VOLTS; 0=none
+    double      pf;         // power factor of a series R-L
+    int8_t      sense;      // IMeas polarity: +1 up while VECTOR2 drives
+} DSIM_LOAD_t;
+
+// ----------
+// local data
+// ----------
+static const DSIM_LOAD_t s_loads[] =
+{
+    { "no load",         0.0, 1.0,  1 },
+    { "60 W",           60.0, 1.0,  1 },
+    { "300 W",         300.0, 1.0,  1 },
+    { "1500 W",       1500.0, 1.0,  1 },
+    { "700 W pf 0.7",  700.0, 0.7,  1 },
+    { "300 W sense -",  300.0, 1.0, -1 },
+    { "1500 W sense -",1500.0, 1.0, -1 },
+};
+
+static uint32_t s_rand = 1;
+
+// ------------------------------------------------------------------------------------
+static int16_t dsim_Noise(int16_t range)
+{
+    s_rand = s_rand * 1103515245 + 12345;
+    return((int16_t)((s_rand >> 16) % (2*range + 1)) - range);
+}
+
+// ------------------------------------------------------------------------------------
+static double dsim_Clamp(double x, double lo, double hi)
+{
+    return((x < lo) ? lo : ((x > hi) ? hi : x));
+}
+
+// ------------------------------------------------------------------------------------
+// runs the inverter into a load; gets the THD and the error near the zero
+// crossings, both % of the fundamental, and the fundamental (Vrms)
+static void dsim_Run(const DSIM_LOAD_t* load, uint8_t comp, double* thd, double* zc, double* vrms)
+{
+    static double v[DSIM_THD_CYCLES * DSIM_CYCLE_SAMPLES];
+    static double ha[DSIM_HARMONICS + 1], hb[DSIM_HARMONICS + 1];
+    double   dt = 1.0 / ((double)FPWM * DSIM_SUBSTEPS);
+    double   leak = DSIM_LEAK_MH * 1.0e-3;
+    double   cap = DSIM_OUTPUT_UF * 1.0e-6;
+    double   r = 0.0, l = 0.0;  // load
+    double   il = 0.0, vc = 0.0, iload = 0.0;
+    double   th, s, d, f, vsec, a, b, sum, zsum;
+    int32_t  imeas_sum = 0;
+    int16_t  imeas, imeas_avg = IMEAS_ZERO_CROSS_A2D;
+    int16_t  duty, p;
+    uint16_t n, k, h, zn;
+    uint8_t  j;
+
+    inv_DeadTimeRestart();
+    g_invDtc.sign = 0;
+
+    if (load->watts > 0.0)
+    {
+        r = DSIM_VOLTS * DSIM_VOLTS / load->watts * load->pf * load->pf;
+        l = r * tan(acos(load->pf)) / (DSIM_TWO_PI * OPTION_AC_OUT_HZ);
+    }
+
+    for (n = 0; n < (DSIM_SETTLE_CYCLES + DSIM_THD_CYCLES) * DSIM_CYCLE_SAMPLES; n++)
+    {
+        k  = n % DSIM_CYCLE_SAMPLES;
+        th = DSIM_TWO_PI * k / DSIM_CYCLE_SAMPLES;
+        s  = sin(th);
+        p  = (s >= 0.0) ? 1 : -1;   // VECTOR2 : VECTOR1
+
+        // IMeas of the primary current; IMeasCycleAvg()
+        imeas = IMEAS_ZERO_CROSS_A2D + (int16_t)floor(load->sense * il * IMEAS_INV_SLOPE + 0.5) + dsim_Noise(DSIM_IMEAS_NOISE);
+        imeas_sum += imeas;
+        if (0 == k)
+        {
+            if (n) imeas_avg = (int16_t)(imeas_sum / DSIM_CYCLE_SAMPLES);
+            imeas_sum = 0;
+            if (n) inv_DeadTimeCycle();
+        }
+
+        // as _inv_PwmIsr()
+        duty = (int16_t)(DSIM_AMPLITUDE * fabs(s));
+        if (comp)
+        {
+            duty += inv_DeadTimeSample(imeas - imeas_avg, (p > 0) ? 1 : 0);   // as _inv_DeadTimeAdj()
+        }
+        if (duty < DSIM_MIN_THRES)
+            duty = 0;
+        else if (duty < DSIM_MIN_DUTY)
+            duty = DSIM_MIN_DUTY;
+
+        // bridge; the dead time shortens the pulse while the current flows with the drive
+        d = 0.0;
+        if (duty > 0)
+        {
+            f = dsim_Clamp(p * il / DSIM_RIPPLE_AMPS, -1.0, 1.0);
+            d = dsim_Clamp(duty - DSIM_DEAD_COUNTS * f, 0.0, DSIM_MAX_DUTY) / DSIM_MAX_DUTY;
+        }
+
+        for (j = 0; j < DSIM_SUBSTEPS; j++)
+        {
+            vsec = DSIM_TURNS * (p * DSIM_VBATT * d - DSIM_TURNS * il * DSIM_BRIDGE_OHMS);
+            il  += dt * (vsec - DSIM_WINDING_OHMS * il - vc) / leak;
+            if (0.0 == r)
+                iload = 0.0;
+            else if (0.0 == l)
+                iload = vc / r;
+            else
+                iload += dt * (vc - r * iload) / l;
+            vc += dt * (il - iload) / cap;
+        }
+
+        if (n >= DSIM_SETTLE_CYCLES * DSIM_CYCLE_SAMPLES)
+        {
+            v[n - DSIM_SETTLE_CYCLES * DSIM_CYCLE_SAMPLES] = vc;
+        }
+    }
+
+    // harmonics
+    sum = 0.0;
+    for (h = 1; h <= DSIM_HARMONICS; h++)
+    {
+        a = b = 0.0;
+        for (n = 0; n < DSIM_THD_CYCLES * DSIM_CYCLE_SAMPLES; n++)
+        {
+            th = DSIM_TWO_PI * h * n / DSIM_CYCLE_SAMPLES;
+            a += v[n] * cos(th);
+            b += v[n] * sin(th);
+        }
+        ha[h] = a * 2.0 / (DSIM_THD_CYCLES * DSIM_CYCLE_SAMPLES);
+        hb[h] = b * 2.0 / (DSIM_THD_CYCLES * DSIM_CYCLE_SAMPLES);
+        if (h > 1) sum += ha[h]*ha[h] + hb[h]*hb[h];
+    }
+    *vrms = sqrt((ha[1]*ha[1] + hb[1]*hb[1]) / 2.0);
+    *thd  = 100.0 * sqrt(sum / (ha[1]*ha[1] + hb[1]*hb[1]));
+
+    // the harmonics, near the zero crossings of the fundamental
+    zsum = 0.0;
+    zn   = 0;
+    for (n = 0; n < DSIM_CYCLE_SAMPLES; n++)
+    {
+        th = DSIM_TWO_PI * n / DSIM_CYCLE_SAMPLES;
+        if (fabs(ha[1] * cos(th) + hb[1] * sin(th)) < *vrms * sqrt(2.0) * sin(DSIM_ZC_DEGREES * DSIM_TWO_PI / 360.0))
+        {
+            a = 0.0;
+            for (h = 2; h <= DSIM_HARMONICS; h++)
+                a += ha[h] * cos(h * th) + hb[h] * sin(h * th);
+            zsum += a * a;
+            zn++;
+        }
+    }
+    *zc = 100.0 * sqrt(zsum / zn) / (*vrms);
+}
+
+// ------------------------------------------------------------------------------------
+int16_t dsim_RunDeadTimeCheck(void)
+{
+    int16_t  nfail = 0;
+    uint16_t k;
+    double   thd0, zc0, v0, thd1, zc1, v1;
+
+    LOG(SS_SYS, SV_INFO, "DSIM: %.0f nsec dead time (%.0f counts), %.1f mOhm bridge, %.1f V battery; open loop",
+        DSIM_DEAD_NSEC, DSIM_DEAD_COUNTS, DSIM_BRIDGE_OHMS * 1000.0, DSIM_VBATT);
+
+    for (k = 0; k < sizeof(s_loads)/sizeof(s_loads[0]); k++)
+    {
+        dsim_Run(&s_loads[k], 0, &thd0, &zc0, &v0);
+        dsim_Run(&s_loads[k], 1, &thd1, &zc1, &v1);
+        LOG(SS_SYS, SV_INFO, "DSIM: %-14s THD %5.2f%% -> %5.2f%%, zero crossings %5.2f%% -> %5.2f%%, %5.1f -> %5.1f Vrms, sense %+d",
+            s_loads[k].name, thd0, thd1, zc0, zc1, v0, v1, g_invDtc.sign);
+
+        if ((s_loads[k].watts >= DSIM_HALVE_WATTS) && (g_invDtc.sign != s_loads[k].sense))
+        {
+            LOG(SS_SYS, SV_ERR, "DSIM: %s: sense polarity not learnt", s_loads[k].name);
+            nfail++;
+        }
+
+        if ((thd1 > thd0 + DSIM_THD_SLACK) ||
+            ((s_loads[k].watts >= DSIM_HALVE_WATTS) && (thd1 > thd0 / 2.0)))
+        {
+            LOG(SS_SYS, SV_ERR, "DSIM: %s: THD not improved", s_loads[k].name);
+            nfail++;
+        }
+    }
+
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "DSIM: dead time check %s", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> inv_deadtime_sim.c <><><><><><><><><><><><><><><><><><><><><><>
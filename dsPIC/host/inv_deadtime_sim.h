@@ -0,0 +1,61 @@
+// <><><><><><><><><><><><><> inv_deadtime_sim.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host THD check of the dead time compensation
+//
+//  Simulates the bridge, averaged over each PWM period: the dead time,
+//  whose error follows the current direction and fades out where the
+//  ripple takes the current through zero; the FET drop; the transformer
+//  leakage and winding; the output capacitor and a load. It is driven with
+//  a sine of the duty, open loop, through the same duty limits as the
+//  inverter PWM ISR, with and without inv_DeadTimeSample() on the IMeas of
+//  the simulated current, and compares the THD of the output for a range
+//  of loads: it must halve the THD from DSIM_HALVE_WATTS up, and add no more
+//  than DSIM_THD_SLACK below. Each run starts with the sense polarity not
+//  known; from DSIM_HALVE_WATTS up it must learn it, with the sense either
+//  way round. The plant figures below are the ones the model's table was
+//  worked out from, except the ripple, which the table only allows for
+//  roughly with its ramp up from no current. These are figures from a
+//  model, not a unit.
+//  Logs the THD and returns the number of failures. Run by host/
+//  'make check' (deadtime).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _INV_DEADTIME_SIM_H_    // include only once
+#define _INV_DEADTIME_SIM_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ---------
+// constants
+// ---------
+#define DSIM_VBATT          (12.6)      // volts
+#define DSIM_DEAD_NSEC      (500.0)     // DTCON1
+#define DSIM_RIPPLE_AMPS    (1.5)       // output amps of peak ripple; the dead time fades out below
+#define DSIM_BRIDGE_OHMS    (0.002)     // FETs and primary copper
+#define DSIM_TURNS          (16.8)      // secondary per primary
+#define DSIM_LEAK_MH        (0.5)       // leakage; secondary
+#define DSIM_WINDING_OHMS   (0.3)       // secondary
+#define DSIM_OUTPUT_UF      (2.0)       // output capacitor
+#define DSIM_IMEAS_NOISE    (3)         // +/- IMeas counts
+#define DSIM_THD_SLACK      (0.05)      // % THD the compensation may add at light load
+#define DSIM_HALVE_WATTS    (300.0)     // from here up the compensation must halve the THD
+
+// --------------------
+// Function Prototyping
+// --------------------
+int16_t dsim_RunDeadTimeCheck(void);    // returns number of failures
+
+#endif // __linux__
+
+#endif  //  _INV_DEADTIME_SIM_H_
+
+// <><><><><><><><><><><><><> inv_deadtime_sim.h <><><><><><><><><><><><><><><><><><><><><><>
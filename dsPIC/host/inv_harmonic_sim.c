@@ -0,0 +1,172 @@
+// <><><><><><><><><><><><><> inv_harmonic_sim.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host THD check of the inverter voltage loop harmonic compensation
+//  (see inv_harmonic_sim.h)
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "hw.h"
+#include "inverter.h"
+#include "inv_harmonic.h"
+#include "inv_harmonic_sim.h"
+#include "sine_table.h"
+#include <math.h>
+
+// ---------
+// constants
+// ---------
+#define VSIM_TWO_PI         (6.28318530718)
+#define VSIM_HARMONICS      (25)
+#define VSIM_SETPOINT       (390)       // peak; a/d counts
+#define VSIM_LAG            (0.6)       // of the step per PWM period
+
+// as inverter.c
+#define VSIM_MAX_DUTY       (((FCY/FPWM) - 1) * 2)
+#define VSIM_MIN_THRES      (60)
+#define VSIM_AMPLITUDE      ((int32_t)(VSIM_MAX_DUTY * .816))
+#define VSIM_I_GAIN_Q16     ((int32_t)(1.1 * 65536))
+#define VSIM_I_LIMIT        (3000)
+
+// ------------------------------------------------------------------------------------
+// runs the loop in a mode at a frequency; gets the THD (%) and the RMS error (%)
+static void vsim_Run(uint8_t mode, uint16_t hz, double* thd, double* rms_err)
+{
+    static double ha[VSIM_HARMONICS + 1], hb[VSIM_HARMONICS + 1];
+    const double kd = VSIM_SETPOINT / (double)VSIM_AMPLITUDE;
+    DDS_t    dds;
+    double   v = 0.0, vopen, vmag, th, sumsq = 0.0, cycsq = 0.0;
+    int32_t  isum = 0, duty, sv;
+    int16_t  offset = 0, rmsCyc = 0, ncyc = 0;
+    const int16_t rmsTarget = (int16_t)lrint(VSIM_SETPOINT / sqrt(2.0));
+    int16_t  index, sp, vm, e, ew, adj = 0;
+    uint16_t cycles = 0, n = 0, h, k, bin;
+    uint8_t  half, events = 0;
+
+    dds.phase = 0;
+    dds.step  = DDS_STEP_HZ(hz);
+    for (k = 0; k < INV_HC_BINS; k++) inv_HarmonicWipe(INV_VLOOP_PID);    // forget the last run
+    for (h = 0; h <= VSIM_HARMONICS; h++) ha[h] = hb[h] = 0.0;
+
+    while (cycles < VSIM_SETTLE_CYCLES + VSIM_THD_CYCLES)
+    {
+        sv   = dds_Sample(&dds, &index);
+        half = (VECTOR2 == dds_Vector(&dds)) ? 1 : 0;
+        bin  = index + (half ? MAX_SINE : 0);
+        th   = dds.phase * (VSIM_TWO_PI / 4294967296.0);
+
+        // as _inv_PwmIsr(); the magnitude domain
+        sp = (int16_t)((sv * (VSIM_SETPOINT + offset)) >> 16);
+        vm = (int16_t)lrint(half ? -v : v);
+        e  = sp - vm;
+        ew = (int16_t)(((int32_t)e * sv) >> 16);
+        if (events & DDS_EV_HALF)
+        {
+            isum = 0;
+            // _inv_AdjustRmsSetpoint(); on the rms of the last whole cycle
+            if (rmsCyc < rmsTarget) offset++;
+            else if (rmsCyc > rmsTarget) offset--;
+        }
+        isum += ew;
+        if (isum >  VSIM_I_LIMIT) isum =  VSIM_I_LIMIT;
+        if (isum < -VSIM_I_LIMIT) isum = -VSIM_I_LIMIT;
+        duty  = (sv * (VSIM_AMPLITUDE + ((isum * VSIM_I_GAIN_Q16) >> 16))) >> 16;
+        inv_HarmonicWipe(mode);
+        // held through the periods either side of the end of the cycle
+        if (!(half && ((uint32_t)(dds.phase + dds.step) < dds.phase)) && !(!half && (events & DDS_EV_HALF)))
+            adj = inv_HarmonicTerm(mode, bin, e, 1);
+        duty += adj;
+        if (duty < VSIM_MIN_THRES) duty = 0;
+        if (duty > VSIM_MAX_DUTY)  duty = VSIM_MAX_DUTY;
+
+        // plant; the rectifier load clamps the peaks
+        vopen = kd * duty;
+        vmag  = vopen;
+        if (vopen > VSIM_CLAMP * VSIM_SETPOINT)
+            vmag = VSIM_CLAMP * VSIM_SETPOINT + 0.25 * (vopen - VSIM_CLAMP * VSIM_SETPOINT);
+        v += VSIM_LAG * ((half ? -vmag : vmag) - v);
+
+        if (cycles >= VSIM_SETTLE_CYCLES)
+        {
+            for (h = 1; h <= VSIM_HARMONICS; h++)
+            {
+                ha[h] += v * cos(h * th);
+                hb[h] += v * sin(h * th);
+            }
+            sumsq += v * v;
+            n++;
+        }
+
+        cycsq += v * v;
+        ncyc++;
+        events = dds_Advance(&dds);
+        if ((events & DDS_EV_HALF) && !(dds.phase & DDS_PHASE_HALF))
+        {
+            cycles++;
+            rmsCyc = (int16_t)sqrt(cycsq / ncyc);
+            cycsq = 0.0;
+            ncyc  = 0;
+        }
+    }
+
+    for (h = 1, *thd = 0.0; h <= VSIM_HARMONICS; h++)
+    {
+        ha[h] *= 2.0 / n;
+        hb[h] *= 2.0 / n;
+        if (h > 1) *thd += ha[h]*ha[h] + hb[h]*hb[h];
+    }
+    *thd     = 100.0 * sqrt(*thd / (ha[1]*ha[1] + hb[1]*hb[1]));
+    *rms_err = 100.0 * (sqrt(sumsq / n) / (VSIM_SETPOINT / sqrt(2.0)) - 1.0);
+}
+
+// ------------------------------------------------------------------------------------
+int16_t vsim_RunHarmonicCheck(void)
+{
+    static const uint16_t freqs[] = { 60, 50 };
+    static const char* const names[] = { "PID", "repetitive", "resonant" };
+    int16_t  nfail = 0;
+    uint16_t f;
+    uint8_t  mode;
+    double   thd0 = 0.0, thd, err;
+
+    Inv.config.rc_gain   = INV_DFLT_RC_GAIN_Q16;
+    Inv.config.rc_forget = INV_DFLT_RC_FORGET_Q16;
+    Inv.config.rc_limit  = INV_DFLT_RC_LIMIT;
+    Inv.config.rc_lead   = INV_DFLT_RC_LEAD;
+
+    for (f = 0; f < sizeof(freqs)/sizeof(freqs[0]); f++)
+    {
+        for (mode = INV_VLOOP_PID; mode <= INV_VLOOP_RESONANT; mode++)
+        {
+            vsim_Run(mode, freqs[f], &thd, &err);
+            if (INV_VLOOP_PID == mode) thd0 = thd;
+            LOG(SS_SYS, SV_INFO, "VSIM: %u Hz %-10s THD %5.2f%%, RMS %+5.2f%%", freqs[f], names[mode], thd, err);
+
+            if ((INV_VLOOP_PID != mode) && (thd > thd0 * VSIM_THD_RATIO))
+            {
+                LOG(SS_SYS, SV_ERR, "VSIM: %u Hz %s: THD above %.2f of the PID loop", freqs[f], names[mode], VSIM_THD_RATIO);
+                nfail++;
+            }
+            if (fabs(err) > VSIM_RMS_PCT)
+            {
+                LOG(SS_SYS, SV_ERR, "VSIM: %u Hz %s: RMS off the setpoint", freqs[f], names[mode]);
+                nfail++;
+            }
+        }
+    }
+
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "VSIM: harmonic compensation check %s", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> inv_harmonic_sim.c <><><><><><><><><><><><><><><><><><><><><><>
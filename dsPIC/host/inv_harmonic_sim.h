@@ -0,0 +1,55 @@
+// <><><><><><><><><><><><><> inv_harmonic_sim.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host THD check of the inverter voltage loop harmonic compensation
+//
+//  A reduced copy of the inverter voltage loop: the sine-weighted error
+//  into an integral reset at each zero crossing, the multiplier, and
+//  inv_HarmonicTerm() on top, held through the PWM periods either side of
+//  the end of the a/c cycle, at the Inv.config defaults but for the mode,
+//  and the RMS setpoint offset of _inv_AdjustRmsSetpoint(): a count up or
+//  down each half-cycle on the RMS of the last whole cycle. The plant is the duty to output gain with a first order lag of about a
+//  PWM period, into a rectifier load that clamps the peaks above
+//  VSIM_CLAMP of the setpoint. The output phase comes from a DDS, at 60 and
+//  50 Hz. After VSIM_SETTLE_CYCLES the THD and RMS are taken over
+//  VSIM_THD_CYCLES: the repetitive and resonant modes must each take the
+//  THD of the PID loop down to VSIM_THD_RATIO of it or less, and every
+//  mode must hold the RMS within VSIM_RMS_PCT of the setpoint, about a
+//  count of VacRMS(). Without the offset the compensation takes the RMS
+//  down by 1.5% into this load and the THD looks better than it is.
+//  Logs the figures and returns the number of failures. Run by host/
+//  'make check' (vloop).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _INV_HARMONIC_SIM_H_    // include only once
+#define _INV_HARMONIC_SIM_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ---------
+// constants
+// ---------
+#define VSIM_CLAMP          (0.85)      // rectifier load; fraction of the setpoint peak
+#define VSIM_SETTLE_CYCLES  (120)
+#define VSIM_THD_CYCLES     (5)         // whole cycles at 50 and 60 Hz
+#define VSIM_THD_RATIO      (0.75)
+#define VSIM_RMS_PCT        (0.5)       // 1 count of VacRMS() is 0.36%
+
+// --------------------
+// Function Prototyping
+// --------------------
+int16_t vsim_RunHarmonicCheck(void);    // returns number of failures
+
+#endif // __linux__
+
+#endif  //  _INV_HARMONIC_SIM_H_
+
+// <><><><><><><><><><><><><> inv_harmonic_sim.h <><><><><><><><><><><><><><><><><><><><><><>
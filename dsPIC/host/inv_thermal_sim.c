@@ -0,0 +1,151 @@
+// <><><><><><><><><><><><><> inv_thermal_sim.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host load profile check for the I2t thermal overload model
+//  (see inv_thermal_sim.h)
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "hs_temp.h"
+#include "inverter.h"
+#include "inv_thermal.h"
+#include "inv_thermal_sim.h"
+
+// ---------
+// constants
+// ---------
+#define TSIM_HOUR_SEC       (3600.0)
+#define TSIM_SEC_CYCLES(s)  ((uint32_t)((s) * OPTION_AC_OUT_HZ + 0.5))
+
+// what to wait for
+#define TSIM_FET_HOT        (1)
+#define TSIM_FET_COOL       (2)
+#define TSIM_XFMR_HOT       (3)
+
+// ------------------------------------------------------------------------------------
+// runs load_pct of rated from where the model is, for up to max_sec or until
+// the event. Returns the seconds to the event, or -1.0 if it did not happen.
+static double tsim_Run(int16_t load_pct, int16_t hs_temp_c, double max_sec, uint8_t event)
+{
+    int16_t  rms = (int16_t)(((int32_t)Inv.config.ovl_rated_rms * load_pct) / 100);
+    uint32_t n, ncycles = TSIM_SEC_CYCLES(max_sec);
+
+    for (n = 1; n <= ncycles; n++)
+    {
+        inv_ThermalCycle(rms, hs_temp_c);
+        if (((TSIM_FET_HOT  == event) &&  g_invThermal.fetHot) ||
+            ((TSIM_FET_COOL == event) && !g_invThermal.fetHot) ||
+            ((TSIM_XFMR_HOT == event) &&  g_invThermal.xfmrHot))
+        {
+            return((double)n / OPTION_AC_OUT_HZ);
+        }
+    }
+    return(-1.0);
+}
+
+// ------------------------------------------------------------------------------------
+// from cold, load_pct until the event; fails unless it happens in lo..hi sec
+// (hi < 0: must not happen within lo sec)
+static int16_t tsim_Case(const char* name, int16_t load_pct, int16_t hs_temp_c, uint8_t event, double lo, double hi)
+{
+    double t;
+
+    inv_ThermalReset();
+    t = tsim_Run(load_pct, hs_temp_c, (hi < 0.0) ? lo : hi + 1.0, event);
+
+    if (hi < 0.0)
+    {
+        if (t >= 0.0)
+        {
+            LOG(SS_SYS, SV_ERR, "TSIM: %s: tripped after %.1f sec", name, t);
+            return(1);
+        }
+        LOG(SS_SYS, SV_INFO, "TSIM: %s: runs on; FET %d%%, xfmr %d%% after %.0f sec",
+            name, inv_ThermalFetPct(), inv_ThermalXfmrPct(), lo);
+        return(0);
+    }
+    if ((t < lo) || (t > hi))
+    {
+        LOG(SS_SYS, SV_ERR, "TSIM: %s: %.1f sec, not %.1f..%.1f", name, t, lo, hi);
+        return(1);
+    }
+    LOG(SS_SYS, SV_INFO, "TSIM: %s: %.1f sec", name, t);
+    return(0);
+}
+
+// ------------------------------------------------------------------------------------
+int16_t tsim_RunOverloadCheck(void)
+{
+    int16_t  nfail = 0;
+    uint16_t k;
+    int16_t  fet_max = 0;
+    double   t;
+
+    Inv.config.ovl_rated_rms   = INV_DFLT_OVL_RATED_RMS;
+    Inv.config.ovl_fet_tau     = INV_DFLT_OVL_FET_TAU;
+    Inv.config.ovl_fet_limit   = INV_DFLT_OVL_FET_LIMIT;
+    Inv.config.ovl_xfmr_tau    = INV_DFLT_OVL_XFMR_TAU;
+    Inv.config.ovl_xfmr_limit  = INV_DFLT_OVL_XFMR_LIMIT;
+    Inv.config.ovl_hs_temp_max = INV_DFLT_OVL_HS_TEMP_MAX;
+
+    // continuous
+    nfail += tsim_Case("100% for an hour",  100, ROOM_TEMP_C, TSIM_XFMR_HOT, TSIM_HOUR_SEC, -1.0);
+    nfail += tsim_Case("107% for an hour",  107, ROOM_TEMP_C, TSIM_XFMR_HOT, TSIM_HOUR_SEC, -1.0);
+    nfail += tsim_Case("100% hot heat sink", 100, INV_DFLT_OVL_HS_TEMP_MAX, TSIM_FET_HOT, TSIM_HOUR_SEC, -1.0);
+
+    // transformer shutdown
+    nfail += tsim_Case("108% to shutdown",  108, ROOM_TEMP_C, TSIM_XFMR_HOT, 120.0, 600.0);
+    nfail += tsim_Case("125% to shutdown",  125, ROOM_TEMP_C, TSIM_XFMR_HOT,  60.0, 100.0);
+    nfail += tsim_Case("150% to shutdown",  150, ROOM_TEMP_C, TSIM_XFMR_HOT,  30.0,  60.0);
+    nfail += tsim_Case("150% FETs",         150, ROOM_TEMP_C, TSIM_FET_HOT,   60.0,  -1.0);
+
+    // surge
+    nfail += tsim_Case("200% to FET clip",  200, ROOM_TEMP_C, TSIM_FET_HOT,    2.5,   3.5);
+    nfail += tsim_Case("200% at 70C",       200, 70,          TSIM_FET_HOT,    1.0,   2.0);
+    nfail += tsim_Case("300% to FET clip",  300, ROOM_TEMP_C, TSIM_FET_HOT,    0.5,   1.5);
+
+    // 2 sec motor start at 200% every 30 sec on a 60% load, for 10 minutes
+    inv_ThermalReset();
+    for (k = 0; k < 20; k++)
+    {
+        t = tsim_Run(200, ROOM_TEMP_C, 2.0, TSIM_FET_HOT);
+        if (inv_ThermalFetPct() > fet_max) fet_max = inv_ThermalFetPct();
+        if ((t >= 0.0) || (tsim_Run(60, ROOM_TEMP_C, 28.0, TSIM_XFMR_HOT) >= 0.0))
+        {
+            LOG(SS_SYS, SV_ERR, "TSIM: motor start %u: tripped; FET %d%%, xfmr %d%%", k + 1, inv_ThermalFetPct(), inv_ThermalXfmrPct());
+            nfail++;
+            break;
+        }
+    }
+    LOG(SS_SYS, SV_INFO, "TSIM: motor starts on 60%%: FET %d%% max (limit %u), xfmr %d%%",
+        fet_max, Inv.config.ovl_fet_limit, inv_ThermalXfmrPct());
+
+    // FETs get the 200% limit back
+    inv_ThermalReset();
+    tsim_Run(200, ROOM_TEMP_C, 10.0, TSIM_FET_HOT);
+    t = tsim_Run(50, ROOM_TEMP_C, 30.0, TSIM_FET_COOL);
+    if ((t < 0.0) || (t > 10.0))
+    {
+        LOG(SS_SYS, SV_ERR, "TSIM: FETs not cooled at 50%% load: %.1f sec", t);
+        nfail++;
+    }
+    else
+    {
+        LOG(SS_SYS, SV_INFO, "TSIM: FETs cooled at 50%% load after %.1f sec", t);
+    }
+
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "TSIM: overload check %s", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> inv_thermal_sim.c <><><><><><><><><><><><><><><><><><><><><><>
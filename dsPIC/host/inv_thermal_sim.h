@@ -0,0 +1,41 @@
+// <><><><><><><><><><><><><> inv_thermal_sim.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host load profile check for the I2t thermal overload model
+//
+//  Steps inv_ThermalCycle() once per a/c cycle, with the Inv.config model
+//  settings at their defaults, through the load profiles the model is
+//  meant for and checks when it lets go:
+//    - rated and just under the transformer limit run on for an hour;
+//    - 108% and 125% shut down (transformer) inside a window;
+//    - 200% from cold runs for the surge time before the FETs clip it, and
+//      sooner on a hot heat sink;
+//    - a 2 sec motor start every 30 sec on a 60% load runs on;
+//    - the FETs cool and get the 200% limit back at light load.
+//  It logs the times and returns the number of failures. Run by host/
+//  'make check' (thermal).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _INV_THERMAL_SIM_H_    // include only once
+#define _INV_THERMAL_SIM_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// --------------------
+// Function Prototyping
+// --------------------
+int16_t tsim_RunOverloadCheck(void);    // returns number of failures
+
+#endif // __linux__
+
+#endif  //  _INV_THERMAL_SIM_H_
+
+// <><><><><><><><><><><><><> inv_thermal_sim.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,239 @@
+// <><><><><><><><><><><><><> load_sense_sim.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host check of the load-sense search mode (see load_sense_sim.h)
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "inverter.h"
+#include "load_sense.h"
+#include "load_sense_sim.h"
+#include "sine_table.h"
+#include <math.h>
+
+// ---------
+// constants
+// ---------
+#define LSIM_TWO_PI         (6.28318530718)
+#define LSIM_VOLTS          (INV_RMS_VAC_SETPOINT_VOLTS)
+#define LSIM_PROBE_SAMPLES  ((LSENSE_PROBE_HALF_CYCLES * FPWM) / (2 * OPTION_AC_OUT_HZ))
+#define LSIM_HALF_CYCLE_SEC (1.0 / (2.0 * OPTION_AC_OUT_HZ))
+
+// loads
+#define LSIM_NONE           (0)
+#define LSIM_RESISTOR       (1)     // watts at the full output
+#define LSIM_RECTIFIER      (2)     // draws over the top 10% of the voltage; watts at the full output
+#define LSIM_SHORT          (3)
+
+// ----------
+// local data
+// ----------
+static uint32_t s_rand = 1;
+
+// ------------------------------------------------------------------------------------
+static int16_t lsim_Noise(int16_t range)
+{
+    s_rand = s_rand * 1103515245 + 12345;
+    return((int16_t)((s_rand >> 16) % (2*range + 1)) - range);
+}
+
+// ------------------------------------------------------------------------------------
+// rectifier current (amps per volt of peak) at sin; 1 watt at the full output
+static double lsim_RectifierAmps(double s)
+{
+    // mean of |sin| * (|sin| - 0.9) over the part of the cycle above 0.9
+    static double scale = 0.0;
+    uint16_t k;
+
+    if (0.0 == scale)
+    {
+        for (k = 0; k < 1000; k++)
+        {
+            double t = fabs(sin(LSIM_TWO_PI * (k + 0.5) / 1000.0));
+            if (t > 0.9) scale += t * (t - 0.9) / 1000.0;
+        }
+        scale = 1.0 / (LSIM_VOLTS * 1.41421356 * scale);
+    }
+    if (fabs(s) <= 0.9) return(0.0);
+    return(scale * ((s > 0.0) ? (s - 0.9) : (s + 0.9)));
+}
+
+// ------------------------------------------------------------------------------------
+// one probe into the load. Returns lsense_ProbeDone().
+static int8_t lsim_Probe(uint8_t load, double watts)
+{
+    double   vpk = (LSENSE_VAC_RMS_FULL * 1.41421356) / LSENSE_PROBE_FRACTION;  // counts
+    double   vratio = 1.0 / LSENSE_PROBE_FRACTION;  // of the full output
+    double   th, s, amps;
+    int16_t  v;
+    uint16_t k;
+
+    lsense_ProbeStart();
+    for (k = 0; k < LSIM_PROBE_SAMPLES; k++)
+    {
+        th = LSIM_TWO_PI * (k + 0.5) * OPTION_AC_OUT_HZ / FPWM;
+        s  = sin(th);
+
+        // output capacitor; leads
+        amps = LSIM_VOLTS * 1.41421356 * vratio * LSIM_TWO_PI * OPTION_AC_OUT_HZ * LSIM_OUTPUT_UF * 1.0e-6 * cos(th);
+
+        if (LSIM_RESISTOR == load)
+            amps += (LSIM_VOLTS * 1.41421356 * vratio * s) * watts / (LSIM_VOLTS * LSIM_VOLTS);
+        else if (LSIM_RECTIFIER == load)
+            amps += watts * lsim_RectifierAmps(s);  // sized at the full output; as if its capacitor had run down
+
+        if (LSIM_SHORT == load)
+        {
+            v    = 0;
+            amps = 20.0 * s;
+        }
+        else
+        {
+            v = (int16_t)floor(vpk * s + 0.5);
+        }
+        lsense_ProbeSample(v + lsim_Noise(LSIM_VAC_NOISE),
+                           (int16_t)floor(amps * IMEAS_INV_SLOPE + 0.5) + LSIM_IMEAS_ZERO_ERR + lsim_Noise(LSIM_IMEAS_NOISE));
+    }
+    return(lsense_ProbeDone());
+}
+
+// ------------------------------------------------------------------------------------
+// probes until one does not give the expected answer. Returns 0=ok
+static int16_t lsim_Case(const char* name, uint8_t load, double watts, uint16_t nprobes, int8_t expect)
+{
+    uint16_t n;
+
+    for (n = 0; n < nprobes; n++)
+    {
+        if (lsim_Probe(load, watts) != expect)
+        {
+            LOG(SS_SYS, SV_ERR, "LSIM: %s: %s on probe %u", name, expect ? "missed" : "found", n + 1);
+            return(1);
+        }
+    }
+    LOG(SS_SYS, SV_INFO, "LSIM: %s: %s, %u ohms", name, expect ? "found" : "nothing", g_lsense.ohms);
+    return(0);
+}
+
+// ------------------------------------------------------------------------------------
+// an hour of nothing on the output; gets the probes and the probe energy,
+// then the mean and worst seconds a load switched on waits for a probe
+static void lsim_Hour(uint16_t interval_max, uint16_t* probes, uint16_t* joules, double* mean, double* worst)
+{
+    uint32_t tick;
+    int16_t  half_sec_ticks = 0;
+
+    Inv.config.load_sense_interval_max = interval_max;
+    lsense_Reset();
+    g_lsense.hourTicks = 0;
+    g_lsense.mjHour    = 0;
+    g_lsense.probes    = 0;
+    *probes = 0;
+
+    // as _inv_Driver() INV_LOAD_SENSE
+    for (tick = 0; tick < LSENSE_HOUR_TICKS; tick++)
+    {
+        half_sec_ticks++;
+        if (g_lsense.hourTicks + 1 >= LSENSE_HOUR_TICKS) *probes = g_lsense.probes;
+        lsense_HalfSecTick();
+        if (half_sec_ticks >= (int16_t)g_lsense.interval)
+        {
+            half_sec_ticks = 0;
+            lsim_Probe(LSIM_NONE, 0.0);
+        }
+    }
+    *joules = g_lsense.joulesPerHour;
+
+    // backed off; the load comes on anywhere in the interval
+    *worst = g_lsense.interval * 0.5;
+    *mean  = g_lsense.interval * 0.25;
+}
+
+// ------------------------------------------------------------------------------------
+int16_t lssim_RunLoadSenseCheck(void)
+{
+    static const uint16_t interval_max[] = { 2, 4, 8, 16, 32, 60 };
+    int16_t  nfail = 0;
+    uint16_t k, probes, joules;
+    double   mean, worst, thres_watts, old_mj;
+
+    Inv.config.load_sense_interval     = INV_DFLT_LOAD_SENSE_INTERVAL;
+    Inv.config.load_sense_interval_max = INV_DFLT_LOAD_SENSE_INTERVAL_MAX;
+    Inv.config.load_sense_threshold    = INV_DFLT_LOAD_SENSE_THRESHOLD;
+    lsense_Reset();
+
+    thres_watts = (Inv.config.load_sense_threshold / IMEAS_INV_SLOPE) * LSIM_VOLTS;
+    LOG(SS_SYS, SV_INFO, "LSIM: threshold %.0f W at %.0f V; probe %.0f V, %u samples",
+        thres_watts, LSIM_VOLTS, LSIM_VOLTS / LSENSE_PROBE_FRACTION, (unsigned)LSIM_PROBE_SAMPLES);
+
+    // what is found
+    nfail += lsim_Case("no load",         LSIM_NONE,      0.0,                LSIM_NO_LOAD_PROBES, 0);
+    nfail += lsim_Case("half threshold",  LSIM_RESISTOR,  thres_watts * 0.5,  LSIM_NO_LOAD_PROBES, 0);
+    nfail += lsim_Case("30 W lamp",       LSIM_RESISTOR,  30.0,  50, 1);
+    nfail += lsim_Case("30 W rectifier",  LSIM_RECTIFIER, 30.0,  50, 1);
+    nfail += lsim_Case("1500 W heater",   LSIM_RESISTOR,  1500.0, 5, 1);
+    nfail += lsim_Case("short",           LSIM_SHORT,     0.0,    5, 1);
+
+    // the 30 W lamp is 504 ohms
+    lsim_Probe(LSIM_RESISTOR, 30.0);
+    if (fabs(g_lsense.ohms - (LSIM_VOLTS * LSIM_VOLTS / 30.0)) > 0.1 * (LSIM_VOLTS * LSIM_VOLTS / 30.0))
+    {
+        LOG(SS_SYS, SV_ERR, "LSIM: 30 W lamp read as %u ohms", g_lsense.ohms);
+        nfail++;
+    }
+
+    // back off; a load found goes back to the shortest interval
+    Inv.config.load_sense_interval_max = INV_DFLT_LOAD_SENSE_INTERVAL_MAX;
+    lsense_Reset();
+    for (k = 0; k < 8; k++) lsim_Probe(LSIM_NONE, 0.0);
+    if (g_lsense.interval != Inv.config.load_sense_interval_max)
+    {
+        LOG(SS_SYS, SV_ERR, "LSIM: backed off to %u, not %u", g_lsense.interval, Inv.config.load_sense_interval_max);
+        nfail++;
+    }
+    lsim_Probe(LSIM_RESISTOR, 30.0);
+    if (g_lsense.interval != Inv.config.load_sense_interval)
+    {
+        LOG(SS_SYS, SV_ERR, "LSIM: interval %u after a load, not %u", g_lsense.interval, Inv.config.load_sense_interval);
+        nfail++;
+    }
+
+    // energy against latency; the old ping was 2/3, 2/3 and 1/3 of the soft start
+    // amplitude for a half-cycle each, every load_sense_interval
+    old_mj = LSENSE_NO_LOAD_WATTS * 1000.0 * LSIM_HALF_CYCLE_SEC * (4.0 + 4.0 + 1.0) / 9.0;
+    LOG(SS_SYS, SV_INFO, "LSIM: old ping:        %5.0f probes/hr, %5.0f J/hr, wait %4.2f sec mean, %4.1f max",
+        3600.0 / (Inv.config.load_sense_interval * 0.5),
+        old_mj * 3600.0 / (Inv.config.load_sense_interval * 0.5) / 1000.0,
+        Inv.config.load_sense_interval * 0.25, Inv.config.load_sense_interval * 0.5);
+
+    for (k = 0; k < sizeof(interval_max)/sizeof(interval_max[0]); k++)
+    {
+        lsim_Hour(interval_max[k], &probes, &joules, &mean, &worst);
+        LOG(SS_SYS, SV_INFO, "LSIM: max %4.1f sec:    %5u probes/hr, %5u J/hr, wait %4.2f sec mean, %4.1f max%s",
+            interval_max[k] * 0.5, probes, joules, mean, worst,
+            (interval_max[k] == INV_DFLT_LOAD_SENSE_INTERVAL_MAX) ? "  (default)" : "");
+        if ((interval_max[k] == INV_DFLT_LOAD_SENSE_INTERVAL_MAX) &&
+            (joules * 1000.0 > old_mj * 3600.0 / (Inv.config.load_sense_interval * 0.5) / 10.0))
+        {
+            LOG(SS_SYS, SV_ERR, "LSIM: default not a tenth of the old ping energy");
+            nfail++;
+        }
+    }
+
+    Inv.config.load_sense_interval_max = INV_DFLT_LOAD_SENSE_INTERVAL_MAX;
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "LSIM: load sense check %s", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> load_sense_sim.c <><><><><><><><><><><><><><><><><><><><><><>
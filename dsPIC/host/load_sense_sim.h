@@ -0,0 +1,48 @@
+// <><><><><><><><><><><><><> load_sense_sim.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host check of the load-sense search mode
+//
+//  Feeds load_sense.c the VAC and IMeas samples of a probe into simulated
+//  loads (the output capacitor, lamps, a rectifier load, a heater, a short)
+//  with sense noise and an IMeas zero error, and checks which are found.
+//  Then, with the Inv.config load-sense settings at their defaults and a
+//  range of load_sense_interval_max, runs an hour of load sensing with
+//  nothing on the output and logs the probe energy per hour against the
+//  time a load switched on waits for the inverter to start, next to the
+//  old 2/3 amplitude ping every load_sense_interval.
+//  Returns the number of failures. Run by host/ 'make check' (lsense).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _LOAD_SENSE_SIM_H_    // include only once
+#define _LOAD_SENSE_SIM_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ---------
+// constants
+// ---------
+#define LSIM_VAC_NOISE      (2)     // +/- VAC counts
+#define LSIM_IMEAS_NOISE    (3)     // +/- IMeas counts
+#define LSIM_IMEAS_ZERO_ERR (5)     // IMeas counts of sensor zero not learnt
+#define LSIM_OUTPUT_UF      (2.0)   // output capacitor (microfarads)
+#define LSIM_NO_LOAD_PROBES (200)   // probes of nothing that must all find nothing
+
+// --------------------
+// Function Prototyping
+// --------------------
+int16_t lssim_RunLoadSenseCheck(void);  // returns number of failures
+
+#endif // __linux__
+
+#endif  //  _LOAD_SENSE_SIM_H_
+
+// <><><><><><><><><><><><><> load_sense_sim.h <><><><><><><><><><><><><><><><><><><><><><>
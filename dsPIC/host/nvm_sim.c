@@ -0,0 +1,406 @@
+// <><><><><><><><><><><><><> nvm_sim.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host 24LC64 EEPROM simulator for the NVM driver (see nvm_sim.h)
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "nvm.h"
+#include "nvm_sim.h"
+
+// -------------------
+// access global data
+// -------------------
+extern volatile int16_t  _T1TickCount;
+
+// ---------
+// constants
+// ---------
+#define NVMSIM_I2C_ADDRESS   0xA0   // 24LC64 control byte with A2..A0 low
+#define NVMSIM_TWC_MSEC      5      // write cycle time (max per data sheet)
+#define NVMSIM_BYTE_USEC     23     // 9 bit times at 400 kHz
+#define NVMSIM_IDLE_USEC     100    // time that passes per idle blocking poll
+#define NVMSIM_RUN_MSEC      5000   // give up on a save that takes longer
+
+// bus phase of the 24LC64
+#define PH_IDLE      0  // waiting for a start
+#define PH_CTRL      1  // next byte is the control byte
+#define PH_ADDR_HI   2  // next byte is the address hi byte
+#define PH_ADDR_LO   3  // next byte is the address lo byte
+#define PH_DATA      4  // bytes go to the page buffer
+#define PH_READ      5  // reads come from the address pointer
+
+// -------------------------
+// I2C register stand-ins
+// -------------------------
+volatile NVMSIM_I2CCON_t   nvmsim_CONbits;
+volatile NVMSIM_I2CSTAT_t  nvmsim_STATbits;
+volatile uint16_t          nvmsim_TRN = NVMSIM_TRN_EMPTY;
+volatile uint16_t          nvmsim_RCV;
+volatile uint16_t          nvmsim_BRG;
+volatile uint16_t          nvmsim_ADD;
+volatile uint16_t          nvmsim_IF;
+volatile uint16_t          nvmsim_IE;
+volatile uint16_t          nvmsim_MD;
+
+// ----------
+// local data
+// ----------
+static uint8_t  s_mem[NVM_BYTES_TOTAL];         // eeprom array
+static uint8_t  s_pageBuf[NVM_PAGE_BYTES];      // page buffer
+static uint8_t  s_pageValid[NVM_PAGE_BYTES];    // 1=byte received for this write
+static uint16_t s_pageBase;                     // array address of the page buffer
+static uint16_t s_nPage;                        // data bytes received for this write
+static uint16_t s_addr;                         // address pointer
+static uint8_t  s_phase = PH_IDLE;
+static uint8_t  s_isPowered = 0;
+static uint8_t  s_isErased  = 0;                // array initialized
+static uint8_t  s_isBusy = 0;                   // write cycle in progress
+static SYSTICKS s_busyTicks;                    // write cycle start
+static uint16_t s_cutAt = 0;                    // cut power at this data byte; 0=never
+static uint32_t s_nWritten = 0;                 // data bytes written since last cut setting
+static uint16_t s_usec = 0;                     // simulated time not yet in system ticks
+
+// ------------------------------------------------------------------------------------
+void nvmsim_Erase(void)
+{
+    memset(s_mem, NVM_ERASE_BYTE, sizeof(s_mem));
+    s_isErased = 1;
+}
+
+// ------------------------------------------------------------------------------------
+// power up the part; a new part comes erased
+void nvmsim_Open(void)
+{
+    if (!s_isErased) nvmsim_Erase();
+    memset((void*)&nvmsim_CONbits,  0, sizeof(nvmsim_CONbits));
+    memset((void*)&nvmsim_STATbits, 0, sizeof(nvmsim_STATbits));
+    nvmsim_TRN  = NVMSIM_TRN_EMPTY;
+    s_phase     = PH_IDLE;
+    s_isBusy    = 0;
+    s_isPowered = 1;
+}
+
+// ------------------------------------------------------------------------------------
+void nvmsim_CutPowerAt(uint16_t nbytes)
+{
+    s_cutAt    = nbytes;
+    s_nWritten = 0;
+}
+
+// ------------------------------------------------------------------------------------
+// move the bytes received into the page buffer to the array
+static void nvmsim_Commit(void)
+{
+    int i;
+
+    for (i=0; i<NVM_PAGE_BYTES; i++)
+    {
+        if (s_pageValid[i]) s_mem[s_pageBase + i] = s_pageBuf[i];
+    }
+    memset(s_pageValid, 0, sizeof(s_pageValid));
+    s_nPage = 0;
+}
+
+// ------------------------------------------------------------------------------------
+// is a write cycle still running
+static int16_t nvmsim_IsBusy(void)
+{
+    if (s_isBusy && IsTimedOut(NVMSIM_TWC_MSEC, s_busyTicks)) s_isBusy = 0;
+    return(s_isBusy);
+}
+
+// ------------------------------------------------------------------------------------
+// the part receives a byte
+// returns: ACKSTAT 0=ack, 1=no ack
+static uint16_t nvmsim_Byte(uint8_t b)
+{
+    switch (s_phase)
+    {
+    case PH_CTRL:
+        // busy in a write cycle or not powered; no ack (ACK polling)
+        if (!s_isPowered || nvmsim_IsBusy() || (b & 0xFE) != NVMSIM_I2C_ADDRESS)
+        {
+            s_phase = PH_IDLE;
+            return(1);
+        }
+        s_phase = (b & 1) ? PH_READ : PH_ADDR_HI;
+        return(0);
+
+    case PH_ADDR_HI:
+        s_addr  = (uint16_t)(b << 8) & (NVM_BYTES_TOTAL-1);
+        s_phase = PH_ADDR_LO;
+        return(0);
+
+    case PH_ADDR_LO:
+        s_addr    |= b;
+        s_pageBase = s_addr & ~(NVM_PAGE_BYTES-1);
+        s_nPage    = 0;
+        memset(s_pageValid, 0, sizeof(s_pageValid));
+        s_phase    = PH_DATA;
+        return(0);
+
+    case PH_DATA:
+        // page buffer wraps within the page
+        s_pageBuf  [s_addr & (NVM_PAGE_BYTES-1)] = b;
+        s_pageValid[s_addr & (NVM_PAGE_BYTES-1)] = 1;
+        s_addr = s_pageBase | ((s_addr+1) & (NVM_PAGE_BYTES-1));
+        s_nPage++;
+        s_nWritten++;
+        if (s_cutAt && s_nWritten >= s_cutAt)
+        {
+            // power dies part way through this page; the part stops answering
+            nvmsim_Commit();
+            s_isPowered = 0;
+            s_phase     = PH_IDLE;
+        }
+        return(0);
+
+    default:
+        return(1);
+    } // switch
+}
+
+// ------------------------------------------------------------------------------------
+// carry out one pending bus action and raise the interrupt
+// returns: 0=nothing pending, 1=action done
+static int16_t nvmsim_Step(void)
+{
+    uint16_t b;
+
+    if (!nvmsim_CONbits.I2CEN) return(0);
+
+    if (nvmsim_CONbits.SEN)
+    {
+        nvmsim_CONbits.SEN = 0;
+        s_phase = PH_CTRL;
+    }
+    else if (nvmsim_CONbits.RSEN)
+    {
+        nvmsim_CONbits.RSEN = 0;
+        s_phase = PH_CTRL;
+    }
+    else if (nvmsim_CONbits.PEN)
+    {
+        nvmsim_CONbits.PEN = 0;
+        if (s_phase == PH_DATA && s_nPage)
+        {
+            // stop starts the write cycle
+            nvmsim_Commit();
+            s_isBusy    = 1;
+            s_busyTicks = GetSysTicks();
+        }
+        s_phase = PH_IDLE;
+    }
+    else if (nvmsim_CONbits.RCEN)
+    {
+        nvmsim_CONbits.RCEN = 0;
+        nvmsim_RCV = s_mem[s_addr];
+        s_addr = (s_addr+1) & (NVM_BYTES_TOTAL-1);
+        s_usec += NVMSIM_BYTE_USEC;
+    }
+    else if (nvmsim_CONbits.ACKEN)
+    {
+        nvmsim_CONbits.ACKEN = 0;
+    }
+    else if (nvmsim_TRN != NVMSIM_TRN_EMPTY)
+    {
+        b = nvmsim_TRN;
+        nvmsim_TRN = NVMSIM_TRN_EMPTY;
+        nvmsim_STATbits.ACKSTAT = nvmsim_Byte((uint8_t)b);
+        s_usec += NVMSIM_BYTE_USEC;
+    }
+    else
+    {
+        return(0);
+    }
+
+    nvmsim_IF = 1;
+    if (nvmsim_IE) _MI2CSimInterrupt();
+    return(1);
+}
+
+// ------------------------------------------------------------------------------------
+// carry out the bus actions the driver has queued
+// advance=1 from blocking waits: bus and idle time move the system ticks
+void nvmsim_Poll(uint8_t advance)
+{
+    while (nvmsim_Step()) { }
+
+    if (!advance) return;   // bus time is carried to the next blocking wait
+
+    s_usec += NVMSIM_IDLE_USEC;
+    while (s_usec >= 1000)
+    {
+        s_usec -= 1000;
+        _SysTicks++;
+        _T1TickCount++;
+    }
+}
+
+// -----------------------------------------------------------------------------
+//                 P O W E R    F A I L    C H E C K
+// -----------------------------------------------------------------------------
+
+#define NVMSIM_EVLOG_FILL   (0x00)      // stands for event log records; not the erased 0xFF
+
+static uint8_t  s_base[NVM_BYTES_TOTAL];    // array image every trial starts from
+static uint32_t s_saveMsec;                 // duration of the last trial save
+
+// ------------------------------------------------------------------------------------
+// power up and validate as at reset
+static void nvmsim_Boot(void)
+{
+    nvm_Config();
+    nvm_Start();
+}
+
+// ------------------------------------------------------------------------------------
+// drive the nvm task until nothing is pending
+// returns: msec it took
+static uint32_t nvmsim_RunDriver(void)
+{
+    SYSTICKS startTicks = GetSysTicks();
+
+    while (!IsTimedOut(NVMSIM_RUN_MSEC, startTicks))
+    {
+        TASK_nvm_Driver();
+        nvmsim_Poll(1);
+        if (!g_nvm.isDirty && !g_nvm.reqCmd && g_nvm.curCmd == NVM_CMD_NONE &&
+            g_nvm.mpwr.state == 0 && g_nvm.isr.status != NVM_STATUS_BUSY) break;
+    }
+    return(GetSysTicks() - startTicks);
+}
+
+// ------------------------------------------------------------------------------------
+// bytes of settings in use; the rest is fill
+#define NVMSIM_USED_BYTES   (NVM_SETTING_SIZE - NVM_UNUSED_SIZE)
+
+// one 16 bit field; a journal save
+static void nvmsim_ChangeOne(void)
+{
+    uint8_t* p = (uint8_t*)&g_nvm.settings;
+    p[(NVMSIM_USED_BYTES/2) & ~1]++;
+    p[(NVMSIM_USED_BYTES/2) | 1] ^= 0x81;
+}
+
+// a byte on every page in use; a full save
+static void nvmsim_ChangeMany(void)
+{
+    uint8_t* p = (uint8_t*)&g_nvm.settings;
+    int i;
+    for (i=0; i<NVMSIM_USED_BYTES; i+=NVM_PAGE_BYTES-3) p[i] ^= 0x5A;
+}
+
+// ------------------------------------------------------------------------------------
+// make a change, save it, cut power at data byte cut (0=no cut) and reboot
+// returns: data bytes written by the save, -1=recovered settings are inconsistent
+static int32_t nvmsim_Trial(void (*change)(void), uint8_t isFull, uint16_t cut)
+{
+    static NVM_SETTINGS_t before, after, recovered;
+    int32_t nbytes;
+
+    memcpy(s_mem, s_base, sizeof(s_mem));
+    nvmsim_Boot();
+    memcpy(&before, &g_nvm.settings, sizeof(before));
+    change();
+    memcpy(&after, &g_nvm.settings, sizeof(after));
+
+    if (isFull)
+        nvm_ReqSaveConfig();
+    else
+        nvm_SetDirty();
+    nvmsim_CutPowerAt(cut);
+    s_saveMsec = nvmsim_RunDriver();
+    nbytes = (int32_t)s_nWritten;
+    nvmsim_CutPowerAt(0);
+
+    // power comes back; must be the old or the new settings
+    nvmsim_Boot();
+    if (memcmp(&g_nvm.settings, &before, sizeof(before)) &&
+        memcmp(&g_nvm.settings, &after,  sizeof(after)))
+    {
+        LOG(SS_SYS, SV_ERR, "SIM: %s cut=%u inconsistent", isFull ? "full" : "journal", cut);
+        return(-1);
+    }
+
+    // let any repair finish; must come up the same again
+    memcpy(&recovered, &g_nvm.settings, sizeof(recovered));
+    nvmsim_RunDriver();
+    nvmsim_Boot();
+    if (memcmp(&g_nvm.settings, &recovered, sizeof(recovered)))
+    {
+        LOG(SS_SYS, SV_ERR, "SIM: %s cut=%u changed after repair", isFull ? "full" : "journal", cut);
+        return(-1);
+    }
+    return(nbytes);
+}
+
+// ------------------------------------------------------------------------------------
+// cut power at every data byte of a save and check each recovery
+static int16_t nvmsim_CheckSave(void (*change)(void), uint8_t isFull)
+{
+    int32_t  nbytes;
+    uint16_t cut;
+    int16_t  nfail = 0;
+
+    // uninterrupted save; how many bytes and how long
+    nbytes = nvmsim_Trial(change, isFull, 0);
+    if (nbytes < 0) return(1);
+    LOG(SS_SYS, SV_INFO, "SIM: %s save %ld bytes in %lu msec",
+        isFull ? "full" : "journal", (long)nbytes, (unsigned long)s_saveMsec);
+
+    for (cut=1; cut<=(uint16_t)nbytes; cut++)
+    {
+        if (nvmsim_Trial(change, isFull, cut) < 0) nfail++;
+    }
+    LOG(SS_SYS, SV_INFO, "SIM: %s save %u power cuts %u failed",
+        isFull ? "full" : "journal", (uint16_t)nbytes, nfail);
+    return(nfail);
+}
+
+// ------------------------------------------------------------------------------------
+// returns: number of failures
+int16_t nvmsim_RunPowerFailCheck(void)
+{
+    int16_t  nfail = 0;
+    uint16_t i;
+
+    // new part; first boot saves the ROM defaults and leaves the event log be
+    nvmsim_Erase();
+    memset(&s_mem[NVM_OFFSET_EVLOG], NVMSIM_EVLOG_FILL, NVM_EVLOG_BYTES);
+    nvmsim_Boot();
+    nvmsim_RunDriver();
+    for (i=NVM_OFFSET_EVLOG; i<NVM_BYTES_TOTAL && s_mem[i] == NVMSIM_EVLOG_FILL; i++) ;
+    if (i < NVM_BYTES_TOTAL)
+    {
+        LOG(SS_SYS, SV_ERR, "SIM: new firmware start changed the event log at %u", i);
+        nfail++;
+    }
+    // leave a live journal record behind the copies
+    nvmsim_ChangeMany();
+    nvm_SetDirty();
+    nvmsim_RunDriver();
+    nvmsim_ChangeOne();
+    nvm_SetDirty();
+    nvmsim_RunDriver();
+    memcpy(s_base, s_mem, sizeof(s_base));
+
+    nfail += nvmsim_CheckSave(nvmsim_ChangeOne,  0);
+    nfail += nvmsim_CheckSave(nvmsim_ChangeMany, 1);
+
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "SIM: power fail check %s", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> nvm_sim.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,78 @@
+// <><><><><><><><><><><><><> nvm_sim.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host 24LC64 EEPROM simulator for the NVM driver
+//
+//  Stands in for the I2C master and the EEPROM so nvm.c runs unchanged on a PC:
+//    - the I2C master: SEN/RSEN/PEN/RCEN/ACKEN and I2CxTRN writes are carried
+//      out by nvmsim_Poll() which then calls the nvm interrupt routine
+//    - the 24LC64: 8K bytes, 32 byte page buffer that wraps within the page,
+//      write cycle time after the stop bit during which the part does not
+//      acknowledge its address (ACK polling)
+//
+//  Power cut injection: nvmsim_CutPowerAt(n) cuts power at the nth data byte
+//  written from then on. The bytes of that page write received so far reach
+//  the array and the rest do not (a torn page). The part stays dead until
+//  nvmsim_Open() (nvm_Config) powers it up again with the array intact.
+//
+//  Time: a blocking wait in nvm.c calls nvmsim_Poll(1), which lets simulated
+//  bus and idle time advance the system ticks. TASK_nvm_Driver() calls
+//  nvmsim_Poll(0) and leaves the ticks to whatever drives them (socket_can.c).
+//
+//  nvmsim_RunPowerFailCheck() cuts power at every data byte of a journal save
+//  and of a full save, reboots each time and checks that validation comes up
+//  with the settings from before or after the save. It also logs the save
+//  throughput. It erases the simulated part, fills the event log and checks
+//  that the first boot, which takes new firmware, leaves the log alone. Run
+//  by host/ 'make check' (nvm).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _NVM_SIM_H_    // include only once
+#define _NVM_SIM_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ------------------------
+// I2C register stand-ins
+// ------------------------
+// only the registers nvm.c touches; nvm.c maps its _I2Cx names onto these
+
+typedef struct { uint16_t SEN:1;   uint16_t RSEN:1; uint16_t PEN:1;  uint16_t RCEN:1; uint16_t ACKEN:1;
+                 uint16_t ACKDT:1; uint16_t I2CEN:1; uint16_t A10M:1; uint16_t SCLREL:1;            } NVMSIM_I2CCON_t;
+typedef struct { uint16_t ACKSTAT:1;                                                              } NVMSIM_I2CSTAT_t;
+
+#define NVMSIM_TRN_EMPTY    (0xFFFF)    // nvmsim_TRN value when no byte is waiting to go out
+
+extern volatile NVMSIM_I2CCON_t   nvmsim_CONbits;
+extern volatile NVMSIM_I2CSTAT_t  nvmsim_STATbits;
+extern volatile uint16_t          nvmsim_TRN;
+extern volatile uint16_t          nvmsim_RCV;
+extern volatile uint16_t          nvmsim_BRG;
+extern volatile uint16_t          nvmsim_ADD;
+extern volatile uint16_t          nvmsim_IF;
+extern volatile uint16_t          nvmsim_IE;
+extern volatile uint16_t          nvmsim_MD;
+
+// --------------------
+// Function Prototyping
+// --------------------
+void    _MI2CSimInterrupt(void);            // nvm.c interrupt routine
+void    nvmsim_Open(void);                  // power up; the array keeps its contents
+void    nvmsim_Poll(uint8_t advance);       // carry out bus actions; advance=1 lets time pass
+void    nvmsim_Erase(void);                 // array to 0xFF
+void    nvmsim_CutPowerAt(uint16_t nbytes); // cut power at the nth data byte from now; 0=never
+int16_t nvmsim_RunPowerFailCheck(void);     // returns number of failures
+
+#endif // __linux__
+
+#endif  //  _NVM_SIM_H_
+
+// <><><><><><><><><><><><><> nvm_sim.h <><><><><><><><><><><><><><><><><><><><><><>
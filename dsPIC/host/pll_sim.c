@@ -0,0 +1,167 @@
+// <><><><><><><><><><><><><> pll_sim.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host check of the line PLL (see pll_sim.h)
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "pll.h"
+#include "pll_sim.h"
+#include "sine_table.h"
+#include <math.h>
+
+// ---------
+// constants
+// ---------
+#define PSIM_VPK            (PSIM_VRMS * 1.41421356)
+#define PSIM_TWO_PI         (6.28318530718)
+#define PSIM_DDS_RAD(ph)    ((double)(ph) * (PSIM_TWO_PI / 4294967296.0))
+#define PSIM_MSEC(ticks)    ((double)(ticks) * 1000.0 / FPWM)
+
+// ----------
+// data types
+// ----------
+typedef struct
+{
+    const char* name;
+    double      hz;
+    double      huntHz;     // +/- at 0.2 Hz
+    uint8_t     noisy;      // noise and spikes
+} PSIM_LINE_t;
+
+// ----------
+// local data
+// ----------
+static const PSIM_LINE_t s_lines[] =
+{
+    { "60 Hz",         60.0, 0.0,          0 },
+    { "50 Hz",         50.0, 0.0,          0 },
+    { "60 Hz noisy",   60.0, 0.0,          1 },
+    { "50 Hz noisy",   50.0, 0.0,          1 },
+    { "60 Hz hunting", 60.0, PSIM_HUNT_HZ, 1 },
+    { "50 Hz hunting", 50.0, PSIM_HUNT_HZ, 1 },
+};
+#define PSIM_NUM_LINES  (sizeof(s_lines)/sizeof(s_lines[0]))
+
+static uint32_t s_rand = 1;
+
+// ------------------------------------------------------------------------------------
+// as the charger ISR: drives while locked and not in a dropout
+static uint8_t psim_Driving(void)
+{
+    return(pll_IsLocked() && !g_pll.dropout);
+}
+
+// ------------------------------------------------------------------------------------
+// the a/c sense sample for the line at phase, or no line
+static void psim_Sample(const PSIM_LINE_t* line, double phase, uint8_t on, uint32_t tick)
+{
+    double  v = on ? PSIM_VPK * sin(phase) * VAC_SLOPE : 0.0;
+    int16_t noise = 0;
+
+    if (line->noisy)
+    {
+        s_rand = s_rand * 1103515245 + 12345;
+        noise  = (int16_t)((s_rand >> 16) % (2*PSIM_NOISE + 1)) - PSIM_NOISE;
+        if (0 == (tick % PSIM_SPIKE_TICKS)) noise += (s_rand & 0x100) ? PSIM_SPIKE : -PSIM_SPIKE;
+    }
+    An.Status.VAC.raw_val = VAC_ZERO_CROSS_A2D + (int16_t)floor(v + 0.5) + noise;
+}
+
+// ------------------------------------------------------------------------------------
+// one line; returns 1 on failure
+static int16_t psim_Line(const PSIM_LINE_t* line)
+{
+    const uint32_t onTicks  = (uint32_t)PSIM_RUN_SEC * FPWM;
+    const uint32_t offTicks = (uint32_t)(((uint64_t)PSIM_OFF_MSEC * FPWM) / 1000);
+    double   phase = 1.0;   // radians; not at a zero-crossing
+    double   hz, err, maxErr = 0.0;
+    uint32_t tick, half;
+    int32_t  lockTick = -1, stopTick = -1, relockTick = -1;
+    uint32_t unlocks = 0, wrongHalf = 0;
+    uint8_t  on, driving, wasDriving = 0;
+    int16_t  fail = 0;
+
+    pll_Reset();
+    An.AvgValid = 0;
+
+    for (tick = 0; tick < 2*onTicks + offTicks; tick++)
+    {
+        on = (tick < onTicks) || (tick >= onTicks + offTicks);
+        psim_Sample(line, phase, on, tick);
+        pll_Isr();
+
+        driving = psim_Driving();
+        if (tick < onTicks)
+        {
+            if (driving && (lockTick < 0)) lockTick = (int32_t)tick;
+            if (wasDriving && !driving) unlocks++;
+        }
+        else if (tick < onTicks + offTicks)
+        {
+            if (!driving && (stopTick < 0)) stopTick = (int32_t)(tick - onTicks);
+        }
+        else
+        {
+            if (driving && (relockTick < 0)) relockTick = (int32_t)(tick - onTicks - offTicks);
+            if (wasDriving && !driving) unlocks++;
+        }
+        wasDriving = driving;
+
+        if (driving && on)
+        {
+            err = fabs(remainder(PSIM_DDS_RAD(pll_Phase()) - phase, PSIM_TWO_PI)) * (360.0 / PSIM_TWO_PI);
+            if (err > maxErr) maxErr = err;
+
+            // the charger drives outside PLL_ZC_GUARD of the oscillator's crossings
+            half = pll_Phase() & (DDS_PHASE_HALF - 1);
+            if ((half >= PLL_ZC_GUARD) && (half <= DDS_PHASE_HALF - PLL_ZC_GUARD) &&
+                ((pll_Phase() < DDS_PHASE_HALF) != (sin(phase) > 0.0)))
+            {
+                wrongHalf++;
+            }
+        }
+
+        hz    = line->hz + line->huntHz * sin(PSIM_TWO_PI * 0.2 * tick / FPWM);
+        phase = fmod(phase + PSIM_TWO_PI * hz / FPWM, PSIM_TWO_PI);
+    }
+
+    if ((lockTick < 0) || (PSIM_MSEC(lockTick) > PSIM_MAX_LOCK_MSEC))    fail = 1;
+    if ((relockTick < 0) || (PSIM_MSEC(relockTick) > PSIM_MAX_LOCK_MSEC)) fail = 1;
+    if ((stopTick < 0) || (PSIM_MSEC(stopTick) > PSIM_MAX_STOP_MSEC))    fail = 1;
+    if (unlocks || wrongHalf || (maxErr > PSIM_MAX_ERR_DEG))              fail = 1;
+
+    LOG(SS_SYS, fail ? SV_ERR : SV_INFO,
+        "PSIM: %-13s lock %.0f ms, relock %.0f ms, err max %.1f deg, %lu unlocks, %lu wrong half, stop %.1f ms after the line",
+        line->name, PSIM_MSEC(lockTick), PSIM_MSEC(relockTick), maxErr,
+        (unsigned long)unlocks, (unsigned long)wrongHalf, PSIM_MSEC(stopTick));
+    return(fail);
+}
+
+// ------------------------------------------------------------------------------------
+int16_t psim_RunLockCheck(void)
+{
+    int16_t  nfail = 0;
+    uint16_t k;
+
+    for (k = 0; k < PSIM_NUM_LINES; k++)
+    {
+        nfail += psim_Line(&s_lines[k]);
+    }
+
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "PSIM: pll lock check %s", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> pll_sim.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,57 @@
+// <><><><><><><><><><><><><> pll_sim.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host check of the line PLL, as the charger uses it
+//
+//  Runs pll.c on a synthetic a/c sense (VacRaw) every PWM period: 50 and
+//  60 Hz lines, clean, with noise and spikes, and a generator hunting
+//  +/- PSIM_HUNT_HZ at 0.2 Hz. Each line runs PSIM_RUN_SEC, goes away for
+//  PSIM_OFF_MSEC and comes back. Against the line, with the charger's
+//  condition for driving (locked, no dropout) it logs:
+//    - the time to lock, and to lock again when the line comes back;
+//    - the largest phase error while locked;
+//    - unlocks and dropouts while the line is there;
+//    - PWM periods the charger would drive in the wrong half-cycle: the
+//      line of the other polarity, more than PLL_ZC_GUARD from the
+//      oscillator's zero-crossings (see charger_isr.c);
+//    - the time from the line going to the charger stopping.
+//  Returns the number of failures. Run by host/ 'make check' (pll).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _PLL_SIM_H_    // include only once
+#define _PLL_SIM_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ---------
+// constants
+// ---------
+#define PSIM_VRMS           (120.0)
+#define PSIM_NOISE          (40)    // +/- a/d counts on the noisy lines
+#define PSIM_SPIKE          (300)   // a/d counts, every PSIM_SPIKE_TICKS on the noisy lines
+#define PSIM_SPIKE_TICKS    (977)
+#define PSIM_HUNT_HZ        (1.5)
+#define PSIM_RUN_SEC        (10)
+#define PSIM_OFF_MSEC       (200)
+#define PSIM_MAX_LOCK_MSEC  (1000)  // limits for a pass
+#define PSIM_MAX_STOP_MSEC  (20)
+#define PSIM_MAX_ERR_DEG    (5.0)
+
+// --------------------
+// Function Prototyping
+// --------------------
+int16_t psim_RunLockCheck(void);    // returns number of failures
+
+#endif // __linux__
+
+#endif  //  _PLL_SIM_H_
+
+// <><><><><><><><><><><><><> pll_sim.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,114 @@
+// <><><><><><><><><><><><><> sine_table_sim.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host check of the DDS sine table index (see sine_table_sim.h)
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "sine_table.h"
+#include "sine_table_sim.h"
+#include <string.h>
+
+// ----------
+// local data
+// ----------
+static uint16_t s_visits[MAX_SINE];
+
+// ------------------------------------------------------------------------------------
+// dds_Position() against the 64 bit product; returns number of mismatches
+static int16_t stsim_PositionCheck(void)
+{
+    uint32_t phase = 0;
+    uint32_t k;
+    uint64_t want;
+    int16_t  nfail = 0;
+
+    for (k = 0; k < 100000; k++)
+    {
+        want = (((uint64_t)(phase & 0x7FFFFFFF)) * MAX_SINE) >> 15;
+        if (dds_Position(phase) != (uint32_t)want)
+        {
+            if (nfail < 4)
+            {
+                LOG(SS_SYS, SV_ERR, "STSIM: phase %08X: position %08X, not %08X",
+                    phase, dds_Position(phase), (uint32_t)want);
+            }
+            nfail++;
+        }
+        phase = phase * 1664525 + 1013904223;   // spread over the whole range
+    }
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "STSIM: position: %d mismatches in %lu phases", nfail, (unsigned long)k);
+    return(nfail ? 1 : 0);
+}
+
+// ------------------------------------------------------------------------------------
+// visits to each entry per half-cycle, at step, from phase; each must be in
+// [lo, hi]. Returns 1 on failure
+static int16_t stsim_VisitCheck(const char* name, uint32_t step, uint32_t phase, uint16_t lo, uint16_t hi)
+{
+    DDS_t    dds;
+    uint32_t n, halves = 0, bad = 0;
+    uint16_t i, vmin = 0xFFFF, vmax = 0;
+    int16_t  index;
+    uint8_t  started = 0;
+
+    dds.phase = phase;
+    dds.step  = step;
+    memset(s_visits, 0, sizeof(s_visits));
+
+    for (n = 0; n < (uint32_t)STSIM_CYCLES * (FPWM / 45); n++)
+    {
+        (void)dds_Sample(&dds, &index);
+        s_visits[index]++;
+        if (dds_Advance(&dds) & DDS_EV_HALF)
+        {
+            if (started)    // whole half-cycles only
+            {
+                for (i = 0; i < MAX_SINE; i++)
+                {
+                    if (s_visits[i] < vmin) vmin = s_visits[i];
+                    if (s_visits[i] > vmax) vmax = s_visits[i];
+                    if ((s_visits[i] < lo) || (s_visits[i] > hi)) bad++;
+                }
+                halves++;
+                if (halves >= 2 * STSIM_CYCLES) break;
+            }
+            started = 1;
+            memset(s_visits, 0, sizeof(s_visits));
+        }
+    }
+
+    LOG(SS_SYS, bad ? SV_ERR : SV_INFO, "STSIM: %s from %08X: %lu half-cycles, %u..%u visits per entry, %lu out of %u..%u",
+        name, phase, (unsigned long)halves, vmin, vmax, (unsigned long)bad, lo, hi);
+    return(bad ? 1 : 0);
+}
+
+// ------------------------------------------------------------------------------------
+int16_t stsim_RunIndexCheck(void)
+{
+    static const uint32_t starts[] = { 0, DDS_STEP_HZ(60) / 3, DDS_STEP_HZ(60) / 2, DDS_PHASE_QUARTER + 12345 };
+    int16_t  nfail = 0;
+    uint16_t k;
+
+    nfail += stsim_PositionCheck();
+    for (k = 0; k < sizeof(starts)/sizeof(starts[0]); k++)
+    {
+        nfail += stsim_VisitCheck("60 Hz", DDS_STEP_HZ(60), starts[k], 1, 1);
+        nfail += stsim_VisitCheck("50 Hz", DDS_STEP_HZ(50), starts[k], 1, 2);
+    }
+
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "STSIM: sine index check %s", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> sine_table_sim.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,43 @@
+// <><><><><><><><><><><><><> sine_table_sim.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host check of the DDS sine table index
+//
+//  Checks dds_Position() against ((phase & 0x7FFFFFFF) * MAX_SINE) >> 15
+//  done in 64 bits over a spread of phases, then advances the DDS through
+//  STSIM_CYCLES a/c cycles from a few starting phases and counts the
+//  visits dds_Sample() makes to each table entry in each half-cycle:
+//    - 60 Hz: every entry exactly once;
+//    - 50 Hz: every entry once or twice.
+//  Logs the counts and returns the number of failures. Run by host/
+//  'make check' (dds).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SINE_TABLE_SIM_H_    // include only once
+#define _SINE_TABLE_SIM_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ---------
+// constants
+// ---------
+#define STSIM_CYCLES        (600)       // a/c cycles from each starting phase
+
+// --------------------
+// Function Prototyping
+// --------------------
+int16_t stsim_RunIndexCheck(void);      // returns number of failures
+
+#endif // __linux__
+
+#endif  //  _SINE_TABLE_SIM_H_
+
+// <><><><><><><><><><><><><> sine_table_sim.h <><><><><><><><><><><><><><><><><><><><><><>
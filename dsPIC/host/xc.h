@@ -0,0 +1,39 @@
+// <><><><><><><><><><><><><> xc.h (host) <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host stand-in for the XC16 device header
+//
+//  Only what the sources built by host/Makefile use outside of their
+//  #ifdef __linux__ code. The register stand-ins a simulator needs are in
+//  that simulator's header (nvm_sim.h, socket_can.h) and must not be here,
+//  except for registers a firmware source reads directly: those are
+//  declared here and set by the stand-in that owns them.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _HOST_XC_H_    // include only once
+#define _HOST_XC_H_
+
+#ifndef __linux__
+  #error host/xc.h is for the Linux host build only
+#endif
+
+// program space qualifier; data lives in ram on the host
+#define __prog__
+
+// no interrupts to hold off; single threaded
+#define SET_AND_SAVE_CPU_IPL(save_to, ipl)  ((save_to) = 0)
+#define RESTORE_CPU_IPL(saved_to)           ((void)(saved_to))
+
+#define Nop()       ((void)0)
+#define ClrWdt()    ((void)0)
+
+// PWM duty; telemetry.c samples them, host_can_state.c sets them
+extern volatile unsigned int PDC1;
+extern volatile unsigned int PDC2;
+
+#endif  //  _HOST_XC_H_
+
+// <><><><><><><><><><><><><> xc.h (host) <><><><><><><><><><><><><><><><><><><><><><>
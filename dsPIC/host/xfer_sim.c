@@ -0,0 +1,305 @@
+// <><><><><><><><><><><><><> xfer_sim.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host a/c line, relay and inverter simulator for the fast transfer
+//  (see xfer_sim.h)
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "inverter.h"
+#include "lpc_cfg.h"
+#include "pll.h"
+#include "sine_table.h"
+#include "xfer.h"
+#include "xfer_sim.h"
+#include <math.h>
+
+// ---------
+// constants
+// ---------
+#define XSIM_VPK            (XSIM_VRMS * 1.41421356)
+#define XSIM_TWO_PI         (6.28318530718)
+#define XSIM_RUN_MSEC       (200)           // give up on a transfer to the inverter
+#define XSIM_DDS_RAD(ph)    ((double)(ph) * (XSIM_TWO_PI / 4294967296.0))
+
+// ----------
+// local data
+// ----------
+static double   s_linePhase;    // radians; runs on while the line is off
+static double   s_lineHz;
+static uint8_t  s_lineOn;
+static uint8_t  s_optoOn;       // 0=line phase input stuck off
+static uint8_t  s_relay;        // 1=contacts closed
+static uint8_t  s_invOn;
+static DDS_t    s_inv;          // inverter output
+static uint32_t s_ticks;        // PWM periods
+static uint32_t s_msec;         // main control ticks
+static uint32_t s_rand = 1;
+
+// ------------------------------------------------------------------------------------
+// the line phase input; on for the positive half-cycle
+uint8_t xsim_LinePhase(void)
+{
+    return(s_optoOn && s_lineOn && (XSIM_VPK * sin(s_linePhase) > XSIM_OPTO_VOLTS));
+}
+
+// ------------------------------------------------------------------------------------
+// as inv_SetFreqTrim()
+void xsim_SetFreqTrim(int16_t trim_mhz)
+{
+    if (trim_mhz >  INV_FREQ_TRIM_MAX_MHZ) trim_mhz =  INV_FREQ_TRIM_MAX_MHZ;
+    if (trim_mhz < -INV_FREQ_TRIM_MAX_MHZ) trim_mhz = -INV_FREQ_TRIM_MAX_MHZ;
+    s_inv.step = DDS_STEP_HZ(OPTION_AC_OUT_HZ) + ((int32_t)trim_mhz * (int32_t)DDS_STEP_HZ(1)) / 1000;
+}
+
+// ------------------------------------------------------------------------------------
+// the inverter output; the line reference while xfer.c syncs
+const DDS_t* xsim_OutputDds(void)
+{
+    return(&s_inv);
+}
+
+// ------------------------------------------------------------------------------------
+// output phase less line phase; degrees -180..180
+static double xsim_PhaseDiffDeg(void)
+{
+    return(remainder(XSIM_DDS_RAD(s_inv.phase) - s_linePhase, XSIM_TWO_PI) * (360.0 / XSIM_TWO_PI));
+}
+
+// ------------------------------------------------------------------------------------
+// one PWM period
+static void xsim_Tick(void)
+{
+    double  v;
+    int16_t noise;
+
+    if (s_relay)
+        v = s_lineOn ? XSIM_VPK * sin(s_linePhase) : 0.0;
+    else
+        v = s_invOn ? XSIM_VPK * sin(XSIM_DDS_RAD(s_inv.phase)) : 0.0;
+
+    s_rand = s_rand * 1103515245 + 12345;
+    noise  = (int16_t)((s_rand >> 16) % (2*XSIM_NOISE + 1)) - XSIM_NOISE;
+    An.Status.VAC.raw_val = VAC_ZERO_CROSS_A2D + (int16_t)floor(v * VAC_SLOPE + 0.5) + noise;
+
+    pll_Isr();
+
+    if (s_invOn) dds_Advance(&s_inv);
+    s_linePhase = fmod(s_linePhase + XSIM_TWO_PI * s_lineHz / FPWM, XSIM_TWO_PI);
+    s_ticks++;
+}
+
+// ------------------------------------------------------------------------------------
+// PWM periods up to the next main control tick
+static void xsim_Msec(void)
+{
+    s_msec++;
+    while ((uint64_t)s_ticks * 1000 < (uint64_t)s_msec * FPWM) xsim_Tick();
+}
+
+// ------------------------------------------------------------------------------------
+static void xsim_Reset(double lineHz, uint8_t lineOn, uint8_t relay, uint8_t invOn)
+{
+    pll_Reset();
+    An.AvgValid  = 0;
+    s_linePhase  = 0.0;
+    s_lineHz     = lineHz;
+    s_lineOn     = lineOn;
+    s_optoOn     = 1;
+    s_relay      = relay;
+    s_invOn      = invOn;
+    s_inv.phase  = 0;
+    xsim_SetFreqTrim(0);
+}
+
+// ------------------------------------------------------------------------------------
+// line drops at lossDeg into its cycle with the relay closed. Returns 0=ok,
+// gets the dead time, the output phase step against the line and the start
+// amplitude against the line's.
+static int16_t xsim_LineLoss(double lineHz, double lossDeg, double* gapMsec, double* stepDeg, double* ampPct)
+{
+    uint32_t lossTicks;
+    int16_t  timer = 0;
+    int16_t  n;
+
+    xsim_Reset(lineHz, 1, 1, 0);
+    for (n = 0; n < XSIM_SETTLE_MSEC; n++)
+    {
+        xsim_Msec();
+        if (n > XSIM_SETTLE_MSEC/2 && (!pll_IsLocked() || xfer_LineLost()))
+        {
+            LOG(SS_SYS, SV_ERR, "SIM: %.1f Hz line not held, locked=%d dropout=%d", lineHz, g_pll.locked, g_pll.dropout);
+            return(1);
+        }
+    }
+
+    // to the loss point, a PWM period at a time
+    while (fabs(remainder(s_linePhase - lossDeg * (XSIM_TWO_PI / 360.0), XSIM_TWO_PI)) > XSIM_TWO_PI * s_lineHz / FPWM)
+    {
+        xsim_Tick();
+    }
+    s_lineOn  = 0;
+    lossTicks = s_ticks;
+
+    // MS_CHARGER, MS_XFER_TO_INV
+    for (n = 0; n < XSIM_RUN_MSEC; n++)
+    {
+        xsim_Msec();
+        if (s_relay)
+        {
+            if (xfer_LineLost())
+            {
+                s_relay = 0;
+                timer = XFER_RELAY_OPEN_DELAY_MSEC;
+            }
+        }
+        else if (--timer <= 0)
+        {
+            // TASK_inv_Driver() asks for INV_ISR_REQ_START a msec later
+            xsim_Msec();
+            s_inv.phase = pll_Phase();
+            s_invOn  = 1;
+            *gapMsec = (double)(s_ticks - lossTicks) * 1000.0 / FPWM;
+            *stepDeg = xsim_PhaseDiffDeg();
+            *ampPct  = 100.0 * ((double)xfer_LineAmp() / XFER_AMP(XSIM_VRMS) - 1.0);
+            return(0);
+        }
+    }
+    LOG(SS_SYS, SV_ERR, "SIM: %.1f Hz line lost at %.0f deg not seen", lineHz, lossDeg);
+    return(1);
+}
+
+// ------------------------------------------------------------------------------------
+// line comes back offsetDeg ahead of the inverter output. Returns 0=ok, gets
+// the time to get in step and the phase error when the contacts close.
+static int16_t xsim_LineReturn(double lineHz, double offsetDeg, uint8_t opto, uint32_t* syncMsec, double* closeDeg)
+{
+    int16_t timer = 0;
+    int8_t  result;
+    int16_t n;
+
+    xsim_Reset(lineHz, 0, 0, 1);
+    for (n = 0; n < XSIM_SETTLE_MSEC; n++) xsim_Msec();
+
+    s_linePhase = fmod(XSIM_DDS_RAD(s_inv.phase) + offsetDeg * (XSIM_TWO_PI / 360.0), XSIM_TWO_PI);
+    s_lineOn = 1;
+    s_optoOn = opto;
+
+    // MS_XFER_SYNC, MS_XFER_TO_LINE
+    xfer_SyncStart();
+    for (n = 0; n < XFER_SYNC_TIMEOUT_MSEC + 100; n++)
+    {
+        xsim_Msec();
+        if (timer)
+        {
+            if (--timer <= 0)
+            {
+                s_relay   = 1;
+                *closeDeg = xsim_PhaseDiffDeg();
+                s_invOn   = 0;
+                xfer_SyncStop();
+                return(0);
+            }
+            continue;
+        }
+        result = xfer_SyncPoll();
+        if (XFER_SYNC_DONE == result)
+        {
+            *syncMsec = n + 1;
+            timer = RELAY_CLOSE_DELAY_MSEC;
+        }
+        else if (XFER_SYNC_FAIL == result)
+        {
+            *syncMsec = n + 1;
+            xfer_SyncStop();
+            return(1);
+        }
+    }
+    return(1);
+}
+
+// ------------------------------------------------------------------------------------
+int16_t xsim_RunTransferCheck(void)
+{
+    static const double lineHz[] = { 59.5, 60.0, 60.5 };
+    int16_t  nfail = 0;
+    uint16_t i, k, ncase;
+    double   gap, step, amp, ampMax, gapMax, gapSum, stepMax, closeDeg, closeMax;
+    uint32_t syncMsec, syncMax, syncSum;
+
+    for (i = 0; i < sizeof(lineHz)/sizeof(lineHz[0]); i++)
+    {
+        // line to inverter
+        gapMax = 0; gapSum = 0; stepMax = 0; ampMax = 0; ncase = 0;
+        for (k = 0; k < 360; k += 15)
+        {
+            if (xsim_LineLoss(lineHz[i], (double)k, &gap, &step, &amp))
+            {
+                nfail++;
+                continue;
+            }
+            if (gap > gapMax) gapMax = gap;
+            if (fabs(step) > stepMax) stepMax = fabs(step);
+            if (fabs(amp) > ampMax) ampMax = fabs(amp);
+            gapSum += gap;
+            ncase++;
+            if (gap > 1000.0 / lineHz[i] || fabs(step) > XSIM_MAX_STEP_DEG || fabs(amp) > XSIM_MAX_AMP_PCT)
+            {
+                LOG(SS_SYS, SV_ERR, "SIM: %.1f Hz line lost at %u deg: %.1f msec, %.1f deg, amplitude %+.1f%%", lineHz[i], k, gap, step, amp);
+                nfail++;
+            }
+        }
+        LOG(SS_SYS, SV_INFO, "SIM: %.1f Hz line to inverter: dead %.1f msec mean, %.1f max; phase step %.1f deg max; amplitude %.1f%% max",
+            lineHz[i], ncase ? gapSum / ncase : 0.0, gapMax, stepMax, ampMax);
+
+        // inverter to line
+        syncMax = 0; syncSum = 0; closeMax = 0; ncase = 0;
+        for (k = 0; k < 360; k += 30)
+        {
+            if (xsim_LineReturn(lineHz[i], (double)k, 1, &syncMsec, &closeDeg))
+            {
+                LOG(SS_SYS, SV_ERR, "SIM: %.1f Hz line back at %u deg not in step after %lu msec", lineHz[i], k, (unsigned long)syncMsec);
+                nfail++;
+                continue;
+            }
+            if (syncMsec > syncMax) syncMax = syncMsec;
+            if (fabs(closeDeg) > closeMax) closeMax = fabs(closeDeg);
+            syncSum += syncMsec;
+            ncase++;
+            if (fabs(closeDeg) > XSIM_MAX_CLOSE_DEG)
+            {
+                LOG(SS_SYS, SV_ERR, "SIM: %.1f Hz line back at %u deg: closed %.1f deg out", lineHz[i], k, closeDeg);
+                nfail++;
+            }
+        }
+        LOG(SS_SYS, SV_INFO, "SIM: %.1f Hz inverter to line: in step %lu msec mean, %lu max; relay closed %.1f deg out max",
+            lineHz[i], ncase ? (unsigned long)(syncSum / ncase) : 0UL, (unsigned long)syncMax, closeMax);
+    }
+
+    // no line phase input; must give up, not close out of step
+    if (!xsim_LineReturn(60.0, 90.0, 0, &syncMsec, &closeDeg))
+    {
+        LOG(SS_SYS, SV_ERR, "SIM: closed without the line phase input");
+        nfail++;
+    }
+    else
+    {
+        LOG(SS_SYS, SV_INFO, "SIM: no line phase input, gave up after %lu msec", (unsigned long)syncMsec);
+    }
+
+    LOG(SS_SYS, nfail ? SV_ERR : SV_INFO, "SIM: transfer check %s", nfail ? "FAILED" : "PASSED");
+    return(nfail);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> xfer_sim.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,64 @@
+// <><><><><><><><><><><><><> xfer_sim.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host a/c line, relay and inverter simulator for the fast transfer
+//
+//  Stands in for the power stage so pll.c and xfer.c run unchanged on a PC.
+//  Every PWM period it makes the a/c sense sample (VacRaw) from the line
+//  while the relay is closed and from the inverter output while it is open,
+//  sets the line phase input from the line, and calls pll_Isr(). The
+//  inverter output is a DDS stepped like _InvDds in inverter.c; it starts
+//  at the PLL phase like INV_ISR_REQ_START, and is the line reference while
+//  xfer.c syncs (xsim_OutputDds()).
+//
+//  xsim_RunTransferCheck() plays the main control states of task_main.c
+//  every msec:
+//    - drops the line at phases around the cycle and logs the time the
+//      output is dead (line gone to inverter on), which must be under a
+//      line cycle, and the phase step of the output against where the line
+//      would have been, and checks the start amplitude (xfer_LineAmp()) is
+//      the line's;
+//    - brings the line back off frequency and out of phase and logs the time
+//      to get in step and the phase error when the relay contacts close;
+//    - checks a transfer without the line phase input gives up.
+//  It returns the number of failures. Run by host/ 'make check' (xfer).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _XFER_SIM_H_    // include only once
+#define _XFER_SIM_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "sine_table.h"
+
+// ---------
+// constants
+// ---------
+#define XSIM_VRMS               (120.0) // line and inverter output
+#define XSIM_NOISE              (4)     // +/- a/d counts on the a/c sense
+#define XSIM_OPTO_VOLTS         (10.0)  // line phase input is on above
+#define XSIM_SETTLE_MSEC        (1000)  // before each case
+#define XSIM_MAX_STEP_DEG       (10.0)  // limits for a pass; the dead time is under a line cycle
+#define XSIM_MAX_CLOSE_DEG      (6.0)
+#define XSIM_MAX_AMP_PCT        (3.0)
+
+// --------------------
+// Function Prototyping
+// --------------------
+uint8_t xsim_LinePhase(void);
+void    xsim_SetFreqTrim(int16_t trim_mhz);
+const DDS_t* xsim_OutputDds(void);
+int16_t xsim_RunTransferCheck(void);    // returns number of failures
+
+#endif // __linux__
+
+#endif  //  _XFER_SIM_H_
+
+// <><><><><><><><><><><><><> xfer_sim.h <><><><><><><><><><><><><><><><><><><><><><>
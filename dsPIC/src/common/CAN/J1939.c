@@ -49,6 +49,7 @@ void J1939_SetInvAddress(uint8_t address)
     g_J1939.MyInvAddress        = address;
     g_can.MyID = (g_can.MyID & 0xFFFFFF00) | address;   // LSB is CA address
     can_SetID(g_can.MyID);  // set the CAN hardware address
+    rvcan_BroadcastReset(); // announce all status from the new address
 }
 
 // ----------------------------------------------------------------------
@@ -61,6 +62,15 @@ void J1939_SetDGN(CAN_MSG* msg, CAN_DGN dgn)
     msg->jid.Priority      = g_J1939.TxPriority;
 }
 
+// ----------------------------------------------------------------------
+// build 29 bit transmit id for DGN from our address and priority
+static CAN_ID J1939_TxID(CAN_DGN dgn)
+{
+    return(((CAN_ID)(g_J1939.TxPriority & 0x7) << 26) |
+           ((CAN_ID)(dgn & 0x1FFFF) << 8) |
+           g_J1939.MyInvAddress);
+}
+
 // ----------------------------------------------------------------------
 // CompareName for determining address priority
 // 
@@ -258,56 +268,127 @@ void J1939_SendAddressClaimed()
 }
 
 // ----------------------------------------------------------------------
-// returns 0=ok, 1=too many bytes
+// queue the broadcast announce (BAM) that starts a multi-packet transfer
+// returns 0=ok, 2=tx queue is full
+static int J1939_TxBamAnnounce(CAN_DGN dgn, uint16_t dataLen, int npackets)
+{
+	CAN_DMA*  frm;
+	CAN_DATA* pd;
+
+    if ((frm = can_TxAlloc()) == 0) return(2);
+    can_FrmSetExtID(frm, J1939_TxID(J1939_DGN_INITIAL_MULTI_PACKET), 8);
+    pd = can_FrmData(frm);
+	pd[0] = 0x20;  // per spec
+	pd[1] = (uint8_t)(dataLen   );  // LSB
+	pd[2] = (uint8_t)(dataLen>>8);  // MSB
+	pd[3] = (uint8_t)npackets;
+	pd[4] = 0;
+	pd[5] = (uint8_t)(dgn      );   // LSB
+	pd[6] = (uint8_t)(dgn >>  8);
+	pd[7] = (uint8_t)(dgn >> 16);   // MSB
+    can_TxCommit();
+    return(0);
+}
+
+// ----------------------------------------------------------------------
+// queue data packet n (1 based) of a multi-packet transfer; last one may be partial
+// returns 0=ok, 2=tx queue is full
+static int J1939_TxBamPacket(int n, uint16_t dataLen, CAN_DATA* data)
+{
+	CAN_DMA*  frm;
+	CAN_DATA* pd;
+    int i, nleft;
+
+    if ((frm = can_TxAlloc()) == 0) return(2);
+    i = (n-1) * J1939_TP_PACKET_BYTES;
+    nleft = dataLen - i;
+    if (nleft > J1939_TP_PACKET_BYTES) nleft = J1939_TP_PACKET_BYTES;
+    can_FrmSetExtID(frm, J1939_TxID(J1939_DGN_SUBSEQUENT_MULTI_PACKET), 8);
+    pd = can_FrmData(frm);
+	pd[0] = (uint8_t)n;
+    memset(&pd[1], 0xFF, J1939_TP_PACKET_BYTES);    // pad unused bytes per spec
+	memcpy(&pd[1], &data[i], nleft);	            // copy the data bytes
+	can_TxCommit();
+    return(0);
+}
+
+// ----------------------------------------------------------------------
+// queues the whole transfer at once, or nothing if the transmit queue
+// cannot take all of it; a BAM cut short would leave the receiver waiting
+// returns 0=ok, 1=too many bytes, 2=tx queue is full
 int J1939_SendMultiPacketMessage(CAN_DGN dgn, uint16_t dataLen, CAN_DATA* data)
 {
-    const int PACKET_BYTES = 7; // maximum bytes per multipacket
-	CAN_MSG can;
-    int i, n, npackets, nfullpackets, nleft;
+    int n, npackets;
 
     if (dataLen < 1) return(0);     // nothing to send
-	if (dataLen > 1785) return(1);	// per spec
+	if (dataLen > J1939_TP_MAX_BYTES) return(1);	// per spec
 
     LOG(SS_J1939, SV_INFO, "TxMultipacket DGN=%lX n=%u", dgn, dataLen);
 
-    // generate initial packet
-    nleft = dataLen;
-    npackets = (dataLen + (PACKET_BYTES-1))/PACKET_BYTES;
-
-    J1939_InitMsg(&can);
-    J1939_SetDGN(&can, J1939_DGN_INITIAL_MULTI_PACKET);
-	can.dataLength = 8;
-	can.data[0]    = 0x20;  // per spec
-	can.data[1]    = (uint8_t)(dataLen   );  // LSB
-	can.data[2]    = (uint8_t)(dataLen>>8);  // MSB
-	can.data[3]    = (uint8_t)npackets;
-	can.data[5]    = (uint8_t)(dgn      );   // LSB
-	can.data[6]    = (uint8_t)(dgn >>  8);
-	can.data[7]    = (uint8_t)(dgn >> 16);   // MSB
-    // transmit initial packet
-   	can_TxEnqueue(&can);
-
-    // subsequent full packets
-    nfullpackets = dataLen/PACKET_BYTES;
-    J1939_SetDGN(&can, J1939_DGN_SUBSEQUENT_MULTI_PACKET);
-    i = 0;
-    for (n=1; n<=nfullpackets; n++, i+=PACKET_BYTES)
+    npackets = (dataLen + (J1939_TP_PACKET_BYTES-1))/J1939_TP_PACKET_BYTES;
+
+    // the queue only drains from here on, so what fits now still fits
+    if (can_TxQueueFree() < npackets + 1)
+    {
+        LOG(SS_J1939, SV_WARN, "TxMultipacket DGN=%lX no room for %d frames", dgn, npackets + 1);
+        g_can.rvcTxFramesDropped += npackets + 1;
+        return(2);
+    }
+    if (J1939_TxBamAnnounce(dgn, dataLen, npackets)) return(2);
+    for (n=1; n<=npackets; n++)
     {
-    	can.data[0] = (char)n;
-    	memcpy(&can.data[1], &data[i], PACKET_BYTES);	// copy the data bytes
-    	can_TxEnqueue(&can);
+        if (J1939_TxBamPacket(n, dataLen, data)) return(2);
     }
+    return(0);
+}
 
-    // remaining partial packet (if any)
-    if (npackets == nfullpackets) return(0);
-   	can.data[0] = (char)npackets;
-    n = dataLen - (nfullpackets*PACKET_BYTES);   // remaining bytes
-   	memcpy(&can.data[1], &data[i], n);
-   	can_TxEnqueue(&can);
+// ----------------------------------------------------------------------
+// start a multi-packet transfer of any length that J1939_MultiPacketPoll()
+// feeds to the transmit queue as it drains. data must stay put until
+// J1939_IsMultiPacketBusy() returns 0.
+// returns 0=ok, 1=too many bytes, 2=previous transfer still going out
+int J1939_StartMultiPacket(CAN_DGN dgn, uint16_t dataLen, CAN_DATA* data)
+{
+    if (g_J1939.mpPackets) return(2);   // busy
+    if (dataLen < 1) return(0);         // nothing to send
+	if (dataLen > J1939_TP_MAX_BYTES) return(1);	// per spec
 
+    LOG(SS_J1939, SV_INFO, "TxMultipacket paced DGN=%lX n=%u", dgn, dataLen);
+
+    g_J1939.mpDgn  = dgn;
+    g_J1939.mpData = data;
+    g_J1939.mpLen  = dataLen;
+    g_J1939.mpNext = 0;     // announce goes first
+    g_J1939.mpPackets = (uint8_t)((dataLen + (J1939_TP_PACKET_BYTES-1))/J1939_TP_PACKET_BYTES);  // last; arms the poll
     return(0);
 }
 
+// ----------------------------------------------------------------------
+// 0=idle, 1=a paced multi-packet transfer is going out
+int J1939_IsMultiPacketBusy(void)
+{
+    return(g_J1939.mpPackets ? 1 : 0);
+}
+
+// ----------------------------------------------------------------------
+// send the paced multi-packet transfer as fast as the transmit queue takes it
+// called from the can task
+void J1939_MultiPacketPoll(void)
+{
+    while (g_J1939.mpPackets && can_TxQueueFree() > J1939_TP_TX_RESERVE)
+    {
+        if (g_J1939.mpNext == 0)
+            J1939_TxBamAnnounce(g_J1939.mpDgn, g_J1939.mpLen, g_J1939.mpPackets);
+        else
+            J1939_TxBamPacket(g_J1939.mpNext, g_J1939.mpLen, g_J1939.mpData);
+
+        if (++g_J1939.mpNext > g_J1939.mpPackets)
+        {
+            g_J1939.mpPackets = 0;  // done; caller may reuse data
+        }
+    }
+}
+
 // ----------------------------------------------------------------------
 // set transmit priority; priority used when transmitting CAN message
 void J1939_SetPriority(uint8_t priority)
@@ -317,16 +398,20 @@ void J1939_SetPriority(uint8_t priority)
 
 // ----------------------------------------------------------------------
 // base J1939 message sender
+// builds the frame in place in the transmit queue
 void J1939_SendMessage(CAN_DGN dgn, CAN_LEN dataLen, CAN_DATA* data)
 {
-	CAN_MSG can;
+	CAN_DMA* frm = can_TxAlloc();
 
+	if (frm == 0)   // tx queue is full
+	{
+		g_can.rvcTxFramesDropped++;
+		return;
+	}
 	if (dataLen > MAX_CAN_DATA) dataLen = MAX_CAN_DATA;	// dont crash buffer
-    J1939_InitMsg(&can);
-    J1939_SetDGN (&can, dgn);
-	can.dataLength = dataLen;
-	memcpy(can.data, data, dataLen); // copy the data bytes
-	can_TxEnqueue(&can);
+	can_FrmSetExtID(frm, J1939_TxID(dgn), dataLen);
+	memcpy(can_FrmData(frm), data, dataLen); // copy the data bytes
+	can_TxCommit();
 }
 
 // ----------------------------------------------------------------------
@@ -418,26 +503,123 @@ uint8_t J1939_ChgrAddress()
     return(g_J1939.MyChgrAddress);
 }
 
+// ----------------------------------------------------------------------
+// receive a multi-packet broadcast (BAM) of dgn into buf; one transfer
+// J1939_MultiPacketRxDone() returns its length once all packets are in.
+// a missing packet drops the transfer; the sender has to start over.
+// an announce that comes in before the caller arms again for the next
+// transfer is held and the transfer starts with the arm
+void J1939_ArmMultiPacketRx(CAN_DGN dgn, CAN_DATA* buf, uint16_t maxLen)
+{
+    g_J1939.rxArmed = 0;
+    g_J1939.rxNext  = 0;
+    g_J1939.rxDone  = 0;
+    if (dgn != g_J1939.rxDgn) g_J1939.rxHeld = 0;
+    g_J1939.rxDgn   = dgn;
+    g_J1939.rxBuf   = buf;
+    g_J1939.rxMax   = maxLen;
+    if (g_J1939.rxHeld && g_J1939.rxLen <= maxLen) g_J1939.rxNext = 1;
+    g_J1939.rxHeld  = 0;
+    g_J1939.rxArmed = 1;    // last
+}
+
+// ----------------------------------------------------------------------
+void J1939_DisarmMultiPacketRx(void)
+{
+    g_J1939.rxArmed = 0;
+    g_J1939.rxNext  = 0;
+    g_J1939.rxHeld  = 0;
+    g_J1939.rxDgn   = 0;
+}
+
+// ----------------------------------------------------------------------
+// bytes of the completed transfer; 0=none
+uint16_t J1939_MultiPacketRxDone(void)
+{
+    return(g_J1939.rxDone);
+}
+
+// ----------------------------------------------------------------------
+// announce for the armed DGN; starts a new transfer
+// returns: 0=not ours, 1=handled
+static int J1939_RxBamAnnounce(CAN_DMA* frm)
+{
+	CAN_DATA* data = can_FrmData(frm);
+    CAN_DGN   dgn;
+    uint16_t  len;
+
+    if (g_J1939.rxDgn == 0 || data[0] != J1939_BAM_CONTROL_BYTE) return(0);
+    dgn = ((CAN_DGN)data[7] << 16) | ((CAN_DGN)data[6] << 8) | data[5];
+    if (dgn != g_J1939.rxDgn) return(0);
+
+    len = MKWORD(data[1], data[2]);
+    if (len == 0 || data[3] != (len + (J1939_TP_PACKET_BYTES-1))/J1939_TP_PACKET_BYTES)
+    {
+        LOG(SS_J1939, SV_ERR, "RxMultipacket DGN=%lX n=%u rejected", dgn, len);
+        return(1);
+    }
+    g_J1939.rxLen     = len;
+    g_J1939.rxPackets = data[3];
+    g_J1939.rxSource  = can_FrmSource(frm);
+    if (g_J1939.rxArmed && len <= g_J1939.rxMax)
+        g_J1939.rxNext = 1;
+    else
+        g_J1939.rxHeld = 1;     // buffer still in use
+    return(1);
+}
+
+// ----------------------------------------------------------------------
+// data packet of the transfer in progress
+// returns: 0=not ours, 1=handled
+static int J1939_RxBamPacket(CAN_DMA* frm)
+{
+	CAN_DATA* data = can_FrmData(frm);
+    uint16_t  i, n;
+
+    if (!g_J1939.rxNext || can_FrmSource(frm) != g_J1939.rxSource) return(0);
+
+    if (data[0] != g_J1939.rxNext)
+    {
+        LOG(SS_J1939, SV_ERR, "RxMultipacket seq=%u expected=%u", data[0], g_J1939.rxNext);
+        g_J1939.rxNext = 0;     // drop; wait for the next announce
+        g_J1939.rxDropped++;
+        return(1);
+    }
+
+    i = (uint16_t)(g_J1939.rxNext-1) * J1939_TP_PACKET_BYTES;
+    n = (i >= g_J1939.rxLen) ? 0 : g_J1939.rxLen - i;
+    if (n > J1939_TP_PACKET_BYTES) n = J1939_TP_PACKET_BYTES;
+    memcpy(&g_J1939.rxBuf[i], &data[1], n);
+
+    if (++g_J1939.rxNext > g_J1939.rxPackets)
+    {
+        g_J1939.rxNext  = 0;
+        g_J1939.rxArmed = 0;    // one transfer; caller re-arms
+        g_J1939.rxDone  = g_J1939.rxLen;
+    }
+    return(1);
+}
+
 // ----------------------------------------------------------------------
 // check if CAN message is a J1939 house keeping message and process it
 // returns: 0=not for us, 1=dispatched
-int16_t J1939_Dispatcher(CAN_MSG* msg)
+int16_t J1939_Dispatcher(CAN_DMA* frm)
 {
 	int Loop;
 	int rc = 0;	// assume not handled
-	uint32_t dgn;
+	CAN_DATA* data = can_FrmData(frm);
 
     // must be extended message
-    if (msg->frameType != CAN_FRAME_EXT) return(0);
+    if (!can_FrmIsExtData(frm)) return(0);
 
-	dgn = can_DGN(msg);
-    switch( msg->jid.PDUFormat )
+    switch( can_FrmPF(frm) )
     {
     	case J1939_PF_TP_CONNECT_MGMT:
-    		if ((msg->data[0] == J1939_BAM_CONTROL_BYTE) &&
-    			(msg->data[5] == J1939_PGN0_COMMANDED_ADDRESS) &&
-    			(msg->data[6] == J1939_PGN1_COMMANDED_ADDRESS) &&
-    			(msg->data[7] == J1939_PGN2_COMMANDED_ADDRESS))
+            if (J1939_RxBamAnnounce(frm)) { rc = 1; break; }
+    		if ((data[0] == J1939_BAM_CONTROL_BYTE) &&
+    			(data[5] == J1939_PGN0_COMMANDED_ADDRESS) &&
+    			(data[6] == J1939_PGN1_COMMANDED_ADDRESS) &&
+    			(data[7] == J1939_PGN2_COMMANDED_ADDRESS))
     		{
                 LOG(SS_J1939, SV_INFO, "Rx:J1939_PF_TP_CONNECT_MGMT");
     			g_J1939.GettingCommandedAddress = 1;
@@ -448,11 +630,12 @@ int16_t J1939_Dispatcher(CAN_MSG* msg)
     		break;
     
     	case J1939_PF_TP_DATA_TRANSFER:
+            if (J1939_RxBamPacket(frm)) { rc = 1; break; }
     		if ((g_J1939.GettingCommandedAddress == 1) &&
     			(g_J1939.CommandedAddressSource == g_J1939.OneMessage.jid.SourceAddress))
     		{  
     			// Commanded Address Handling
-    			if ((!g_J1939.GotFirstDataPacket) && (msg->data[0] == 1))
+    			if ((!g_J1939.GotFirstDataPacket) && (data[0] == 1))
     			{
     				for (Loop=0; Loop<7; Loop++)
     				{
@@ -462,7 +645,7 @@ int16_t J1939_Dispatcher(CAN_MSG* msg)
                     rc = 1; // handled
                 	LOG(SS_J1939, SV_INFO, "rx DATA_TRANSFER 1st packet");
     			}
-    			else if ((g_J1939.GotFirstDataPacket) && (msg->data[0] == 2))
+    			else if ((g_J1939.GotFirstDataPacket) && (data[0] == 2))
     			{
     				g_J1939.CommandedAddressName[7] = g_J1939.OneMessage.data[1];
     				J1939_SetInvAddress(g_J1939.OneMessage.data[2]);
@@ -484,10 +667,10 @@ int16_t J1939_Dispatcher(CAN_MSG* msg)
     		break;
     
     	case J1939_PF_REQUEST_DGN:
-            if (msg->jid.PDUSpecific == J1939_GLOBAL_ADDRESS)
+            if (can_FrmPS(frm) == J1939_GLOBAL_ADDRESS)
             {
                 // global message
-        		if ((msg->data[0]==0x00) && (msg->data[1]==J1939_PF_ADDRESS_CLAIMED) && (msg->data[2]==0x00))
+        		if ((data[0]==0x00) && (data[1]==J1939_PF_ADDRESS_CLAIMED) && (data[2]==0x00))
                 {
                     if (g_J1939.CannotClaimAddress)
                         J1939_SetInvAddress(J1939_NULL_ADDRESS);
@@ -498,16 +681,16 @@ int16_t J1939_Dispatcher(CAN_MSG* msg)
             else
             {
                 // targeted message
-                if (msg->jid.PDUSpecific != g_J1939.MyInvAddress) break;
+                if (can_FrmPS(frm) != g_J1939.MyInvAddress) break;
                 // for us
-        		if ((msg->data[0]==0xEB) && (msg->data[1]==0xFE) && (msg->data[2]==0x00))
+        		if ((data[0]==0xEB) && (data[1]==0xFE) && (data[2]==0x00))
                 {
                     rvcan_SendProductID(rvcan_GetProductIdString());
                     rc = 1; // handled
                 }
                 else
                 {
-                	LOG(SS_J1939, SV_ERR, "JID=%08lX reqDGN=%02X %02X %02x NOT HANDLED", msg->jid.ID, msg->data[0], msg->data[1], msg->data[2]);
+                	LOG(SS_J1939, SV_ERR, "JID=%08lX reqDGN=%02X %02X %02x NOT HANDLED", can_FrmID(frm), data[0], data[1], data[2]);
                  // J1939_SendNak(); // TODO
                 }
             }
@@ -515,7 +698,7 @@ int16_t J1939_Dispatcher(CAN_MSG* msg)
     
     	case J1939_PF_ADDRESS_CLAIMED:
             LOG(SS_J1939, SV_INFO, "Rx:J1939_PF_ADDRESS_CLAIMED");
-            g_J1939.OneMessage = *msg;   // save a copy
+            can_UnpackDma(frm, &g_J1939.OneMessage);   // save a copy
     		J1939_RxAddressClaim();
     		break;
     
@@ -124,6 +124,13 @@
 #define J1939_DGN_SUBSEQUENT_MULTI_PACKET   0x0EBFF    // subsequent multi-packet
 #define J1939_DGN_ACK                     	0x0E800	   // 
 
+// --------------------------------
+// transport protocol (multi-packet)
+// --------------------------------
+#define J1939_TP_PACKET_BYTES       7       // data bytes per packet
+#define J1939_TP_MAX_BYTES          1785    // per spec; 255 packets
+#define J1939_TP_TX_RESERVE         4       // tx queue slots a paced transfer leaves for other traffic
+
 
 // ------------------------------------------------------
 //  S T A N D A R D    A C K N O W L E D G M E N T S
@@ -157,6 +164,26 @@ typedef struct
 	// working message
 	CAN_MSG		OneMessage;
 
+	// paced multi-packet transfer; see J1939_StartMultiPacket()
+	CAN_DGN     mpDgn;
+	CAN_DATA*   mpData;
+	uint16_t    mpLen;
+	uint8_t     mpPackets;  // data packets; 0=idle
+	uint16_t    mpNext;     // next packet to queue; 0=announce
+
+	// multi-packet (BAM) receive of one DGN; see J1939_ArmMultiPacketRx()
+	CAN_DGN     rxDgn;
+	CAN_DATA*   rxBuf;
+	uint16_t    rxMax;      // size of rxBuf
+	uint16_t    rxLen;      // bytes announced
+	uint16_t    rxDone;     // bytes of the completed transfer; 0=none yet
+	uint8_t     rxArmed;    // 1=rxBuf is free for a transfer of rxDgn
+	uint8_t     rxHeld;     // 1=announce came in before rxBuf was free; starts at the next arm
+	uint8_t     rxSource;   // address of the sender
+	uint8_t     rxPackets;  // packets announced
+	uint16_t    rxNext;     // next packet expected; 0=no transfer in progress
+	uint16_t    rxDropped;  // transfers dropped on a missing packet
+
 } J1939_STATE;
 #pragma pack()  // restore packing setting
 
@@ -179,6 +206,12 @@ void J1939_SendAddressRequest(uint8_t desiredAddress);
 void J1939_SendRequestForDGN(uint32_t dgn, uint8_t destAddress);
 void J1939_SendAddressClaimed(void);
 int  J1939_SendMultiPacketMessage(CAN_DGN dgn, uint16_t dataLen, CAN_DATA* data);
+int  J1939_StartMultiPacket(CAN_DGN dgn, uint16_t dataLen, CAN_DATA* data);
+int  J1939_IsMultiPacketBusy(void);
+void J1939_MultiPacketPoll(void);
+void J1939_ArmMultiPacketRx(CAN_DGN dgn, CAN_DATA* buf, uint16_t maxLen);
+void J1939_DisarmMultiPacketRx(void);
+uint16_t J1939_MultiPacketRxDone(void);
 
 #endif	// __J1939_H_
 
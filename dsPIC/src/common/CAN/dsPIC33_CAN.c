@@ -12,9 +12,15 @@
 // -------
 #include "options.h"    // must be first include
 #include "dsPIC33_CAN.h"
+#include "evlog.h"
+#include "fwupdate.h"
 #include "rv_can.h"
 #include "tasker.h"
 #include "nvm.h"
+#include "telemetry.h"
+#ifdef __linux__
+ #include "socket_can.h"    // host: SocketCAN stands in for the ECAN module
+#endif
 
 // -------------------
 // access global data
@@ -39,20 +45,73 @@ void J1939_Start(void);  // Dont include J1939.h to avoid recursion
 #define  NUM_OF_ECAN_BUFFERS   (32)
 #define  ECAN_MSG_BUF_LENGTH   (4)
 typedef  uint16_t   ECANMSGBUF[ECAN_MSG_BUF_LENGTH][CAN_DMA_WORDS];
+#ifdef __linux__
+volatile ECANMSGBUF g_canTxDmaBuf;
+volatile ECANMSGBUF g_canRxDmaBuf;
+ #define CAN_ISR        // host: called from sockcan_Poll()
+#else
 volatile ECANMSGBUF g_canTxDmaBuf __attribute__((space(dma),aligned(ECAN_MSG_BUF_LENGTH * sizeof(DMA_WORD))));
 volatile ECANMSGBUF g_canRxDmaBuf __attribute__((space(dma),aligned(ECAN_MSG_BUF_LENGTH * sizeof(DMA_WORD))));
+ #define CAN_ISR        __attribute__((interrupt, no_auto_psv))
+#endif
 
 // increment queue pointer and handle wrap around
 #define INC_QUEUE_PTR(PTR, QUEUE_SIZE)  { PTR++; if (PTR >= QUEUE_SIZE) PTR = 0; }
 
 // ------------------------------------------------------------------------------------
 // CAN Bus Interrupt   ~10 usec
-void __attribute__((interrupt, no_auto_psv))_C1Interrupt(void)
+void CAN_ISR _C1Interrupt(void)
 {
+    uint8_t  tec, rec;
+
+    // track error counters; tx errors add 8, rx errors add 1 (8 if we flagged it)
+    tec = C1ECbits.TERRCNT;
+    rec = C1ECbits.RERRCNT;
+    if (tec > g_can.tec) g_can.rvcTxErrCount += (tec - g_can.tec + 7) >> 3;
+    if (rec > g_can.rec) g_can.rvcRxErrCount += (rec - g_can.rec);
+    g_can.tec = tec;
+    g_can.rec = rec;
+
+    // check error state changes
+    if (C1INTFbits.ERRIF)
+    {
+        if (C1INTFbits.TXBO && g_can.busState == CAN_BUS_OK)
+        {
+            g_can.busState = CAN_BUS_OFF;   // recovered in TASK_can_Driver()
+            g_can.rvcBusOffErr++;
+            task_MarkAsReady(_task_can);
+        }
+        C1INTFbits.ERRIF = 0;
+    }
+
+    // invalid message received
+    if (C1INTFbits.IVRIF)
+    {
+        g_can.rvcRxErrCount++;
+        C1INTFbits.IVRIF = 0;
+    }
+
+    // receive buffer overflow; hardware lost a frame
+    if (C1INTFbits.RBOVIF)
+    {
+        g_can.rvcRxFramesDropped++;
+        C1RXOVF1 = 0;
+        C1INTFbits.RBOVIF = 0;
+    }
+
     // check transmit interrupts
     if (C1INTFbits.TBIF)
     {
-        // transmit interrupt
+        // transmit interrupt; buffer 0 went out
+        uint16_t msec = (uint16_t)GetSysTicks() - g_can.txSentStamp;
+        uint8_t  bin  = 0;
+        while (msec && bin < CAN_TX_LAT_BINS-1) { bin++; msec >>= 1; }
+        g_can.txLatency[bin]++;
+        if (g_can.busState == CAN_BUS_PROBE)
+        {
+            g_can.busTxDone = 1;
+            task_MarkAsReady(_task_can);
+        }
         C1INTFbits.TBIF = 0;
     }
 
@@ -63,18 +122,27 @@ void __attribute__((interrupt, no_auto_psv))_C1Interrupt(void)
         // check to see if buffer 1 is full
         if(C1RXFUL1bits.RXFUL1)
         {
-            // transfer data from dma buffer 1 to circular buffer
-            // cant use memcpy here
-            g_can.RxQueue[g_can.RxHead].word[0] = g_canRxDmaBuf[0][0];
-            g_can.RxQueue[g_can.RxHead].word[1] = g_canRxDmaBuf[0][1];
-            g_can.RxQueue[g_can.RxHead].word[2] = g_canRxDmaBuf[0][2];
-            g_can.RxQueue[g_can.RxHead].word[3] = g_canRxDmaBuf[0][3];
-            g_can.RxQueue[g_can.RxHead].word[4] = g_canRxDmaBuf[0][4];
-            g_can.RxQueue[g_can.RxHead].word[5] = g_canRxDmaBuf[0][5];
-            g_can.RxQueue[g_can.RxHead].word[6] = g_canRxDmaBuf[0][6];
-            g_can.RxQueue[g_can.RxHead].word[7] = g_canRxDmaBuf[0][7];
-
-            INC_QUEUE_PTR(g_can.RxHead, CAN_RX_QUEUE_SIZE);
+            CAN_QPTR head = g_can.RxHead;
+            INC_QUEUE_PTR(head, CAN_RX_QUEUE_SIZE);
+            if (head == g_can.RxTail)
+            {
+                // receive queue full; keep the frames already queued
+                g_can.rvcRxFramesDropped++;
+            }
+            else
+            {
+                // transfer data from dma buffer 1 to circular buffer
+                // cant use memcpy here
+                g_can.RxQueue[g_can.RxHead].word[0] = g_canRxDmaBuf[0][0];
+                g_can.RxQueue[g_can.RxHead].word[1] = g_canRxDmaBuf[0][1];
+                g_can.RxQueue[g_can.RxHead].word[2] = g_canRxDmaBuf[0][2];
+                g_can.RxQueue[g_can.RxHead].word[3] = g_canRxDmaBuf[0][3];
+                g_can.RxQueue[g_can.RxHead].word[4] = g_canRxDmaBuf[0][4];
+                g_can.RxQueue[g_can.RxHead].word[5] = g_canRxDmaBuf[0][5];
+                g_can.RxQueue[g_can.RxHead].word[6] = g_canRxDmaBuf[0][6];
+                g_can.RxQueue[g_can.RxHead].word[7] = g_canRxDmaBuf[0][7];
+                g_can.RxHead = head;
+            }
             C1RXFUL1bits.RXFUL1=0;      // no longer full
             
             task_MarkAsReady(_task_can);
@@ -89,13 +157,13 @@ void __attribute__((interrupt, no_auto_psv))_C1Interrupt(void)
 //------------------------------------------------------------------------------
 
 // never called
-void __attribute__((interrupt, no_auto_psv)) _DMA1Interrupt(void)
+void CAN_ISR _DMA1Interrupt(void)
 {
     IFS0bits.DMA1IF = 0; // Clear the DMA1 Interrupt Flag;
 }
 
 // never called
-void __attribute__((interrupt, no_auto_psv)) _DMA2Interrupt(void)
+void CAN_ISR _DMA2Interrupt(void)
 {
     IFS1bits.DMA2IF = 0; // Clear the DMA2 Interrupt Flag;
 }
@@ -108,12 +176,26 @@ void __attribute__((interrupt, no_auto_psv)) _DMA2Interrupt(void)
 // 
 // Parameters:  unsigned char   ECAN module mode.  Must be either
 //                              ECAN_CONFIG_MODE or ECAN_NORMAL_MODE
-// Return:      None
+// Return:      0=mode set, 1=module did not take it within CAN_MODE_WAIT_LOOPS
+//              (it waits for the bus to go idle; a bus held dominant never does)
 // ------------------------------------------------------------------------------------
-void can_SetMode( unsigned char Mode )
+int16_t can_SetMode( unsigned char Mode )
 {
+    uint16_t loops = CAN_MODE_WAIT_LOOPS;
+
     C1CTRL1bits.REQOP = Mode;
-    while (C1CTRL1bits.OPMODE != Mode);
+  #ifdef __linux__
+    C1CTRL1bits.OPMODE = Mode;  // host: no module to acknowledge
+  #endif
+    while (C1CTRL1bits.OPMODE != Mode)
+    {
+        if (--loops == 0)
+        {
+            LOG(SS_CAN, SV_ERR, "SetMode %u timed out; mode=%u", Mode, C1CTRL1bits.OPMODE);
+            return(1);
+        }
+    }
+    return(0);
 }
 
 // ------------------------------------------------------------------------------------
@@ -180,7 +262,9 @@ void can_Config(void)
     can_SetBaudRate(g_can.baud);
     rvcan_BuildProductId();
  
-  #ifndef WIN32
+  #ifdef __linux__
+    sockcan_Open();
+  #elif !defined(WIN32)
 
     // disable can interrupts to allow resetting
     C1INTEbits.RBIE = 0;
@@ -269,7 +353,7 @@ void can_Config(void)
     // clear the buffer and overflow flags 
     C1RXFUL1=C1RXFUL2=C1RXOVF1=C1RXOVF2=0x0000;
 
-  #endif // WIN32
+  #endif // __linux__ WIN32
 
     // back to Normal mode.
     can_SetMode(ECAN_MODE_NORMAL);
@@ -302,8 +386,15 @@ void can_SetID(CAN_ID id)
 // start CAN bus interrupts
 void can_Start(void)
 {
-    // CAN RX interrupt enable - 'double arm' since 2-level nested interrupt
-    C1INTEbits.RBIE = 1;
+    g_can.busState      = CAN_BUS_OK;
+    g_can.busOffBackoff = CAN_BUSOFF_BACKOFF_MIN_MSEC;
+
+    // CAN interrupt enable - 'double arm' since 2-level nested interrupt
+    C1INTEbits.RBIE   = 1;  // receive
+    C1INTEbits.TBIE   = 1;  // transmit complete; tx latency
+    C1INTEbits.ERRIE  = 1;  // error state change; bus-off
+    C1INTEbits.RBOVIE = 1;  // receive overflow
+    C1INTEbits.IVRIE  = 1;  // invalid message
     IEC2bits.C1IE = 1;
 
     LOG(SS_CAN, SV_INFO, "Start");
@@ -315,7 +406,11 @@ void can_Start(void)
 // stop CAN bus interrupts
 void can_Stop(void)
 {
-    C1INTEbits.RBIE = 0;
+    C1INTEbits.RBIE   = 0;
+    C1INTEbits.TBIE   = 0;
+    C1INTEbits.ERRIE  = 0;
+    C1INTEbits.RBOVIE = 0;
+    C1INTEbits.IVRIE  = 0;
     IEC2bits.C1IE = 0;
 
 //  LOG("Stop CAN\r\n");
@@ -323,7 +418,9 @@ void can_Stop(void)
 
 // ------------------------------------------------------------------------------------
 // unpack DMA data to CAN message
-static void can_UnpackDma(CAN_DMA *dma, CAN_MSG* can)
+// handlers read queued frames in place with the can_Frm views; use this only
+// when a frame must be kept beyond its queue slot
+void can_UnpackDma(CAN_DMA *dma, CAN_MSG* can)
 {
     uint16_t word0, word1, word2, word3;
     uint16_t ide=0;
@@ -471,7 +568,7 @@ void can_DumpMsg(CAN_MSG* canMsg)
     memset(buf,0,sizeof(buf));
     for (i=0; i<n; i++)
     {
-        sprintf(&buf[i*3],"%02X ", (unsigned)canMsg->data[i]);
+        sprintf((char*)&buf[i*3],"%02X ", (unsigned)canMsg->data[i]);
     }
 
     // dump can data
@@ -485,15 +582,16 @@ void can_DumpMsg(CAN_MSG* canMsg)
 
 // ------------------------------------------------------------------------------------
 // dispatch can messageas to appropriate handlers
-static void can_CmdDispatcher(CAN_MSG* canMsg)
+// frame is read in place from its receive queue slot
+static void can_CmdDispatcher(CAN_DMA* frm)
 {
-    if (canMsg->frameType == CAN_FRAME_EXT && canMsg->msgType == CAN_MSG_DATA)
+    if (can_FrmIsExtData(frm))
     {
-        if (J1939_Dispatcher(canMsg)) return; // handled
-        if (rvcan_Dispatcher(canMsg)) return; // handled
+        if (J1939_Dispatcher(frm)) return; // handled
+        if (rvcan_Dispatcher(frm)) return; // handled
     }
 
-//  LOGX(SS_CAN, SV_ERR, "Rx Ignored", canMsg->data, canMsg->dataLength);
+//  LOGX(SS_CAN, SV_ERR, "Rx Ignored", can_FrmData(frm), can_FrmLen(frm));
 }
 
 // ------------------------------------------------------------------------------------
@@ -520,6 +618,15 @@ int16_t can_IsTxQueueFull(void)
     return (head == g_can.TxTail ? 1 : 0);
 }
 
+// ------------------------------------------------------------------------------------
+// returns number of frames that can still be queued for transmit
+int16_t can_TxQueueFree(void)
+{
+    int16_t used = (int16_t)g_can.TxHead - (int16_t)g_can.TxTail;
+    if (used < 0) used += CAN_TX_QUEUE_SIZE;
+    return(CAN_TX_QUEUE_SIZE - 1 - used);
+}
+
 // ------------------------------------------------------------------------------------
 // returns: 0=no, 1=yes
 int16_t can_IsRxQueueFull(void)
@@ -546,6 +653,7 @@ void can_TxDriver()
         g_canTxDmaBuf[0][5] = g_can.TxQueue[g_can.TxTail].word[5];
         g_canTxDmaBuf[0][6] = g_can.TxQueue[g_can.TxTail].word[6];
         g_canTxDmaBuf[0][7] = g_can.TxQueue[g_can.TxTail].word[7];
+        g_can.txSentStamp   = g_can.TxStamp[g_can.TxTail];
 
         INC_QUEUE_PTR(g_can.TxTail, CAN_TX_QUEUE_SIZE);
         C1TR01CONbits.TXREQ0 = 0x1;     // transmit it
@@ -561,28 +669,51 @@ static void can_RxDriver()
     // process any messages in receive queue
     if (!can_IsRxQueueEmpty())
     {
-        CAN_MSG canMsg;
-        can_UnpackDma(&g_can.RxQueue[g_can.RxTail], &canMsg);
-        INC_QUEUE_PTR(g_can.RxTail, CAN_RX_QUEUE_SIZE);
         g_can.rvcRxFrameCount++;    // one more packet received
-        can_CmdDispatcher(&canMsg);
+        can_CmdDispatcher(&g_can.RxQueue[g_can.RxTail]);
+        // release the slot after dispatching; isr only fills at head
+        INC_QUEUE_PTR(g_can.RxTail, CAN_RX_QUEUE_SIZE);
     }
 }
 
 // ------------------------------------------------------------------------------------
-// place a can message in the transmit queue
-// returns: 0=ok, 1=tx queue is full
-int16_t can_TxEnqueue(CAN_MSG* msg)
+// get the next free transmit queue slot to build a frame in place
+// fill it with can_FrmSetExtID() and can_FrmData(), then call can_TxCommit()
+// returns: null=tx queue is full; a caller that then discards the frame
+// counts it in g_can.rvcTxFramesDropped, one that retries later does not
+CAN_DMA* can_TxAlloc(void)
 {
     if (can_IsTxQueueFull())
     {
      // LOG(SS_CAN, SV_ERR, "Tx Queue is Full");
-        return(1);
+        return(0);
     }
-    can_PackDma(msg, &g_can.TxQueue[g_can.TxHead]); // put in the next queue slot
+    return(&g_can.TxQueue[g_can.TxHead]);
+}
+
+// ------------------------------------------------------------------------------------
+// queue the frame built in the slot returned by can_TxAlloc()
+void can_TxCommit(void)
+{
+    g_can.TxStamp[g_can.TxHead] = (uint16_t)GetSysTicks();
     INC_QUEUE_PTR(g_can.TxHead, CAN_TX_QUEUE_SIZE); // advance to next entry in queue
     // wake up handler to transmit
     task_MarkAsReady(_task_can);
+}
+
+// ------------------------------------------------------------------------------------
+// place a can message in the transmit queue
+// returns: 0=ok, 1=tx queue is full
+int16_t can_TxEnqueue(CAN_MSG* msg)
+{
+    CAN_DMA* frm = can_TxAlloc();
+    if (frm == 0)
+    {
+        g_can.rvcTxFramesDropped++;
+        return(1);
+    }
+    can_PackDma(msg, frm);  // put in the next queue slot
+    can_TxCommit();
 
 //  LOG(SS_CAN, SV_INFO, "TxEnqueue msgType=%u frmType=%u", msg->msgType, msg->frameType);
 //  can_DumpMsg(msg);
@@ -591,47 +722,133 @@ int16_t can_TxEnqueue(CAN_MSG* msg)
 }
 
 // ------------------------------------------------------------------------------------
-#define BROADCAST_EVENT_MSEC  (2000)
+// bus-off recovery
+//   OFF:     abort the pending transmit, drop the stale queue and go to configuration mode
+//   BACKOFF: stay off the bus; the hold-off doubles on each repeated bus-off
+//   PROBE:   back in normal mode; recovered once the interrupt sees a frame go out, or,
+//            with nothing to send, after CAN_BUSOFF_PROBE_MSEC with a clean error counter
+// a mode change the module does not take is retried on the next pass
+static void can_BusOffRecovery(void)
+{
+    uint16_t ie;
+
+    switch (g_can.busState)
+    {
+    case CAN_BUS_OFF:
+        C1CTRL1bits.ABAT = 1;   // abort pending transmissions
+
+        // drop the queue with the can interrupt masked; it must not see the tail move
+        ie = IEC2bits.C1IE;
+        IEC2bits.C1IE = 0;
+        while (!can_IsTxQueueEmpty())
+        {
+            INC_QUEUE_PTR(g_can.TxTail, CAN_TX_QUEUE_SIZE);
+            g_can.rvcTxFramesDropped++;
+        }
+        IEC2bits.C1IE = ie;
+
+        if (can_SetMode(ECAN_MODE_CONFIGURE)) break;
+        g_can.busOffTicks = GetSysTicks();
+        g_can.busState    = CAN_BUS_BACKOFF;
+        LOG(SS_CAN, SV_ERR, "Bus-Off tec=%u rec=%u backoff=%u", (int)g_can.tec, (int)g_can.rec, g_can.busOffBackoff);
+        break;
+
+    case CAN_BUS_BACKOFF:
+        if (!IsTimedOut(g_can.busOffBackoff, g_can.busOffTicks)) break;
+        C1CTRL1bits.ABAT = 0;
+        if (can_SetMode(ECAN_MODE_NORMAL)) break;
+        g_can.busOffTicks = GetSysTicks();
+        g_can.busTxDone   = 0;
+        g_can.busState    = CAN_BUS_PROBE;
+        break;
+
+    case CAN_BUS_PROBE:
+        if (C1INTFbits.TXBO)
+        {
+            // still bus-off; back off longer
+            if (g_can.busOffBackoff < CAN_BUSOFF_BACKOFF_MAX_MSEC) g_can.busOffBackoff <<= 1;
+            g_can.rvcBusOffErr++;
+            g_can.busState = CAN_BUS_OFF;
+        }
+        else if (g_can.busTxDone ||
+                 (C1TR01CONbits.TXREQ0 == 0 && can_IsTxQueueEmpty() && C1ECbits.TERRCNT == 0 &&
+                  IsTimedOut(CAN_BUSOFF_PROBE_MSEC, g_can.busOffTicks)))
+        {
+            // a frame went out, or nothing to send and no errors; on the bus again
+            g_can.busOffBackoff = CAN_BUSOFF_BACKOFF_MIN_MSEC;
+            g_can.busState      = CAN_BUS_OK;
+            LOG(SS_CAN, SV_INFO, "Bus-Off recovered");
+        }
+        break;
+
+    default:
+        g_can.busState = CAN_BUS_OK;
+        break;
+    } // switch
+
+    // keep running until recovered
+    task_MarkAsReady(_task_can);
+}
+
+// ------------------------------------------------------------------------------------
+// clear bus health statistics
+void can_ResetStats(void)
+{
+    g_can.rvcRxErrCount      = 0;
+    g_can.rvcTxErrCount      = 0;
+    g_can.rvcTxFrameCount    = 0;  
+    g_can.rvcRxFrameCount    = 0;  
+    g_can.rvcBusOffErr       = 0;     
+    g_can.rvcRxFramesDropped = 0;
+    g_can.rvcTxFramesDropped = 0;
+    memset(g_can.txLatency, 0, sizeof(g_can.txLatency));
+}
+
+// ------------------------------------------------------------------------------------
+// log bus health statistics
+void can_LogStats(void)
+{
+    LOG(SS_CAN, SV_INFO, "Errs rx=%u tx=%u busOff=%u  Dropped rx=%u tx=%u  tec=%u rec=%u",
+        g_can.rvcRxErrCount, g_can.rvcTxErrCount, g_can.rvcBusOffErr,
+        g_can.rvcRxFramesDropped, g_can.rvcTxFramesDropped, (int)g_can.tec, (int)g_can.rec);
+    LOG(SS_CAN, SV_INFO, "TxLatency 0:%u 1:%u 2:%u 4:%u 8:%u 16:%u 32:%u 64+:%u msec",
+        g_can.txLatency[0], g_can.txLatency[1], g_can.txLatency[2], g_can.txLatency[3],
+        g_can.txLatency[4], g_can.txLatency[5], g_can.txLatency[6], g_can.txLatency[7]);
+}
 
+// ------------------------------------------------------------------------------------
 // drive the CAN state machine
 void TASK_can_Driver(void)
 {
     static SYSTICKS s_lastTick = 0;
-    static SYSTICKS s_ticks    = 0;
-    static int      s_sendItem = 0;
-    SYSTICKS nowTick = GetSysTicks();
+    SYSTICKS nowTick;
 
-    if (IsTimedOut(BROADCAST_EVENT_MSEC,s_ticks))
-    {
-        s_ticks = nowTick;    // reset timer
-        s_sendItem = 1;
-    }
+  #ifdef __linux__
+    // host: service the socket in place of the ECAN interrupt
+    sockcan_Poll();
+  #endif
+    nowTick = GetSysTicks();
 
-    // send the can messages out on different timer ticks
-    if (can_IsTxQueueFull()) s_sendItem = 0; // dont send if full
-    switch (s_sendItem)
-    {
-    default: s_sendItem=0;                                    break;
-    case  1: s_sendItem++; rvcan_Send_DM_RV();                break;
-    case  2: s_sendItem++; rvcan_SendDcSourceStatus1();       break;
-    case  3: s_sendItem++; rvcan_SendDcSourceStatus2();       break;
-    case  4: s_sendItem++; rvcan_SendInverterStatus();        break;
-    case  5: s_sendItem++; rvcan_SendInverterAcStatus1();     break;
-    case  6: s_sendItem++; rvcan_SendInverterAcStatus3();     break;
-    case  7: s_sendItem++; rvcan_SendInverterDcStatus();      break;
-    case  8: s_sendItem++; rvcan_SendInverterConfigStatus1(); break;
- #ifdef OPTION_HAS_CHARGER
-    case  9: s_sendItem++; rvcan_SendChargerStatus();         break;
-    case 10: s_sendItem++; rvcan_SendChargerConfigStatus();   break;
-    case 11: s_sendItem++; rvcan_SendChargerConfigStatus2();  break;
-    case 12: s_sendItem++; rvcan_SendChargerAcStatus1();      break;
-    case 13: s_sendItem++; rvcan_SendChargerAcStatus2();      break;
-    case 14: s_sendItem++; rvcan_SendChargerEqualStatus();    break;
- #endif
-    } // switch
+    // rejoin the bus after a bus-off
+    if (g_can.busState != CAN_BUS_OK) can_BusOffRecovery();
+
+    // send status messages on change or when due
+    rvcan_BroadcastPoll();
+
+    // batched field responses
+    J1939_MultiPacketPoll();
+
+    // stream telemetry into what is left of the transmit queue
+    tlm_Poll();
+
+    // event log bulk read
+    evlog_Poll();
+
+    // firmware update; page writes
+    fwup_Poll();
 
     // keep the transmitter pumping
-    can_TxDriver();
+    if (g_can.busState == CAN_BUS_OK || g_can.busState == CAN_BUS_PROBE) can_TxDriver();
 
     // keep the receiver pumping
     can_RxDriver();
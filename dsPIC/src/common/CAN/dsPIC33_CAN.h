@@ -68,6 +68,25 @@ STRUCT_SIZE_CHECK(DMA_WORD, 2);
 #define CAN_RX_QUEUE_SIZE   32  // number of CAN messages in receive  queue
 
 
+// ---------------
+// CAN bus health
+// ---------------
+#define CAN_BUS_OK          0   // on the bus
+#define CAN_BUS_OFF         1   // bus-off detected by interrupt; recovery pending
+#define CAN_BUS_BACKOFF     2   // held in configuration mode for the backoff time
+#define CAN_BUS_PROBE       3   // rejoined; waiting for a frame to go out or a quiet probe window
+
+#define CAN_BUSOFF_BACKOFF_MIN_MSEC   (100)   // first hold-off after bus-off
+#define CAN_BUSOFF_BACKOFF_MAX_MSEC  (6400)   // doubled on each repeat up to this
+#define CAN_BUSOFF_PROBE_MSEC          (50)   // nothing to send; error free this long is recovered
+
+#define CAN_MODE_WAIT_LOOPS         (20000)   // ~3 msec at 40 MIPS; > longest frame at 250k
+
+// tx latency histogram (enqueue to transmit complete) bins in msec:
+//   0, 1, 2-3, 4-7, 8-15, 16-31, 32-63, 64+
+#define CAN_TX_LAT_BINS     8
+
+
 // --------------
 // CAN Device ID
 // --------------
@@ -162,6 +181,73 @@ STRUCT_SIZE_CHECK(CAN_DMA ,16);
 #pragma pack()  // restore packing setting
 
 
+// ----------------------------------------------------
+// Frame views
+// Access a queued frame in place in its DMA words;
+// no unpacking into a CAN_MSG. Extended frames only.
+// Data bytes are stored lsb first in word3-word6 so
+// they can be addressed directly as a byte array.
+// ----------------------------------------------------
+
+// returns: 0=no, 1=extended data frame
+INLINE int16_t can_FrmIsExtData(CAN_DMA* frm)
+{
+    return((frm->word[0] & 0x0001) && !(frm->word[2] & 0x0200) ? 1 : 0);
+}
+
+// 29 bit id
+INLINE CAN_ID can_FrmID(CAN_DMA* frm)
+{
+    return(((CAN_ID)(frm->word[0] & 0x1FFC) << 16) |
+           ((CAN_ID)(frm->word[1] & 0x0FFF) <<  6) |
+           (frm->word[2] >> 10));
+}
+
+// data group number; includes data-page
+INLINE CAN_DGN can_FrmDGN(CAN_DMA* frm)
+{
+    return(((CAN_DGN)(frm->word[0] & 0x01FC) << 8) | ((frm->word[1] & 0x0FFF) >> 2));
+}
+
+// J1939 PDU format (DGN hi byte)
+INLINE uint8_t can_FrmPF(CAN_DMA* frm)
+{
+    return((uint8_t)((frm->word[0] & 0x00FC) | ((frm->word[1] >> 10) & 0x03)));
+}
+
+// J1939 PDU specific (DGN lo byte)
+INLINE uint8_t can_FrmPS(CAN_DMA* frm)
+{
+    return((uint8_t)(frm->word[1] >> 2));
+}
+
+// J1939 source address
+INLINE uint8_t can_FrmSource(CAN_DMA* frm)
+{
+    return((uint8_t)(((frm->word[1] & 0x0003) << 6) | (frm->word[2] >> 10)));
+}
+
+// number of data bytes
+INLINE CAN_LEN can_FrmLen(CAN_DMA* frm)
+{
+    return((CAN_LEN)(frm->word[2] & 0x0F));
+}
+
+// data payload
+INLINE CAN_DATA* can_FrmData(CAN_DMA* frm)
+{
+    return((CAN_DATA*)&frm->word[3]);
+}
+
+// set 29 bit id and data length of an extended data frame
+INLINE void can_FrmSetExtID(CAN_DMA* frm, CAN_ID id, CAN_LEN len)
+{
+    frm->word[0] = (DMA_WORD)((id >> 16) & 0x1FFC) | 0x0003;  // SRR and IDE
+    frm->word[1] = (DMA_WORD)((id >>  6) & 0x0FFF);
+    frm->word[2] = (DMA_WORD)((id & 0x3F) << 10) | (len & 0x0F);
+}
+
+
 // --------------------------
 // Global CAN Data Structure
 // --------------------------
@@ -181,7 +267,7 @@ typedef struct
     CAN_QPTR    TxTail;     // points to next take out
     CAN_DMA     TxQueue[CAN_TX_QUEUE_SIZE];
 
-    // RVC communication status 1  TODO set these
+    // RVC communication status 1
     uint16_t    rvcRxErrCount;  // The number of errors encountered receiving incoming CAN messages.
     uint16_t    rvcTxErrCount;  // The number of errors encountered transmitting CAN messages.
 
@@ -189,11 +275,22 @@ typedef struct
     uint32_t    rvcTxFrameCount;  // The number of can packets transmitted by this node
     uint32_t    rvcRxFrameCount;  // The number of can packets received    by this node
 
-    // RVC communication status 3  TODO set these
+    // RVC communication status 3
     uint16_t    rvcBusOffErr;       // The number of bus-off errors detected.
     uint16_t    rvcRxFramesDropped; // The number of receive  frames dropped.
     uint16_t    rvcTxFramesDropped; // The number of transmit frames dropped. 
 
+    // bus health
+    uint8_t     busState;           // CAN_BUS_OK etc
+    uint8_t     tec;                // last transmit error counter read
+    uint8_t     rec;                // last receive  error counter read
+    uint16_t    busOffBackoff;      // msec to stay off the bus on the next recovery
+    SYSTICKS    busOffTicks;        // start of the current backoff
+    volatile uint8_t busTxDone;     // a frame went out while probing; set by the interrupt
+    uint16_t    TxStamp[CAN_TX_QUEUE_SIZE]; // enqueue time of each transmit slot (low 16 bits of ticks)
+    uint16_t    txSentStamp;        // enqueue time of the frame in the transmit buffer
+    uint16_t    txLatency[CAN_TX_LAT_BINS]; // tx latency histogram
+
     // configuration
     CAN_BAUD    baud;
     uint8_t     address;
@@ -249,7 +346,7 @@ extern CAN_STATE      g_can;
 // -------------
 void can_SetBaudRate(CAN_BAUD baudRate);
 void can_SetID(CAN_ID id);
-void can_SetMode(unsigned char Mode);
+int16_t can_SetMode(unsigned char Mode);
 void can_Config(void);
 void can_Start(void);
 void can_Stop(void);
@@ -261,13 +358,19 @@ int16_t  can_IsTxQueueFull(void);
 int16_t  can_IsRxQueueFull(void);
 int16_t  can_IsTxQueueEmpty(void);
 int16_t  can_IsRxQueueEmpty(void);
+int16_t  can_TxQueueFree(void);
 void     can_TxDriver(void);
 int16_t  can_TxEnqueue(CAN_MSG* msg);
+CAN_DMA* can_TxAlloc(void);
+void     can_TxCommit(void);
+void     can_UnpackDma(CAN_DMA *dma, CAN_MSG* can);
+void     can_ResetStats(void);
+void     can_LogStats(void);
 void     J1939_Poll(unsigned long ElapsedTime);
-int16_t  J1939_Dispatcher(CAN_MSG* msg);
+int16_t  J1939_Dispatcher(CAN_DMA* frm);
 uint8_t  J1939_InvAddress(void);
 uint8_t  J1939_ChgrAddress(void);
-int16_t  rvcan_Dispatcher(CAN_MSG* msg);
+int16_t  rvcan_Dispatcher(CAN_DMA* frm);
 
 #endif  //  __DSPIC33_CAN_H__
 
@@ -16,14 +16,22 @@
 #include "charger_cmds.h"
 #include "config.h"
 #include "dsPIC33_CAN.h"
+#include "evlog.h"
+#include "fwupdate.h"
 #include "inverter.h"
 #include "inverter_cmds.h"
 #include "rv_can.h"
 #include "sensata_can.h"
 #include "nvm.h"
 #include "hs_temp.h"
+#include "telemetry.h"
 #include "tasker.h"
 
+// -----------
+// Prototyping
+// -----------
+static void rvcan_SendStatus(CAN_DGN dgn, CAN_LEN ndata, CAN_DATA* data, char* logText);
+
 
 // ----------------------------------------------------------------------
 //                  B A S I C    M E S S A G E S
@@ -84,9 +92,7 @@ void rvcan_Send_DM_RV()
 
     inv_GetDM_RV((RVCS_DM_RV*)&data);
 
-    LOGX(SS_J1939, SV_INFO, "Send_DM_RV: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_DM_RV, ndata, data);
+    rvcan_SendStatus(RVC_DGN_DM_RV, ndata, data, "Send_DM_RV: ");
 }
 
 // ----------------------------------------------------------------------
@@ -157,14 +163,9 @@ void rvcan_ResetCommStats()
 {
     LOG(SS_INVCMD, SV_INFO, "Reset Comm Stats");
 
-    // clear state counters and flags
-    g_can.rvcRxErrCount      = 0;
-    g_can.rvcTxErrCount      = 0;
-    g_can.rvcTxFrameCount    = 0;  
-    g_can.rvcRxFrameCount    = 0;  
-    g_can.rvcBusOffErr       = 0;     
-    g_can.rvcRxFramesDropped = 0;
-    g_can.rvcTxFramesDropped = 0;
+    // clear state counters and flags; log what is being cleared
+    can_LogStats();
+    can_ResetStats();
 }
 
 // ----------------------------------------------------------------------
@@ -267,10 +268,10 @@ void rvcan_SendCommStatus3()
 
     data[0] = LOBYTE(g_can.rvcBusOffErr);
     data[1] = HIBYTE(g_can.rvcBusOffErr);
-    data[2] = LOBYTE(g_can.rvcRxFrameCount);
-    data[3] = HIBYTE(g_can.rvcRxFrameCount);
-    data[4] = LOBYTE(g_can.rvcTxFrameCount);
-    data[5] = HIBYTE(g_can.rvcTxFrameCount);
+    data[2] = LOBYTE(g_can.rvcRxFramesDropped);
+    data[3] = HIBYTE(g_can.rvcRxFramesDropped);
+    data[4] = LOBYTE(g_can.rvcTxFramesDropped);
+    data[5] = HIBYTE(g_can.rvcTxFramesDropped);
 
     LOGX(SS_RVC, SV_INFO, "SendCommStatus3: ", data, ndata);
 
@@ -291,9 +292,7 @@ void rvcan_SendDcSourceStatus1()
 
     inv_GetDcSourceStatus1((RVCS_DC_SOURCE_STATUS_1*)&data[0]);
 
-    LOGX(SS_RVC, SV_INFO, "SendDcSrcStat1: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_DC_SOURCE_STATUS_1, ndata, data);
+    rvcan_SendStatus(RVC_DGN_DC_SOURCE_STATUS_1, ndata, data, "SendDcSrcStat1: ");
 }
 
 // ----------------------------------------------------------------------
@@ -306,9 +305,7 @@ void rvcan_SendDcSourceStatus2()
     data[0] = g_can.MyInstance;
     inv_GetDcSourceStatus2((RVCS_DC_SOURCE_STATUS_2*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendDcSrcStat2: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_DC_SOURCE_STATUS_2, ndata, data);
+    rvcan_SendStatus(RVC_DGN_DC_SOURCE_STATUS_2, ndata, data, "SendDcSrcStat2: ");
 }
 
 // ----------------------------------------------------------------------
@@ -342,9 +339,7 @@ void rvcan_SendInverterStatus()
     data[1] = inv_GetRvcStatus();
     data[2] = (inv_GetBatteryTempSensorPresent()?1:0) + (IsInvLoadSenseEn()?4:0);
 
-    LOGX(SS_RVC, SV_INFO, "SendInvStat: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_INVERTER_STATUS, ndata, data);
+    rvcan_SendStatus(RVC_DGN_INVERTER_STATUS, ndata, data, "SendInvStat: ");
 }
 
 // ----------------------------------------------------------------------
@@ -357,9 +352,7 @@ void rvcan_SendInverterConfigStatus1()
     data[0] = g_can.MyInstance;
     inv_GetConfigStatus1((RVCS_INV_CFG_STATUS1*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendInvCfgStat1: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_INVERTER_CONFIGURATION_STATUS_1, ndata, data);
+    rvcan_SendStatus(RVC_DGN_INVERTER_CONFIGURATION_STATUS_1, ndata, data, "SendInvCfgStat1: ");
 }
 
 // ----------------------------------------------------------------------
@@ -387,9 +380,7 @@ void rvcan_SendInverterDcStatus()
     data[0] = g_can.MyInstance;
     inv_GetDcStatus((RVCS_INV_DC_STATUS*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendInvDcStat: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_INVERTER_DC_STATUS, ndata, data);
+    rvcan_SendStatus(RVC_DGN_INVERTER_DC_STATUS, ndata, data, "SendInvDcStat: ");
 }
 
 // ----------------------------------------------------------------------
@@ -432,9 +423,7 @@ void rvcan_SendInverterAcStatus1()
     data[0] = g_can.MyInstance | 0x40;  // output
     inv_GetAcStatus1((RVCS_AC_PNT_PG1*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendInvAcStat1: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_INVERTER_AC_STATUS_1, ndata, data);
+    rvcan_SendStatus(RVC_DGN_INVERTER_AC_STATUS_1, ndata, data, "SendInvAcStat1: ");
 }
 
 // ----------------------------------------------------------------------
@@ -462,9 +451,7 @@ void rvcan_SendInverterAcStatus3()
     data[0] = g_can.MyInstance;
     inv_GetAcStatus3((RVCS_AC_PNT_PG3*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendInvAcStat3: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_INVERTER_AC_STATUS_3, ndata, data);
+    rvcan_SendStatus(RVC_DGN_INVERTER_AC_STATUS_3, ndata, data, "SendInvAcStat3: ");
 }
 
 // ----------------------------------------------------------------------
@@ -499,9 +486,7 @@ void rvcan_SendChargerStatus(void)
     data[0] = g_can.MyInstance;
     chgr_GetStatusInfo((RVCS_CHARGER_STATUS*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendChgrStatus: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_CHARGER_STATUS, ndata, data);
+    rvcan_SendStatus(RVC_DGN_CHARGER_STATUS, ndata, data, "SendChgrStatus: ");
 }
 
 // ----------------------------------------------------------------------
@@ -514,9 +499,7 @@ void rvcan_SendChargerConfigStatus(void)
     data[0] = g_can.MyInstance;
     chgr_GetConfigStatus((RVCS_CHARGER_CFG_STATUS*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendChgrCfgStatus: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_CHARGER_CONFIGURATION_STATUS, ndata, data);
+    rvcan_SendStatus(RVC_DGN_CHARGER_CONFIGURATION_STATUS, ndata, data, "SendChgrCfgStatus: ");
 }
 
 // ----------------------------------------------------------------------
@@ -529,9 +512,7 @@ void rvcan_SendChargerConfigStatus2(void)
     data[0] = g_can.MyInstance;
     chgr_GetConfigStatus2((RVCS_CHARGER_CFG_STATUS2*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendChgrCfgStatus2: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_CHARGER_CONFIGURATION_STATUS_2, ndata, data);
+    rvcan_SendStatus(RVC_DGN_CHARGER_CONFIGURATION_STATUS_2, ndata, data, "SendChgrCfgStatus2: ");
 }
 
 // ----------------------------------------------------------------------
@@ -544,9 +525,7 @@ void rvcan_SendChargerEqualStatus(void)
     data[0] = g_can.MyInstance;
     chgr_GetEqualStatus((RVCS_CHARGER_EQUAL_STATUS*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendChgrEqualStatus: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_CHARGER_EQUALIZATION_STATUS, ndata, data);
+    rvcan_SendStatus(RVC_DGN_CHARGER_EQUALIZATION_STATUS, ndata, data, "SendChgrEqualStatus: ");
 }
 
 // ----------------------------------------------------------------------
@@ -589,9 +568,7 @@ void rvcan_SendChargerAcStatus1(void)
     data[0] = g_can.MyInstance;
     chgr_GetAcStatus1((RVCS_AC_PNT_PG1*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendChgrAcStat1: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_CHARGER_AC_STATUS_1, ndata, data);
+    rvcan_SendStatus(RVC_DGN_CHARGER_AC_STATUS_1, ndata, data, "SendChgrAcStat1: ");
 }
 
 // ----------------------------------------------------------------------
@@ -604,9 +581,7 @@ void rvcan_SendChargerAcStatus2(void)
     data[0] = g_can.MyInstance;
     chgr_GetAcStatus2((RVCS_AC_PNT_PG2*)&data[1]);
 
-    LOGX(SS_RVC, SV_INFO, "SendChgrAcStat2: ", data, ndata);
-
-    J1939_SendMessage(RVC_DGN_CHARGER_AC_STATUS_2, ndata, data);
+    rvcan_SendStatus(RVC_DGN_CHARGER_AC_STATUS_2, ndata, data, "SendChgrAcStat2: ");
 }
 
 // ----------------------------------------------------------------------
@@ -851,6 +826,132 @@ void rvcan_ChargerAcFaultCtrlCfgCmd2(RVCS_AC_FAULT_STATUS_2* cfg)
 
 #endif // OPTION_HAS_CHARGER
 
+// ----------------------------------------------------------------------
+//          S T A T U S    B R O A D C A S T    S C H E D U L E R
+// ----------------------------------------------------------------------
+
+// Each broadcast status DGN keeps a copy of the last payload sent.
+// A changed payload goes out as soon as its minimum interval allows;
+// an unchanged one is refreshed only when its maximum interval expires.
+// Measurement DGNs (volts, amps, hz) change on every read, so they use
+// equal min/max intervals and are sent periodically.
+
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    void      (*send)(void);        // status send function
+    uint16_t  minMsec;              // minimum msecs between sends (rate limit)
+    uint16_t  maxMsec;              // maximum msecs between sends (refresh)
+    CAN_DGN   dgn;                  // filled in on first send
+    SYSTICKS  lastTicks;            // time of last send
+    CAN_LEN   nlast;                // number of bytes in last[]; 0=never sent
+    CAN_DATA  last[MAX_CAN_DATA];   // last payload sent
+} RVC_BCAST_t;
+#pragma pack()  // restore packing setting
+
+static RVC_BCAST_t s_bcast[] =
+{
+   // send function                     min   max msecs
+    { rvcan_Send_DM_RV,                  50, RVC_BCAST_STATE_MSEC },
+    { rvcan_SendDcSourceStatus1,       RVC_BCAST_MEAS_MSEC, RVC_BCAST_MEAS_MSEC },
+    { rvcan_SendDcSourceStatus2,       RVC_BCAST_MEAS_MSEC, RVC_BCAST_MEAS_MSEC },
+    { rvcan_SendInverterStatus,          20, RVC_BCAST_STATE_MSEC },
+    { rvcan_SendInverterAcStatus1,     RVC_BCAST_MEAS_MSEC, RVC_BCAST_MEAS_MSEC },
+    { rvcan_SendInverterAcStatus3,      100, RVC_BCAST_STATE_MSEC },
+    { rvcan_SendInverterDcStatus,      RVC_BCAST_MEAS_MSEC, RVC_BCAST_MEAS_MSEC },
+    { rvcan_SendInverterConfigStatus1,  100, RVC_BCAST_STATE_MSEC },
+ #ifdef OPTION_HAS_CHARGER
+    { rvcan_SendChargerStatus,           20, RVC_BCAST_STATE_MSEC },
+    { rvcan_SendChargerConfigStatus,    100, RVC_BCAST_STATE_MSEC },
+    { rvcan_SendChargerConfigStatus2,   100, RVC_BCAST_STATE_MSEC },
+    { rvcan_SendChargerAcStatus1,      RVC_BCAST_MEAS_MSEC, RVC_BCAST_MEAS_MSEC },
+    { rvcan_SendChargerAcStatus2,      RVC_BCAST_MEAS_MSEC, RVC_BCAST_MEAS_MSEC },
+    { rvcan_SendChargerEqualStatus,     100, RVC_BCAST_STATE_MSEC },
+ #endif
+};
+#define RVC_NUM_BCAST  ((int)(sizeof(s_bcast)/sizeof(s_bcast[0])))
+
+// entry being polled by rvcan_BroadcastPoll(); null for requested sends
+static RVC_BCAST_t* s_bcastPoll = 0;
+
+// ----------------------------------------------------------------------
+// find the broadcast entry for a DGN
+// returns: null if DGN is not broadcast
+static RVC_BCAST_t* rvcan_FindBroadcast(CAN_DGN dgn)
+{
+    int i;
+    for (i=0; i<RVC_NUM_BCAST; i++)
+    {
+        if (s_bcast[i].nlast && s_bcast[i].dgn == dgn) return(&s_bcast[i]);
+    }
+    return(0);
+}
+
+// ----------------------------------------------------------------------
+// send a status DGN
+// when polled, only sends if payload changed (after min interval)
+// or max interval has expired; requested sends always go out
+static void rvcan_SendStatus(CAN_DGN dgn, CAN_LEN ndata, CAN_DATA* data, char* logText)
+{
+    RVC_BCAST_t* bc = s_bcastPoll;
+    int16_t  isChanged;
+
+    if (ndata > MAX_CAN_DATA) ndata = MAX_CAN_DATA;
+    if (bc == 0) bc = rvcan_FindBroadcast(dgn);   // keep cache in step with requested sends
+
+    if (bc)
+    {
+        isChanged = (bc->nlast != ndata || memcmp(bc->last, data, ndata)) ? 1 : 0;
+        if (s_bcastPoll)
+        {
+            if (isChanged)
+            {
+                if (bc->nlast && !IsTimedOut(bc->minMsec, bc->lastTicks)) return;
+            }
+            else
+            {
+                if (!IsTimedOut(bc->maxMsec, bc->lastTicks)) return;
+            }
+        }
+        if (can_IsTxQueueFull()) return;  // try again on next poll
+        bc->dgn       = dgn;
+        bc->nlast     = ndata;
+        bc->lastTicks = GetSysTicks();
+        memcpy(bc->last, data, ndata);
+    }
+
+    LOGX(SS_RVC, SV_INFO, logText, data, ndata);
+
+    J1939_SendMessage(dgn, ndata, data);
+}
+
+// ----------------------------------------------------------------------
+// check one status DGN per call for change or refresh
+// call from the CAN task every pass
+void rvcan_BroadcastPoll()
+{
+    static uint8_t s_index = 0;
+
+    if (can_IsTxQueueFull()) return; // dont build if cannot send
+
+    s_bcastPoll = &s_bcast[s_index];
+    s_bcastPoll->send();
+    s_bcastPoll = 0;
+
+    if (++s_index >= RVC_NUM_BCAST) s_index = 0;
+}
+
+// ----------------------------------------------------------------------
+// force all status DGNs to be sent on their next poll
+void rvcan_BroadcastReset()
+{
+    int i;
+    for (i=0; i<RVC_NUM_BCAST; i++)
+    {
+        s_bcast[i].nlast = 0;
+    }
+}
+
 // ----------------------------------------------------------------------
 //           P R O P R I E T A R Y    M E S S A G E S
 // ----------------------------------------------------------------------
@@ -896,27 +997,28 @@ void rvcan_SendPropInvStatus(uint8_t loDGN)
 // ----------------------------------------------------------------------
 // check if CAN message is a RV-C message and process it
 // returns: 0=not for us, 1=dispatched
-int16_t rvcan_Dispatcher(CAN_MSG* msg)
+int16_t rvcan_Dispatcher(CAN_DMA* frm)
 {
     CAN_DATA outData[SENFLD_MAX_BYTES];
     CAN_LEN  ndata;
     int16_t  rc = 0;    // assume dispatched
     uint32_t dgn;
+    CAN_DATA* data = can_FrmData(frm);  // read in place
 
     // must be extended message
-    if (msg->frameType != CAN_FRAME_EXT) return(0);
+    if (!can_FrmIsExtData(frm)) return(0);
 
-    dgn = can_DGN(msg);
+    dgn = can_FrmDGN(frm);
     switch( dgn )
     {
         case SENSATA_CUSTOM_SET_FIELD_DGN:
-            sen_SetField(msg->data);
+            sen_SetField(data);
             break;
 
         case SENSATA_CUSTOM_GET_FIELD_DGN:
             // get data for requested field
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            if (sen_GetField(msg->data, outData, &ndata)) break;
+            if (!IsRvcCmdForMe(data[0])) break;
+            if (sen_GetField(data, outData, &ndata)) break;
             // send CAN response to host
             if (outData[3] == SENFLD_TYPE_STRING)  // string is the odd ball
                 J1939_SendMultiPacketMessage(SENSATA_CUSTOM_GET_FIELD_RSP_DGN, ndata, outData);
@@ -924,93 +1026,128 @@ int16_t rvcan_Dispatcher(CAN_MSG* msg)
                 J1939_SendMessage(SENSATA_CUSTOM_GET_FIELD_RSP_DGN, ndata, outData);
             break;
 
+        case SENSATA_CUSTOM_GET_FIELDS_DGN:
+            // the response is the ack
+            if (!IsRvcCmdForMe(data[0])) break;
+            if (sen_GetFields(data) == 2) J1939_SendNak(SENSATA_CUSTOM_GET_FIELDS_DGN);
+            break;
+
+        case SENSATA_CUSTOM_SET_FIELDS_DGN:
+            if (!IsRvcCmdForMe(data[0])) break;
+            switch (sen_SetFields(data))
+            {
+            case 1: J1939_SendAck(SENSATA_CUSTOM_SET_FIELDS_DGN); break;
+            case 2: J1939_SendNak(SENSATA_CUSTOM_SET_FIELDS_DGN); break;
+            }
+            break;
+
+        case SENSATA_CUSTOM_TELEMETRY_DGN:
+            if (!IsRvcCmdForMe(data[0])) break;
+            tlm_Start(data[1], (uint16_t)data[2] | ((uint16_t)data[3] << 8));
+            J1939_SendAck(SENSATA_CUSTOM_TELEMETRY_DGN);
+            break;
+
+        case SENSATA_CUSTOM_EVLOG_DGN:
+            if (!IsRvcCmdForMe(data[0])) break;
+            evlog_StartRead(MKWORD(data[1],data[2]));
+            J1939_SendAck(SENSATA_CUSTOM_EVLOG_DGN);
+            break;
+
+        case SENSATA_CUSTOM_FWUP_DGN:
+            if (!IsRvcCmdForMe(data[0])) break;
+            if (fwup_Cmd(data))
+                J1939_SendNak(SENSATA_CUSTOM_FWUP_DGN);
+            else
+                J1939_SendAck(SENSATA_CUSTOM_FWUP_DGN);
+            break;
+
         case RVC_DGN_GENERAL_RESET: 
-            if (!IsRvcCmdForMe(msg->data[1])) break;    // Sensata extension
-            rvcan_GeneralReset((msg->data[0] & (3<<0)) ? 1 : 0,   // 0=no, 1=reboot cpu
-                               (msg->data[0] & (3<<2)) ? 1 : 0,   // 0=no, 1=clear faults
-                               (msg->data[0] & (3<<4)) ? 1 : 0,   // 0=no, 1=restore to default values
-                               (msg->data[0] & (3<<6)) ? 1 : 0);  // 0=no, 1=reset communication statistics
+            if (!IsRvcCmdForMe(data[1])) break;    // Sensata extension
+            rvcan_GeneralReset((data[0] & (3<<0)) ? 1 : 0,   // 0=no, 1=reboot cpu
+                               (data[0] & (3<<2)) ? 1 : 0,   // 0=no, 1=clear faults
+                               (data[0] & (3<<4)) ? 1 : 0,   // 0=no, 1=restore to default values
+                               (data[0] & (3<<6)) ? 1 : 0);  // 0=no, 1=reset communication statistics
 
             break;
         case RVC_DGN_INVERTER_COMMAND:
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_InverterCmd( msg->data[1], msg->data[7] );
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_InverterCmd( data[1], data[7] );
             break;
 
         case RVC_DGN_INVERTER_CONFIGURATION_COMMAND_1:
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_InverterCfgCmd1( MKWORD(msg->data[1],msg->data[2]),
-                                   MKWORD(msg->data[3],msg->data[4]),
-                                   MKWORD(msg->data[5],msg->data[6]) );
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_InverterCfgCmd1( MKWORD(data[1],data[2]),
+                                   MKWORD(data[3],data[4]),
+                                   MKWORD(data[5],data[6]) );
             break;
 
         case RVC_DGN_INVERTER_CONFIGURATION_COMMAND_2:
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_InverterCfgCmd2( MKWORD(msg->data[1],msg->data[2]),
-                                   MKWORD(msg->data[3],msg->data[4]),
-                                   MKWORD(msg->data[5],msg->data[6]) );
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_InverterCfgCmd2( MKWORD(data[1],data[2]),
+                                   MKWORD(data[3],data[4]),
+                                   MKWORD(data[5],data[6]) );
             break;
 
         case RVC_DGN_INVERTER_ACFAULT_CONFIGURATION_COMMAND_1:        
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_InverterAcFaultCtrlCfgCmd1((RVCS_AC_FAULT_STATUS_1*)&msg->data[1]);
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_InverterAcFaultCtrlCfgCmd1((RVCS_AC_FAULT_STATUS_1*)&data[1]);
             break;
 
         case RVC_DGN_INVERTER_ACFAULT_CONFIGURATION_COMMAND_2:        
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_InverterAcFaultCtrlCfgCmd2((RVCS_AC_FAULT_STATUS_2*)&msg->data[1]);
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_InverterAcFaultCtrlCfgCmd2((RVCS_AC_FAULT_STATUS_2*)&data[1]);
             break;
 
     #ifdef OPTION_HAS_CHARGER
         case RVC_DGN_CHARGER_COMMAND:
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_ChargerCmd(msg->data[1],      // 0=off, 1=on, 2=start equalization
-                             msg->data[2] & 3); // 0=off, 1=on, ignore all others
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_ChargerCmd(data[1],      // 0=off, 1=on, 2=start equalization
+                             data[2] & 3); // 0=off, 1=on, ignore all others
             break;
 
         case RVC_DGN_CHARGER_CONFIGURATION_COMMAND:
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_ChargerCfgCmd(msg->data[1],                       // charging algorithm
-                                msg->data[2],                       // charger mode
-                                msg->data[3] & 3,                   // battery temp sensor
-                               (msg->data[3]>>2) & 3,               // install line
-                                MKWORD(msg->data[4],msg->data[5]),  // battery size
-                                msg->data[6],                       // battery type
-                                msg->data[7]);                      // max charge amps
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_ChargerCfgCmd(data[1],                       // charging algorithm
+                                data[2],                       // charger mode
+                                data[3] & 3,                   // battery temp sensor
+                               (data[3]>>2) & 3,               // install line
+                                MKWORD(data[4],data[5]),  // battery size
+                                data[6],                       // battery type
+                                data[7]);                      // max charge amps
             break;
 
         case RVC_DGN_CHARGER_CONFIGURATION_COMMAND_2:                 
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_ChargerCfgCmd2(msg->data[1],              // charge percent
-                                 msg->data[2],              // charge rate percent
-                                 msg->data[3]);             // breakerSize
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_ChargerCfgCmd2(data[1],              // charge percent
+                                 data[2],              // charge rate percent
+                                 data[3]);             // breakerSize
             break;
 
         case RVC_DGN_CHARGER_EQUALIZATION_CONFIGURATION_COMMAND:      
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_ChargerEqualizationCmd(MKWORD(msg->data[1],msg->data[2]),     // voltage
-                                         MKWORD(msg->data[3],msg->data[4]));    // minutes
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_ChargerEqualizationCmd(MKWORD(data[1],data[2]),     // voltage
+                                         MKWORD(data[3],data[4]));    // minutes
             break;
 
         case RVC_DGN_CHARGER_ACFAULT_CONFIGURATION_COMMAND_1:         
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_ChargerAcFaultCtrlCfgCmd1((RVCS_AC_FAULT_STATUS_1*)&msg->data[1]);
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_ChargerAcFaultCtrlCfgCmd1((RVCS_AC_FAULT_STATUS_1*)&data[1]);
             break;
 
         case RVC_DGN_CHARGER_ACFAULT_CONFIGURATION_COMMAND_2:
-            if (!IsRvcCmdForMe(msg->data[0])) break;
-            rvcan_ChargerAcFaultCtrlCfgCmd2((RVCS_AC_FAULT_STATUS_2*)&msg->data[1]);
+            if (!IsRvcCmdForMe(data[0])) break;
+            rvcan_ChargerAcFaultCtrlCfgCmd2((RVCS_AC_FAULT_STATUS_2*)&data[1]);
             break;
      #endif // OPTION_HAS_CHARGER
 
         case RVC_DGN_INSTANCE_ASSIGNMENT:
-            rvcan_InstanceAssignment(msg->data[0],msg->data[1],msg->data[2],
-                              MKWORD(msg->data[3],msg->data[4]),
-                              MKWORD(msg->data[5],msg->data[6]) );
+            rvcan_InstanceAssignment(data[0],data[1],data[2],
+                              MKWORD(data[3],data[4]),
+                              MKWORD(data[5],data[6]) );
             break;
 
         case RVC_DGN_PROP_MAGNUM_INVERTER_STATUS:
-            rvcan_SendPropInvStatus(msg->jid.SourceAddress);
+            rvcan_SendPropInvStatus(can_FrmSource(frm));
             break;
         /*
         // not received, but sent
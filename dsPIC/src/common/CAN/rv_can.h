@@ -372,6 +372,12 @@
 // instance Table 5.3
 #define RVC_BROADCAST_INSTANCE   0         // instance used for broadcasting
 
+// ----------------------
+// Status broadcast rates
+// ----------------------
+#define RVC_BCAST_STATE_MSEC   (5000)  // refresh for unchanged state/config DGNs; sent on change
+#define RVC_BCAST_MEAS_MSEC    (2000)  // period for measurement DGNs (volts, amps)
+
 
 // -------------------------
 // structure packing on
@@ -774,7 +780,9 @@ void rvcan_ChargerEqualizationCmd(uint16_t  equalizationVolts,       // equaliza
 void rvcan_ChargerAcFaultCtrlCfgCmd1(RVCS_AC_FAULT_STATUS_1* cfg);
 void rvcan_ChargerAcFaultCtrlCfgCmd2(RVCS_AC_FAULT_STATUS_2* cfg);
 void rvcan_SendPropInvStatus(uint8_t loDGN);
-int16_t rvcan_Dispatcher(CAN_MSG* msg);
+void rvcan_BroadcastPoll(void);
+void rvcan_BroadcastReset(void);
+int16_t rvcan_Dispatcher(CAN_DMA* frm);
 
 
 #endif // _RV_CAN_H_
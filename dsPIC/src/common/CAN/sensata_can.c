@@ -19,6 +19,9 @@
 #include "dsPIC33_CAN.h"
 #include "inverter.h"
 #include "inverter_cmds.h"
+#include "inv_thermal.h"
+#include "load_sense.h"
+#include "J1939.h"
 #include "nvm.h"
 #include "sensata_can.h"
 #include "tasker.h"
@@ -44,6 +47,9 @@
 uint16_t g_test_mode      = 0;   // 0=off, 1=in test mode
 uint16_t g_led_test_color = 0;   // 0=off, 1=red, 2=green, 3=amber
 
+static SEN_BATCH_t s_batch;      // batched get/set being received
+static uint8_t     s_batchQuiet; // 1=sen_GetField() does not log; a batch is being read
+
 // ------------------
 // access global data
 // ------------------
@@ -175,6 +181,12 @@ int16_t sen_SetField(CAN_DATA* canData)
         LOG(SS_SYS, SV_INFO, "Set BattTempSensorPresent%d", g_nvm.settings.dev.batt_temp_sense_present);
 	  #endif
         break;
+    case SENFLD_DEV_FAST_XFER_ENABLE:
+        g_nvm.settings.dev.fast_xfer_enabled = int16A?1:0;
+        Device.config.fast_xfer_enabled = g_nvm.settings.dev.fast_xfer_enabled;
+        nvm_SetDirty();
+        LOG(SS_SYS, SV_INFO, "Set DevFastXferEn=%d", g_nvm.settings.dev.fast_xfer_enabled);
+        break; // INT16
 
         // can bus
     case SENFLD_CAN_BAUD:          
@@ -195,6 +207,7 @@ int16_t sen_SetField(CAN_DATA* canData)
     case SENFLD_INV_LOADSENSE_DELAY:			  inv_SetLoadSenseDelay((uint16_t)int16A);      break;      // INT16
     case SENFLD_INV_LOADSENSE_INTERVAL:			  inv_SetLoadSenseInterval((uint16_t)int16A);	break;      // INT16
     case SENFLD_INV_LOADSENSE_THRESHOLD:		  inv_SetLoadSenseThreshold(int16A);  	        break;		// INT16
+    case SENFLD_INV_LOADSENSE_INTERVAL_MAX:		  inv_SetLoadSenseIntervalMax((uint16_t)int16A); break;     // INT16
 
     // timer shutdown	
 	case SENFLD_TMR_SHUTDOWN_ENABLE:			  dev_SetTimerShutdownEnabled(int16A);		    break;      // INT16
@@ -207,6 +220,11 @@ int16_t sen_SetField(CAN_DATA* canData)
     case SENFLD_INV_I_GAIN:     	        inv_SetIGain(&canData[3]); break; // Q16
     case SENFLD_INV_D_GAIN:     	        inv_SetDGain(&canData[3]); break; // Q16
     case SENFLD_INV_I_LIMIT:                inv_SetILimit(int16A);	   break; // INT16 hard-coded
+    case SENFLD_INV_VLOOP_MODE:             inv_SetVLoopMode((uint16_t)int16A); break; // UINT16
+    case SENFLD_INV_RC_GAIN:                inv_SetRcGain(&canData[3]);         break; // Q16
+    case SENFLD_INV_RC_FORGET:              inv_SetRcForget((uint16_t)int16A);  break; // UINT16
+    case SENFLD_INV_RC_LIMIT:               inv_SetRcLimit(int16A);             break; // INT16
+    case SENFLD_INV_RC_LEAD:                inv_SetRcLead((uint16_t)int16A);    break; // UINT16
 	
     case SENFLD_INV_SUPPLY_LOW_SHUTDOWN:    inv_SetSupplyLowShutdown(	(uint16_t)VBATT_VOLTS_ADC(floatA));  break;
     case SENFLD_INV_SUPPLY_LOW_THRES:       inv_SetSupplyLowThreshold(	(uint16_t)VBATT_VOLTS_ADC(floatA));  break;
@@ -215,6 +233,14 @@ int16_t sen_SetField(CAN_DATA* canData)
     case SENFLD_INV_SUPPLY_HIGH_RECOVER:    inv_SetSupplyHighRecover(	(uint16_t)VBATT_VOLTS_ADC(floatA));  break;
     case SENFLD_INV_SUPPLY_HIGH_THRES:      inv_SetSupplyHighThreshold(	(uint16_t)VBATT_VOLTS_ADC(floatA));  break;
     case SENFLD_INV_SUPPLY_HIGH_SHUTDOWN:   inv_SetSupplyHighShutdown(	(uint16_t)VBATT_VOLTS_ADC(floatA));  break;
+  #if IS_PCB_LPC
+    case SENFLD_INV_OVL_RATED_RMS:          inv_SetOvlRatedRms(int16A);             break; // INT16
+    case SENFLD_INV_OVL_FET_TAU:            inv_SetOvlFetTau((uint16_t)int16A);     break; // UINT16
+    case SENFLD_INV_OVL_FET_LIMIT:          inv_SetOvlFetLimit((uint16_t)int16A);   break; // UINT16
+    case SENFLD_INV_OVL_XFMR_TAU:           inv_SetOvlXfmrTau((uint16_t)int16A);    break; // UINT16
+    case SENFLD_INV_OVL_XFMR_LIMIT:         inv_SetOvlXfmrLimit((uint16_t)int16A);  break; // UINT16
+    case SENFLD_INV_OVL_HS_TEMP_MAX:        inv_SetOvlHsTempMax(int16A);            break; // INT16
+  #endif
 
   #ifdef OPTION_HAS_CHARGER
 
@@ -271,6 +297,131 @@ int16_t sen_SetField(CAN_DATA* canData)
 	return(rc);
 }
 
+// ----------------------------------------------------------------------
+// 1=float value bytes (Field Payload order) are a number; not inf or nan
+static int16_t sen_IsFloatFinite(const CAN_DATA* value)
+{
+    return(((value[3] & 0x7F) != 0x7F || (value[2] & 0x80) == 0) ? 1 : 0);
+}
+
+// ----------------------------------------------------------------------
+// check a field and value sen_SetField() would take, without setting it;
+// isCustomRecipe: the battery recipe is custom, or made custom earlier in the batch
+// keep in step with sen_SetField(); fields it ignores fail here
+// returns: 1=settable, 0=not
+int16_t sen_IsFieldSettable(SENFLD fieldNum, const CAN_DATA* value, uint8_t isCustomRecipe)
+{
+    switch (fieldNum)
+    {
+        // system
+    case SENFLD_SAVE_TO_NVM:
+    case SENFLD_TEST:
+    case SENFLD_ENTER_BOOTLOADER:
+    case SENFLD_DEV_REMOTE_MODE:
+    case SENFLD_DEV_AUX_MODE:
+    case SENFLD_DEV_PUSH_BTN_ENABLE:
+  #if !defined(OPTION_HAS_CHGR_EN_SWITCH)
+    case SENFLD_DEV_HAS_BATT_TEMP_SENSOR:
+  #endif
+    case SENFLD_DEV_FAST_XFER_ENABLE:
+
+        // can bus
+    case SENFLD_CAN_BAUD:
+    case SENFLD_CAN_ADDRESS:
+    case SENFLD_CAN_INSTANCE:
+
+        // inverter load-sensing & timers
+    case SENFLD_INV_LOADSENSE_ENABLE:
+    case SENFLD_INV_LOADSENSE_ENABLE_ON_STARTUP:
+    case SENFLD_INV_LOADSENSE_DELAY:
+    case SENFLD_INV_LOADSENSE_INTERVAL:
+    case SENFLD_INV_LOADSENSE_THRESHOLD:
+    case SENFLD_INV_LOADSENSE_INTERVAL_MAX:
+    case SENFLD_TMR_SHUTDOWN_ENABLE:
+    case SENFLD_TMR_SHUTDOWN_ENABLE_ON_STARTUP:
+    case SENFLD_TMR_SHUTDOWN_DELAY:
+
+        // inverter
+    case SENFLD_INV_P_GAIN:
+    case SENFLD_INV_I_GAIN:
+    case SENFLD_INV_D_GAIN:
+    case SENFLD_INV_I_LIMIT:
+    case SENFLD_INV_VLOOP_MODE:
+    case SENFLD_INV_RC_GAIN:
+    case SENFLD_INV_RC_FORGET:
+    case SENFLD_INV_RC_LIMIT:
+    case SENFLD_INV_RC_LEAD:
+  #if IS_PCB_LPC
+    case SENFLD_INV_OVL_RATED_RMS:
+    case SENFLD_INV_OVL_FET_TAU:
+    case SENFLD_INV_OVL_FET_LIMIT:
+    case SENFLD_INV_OVL_XFMR_TAU:
+    case SENFLD_INV_OVL_XFMR_LIMIT:
+    case SENFLD_INV_OVL_HS_TEMP_MAX:
+  #endif
+  #ifdef OPTION_HAS_CHARGER
+    case SENFLD_CHGR_BRANCH_CIRCUIT_RATING:
+    case SENFLD_CHGR_AC_QUAL_MSEC:
+    case SENFLD_CHGR_BATT_TYPE:
+    case SENFLD_CHGR_BATT_RECIPE_CUSTOM_FLAG:
+  #endif
+    case SENFLD_CONV_I_LIMIT:
+    case SENFLD_CONV_D_LIMIT:
+    case SENFLD_CONV_PID_DEADBAND:
+    case SENFLD_CONV_FF_DEADBAND:
+
+        // testing
+    case SENFLD_TEST_MODE:
+    case SENFLD_TEST_COOLING_FAN:
+    case SENFLD_TEST_LED:
+        return(1);
+
+        // float values
+    case SENFLD_INV_SUPPLY_LOW_SHUTDOWN:
+    case SENFLD_INV_SUPPLY_LOW_THRES:
+    case SENFLD_INV_SUPPLY_LOW_RECOVER:
+    case SENFLD_INV_SUPPLY_HIGH_RECOVER:
+    case SENFLD_INV_SUPPLY_HIGH_THRES:
+    case SENFLD_INV_SUPPLY_HIGH_SHUTDOWN:
+  #ifdef OPTION_HAS_CHARGER
+    case SENFLD_CHGR_AMPS_LIMIT:
+  #endif
+    case SENFLD_CONV_P_GAIN:
+    case SENFLD_CONV_I_GAIN:
+    case SENFLD_CONV_D_GAIN:
+    case SENFLD_CONV_FF_GAIN:
+    case SENFLD_CONV_DCOUT_SETPOINT:
+        return(sen_IsFloatFinite(value));
+
+  #ifdef OPTION_HAS_CHARGER
+        // custom recipe values; ignored unless the recipe is custom
+    case SENFLD_CHGR_BATT_RECIPE_FLOAT_THRESHOLD:
+    case SENFLD_CHGR_BATT_RECIPE_EQ_VOLTS_MAX:
+    case SENFLD_CHGR_BATT_RECIPE_EQ_VSETPOINT:
+    case SENFLD_CHGR_BATT_RECIPE_CV_VSETPOINT:
+    case SENFLD_CHGR_BATT_RECIPE_CV_VOLTS_MAX:
+    case SENFLD_CHGR_BATT_RECIPE_FLOAT_VSETPOINT:
+    case SENFLD_CHGR_BATT_RECIPE_FLOAT_VOLTS_MAX:
+        return(isCustomRecipe && sen_IsFloatFinite(value));
+    case SENFLD_CHGR_BATT_RECIPE_MAX_AMP_HOURS:
+    case SENFLD_CHGR_BATT_RECIPE_CV_ROC_SDEV_THRES:
+    case SENFLD_CHGR_BATT_RECIPE_CV_ROC_TIMEOUT:
+    case SENFLD_CHGR_BATT_RECIPE_CV_TIMEOUT:
+    case SENFLD_CHGR_BATT_RECIPE_EQ_TIMEOUT:
+    case SENFLD_CHGR_BATT_RECIPE_FLOAT_TIMEOUT:
+    case SENFLD_CHGR_BATT_RECIPE_WARM_BATT_TEMP_RECOV:
+    case SENFLD_CHGR_BATT_RECIPE_WARM_BATT_TEMP_THRES:
+    case SENFLD_CHGR_BATT_RECIPE_SHUTDOWN_TEMP_RECOV:
+    case SENFLD_CHGR_BATT_RECIPE_SHUTDOWN_TEMP_THRES:
+        return(isCustomRecipe);
+  #endif
+    } // switch
+
+    // read only, not settable here (SENFLD_INV_AC_SETPOINT, _SUPPLY_LOW_HYSTER)
+    // or no such field
+    return(0);
+}
+
 // ----------------------------------------------------------------------
 // returns device features bitmask
 static uint16_t DeviceFeatures(void)
@@ -361,6 +512,7 @@ int16_t sen_GetField(CAN_DATA* canData, CAN_DATA* outData, CAN_LEN* ndata)   //
     case SENFLD_DEV_AUX_MODE:             GETINT16(g_nvm.settings.dev.aux_mode);                break; // INT16 (need to read nvm value)
     case SENFLD_DEV_PUSH_BTN_ENABLE:      GETINT16(g_nvm.settings.dev.pushbutton_enabled);      break; // INT16 (need to read nvm value)
     case SENFLD_DEV_HAS_BATT_TEMP_SENSOR: GETINT16(g_nvm.settings.dev.batt_temp_sense_present); break; // INT16 (need to read nvm value)
+    case SENFLD_DEV_FAST_XFER_ENABLE:     GETINT16(Device.config.fast_xfer_enabled);             break; // INT16
     
         // can bus                  
     case SENFLD_CAN_BAUD:            GETINT16(g_can.baud);       break; // INT16
@@ -451,6 +603,9 @@ int16_t sen_GetField(CAN_DATA* canData, CAN_DATA* outData, CAN_LEN* ndata)   //
     case SENFLD_INV_LOADSENSE_INTERVAL:	         GETINT16(Inv.config.load_sense_interval);      break; // INT16
     case SENFLD_INV_LOADSENSE_THRESHOLD:         GETINT16(Inv.config.load_sense_threshold);     break; // INT16
     case SENFLD_INV_LOADSENSE_TIMER:	         GETINT16(Inv.status.load_sense_timer);         break; // INT16
+    case SENFLD_INV_LOADSENSE_INTERVAL_MAX:      GETINT16(Inv.config.load_sense_interval_max);  break; // INT16
+    case SENFLD_INV_LOADSENSE_PROBE_INTERVAL:    GETINT16(g_lsense.interval);                   break; // INT16
+    case SENFLD_INV_LOADSENSE_JOULES_PER_HR:     GETINT16(g_lsense.joulesPerHour);              break; // INT16
 	                                                                                            
     case SENFLD_TMR_SHUTDOWN_ENABLE:	         GETINT16(Device.status.tmr_shutdown_enabled);  break; // INT16	
     case SENFLD_TMR_SHUTDOWN_ENABLE_ON_STARTUP:	 GETINT16(Device.config.tmr_shutdown_enabled);  break; // INT16	
@@ -466,6 +621,11 @@ int16_t sen_GetField(CAN_DATA* canData, CAN_DATA* outData, CAN_LEN* ndata)   //
     case SENFLD_INV_I_GAIN:                      GETQ16(&Inv.config.i_gain);	                                break; // Q16
     case SENFLD_INV_D_GAIN:                      GETQ16(&Inv.config.d_gain);	                                break; // Q16
     case SENFLD_INV_I_LIMIT:                     GETINT16(Inv.config.i_limit);                                  break; // INT16
+    case SENFLD_INV_VLOOP_MODE:                  GETINT16(Inv.config.vloop_mode);                               break; // UINT16
+    case SENFLD_INV_RC_GAIN:                     GETQ16(&Inv.config.rc_gain);                                   break; // Q16
+    case SENFLD_INV_RC_FORGET:                   GETINT16(Inv.config.rc_forget);                                break; // UINT16
+    case SENFLD_INV_RC_LIMIT:                    GETINT16(Inv.config.rc_limit);                                 break; // INT16
+    case SENFLD_INV_RC_LEAD:                     GETINT16(Inv.config.rc_lead);                                  break; // UINT16
 
     // battery voltage thresholds
     case SENFLD_INV_SUPPLY_LOW_HYSTER:           GETFLOAT(VBATT_ADC_VOLTS(InvCfgVBattLoHyster()  ));    break; // FLOAT
@@ -475,6 +635,18 @@ int16_t sen_GetField(CAN_DATA* canData, CAN_DATA* outData, CAN_LEN* ndata)   //
     case SENFLD_INV_SUPPLY_HIGH_RECOVER:         GETFLOAT(VBATT_ADC_VOLTS(InvCfgVBattHiRecover() ));    break; // FLOAT
     case SENFLD_INV_SUPPLY_HIGH_THRES:           GETFLOAT(VBATT_ADC_VOLTS(InvCfgVBattHiThresh()  ));    break; // FLOAT
     case SENFLD_INV_SUPPLY_HIGH_SHUTDOWN:        GETFLOAT(VBATT_ADC_VOLTS(InvCfgVBattHiShutDown()));    break; // FLOAT
+
+    // I2t thermal overload model
+  #if IS_PCB_LPC
+    case SENFLD_INV_OVL_RATED_RMS:               GETINT16(Inv.config.ovl_rated_rms);                            break; // INT16
+    case SENFLD_INV_OVL_FET_TAU:                 GETINT16(Inv.config.ovl_fet_tau);                              break; // UINT16
+    case SENFLD_INV_OVL_FET_LIMIT:               GETINT16(Inv.config.ovl_fet_limit);                            break; // UINT16
+    case SENFLD_INV_OVL_XFMR_TAU:                GETINT16(Inv.config.ovl_xfmr_tau);                             break; // UINT16
+    case SENFLD_INV_OVL_XFMR_LIMIT:              GETINT16(Inv.config.ovl_xfmr_limit);                           break; // UINT16
+    case SENFLD_INV_OVL_HS_TEMP_MAX:             GETINT16(Inv.config.ovl_hs_temp_max);                          break; // INT16
+    case SENFLD_INV_OVL_FET_RISE:                GETINT16(inv_ThermalFetPct());                                 break; // INT16
+    case SENFLD_INV_OVL_XFMR_RISE:               GETINT16(inv_ThermalXfmrPct());                                break; // INT16
+  #endif
                                             
     // charger                              
     case SENFLD_CHGR_STATUS:                            GETINT16(Chgr.status.all_flags);                                       break; // INT16
@@ -566,7 +738,7 @@ int16_t sen_GetField(CAN_DATA* canData, CAN_DATA* outData, CAN_LEN* ndata)   //
     {
         // field type not set
         *ndata = 4;
-        LOG(SS_SEN, SV_ERR, "GetField Invalid#=%u", fieldNum);
+        if (!s_batchQuiet) LOG(SS_SEN, SV_ERR, "GetField Invalid#=%u", fieldNum);
         return(1);  // invalid field
     }
 
@@ -577,33 +749,250 @@ int16_t sen_GetField(CAN_DATA* canData, CAN_DATA* outData, CAN_LEN* ndata)   //
     {
     case SENFLD_TYPE_INT16:
         *ndata = 6;
-        LOG(SS_SEN, SV_INFO, "GetField #=%u  uint16=%u", fieldNum, *pInt16);
+        if (!s_batchQuiet) LOG(SS_SEN, SV_INFO, "GetField #=%u  uint16=%u", fieldNum, *pInt16);
         break;
 
     case SENFLD_TYPE_FLOAT:
         *ndata = 8;
-        LOG(SS_SEN, SV_INFO, "GetField #=%u  float=%.5f", fieldNum, *pFloat);
+        if (!s_batchQuiet) LOG(SS_SEN, SV_INFO, "GetField #=%u  float=%.5f", fieldNum, *pFloat);
         break;
 
     case SENFLD_TYPE_INT32:
         *ndata = 8;
-        LOG(SS_SEN, SV_INFO, "GetField #=%u  uint32A=%lu", fieldNum, *pInt32);
+        if (!s_batchQuiet) LOG(SS_SEN, SV_INFO, "GetField #=%u  uint32A=%lu", fieldNum, *pInt32);
         break;
 
     case SENFLD_TYPE_STRING:
         strA[SENFLD_MAX_STRING] = 0;   // guarantee null terminate
         len = strlen(strA);
         *ndata = (4 + len);
-        LOG(SS_SEN, SV_INFO, "GetField #=%u  len=%u str=%s", fieldNum, len, strA);
+        if (!s_batchQuiet) LOG(SS_SEN, SV_INFO, "GetField #=%u  len=%u str=%s", fieldNum, len, strA);
         break;
 		
     case SENFLD_TYPE_Q16:
         *ndata = 8;
-        LOG(SS_SEN, SV_INFO, "GetField #=%u  Q16=%X%X.%X%X", fieldNum, outData[7], outData[6], outData[5], outData[4]);
+        if (!s_batchQuiet) LOG(SS_SEN, SV_INFO, "GetField #=%u  Q16=%X%X.%X%X", fieldNum, outData[7], outData[6], outData[5], outData[4]);
         break;			
     } // switch
 
     return(0); // ok
 }
 
+// ----------------------------------------------------------------------
+//              B A T C H E D    G E T / S E T    F I E L D S
+// ----------------------------------------------------------------------
+
+// ----------------------------------------------------------------------
+// sequence a request frame into the batch
+// returns: 0=take the frame, 1=ignore it, 2=batch dropped
+static int16_t sen_BatchFrame(uint8_t isSet, uint8_t ctrl)
+{
+    uint8_t seq = ctrl & SEN_BATCH_SEQ_MASK;
+
+    if (seq == 0)
+    {
+        // either batch would overwrite the get response going out
+        if (J1939_IsMultiPacketBusy())
+        {
+            LOG(SS_SEN, SV_ERR, "Batch dropped; response busy");
+            s_batch.dropped = 1;
+            return(2);
+        }
+        // start a new batch; abandons one in progress
+        s_batch.isSet   = isSet;
+        s_batch.nextSeq = 0;
+        s_batch.dropped = 0;
+        s_batch.count   = 0;
+    }
+    if (s_batch.dropped) return(1);
+
+    if (s_batch.isSet != isSet || seq != s_batch.nextSeq)
+    {
+        LOG(SS_SEN, SV_ERR, "Batch dropped seq=%u expected=%u", seq, s_batch.nextSeq);
+        s_batch.dropped = 1;
+        return(2);
+    }
+    s_batch.nextSeq = (seq + 1) & SEN_BATCH_SEQ_MASK;
+    return(0);
+}
+
+// ----------------------------------------------------------------------
+// append one field to the get response at *pos; the entry must end by limit
+// returns: 0=added, 1=field does not exist and skipInvalid, 2=no room,
+//          3=field does not exist and was added empty
+static int16_t sen_BatchAppend(SENFLD fieldNum, uint8_t skipInvalid, uint16_t* pos, uint16_t limit)
+{
+    CAN_DATA  req[3];
+    CAN_DATA  out[SENFLD_MAX_BYTES];
+    CAN_LEN   ndata;
+    CAN_DATA* p;
+    uint8_t   nval;
+    int16_t   invalid;
+
+    req[0] = s_batch.rsp[0];
+    req[1] = LOBYTE(fieldNum);
+    req[2] = HIBYTE(fieldNum);
+    invalid = sen_GetField(req, out, &ndata);
+    if (invalid && skipInvalid) return(1);
+
+    nval = ndata - 4;   // value bytes; 0 for an invalid field
+    if (*pos + 4 + nval > limit) return(2);
+
+    p = &s_batch.rsp[*pos];
+    p[0] = out[1];      // field number
+    p[1] = out[2];
+    p[2] = out[3];      // type
+    p[3] = nval;
+    memcpy(&p[4], &out[4], nval);
+    *pos += 4 + nval;
+    return(invalid ? 3 : 0);
+}
+
+// ----------------------------------------------------------------------
+// batched get; see sensata_can.h for the frame layout
+// the response is sent after the last frame, all fields read in one pass
+// returns: 0=more frames expected, 1=response started, 2=batch dropped
+int16_t sen_GetFields(CAN_DATA* canData)
+{
+    uint8_t  ctrl = canData[1];
+    uint16_t pos, i, limit, nentries = 0, ninvalid = 0;
+    SENFLD   fieldNum, lastNum;
+    CAN_DATA* list = &s_batch.rsp[SEN_BATCH_LIST_AT];
+    int16_t  rc;
+
+    rc = sen_BatchFrame(0, ctrl);
+    if (rc == 1) return(0);
+    if (rc) return(rc);
+
+    if (ctrl & SEN_BATCH_RANGE)
+    {
+        // a range is a batch of its own
+        if ((ctrl & (SEN_BATCH_SEQ_MASK|SEN_BATCH_LAST)) != SEN_BATCH_LAST)
+        {
+            s_batch.dropped = 1;
+            return(2);
+        }
+    }
+    else
+    {
+        for (i=0; i<3; i++)
+        {
+            fieldNum = MKWORD(canData[2+i*2], canData[3+i*2]);
+            if (fieldNum == 0xFFFF) continue;   // unused
+            if (s_batch.count >= SEN_BATCH_FIELDS)
+            {
+                LOG(SS_SEN, SV_ERR, "GetFields too many");
+                s_batch.dropped = 1;
+                return(2);
+            }
+            list[s_batch.count*2]   = LOBYTE(fieldNum);
+            list[s_batch.count*2+1] = HIBYTE(fieldNum);
+            s_batch.count++;
+        }
+        if (!(ctrl & SEN_BATCH_LAST)) return(0);
+    }
+    s_batch.dropped = 1;    // done; ignore stray frames until the next batch
+
+    // response buffer still going out?
+    if (J1939_IsMultiPacketBusy()) return(2);
+
+    s_batch.rsp[0] = canData[0];    // instance
+    pos = 2;
+    s_batchQuiet = 1;
+    if (ctrl & SEN_BATCH_RANGE)
+    {
+        fieldNum = MKWORD(canData[2], canData[3]);
+        lastNum  = MKWORD(canData[4], canData[5]);
+        for (i=0; i<SEN_BATCH_RANGE_MAX && fieldNum <= lastNum; i++, fieldNum++)
+        {
+            rc = sen_BatchAppend(fieldNum, 1, &pos, SEN_BATCH_RSP_BYTES);
+            if (rc == 2) break;     // full
+            if (rc == 0) nentries++;    // a range leaves out the gaps
+        }
+    }
+    else
+    {
+        for (i=0; i<s_batch.count; i++)
+        {
+            // the entry may not reach the next field number still to be read
+            fieldNum = MKWORD(list[i*2], list[i*2+1]);
+            limit = (i+1 < s_batch.count) ? SEN_BATCH_LIST_AT + (i+1)*2 : SEN_BATCH_RSP_BYTES;
+            rc = sen_BatchAppend(fieldNum, 0, &pos, limit);
+            if (rc == 2) break;     // full
+            if (rc == 3) ninvalid++;
+            nentries++;
+        }
+    }
+    s_batchQuiet = 0;
+    s_batch.rsp[1] = (CAN_DATA)nentries;
+
+    LOG(SS_SEN, SV_INFO, "GetFields n=%u bytes=%u", nentries, pos);
+    if (ninvalid) LOG(SS_SEN, SV_ERR, "GetFields %u fields do not exist", ninvalid);
+    J1939_StartMultiPacket(SENSATA_CUSTOM_GET_FIELDS_RSP_DGN, pos, s_batch.rsp);
+    return(1);
+}
+
+// ----------------------------------------------------------------------
+// batched set; see sensata_can.h for the frame layout
+// fields are held until the last frame, all checked, and then set in one
+// pass; the nvm task cannot run in between so the changes go out in one
+// settings save. One entry failing the check leaves every setting as it was.
+// returns: 0=more frames expected, 1=applied, 2=batch dropped or refused
+int16_t sen_SetFields(CAN_DATA* canData)
+{
+    uint8_t  ctrl = canData[7];
+    CAN_DATA req[MAX_CAN_DATA];
+    SEN_BATCH_ENTRY_t* pe;
+    uint16_t i;
+    int16_t  rc;
+    uint8_t  isCustom = 0;
+
+    rc = sen_BatchFrame(1, ctrl);
+    if (rc == 1) return(0);
+    if (rc) return(rc);
+
+    if (s_batch.count >= SEN_BATCH_FIELDS)
+    {
+        LOG(SS_SEN, SV_ERR, "SetFields too many");
+        s_batch.dropped = 1;
+        return(2);
+    }
+    pe = &s_batch.entry[s_batch.count++];
+    pe->field = MKWORD(canData[1], canData[2]);
+    memcpy(pe->value, &canData[3], 4);
+    if (!(ctrl & SEN_BATCH_LAST)) return(0);
+    s_batch.dropped = 1;    // done; ignore stray frames until the next batch
+
+    // check them all before setting any
+  #ifdef OPTION_HAS_CHARGER
+    isCustom = Chgr.config.battery_recipe.is_custom ? 1 : 0;
+  #endif
+    for (i=0; i<s_batch.count; i++)
+    {
+        pe = &s_batch.entry[i];
+        if (!sen_IsFieldSettable(pe->field, pe->value, isCustom))
+        {
+            LOG(SS_SEN, SV_ERR, "SetFields refused; field %u of %u #=%u", i, s_batch.count, pe->field);
+            return(2);
+        }
+      #ifdef OPTION_HAS_CHARGER
+        if (pe->field == SENFLD_CHGR_BATT_RECIPE_CUSTOM_FLAG) isCustom = MKWORD(pe->value[0], pe->value[1]) ? 1 : 0;
+      #endif
+    }
+
+    // apply them all
+    req[0] = canData[0];    // instance
+    req[7] = 0;
+    for (i=0; i<s_batch.count; i++)
+    {
+        pe = &s_batch.entry[i];
+        req[1] = LOBYTE(pe->field);
+        req[2] = HIBYTE(pe->field);
+        memcpy(&req[3], pe->value, 4);
+        sen_SetField(req);
+    }
+    LOG(SS_SEN, SV_INFO, "SetFields n=%u", s_batch.count);
+    return(1);
+}
+
 // <><><><><><><><><><><><><> sensata_can.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -26,6 +26,16 @@
 #define SENSATA_CUSTOM_SET_FIELD_RSP_DGN    0x1FA02
 #define SENSATA_CUSTOM_GET_FIELD_DGN        0x1FA03
 #define SENSATA_CUSTOM_GET_FIELD_RSP_DGN    0x1FA04
+#define SENSATA_CUSTOM_TELEMETRY_DGN        0x1FA05  // start/stop streaming; see telemetry.h
+#define SENSATA_CUSTOM_TELEMETRY_DATA_DGN   0x1FA06  // streamed samples
+#define SENSATA_CUSTOM_EVLOG_DGN            0x1FA07  // event log bulk read; see evlog.h
+#define SENSATA_CUSTOM_EVLOG_DATA_DGN       0x1FA08  // event log records
+#define SENSATA_CUSTOM_GET_FIELDS_DGN       0x1FA09  // batched get; see sen_GetFields()
+#define SENSATA_CUSTOM_GET_FIELDS_RSP_DGN   0x1FA0A  // batched get response; one multi-packet transfer
+#define SENSATA_CUSTOM_SET_FIELDS_DGN       0x1FA0B  // batched set; see sen_SetFields()
+#define SENSATA_CUSTOM_FWUP_DGN             0x1FA0C  // firmware update command; see fwupdate.h
+#define SENSATA_CUSTOM_FWUP_DATA_DGN        0x1FA0D  // firmware row; multi-packet
+#define SENSATA_CUSTOM_FWUP_STATUS_DGN      0x1FA0E  // firmware update status
 
 // Sensata Custom Field Types
 typedef uint16_t  SENFLD; 
@@ -87,6 +97,7 @@ typedef uint16_t  SENFLD;
 #define SENFLD_DEV_AUX_MODE                              19 	// INT16  auxillary input mode 0=Disabled, 1=RV,   2=Utility,   3=Wired Control (LPC only)(LPC only; requires reboot when changed)
 #define SENFLD_DEV_PUSH_BTN_ENABLE                       20 	// INT16  push button enabled  0=disabled, 1=enabled (LPC only; requires reboot when changed)
 #define SENFLD_DEV_HAS_BATT_TEMP_SENSOR                  21 	// INT16  0=no, 1=battery temp sensor is present
+#define SENFLD_DEV_FAST_XFER_ENABLE                      22 	// INT16  0=disabled, 1=phase synchronized line/inverter transfer
 
 // can bus
 #define SENFLD_CAN_BAUD                                 101    // UINT16 CAN Bus baud rate: 0=250k, 1=500k, 2=1m         (requires reboot)
@@ -176,6 +187,9 @@ typedef uint16_t  SENFLD;
 #define SENFLD_INV_LOADSENSE_INTERVAL                   404    // UINT16 delay between pings [resolution = .5-sec]               
 #define SENFLD_INV_LOADSENSE_THRESHOLD                  405    // FLOAT  load RMS threshold (adc counts)
 #define SENFLD_INV_LOADSENSE_TIMER                      406    // UINT16 start pinging when this timer expires
+#define SENFLD_INV_LOADSENSE_INTERVAL_MAX               407    // UINT16 longest delay between pings with no load [resolution = .5-sec]
+#define SENFLD_INV_LOADSENSE_PROBE_INTERVAL             408    // UINT16 (read only) delay to the next ping [resolution = .5-sec]
+#define SENFLD_INV_LOADSENSE_JOULES_PER_HR              409    // UINT16 (read only) estimated ping energy over the last hour of load-sensing (joules); see load_sense.h
 
 // shut down timer
 #define SENFLD_TMR_SHUTDOWN_ENABLE	 					410    // UINT16 0=no, 1=enable
@@ -192,6 +206,11 @@ typedef uint16_t  SENFLD;
 #define SENFLD_INV_I_GAIN                               512    // Q16  Integral gain value      (0=no gain multiplier)
 #define SENFLD_INV_D_GAIN                               513    // Q16  Differential gain value  (0=no gain multiplier)
 #define SENFLD_INV_I_LIMIT                              514    // UINT16 Integral limit value   (adc counts)
+#define SENFLD_INV_VLOOP_MODE                           515    // UINT16 0=PID, 1=PID+repetitive, 2=PID+resonant
+#define SENFLD_INV_RC_GAIN                              516    // Q16  Harmonic compensation learning gain
+#define SENFLD_INV_RC_FORGET                            517    // UINT16 Harmonic compensation kept per a/c cycle (Q16 fraction)
+#define SENFLD_INV_RC_LIMIT                             518    // INT16  Harmonic compensation limit (duty counts)
+#define SENFLD_INV_RC_LEAD                              519    // UINT16 Harmonic compensation phase lead (PWM periods)
 // supply (ie battery) voltage thresholds
 #define SENFLD_INV_SUPPLY_LOW_HYSTER                    520    // FLOAT  Supply Low Hystesis   (volts)
 #define SENFLD_INV_SUPPLY_LOW_RECOVER                   521    // FLOAT  Supply Recovery       (volts)
@@ -200,6 +219,15 @@ typedef uint16_t  SENFLD;
 #define SENFLD_INV_SUPPLY_HIGH_RECOVER                  524    // FLOAT  Supply High Recovery  (volts)
 #define SENFLD_INV_SUPPLY_HIGH_THRES                    525    // FLOAT  Supply High Threshold (volts)
 #define SENFLD_INV_SUPPLY_HIGH_SHUTDOWN                 526    // FLOAT  Supply High Shutdown  (volts)
+// I2t thermal overload model (LPC)
+#define SENFLD_INV_OVL_RATED_RMS                        530    // INT16  IMeas RMS at 100% output (adc counts)
+#define SENFLD_INV_OVL_FET_TAU                          531    // UINT16 FET time constant (0.1 sec)
+#define SENFLD_INV_OVL_FET_LIMIT                        532    // UINT16 FET rise limit (% of rise at rated output)
+#define SENFLD_INV_OVL_XFMR_TAU                         533    // UINT16 Transformer time constant (0.1 sec)
+#define SENFLD_INV_OVL_XFMR_LIMIT                       534    // UINT16 Transformer rise limit (% of rise at rated output)
+#define SENFLD_INV_OVL_HS_TEMP_MAX                      535    // INT16  Heat sink temperature with no surge left (Celsius)
+#define SENFLD_INV_OVL_FET_RISE                         536    // INT16  (read only) FET rise (% of rise at rated output)
+#define SENFLD_INV_OVL_XFMR_RISE                        537    // INT16  (read only) Transformer rise (% of rise at rated output)
 
 // charger                                  
 #define SENFLD_CHGR_STATUS                              601    // UINT16 (read only)  bit mapped
@@ -301,11 +329,83 @@ typedef uint16_t  SENFLD;
 // max buffer needed for retrieving field data
 #define SENFLD_MAX_BYTES     (MAX_CAN_DATA+SENFLD_MAX_STRING+1)  // 8 + 32 + 1 = 41
 
+// --------------------------------------------------------------
+// Batched fields
+//
+//  A service tool screen needs dozens of fields. Instead of one
+//  request/response round trip per field the tool sends the whole list
+//  and gets one multi-packet response, or sets them all at once.
+//  The request frames of a batch carry a sequence number; the frame
+//  with sequence 0 starts a new batch and a missing frame drops it.
+//
+//  Get request:  SENSATA_CUSTOM_GET_FIELDS_DGN
+//    data[0]    instance
+//    data[1]    bits 0..5 frame sequence number, bit 6 range, bit 7 last frame
+//    data[2..7] up to 3 field numbers (lsb first); 0xFFFF=unused
+//               range: data[2..3] first field, data[4..5] last field;
+//                      fields that do not exist are left out
+//  Get response: SENSATA_CUSTOM_GET_FIELDS_RSP_DGN, sent after the last frame
+//    [0]        instance
+//    [1]        number of entries that follow; fewer than asked if the
+//               response buffer filled up, which only string fields do:
+//               SEN_BATCH_FIELDS numeric fields always fit
+//    entry      field lo, field hi, field type, n, n value bytes
+//               (as in Field Payload; n=0 for a field that does not exist)
+//  The field list of a get is kept at the end of the response buffer and
+//  the response is built over it from the front; an entry is never longer
+//  than 8 bytes and a field number 2, so a numeric entry never reaches a
+//  field number not yet read. A get or set batch that starts while the
+//  response is still going out is dropped; they all share one buffer.
+//
+//  Set request:  SENSATA_CUSTOM_SET_FIELDS_DGN, one field per frame
+//    data[0]    instance
+//    data[1..2] field number
+//    data[3..6] value (as in Field Payload)
+//    data[7]    bits 0..5 frame sequence number, bit 7 last frame
+//  Nothing is applied until the last frame arrives. Then every entry is
+//  checked (sen_IsFieldSettable()) and, only if all pass, every field is
+//  set in one pass so the settings go to NVM in a single save. ACK when
+//  applied, NAK when the batch was dropped or an entry failed the check;
+//  nothing was changed then.
+// --------------------------------------------------------------
+#define SEN_BATCH_FIELDS        64      // max fields in one batch; a service tool screen is ~60
+#define SEN_BATCH_RSP_BYTES     (2 + SEN_BATCH_FIELDS*8)  // fits 64 numeric fields
+#define SEN_BATCH_LIST_AT       (SEN_BATCH_RSP_BYTES - SEN_BATCH_FIELDS*2)  // get field list in rsp[]
+#define SEN_BATCH_RANGE_MAX     256     // max field numbers a range request scans
+#define SEN_BATCH_SEQ_MASK      0x3F
+#define SEN_BATCH_RANGE         0x40
+#define SEN_BATCH_LAST          0x80
+
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    SENFLD    field;
+    CAN_DATA  value[4];         // set only
+} SEN_BATCH_ENTRY_t;
+
+typedef struct
+{
+    uint8_t   isSet;            // 0=get, 1=set batch being received
+    uint8_t   nextSeq;          // sequence number of the next frame
+    uint8_t   dropped;          // 1=ignore frames until the next sequence 0
+    uint8_t   count;            // entries received
+    union
+    {
+        SEN_BATCH_ENTRY_t entry[SEN_BATCH_FIELDS];     // set
+        CAN_DATA  rsp[SEN_BATCH_RSP_BYTES];            // get; field list from SEN_BATCH_LIST_AT
+                                                       // busy while J1939_IsMultiPacketBusy()
+    };
+} SEN_BATCH_t;      // 518 bytes
+#pragma pack()  // restore packing setting
+
 // -----------
 // Prototyping
 // -----------
 int16_t  sen_SetField(CAN_DATA* msgData);
 int16_t  sen_GetField(CAN_DATA* msgData, CAN_DATA* outData, CAN_LEN* ndata);
+int16_t  sen_GetFields(CAN_DATA* msgData);
+int16_t  sen_SetFields(CAN_DATA* msgData);
+int16_t  sen_IsFieldSettable(SENFLD fieldNum, const CAN_DATA* value, uint8_t isCustomRecipe);
 uint16_t IsInTestMode(void);
 uint16_t GetLedTestColor(void);
 
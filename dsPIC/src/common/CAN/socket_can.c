@@ -0,0 +1,305 @@
+// <><><><><><><><><><><><><> socket_can.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2015 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host bridge for the CAN stack (see socket_can.h)
+//
+//  The DMA buffers are serviced the way the ECAN module would:
+//  one pending transmit frame and one receive frame per _C1Interrupt() call.
+//  Frames go out back to back at the bit rate of g_can.baud, as on the wire,
+//  however often the host loop polls.
+//  System ticks follow the host monotonic clock in place of the T1 interrupt.
+//
+//-----------------------------------------------------------------------------
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "dsPIC33_CAN.h"
+#include "socket_can.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/can/error.h>
+
+// -------------------
+// access global data
+// -------------------
+extern volatile uint16_t g_canTxDmaBuf[][CAN_DMA_WORDS];
+extern volatile uint16_t g_canRxDmaBuf[][CAN_DMA_WORDS];
+extern volatile int16_t  _T1TickCount;
+void _C1Interrupt(void);
+
+// -------------------------
+// ECAN register stand-ins
+// -------------------------
+volatile SOCKCAN_C1INTF_t     C1INTFbits;
+volatile SOCKCAN_C1INTE_t     C1INTEbits;
+volatile SOCKCAN_C1RXFUL1_t   C1RXFUL1bits;
+volatile SOCKCAN_C1EC_t       C1ECbits;
+volatile SOCKCAN_C1CTRL1_t    C1CTRL1bits;
+volatile SOCKCAN_C1CFG1_t     C1CFG1bits;
+volatile SOCKCAN_C1RXF0SID_t  C1RXF0SIDbits;
+volatile SOCKCAN_C1TR01CON_t  C1TR01CONbits;
+volatile SOCKCAN_IFS0_t       IFS0bits;
+volatile SOCKCAN_IFS1_t       IFS1bits;
+volatile SOCKCAN_IFS2_t       IFS2bits;
+volatile SOCKCAN_IEC2_t       IEC2bits;
+volatile uint16_t             C1RXF0SID;
+volatile uint16_t             C1RXF0EID;
+volatile uint16_t             C1RXOVF1;
+
+// ---------
+// constants
+// ---------
+#define SOCKCAN_FRAME_BITS      (131)   // 29 bit id, 8 data bytes, typical stuffing, ifs
+#define SOCKCAN_MAX_BURST_USEC  (5000)  // wire time a late poll may catch up on
+
+// ----------
+// local data
+// ----------
+static int      s_sock = -1;        // raw CAN socket; -1=closed
+static uint32_t s_startMsec = 0;    // host clock at open
+static uint64_t s_wireUsec = 0;     // host clock the wire is busy until
+
+// ------------------------------------------------------------------------------------
+// host monotonic clock in milliseconds
+static uint32_t sockcan_HostMsec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((uint32_t)(ts.tv_sec*1000UL + ts.tv_nsec/1000000UL));
+}
+
+// ------------------------------------------------------------------------------------
+// host monotonic clock in microseconds
+static uint64_t sockcan_HostUsec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((uint64_t)ts.tv_sec*1000000ULL + ts.tv_nsec/1000UL);
+}
+
+// ------------------------------------------------------------------------------------
+// time one frame takes on the wire; CAN_BAUD_250K, _500K, _1000K double the rate
+static uint32_t sockcan_FrameUsec(void)
+{
+    return((SOCKCAN_FRAME_BITS * 4UL + (1U << g_can.baud) - 1) / (1U << g_can.baud));
+}
+
+// ------------------------------------------------------------------------------------
+// open a non-blocking raw socket on the host CAN interface
+// returns 0=ok, 1=failed
+int16_t sockcan_Open(void)
+{
+    struct sockaddr_can addr;
+    struct ifreq        ifr;
+    can_err_mask_t      errMask = CAN_ERR_BUSOFF | CAN_ERR_RESTARTED | CAN_ERR_CRTL | CAN_ERR_CNT;
+    const char* ifname = getenv("CAN_IFNAME");
+
+    if (ifname == 0 || *ifname == 0) ifname = "vcan0";
+    sockcan_Close();
+
+    s_sock = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (s_sock < 0)
+    {
+        LOG(SS_CAN, SV_ERR, "SocketCAN open failed errno=%d", errno);
+        return(1);
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ-1);
+    if (ioctl(s_sock, SIOCGIFINDEX, &ifr) < 0)
+    {
+        LOG(SS_CAN, SV_ERR, "SocketCAN no interface '%s'", ifname);
+        sockcan_Close();
+        return(1);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family  = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(s_sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        LOG(SS_CAN, SV_ERR, "SocketCAN bind '%s' failed errno=%d", ifname, errno);
+        sockcan_Close();
+        return(1);
+    }
+    setsockopt(s_sock, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &errMask, sizeof(errMask));
+    fcntl(s_sock, F_SETFL, fcntl(s_sock, F_GETFL, 0) | O_NONBLOCK);
+
+    s_startMsec = sockcan_HostMsec() - (uint32_t)_SysTicks;
+    LOG(SS_CAN, SV_INFO, "SocketCAN on '%s'", ifname);
+    return(0);
+}
+
+// ------------------------------------------------------------------------------------
+void sockcan_Close(void)
+{
+    if (s_sock >= 0) close(s_sock);
+    s_sock = -1;
+}
+
+// ------------------------------------------------------------------------------------
+// transmit the frame waiting in dma buffer 0
+// returns: 0=sent or nothing to send, 1=interface busy; retry later
+static int16_t sockcan_Transmit(void)
+{
+    struct can_frame cf;
+    uint16_t word0, word1, word2;
+    int i;
+
+    if (!C1TR01CONbits.TXREQ0) return(0);
+
+    word0 = g_canTxDmaBuf[0][0];
+    word1 = g_canTxDmaBuf[0][1];
+    word2 = g_canTxDmaBuf[0][2];
+
+    memset(&cf, 0, sizeof(cf));
+    if (word0 & 0x0001)
+    {
+        // extended identifier (29 bit)
+        cf.can_id = CAN_EFF_FLAG
+                  | ((canid_t)(word0 & 0x1FFC) << 16)
+                  | ((canid_t)(word1 & 0x0FFF) << 6)
+                  | (canid_t)(word2 >> 10);
+        if (word2 & 0x0200) cf.can_id |= CAN_RTR_FLAG;
+    }
+    else
+    {
+        // standard identifier (11 bit)
+        cf.can_id = (word0 & 0x1FFC) >> 2;
+        if (word0 & 0x0002) cf.can_id |= CAN_RTR_FLAG;
+    }
+    cf.can_dlc = word2 & 0x0F;
+    if (cf.can_dlc > MAX_CAN_DATA) cf.can_dlc = MAX_CAN_DATA;
+    for (i=0; i<4; i++)
+    {
+        uint16_t w = g_canTxDmaBuf[0][3+i];
+        cf.data[i*2]   = (uint8_t)(w     );
+        cf.data[i*2+1] = (uint8_t)(w >> 8);
+    }
+
+    if (write(s_sock, &cf, sizeof(cf)) != (ssize_t)sizeof(cf))
+    {
+        if (errno == EAGAIN || errno == ENOBUFS) return(1);  // tx queue full; still pending
+        LOG(SS_CAN, SV_ERR, "SocketCAN write failed errno=%d", errno);
+    }
+
+    // transmit complete
+    C1TR01CONbits.TXREQ0 = 0;
+    C1INTFbits.TBIF = 1;
+    IFS2bits.C1IF   = 1;
+    if (IEC2bits.C1IE) _C1Interrupt();
+    return(0);
+}
+
+// ------------------------------------------------------------------------------------
+// move one received socket frame into dma buffer 0 and raise the receive interrupt
+// returns: 0=frame delivered, 1=nothing to receive
+static int16_t sockcan_Receive(void)
+{
+    struct can_frame cf;
+    uint16_t word2;
+    int i;
+
+    if (read(s_sock, &cf, sizeof(cf)) != (ssize_t)sizeof(cf)) return(1);
+    if (cf.can_id & CAN_ERR_FLAG)
+    {
+        // controller state from a real interface; vcan never reports these
+        if (cf.can_id & CAN_ERR_CNT)
+        {
+            C1ECbits.TERRCNT = cf.data[6];
+            C1ECbits.RERRCNT = cf.data[7];
+        }
+        if (cf.can_id & CAN_ERR_BUSOFF)    C1INTFbits.TXBO = 1;
+        if (cf.can_id & CAN_ERR_RESTARTED) C1INTFbits.TXBO = 0;
+        C1INTFbits.ERRIF = 1;
+        IFS2bits.C1IF    = 1;
+        if (IEC2bits.C1IE) _C1Interrupt();
+        return(0);
+    }
+
+    if (cf.can_id & CAN_EFF_FLAG)
+    {
+        CAN_ID id = cf.can_id & CAN_EFF_MASK;
+        g_canRxDmaBuf[0][0] = ((id >> 16) & 0x1FFC) | 0x0003;  // SRR and IDE
+        g_canRxDmaBuf[0][1] = (id >> 6) & 0x0FFF;
+        word2 = (uint16_t)((id & 0x3F) << 10);
+        if (cf.can_id & CAN_RTR_FLAG) word2 |= 0x0200;
+    }
+    else
+    {
+        g_canRxDmaBuf[0][0] = (uint16_t)((cf.can_id & CAN_SFF_MASK) << 2);
+        if (cf.can_id & CAN_RTR_FLAG) g_canRxDmaBuf[0][0] |= 0x0002;
+        g_canRxDmaBuf[0][1] = 0;
+        word2 = 0;
+    }
+    g_canRxDmaBuf[0][2] = word2 | (cf.can_dlc & 0x0F);
+    for (i=0; i<4; i++)
+    {
+        g_canRxDmaBuf[0][3+i] = cf.data[i*2] | (cf.data[i*2+1] << 8);
+    }
+    g_canRxDmaBuf[0][7] = 0;
+
+    C1RXFUL1bits.RXFUL1 = 1;
+    C1INTFbits.RBIF = 1;
+    IFS2bits.C1IF   = 1;
+    if (IEC2bits.C1IE) _C1Interrupt();
+    return(0);
+}
+
+// ------------------------------------------------------------------------------------
+// service the socket in place of the ECAN module and the T1 interrupt
+void sockcan_Poll(void)
+{
+    uint64_t now;
+    uint32_t ticks = sockcan_HostMsec() - s_startMsec;
+    if (ticks != (uint32_t)_SysTicks)
+    {
+        _T1TickCount += (int16_t)(ticks - (uint32_t)_SysTicks);
+        _SysTicks = ticks;
+    }
+
+    if (s_sock < 0) return;
+
+    // send what the wire would have carried since the last poll
+    now = sockcan_HostUsec();
+    if (s_wireUsec + SOCKCAN_MAX_BURST_USEC < now) s_wireUsec = now - SOCKCAN_MAX_BURST_USEC;
+    while (C1TR01CONbits.TXREQ0 && s_wireUsec < now)
+    {
+        if (sockcan_Transmit()) break;
+        s_wireUsec += sockcan_FrameUsec();
+    }
+    if (!C1TR01CONbits.TXREQ0 && s_wireUsec < now) s_wireUsec = now;   // wire idle
+
+    // take only what the receive queue can hold; the rest waits in the socket
+    // buffer the way frames wait on the wire
+    while (IEC2bits.C1IE && !can_IsRxQueueFull())
+    {
+        if (sockcan_Receive()) break;
+    }
+}
+
+// ------------------------------------------------------------------------------------
+// the next sockcan_Poll() would send the frame in dma buffer 0
+// returns: 0=no, 1=yes
+int16_t sockcan_IsTxDue(void)
+{
+    return((s_sock >= 0 && C1TR01CONbits.TXREQ0 && s_wireUsec < sockcan_HostUsec()) ? 1 : 0);
+}
+
+#endif // __linux__
+
+// <><><><><><><><><><><><><> socket_can.c <><><><><><><><><><><><><><><><><><><><><><>
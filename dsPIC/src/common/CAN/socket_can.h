@@ -0,0 +1,81 @@
+// <><><><><><><><><><><><><> socket_can.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2015 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Linux host bridge for the CAN stack
+//
+//  Stands in for the ECAN module so dsPIC33_CAN.c, J1939.c, rv_can.c and
+//  sensata_can.c run unchanged on a PC against a SocketCAN interface:
+//    - transmit: a frame placed in g_canTxDmaBuf[0] with TXREQ0 set is written to the socket
+//    - receive:  socket frames are placed in g_canRxDmaBuf[0] and _C1Interrupt() is called
+//
+//  Interface name is taken from the CAN_IFNAME environment variable (default "vcan0")
+//    sudo ip link add dev vcan0 type vcan
+//    sudo ip link set up vcan0
+//    candump -ta vcan0
+//
+//  Several host nodes may share one interface; give each its own address (NVM can settings).
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SOCKET_CAN_H_    // include only once
+#define _SOCKET_CAN_H_
+
+#ifdef __linux__
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// -------------------------
+// ECAN register stand-ins
+// -------------------------
+// only the registers the stack touches outside of the can_Config() hardware setup
+// the host xc.h must leave these to this header
+
+typedef struct { uint16_t TBIF:1;  uint16_t RBIF:1;  uint16_t RBOVIF:1;
+                 uint16_t ERRIF:1; uint16_t IVRIF:1; uint16_t TXBO:1;   } SOCKCAN_C1INTF_t;
+typedef struct { uint16_t TBIE:1;  uint16_t RBIE:1;  uint16_t RBOVIE:1;
+                 uint16_t ERRIE:1; uint16_t IVRIE:1;                    } SOCKCAN_C1INTE_t;
+typedef struct { uint16_t RXFUL1:1;                                     } SOCKCAN_C1RXFUL1_t;
+typedef struct { uint16_t RERRCNT:8; uint16_t TERRCNT:8;                } SOCKCAN_C1EC_t;
+typedef struct { uint16_t REQOP:3; uint16_t OPMODE:3; uint16_t ABAT:1;  } SOCKCAN_C1CTRL1_t;
+typedef struct { uint16_t BRP:6;                                        } SOCKCAN_C1CFG1_t;
+typedef struct { uint16_t EID16:1; uint16_t EID17:1;                    } SOCKCAN_C1RXF0SID_t;
+typedef struct { uint16_t TXREQ0:1;                                     } SOCKCAN_C1TR01CON_t;
+typedef struct { uint16_t DMA1IF:1;                                     } SOCKCAN_IFS0_t;
+typedef struct { uint16_t DMA2IF:1;                                     } SOCKCAN_IFS1_t;
+typedef struct { uint16_t C1IF:1;                                       } SOCKCAN_IFS2_t;
+typedef struct { uint16_t C1IE:1;                                       } SOCKCAN_IEC2_t;
+
+extern volatile SOCKCAN_C1INTF_t     C1INTFbits;
+extern volatile SOCKCAN_C1INTE_t     C1INTEbits;
+extern volatile SOCKCAN_C1RXFUL1_t   C1RXFUL1bits;
+extern volatile SOCKCAN_C1EC_t       C1ECbits;
+extern volatile SOCKCAN_C1CTRL1_t    C1CTRL1bits;
+extern volatile SOCKCAN_C1CFG1_t     C1CFG1bits;
+extern volatile SOCKCAN_C1RXF0SID_t  C1RXF0SIDbits;
+extern volatile SOCKCAN_C1TR01CON_t  C1TR01CONbits;
+extern volatile SOCKCAN_IFS0_t       IFS0bits;
+extern volatile SOCKCAN_IFS1_t       IFS1bits;
+extern volatile SOCKCAN_IFS2_t       IFS2bits;
+extern volatile SOCKCAN_IEC2_t       IEC2bits;
+extern volatile uint16_t             C1RXF0SID;
+extern volatile uint16_t             C1RXF0EID;
+extern volatile uint16_t             C1RXOVF1;
+
+// --------------------
+// Function Prototyping
+// --------------------
+int16_t sockcan_Open(void);     // returns 0=ok, 1=failed
+void    sockcan_Close(void);
+void    sockcan_Poll(void);     // call each pass of TASK_can_Driver()
+int16_t sockcan_IsTxDue(void);  // 1=a frame waits in the buffer and the wire is free for it
+
+#endif // __linux__
+
+#endif  //  _SOCKET_CAN_H_
+
+// <><><><><><><><><><><><><> socket_can.h <><><><><><><><><><><><><><><><><><><><><><>
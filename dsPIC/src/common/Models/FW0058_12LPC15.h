@@ -25,3 +25,16 @@
     // optional
     #define OPTION_HAS_CHARGER  1
     #define OPTION_CHARGE_3STEP 1
+    // inverter no-load draw from the battery at the full output, watts; load-sense probe energy
+    // (see load_sense.h). ### the 1.5 kW 12 V class figure, not yet measured on a 12LPC15
+    #define OPTION_INV_NO_LOAD_WATTS    (25.0)
+    // bridge dead time compensation (see inv_deadtime.h); duty counts (12.5 nsec) at 0, 0.5, 1.0,
+    // 1.5 output amps, held from there. The dead time is DTCON1 = 20 Tcy (pwm.c), 500 nsec or 40
+    // counts. Below the peak ripple the current goes through zero within the period and the error
+    // fades out, taken as linear to none at no current. The ripple is the transformer leakage
+    // (0.5 mH on the secondary, 16.8 turns ratio) at 12.6 V: 1.1 A peak at 10 degrees from the zero
+    // crossing, 2.2 A at 30; 1.5 A at 20, the middle of where the error shows. These are the
+    // figures of the host check "deadtime" (inv_deadtime_sim.h); not yet measured on a unit.
+    #define OPTION_INV_DTC_COUNTS       (40)
+    #define OPTION_INV_DTC_AMPS_STEP    (0.5)
+    #define OPTION_INV_DTC_DUTY         0, OPTION_INV_DTC_COUNTS/3, (2*OPTION_INV_DTC_COUNTS)/3, OPTION_INV_DTC_COUNTS
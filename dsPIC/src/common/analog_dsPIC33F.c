@@ -979,8 +979,6 @@ void __attribute__((interrupt, no_auto_psv)) _DMA0Interrupt(void)
 // typical execute time ~65 usec (when run in interrupt routine)
 void TASK_AnalogData(void)
 {
-    #define DIV_BY_MAX_SINE_Q16 (int32_t)(((int32_t)(0x00010000))/(MAX_SINE * 2))
-
     DWORD_t temp32;
     int16_t n_samples;
 
@@ -1000,11 +998,11 @@ void TASK_AnalogData(void)
 	if(An.Status.IMeas.avg.val <= 0) LOG(SS_SYS,SV_ERR, "An.Status.IMeas.avg.val <= 0, %s, line-%d ", __FILE__, __LINE__);
     An.Status.IMeas.avg.sum[An.Status.RmsSosIndxFg] = 0;
 
+    //  divide by the samples in this cycle; 384 at 60 Hz, 460 at 50 Hz
     temp32.dword = An.Status.IMeas.rms.sos[An.Status.RmsSosIndxFg];
-    temp32.dword >>= 5;
-    temp32.dword *= DIV_BY_MAX_SINE_Q16;
-	temp32.dword >>= 11;
-    An.Status.IMeas.rms.val = isqrt32(temp32.dword);
+    temp32.dword >>= 2;
+    An.Status.IMeas.rms.val = isqrt32(__builtin_divud(temp32.dword, n_samples));
+    An.Status.IMeas.rms.val <<= 1;
     An.Status.IMeas.rms.sos[An.Status.RmsSosIndxFg] = (uint32_t)0;
 
     //  ILimit AC Current RMS calculations
@@ -1015,11 +1013,11 @@ void TASK_AnalogData(void)
     An.Status.ILimit.avg.val = __builtin_divud(An.Status.ILimit.avg.sum[An.Status.RmsSosIndxFg], n_samples);
     An.Status.ILimit.avg.sum[An.Status.RmsSosIndxFg] = 0;
 
+    //  divide by the samples in this cycle; 384 at 60 Hz, 460 at 50 Hz
     temp32.dword = An.Status.ILimit.rms.sos[An.Status.RmsSosIndxFg];
-    temp32.dword >>= 5;
-    temp32.dword *= DIV_BY_MAX_SINE_Q16;
-    temp32.dword >>= 11;
-    An.Status.ILimit.rms.val = isqrt32(temp32.dword);
+    temp32.dword >>= 2;
+    An.Status.ILimit.rms.val = isqrt32(__builtin_divud(temp32.dword, n_samples));
+    An.Status.ILimit.rms.val <<= 1;
     An.Status.ILimit.rms.sos[An.Status.RmsSosIndxFg] = (uint32_t)0;
   #endif
   
@@ -1027,11 +1025,11 @@ void TASK_AnalogData(void)
     An.Status.ILine.avg.val = __builtin_divud(An.Status.ILine.avg.sum[An.Status.RmsSosIndxFg], n_samples);
     An.Status.ILine.avg.sum[An.Status.RmsSosIndxFg] = 0;
 
+    //  divide by the samples in this cycle; 384 at 60 Hz, 460 at 50 Hz
     temp32.dword = An.Status.ILine.rms.sos[An.Status.RmsSosIndxFg];
-    temp32.dword >>= 5;
-    temp32.dword *= DIV_BY_MAX_SINE_Q16;
-    temp32.dword >>= 11;
-    An.Status.ILine.rms.val = isqrt32(temp32.dword);
+    temp32.dword >>= 2;
+    An.Status.ILine.rms.val = isqrt32(__builtin_divud(temp32.dword, n_samples));
+    An.Status.ILine.rms.val <<= 1;
     An.Status.ILine.rms.sos[An.Status.RmsSosIndxFg] = (uint32_t)0;
 
     //  AC Voltage RMS calculations
@@ -81,8 +81,14 @@
 //               |           Code          |       
 //               |                         |             F I R M W A R E
 //               |                         |                          
-//               |                         |                (70 pages)  
-//       15800h  |                         |
+//               |                         |                (35 pages)  
+//               +-------------------------+
+//        CC00h  |   Firmware Update Stage |<--------  fwupdate.c stages a new
+//               |       (34 pages)        |           image here over CAN
+//               +-------------------------+
+//       15400h  |    Stage Swap Record    |<--------  written once the staged image
+//               |                         |           is verified; the bootloader
+//       15800h  |                         |           copies the stage to 4000h
 //               +-------------------------+
 //                        no memory
 //               +-------------------------+
@@ -105,9 +111,18 @@
 #define  FW_LENGTH_ADDRESS    0x4100   // firmware length (two u16)
 #define  FW_CHECKSUM_ADDRESS  0x4102   // firmware checksum (u16)
 #define  FW_IS_FLASHED_FLAG   0x4103   // NP uses self-modifying code to detect when reflashed
-#define  FW_CODE_ADDRESS      0x4200   // firwmare code address; start of checksum
+#define  FW_CODE_ADDRESS      0x4200   // firwmare code address; start of checksum and image crc
 #define  FUSE_REG_ADDRESS     0x3FFFF  // words
 
+// -----------------------
+// firmware image check
+// -----------------------
+// crc-32 (crc.h) of the firmware code: the instructions from FW_CODE_ADDRESS for
+// the length at FW_LENGTH_ADDRESS, 3 bytes each lsb first. fwupdate.c works it out
+// a page at a time while it reads back a staged image and hands it to the
+// bootloader in the swap record. The checksum at FW_CHECKSUM_ADDRESS is left
+// as the bootloader has always checked it.
+
 // -------------------
 // program flash pages
 // -------------------
@@ -116,6 +131,41 @@
 #define  FLASH_PAGES_BL     (FW_BASE_ADDRESS/FLASH_PAGE_SIZE)     // 16 pages
 #define  FLASH_PAGES_FW     (FLASH_PAGES_TOTAL - FLASH_PAGES_BL)  // 70 pages
 
+#define  FLASH_ROW_INSTR    64      // instructions per row write
+#define  FLASH_PAGE_INSTR   (FLASH_PAGE_SIZE/2)   // 512 instructions per page erase
+#define  FLASH_PAGE_BYTES   (FLASH_PAGE_INSTR*3)  // 1536 image bytes per page; 3 per instruction lsb first
+#define  FLASH_ROW_BYTES    (FLASH_ROW_INSTR*3)   // 192 image bytes per row
+#define  FLASH_PAGE_ROWS    (FLASH_PAGE_INSTR/FLASH_ROW_INSTR)  // 8 rows per page
+
+// --------------------------------------------------------
+// firmware update staging area (fwupdate.c)
+// the firmware is linked below FW_STAGE_ADDRESS; the top half
+// of the firmware pages holds an image received over CAN
+// --------------------------------------------------------
+#define  FW_STAGE_PAGES     (FLASH_PAGES_FW/2)    // 35 pages incl the swap record
+#define  FW_STAGE_ADDRESS   (FW_BASE_ADDRESS + (uint32_t)FW_STAGE_PAGES*FLASH_PAGE_SIZE)           // 0xCC00
+#define  FW_STAGE_MAX_PAGES (FW_STAGE_PAGES - 1)   // 34 pages of image
+#define  FW_SWAP_ADDRESS    (FW_BASE_ADDRESS + (uint32_t)(FLASH_PAGES_FW-1)*FLASH_PAGE_SIZE)     // 0x15400; last page
+
+// swap record; one instruction per word (lower 16 bits)
+//   FW_SWAP_ADDRESS+0  FW_SWAP_MAGIC
+//   FW_SWAP_ADDRESS+2  number of staged pages
+//   FW_SWAP_ADDRESS+4  crc-32 of the staged pages lo word
+//   FW_SWAP_ADDRESS+6  crc-32 of the staged pages hi word
+//   FW_SWAP_ADDRESS+8  crc-32 of the image code lo word (firmware image check)
+//   FW_SWAP_ADDRESS+10 crc-32 of the image code hi word
+// the bootloader copies the pages to FW_BASE_ADDRESS, checks the image code crc
+// of the copy and the firmware checksum, and erases the record
+#define  FW_SWAP_MAGIC      0x5357  // 'SW'
+
+// stage contract: the firmware never erases flash (a page erase outlasts the
+// watchdog), so the bootloader leaves the stage pages and the swap record
+// erased; after a swap, and whenever it runs without a valid swap record,
+// as after SENFLD_ENTER_BOOTLOADER on an update that was given up.
+// define once the bootloader keeps this contract; until then fwupdate.c
+// refuses to start an update
+// #define  BL_HAS_STAGE_SWAP
+
 // --------------------------------
 // flash memory gets erased to FF's
 // --------------------------------
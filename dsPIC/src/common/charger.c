@@ -51,6 +51,7 @@ void TASK_chgr_Driver(void)
     if(IsChgrActive())
     {
         chgr_Driver(0);
+        _chgr_DutyTableTask();
     }
 }
 
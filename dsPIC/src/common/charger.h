@@ -465,6 +465,7 @@ extern void  	TASK_chgr_Driver(void);
 extern void   _chgr_pwm_isr(int8_t reset);
 extern void   _chgr_DutyReset(void);
 extern int8_t _chgr_DutyAdjust(int16_t count);
+extern void   _chgr_DutyTableTask(void);
 
 #endif  //  __CHARGER_H
 
@@ -18,6 +18,8 @@
 #include "hw.h"
 #include "analog.h"
 #include "charger.h"
+#include "duty_table.h"
+#include "pll.h"
 #include "pwm.h"
 #include "config.h"
 #include "sine_table.h"
@@ -39,17 +41,30 @@
   #undef DEBUG_CHG_DISABLE_DRIVES
 #endif	
 
+// --------------------
+// Line synchronization
+// --------------------
+
+// take the zero-crossings from the line PLL (pll.h) in place of the edge detector;
+// comment out to go back to the edge detector (see check "pll" in dsPIC/host)
+#define ENABLE_CHGR_PLL_SYNC  (1)
+
 
 // ------------------
 // Charger PWM States
 // ------------------
 typedef enum 
 {
+  #ifdef ENABLE_CHGR_PLL_SYNC
+    CHGR_PWM_INIT             = 0,      //  wait for the line PLL to lock
+                                        //  1..4 are the edge detector's sync states
+  #else
     CHGR_PWM_INIT             = 0,
     CHGR_PWM_POS_WAIT_NEG_1   = 1,       
     CHGR_PWM_NEG_WAIT_POS_1   = 2,          
     CHGR_PWM_POS_WAIT_NEG_2   = 3, 
     CHGR_PWM_NEG_WAIT_POS_2   = 4,      
+  #endif
     CHGR_PWM_CONFIRM_NEG_POS  = 5,      
     CHGR_PWM_POS_DETECT_OC    = 6,      
     CHGR_PWM_CONFIRM_POS_NEG  = 7,         
@@ -87,6 +102,27 @@ typedef enum
 //  The Max Threshold is the Max Duty Cycle less the Min Duty Cycle.
 #define MAX_THRES   (MAX_DUTY - MIN_DUTY)
 
+//-----------------------------------------------------------------------------
+//  A duty table is asked for once _comp_q16 has held for CHGR_DTBL_HOLD_MSEC.
+//	While the regulation is still moving it, every new value would cost a 
+//	table fill that is stale by the next msec, so the ISR multiplies instead.
+//-----------------------------------------------------------------------------
+#define CHGR_DTBL_HOLD_MSEC		(20)
+
+#ifdef ENABLE_CHGR_PLL_SYNC
+
+//-----------------------------------------------------------------------------
+//  Zero-crossings come from the line PLL (pll.h); its phase error is up to
+//  ~5 degrees when locked. The drivers are held off for CHGR_ZC_BLANK_BEFORE
+//  before and CHGR_ZC_BLANK_AFTER after each zero-crossing so they do not
+//  conduct across the line's, where the edge detector held them off until
+//  its averaged samples confirmed the crossing.
+//-----------------------------------------------------------------------------
+#define CHGR_ZC_BLANK_BEFORE	(PLL_ZC_GUARD)		//	6 PWM periods at 60 Hz
+#define CHGR_ZC_BLANK_AFTER		(PLL_ZC_GUARD)
+
+#else	//	edge detector
+
 //-----------------------------------------------------------------------------
 //  ZC_CONF_TIMEOUT defines a number of PWM-clock cycles for qualifying the 
 //	zero-crossing AFTER it was detected. 
@@ -119,6 +155,8 @@ typedef enum
 //-----------------------------------------------------------------------------
 #define ZC_DET_WIN_END	(25)
 
+#endif	//	ENABLE_CHGR_PLL_SYNC
+
 //  PWM_PHASE_MAX corresponds to 180-degrees
 #define PWM_PHASE_MAX   (MAX_SINE)
 
@@ -148,7 +186,9 @@ typedef enum
 
 static   DWORD_t temp32;
 static   DWORD_t curr_duty = {{0}};
+#ifndef ENABLE_CHGR_PLL_SYNC
 uint16_t ZcThreshold = VAC_ZERO_CROSS_A2D;
+#endif
 uint16_t _comp_q16   = 0;
 uint16_t _duty_cycle = 0;
 // static uint16_t _comp_q16 = 0;
@@ -173,6 +213,51 @@ void _chgr_DutyReset(void)
 	_comp_q16 = 0;
 }
 
+//-----------------------------------------------------------------------------
+//	_chgr_DutyFill() is the inverted-sine duty profile of _chgr_pwm_isr() for
+//	one value of _comp_q16, for each sine table entry (see duty_table.h).
+//-----------------------------------------------------------------------------
+
+static void _chgr_DutyFill(int16_t* duty, uint16_t comp)
+{
+	int16_t  i;
+	uint32_t d;
+
+	for(i = 0; i <= MAX_SINE; i++)
+	{
+		d = ((uint32_t)(uint16_t)~((i < MAX_SINE) ? _SineTableQ16[i] : 0) * comp) >> 16;
+		duty[i] = (int16_t)(((d + comp) * MAX_DUTY) >> 16);
+	}
+}
+
+//-----------------------------------------------------------------------------
+//	_chgr_DutyTableTask() asks for the duty table of _comp_q16 once it has 
+//	held for CHGR_DTBL_HOLD_MSEC. Called from the foreground every msec while 
+//	the charger is active.
+//-----------------------------------------------------------------------------
+
+void _chgr_DutyTableTask(void)
+{
+	static uint16_t comp_last = 0;
+	static uint16_t held_msec = 0;
+	uint16_t comp = _comp_q16;	//	the ISR changes it too
+
+	if(comp != comp_last)
+	{
+		comp_last = comp;
+		held_msec = 0;
+	}
+	else if(held_msec < CHGR_DTBL_HOLD_MSEC)
+	{
+		held_msec++;
+	}
+	if(held_msec >= CHGR_DTBL_HOLD_MSEC)
+	{
+		dtbl_Request(&_chgr_DutyFill, comp);
+	}
+	dtbl_Task();
+}
+
 //-----------------------------------------------------------------------------
 //  _chgr_DutyAdjust
 //  Returns 1 (non-zero) if the adjustment was successful.
@@ -403,20 +488,30 @@ static int16_t chgr_pwm_isr_state = CHGR_PWM_INIT;
 
 void _chgr_pwm_isr(int8_t reset)
 {
+	static int16_t last_state = 0;
+    int16_t  sine_table_index;
+    const int16_t* duty_tbl;
+  #ifdef ENABLE_CHGR_PLL_SYNC
+    uint32_t phase = pll_Phase();
+    uint32_t half_pos = phase & (DDS_PHASE_HALF - 1);
+    int8_t   blank;
+  #else
     static uint16_t hist[4];
     uint16_t avg[3];
     static int16_t count = 0;
     static int16_t neg_count = 0;
     static int16_t pos_count = 0;
-    static int16_t sine_table_index = 0;
-	static int16_t last_state = 0;
+    static DDS_t dds = { DDS_PHASE_HALF, DDS_STEP_HZ(OPTION_AC_OUT_HZ) };
+    static uint8_t dds_events = 0;
+  #endif
 
 	//	These macros are used for calculating peak current from the RMS
 	//	values, to protect against over-current
 	#define IMEAS_PEAK_ADC(y)	(IMEAS_INV_AMPS_ADC(Y) * SQRT_OF_TWO)
 	
 	//	This macro defines how large of an [opposite polarity] spike is 
-	//	tolerated before we force a re-synch. Used in states 6 & 8 below.
+	//	tolerated with the drivers on (PLL), or before we force a re-synch 
+	//	(edge detector). Used in states 6 & 8 below.
 	#define VAC_SPIKE_TOLERANCE	VAC_VOLTS_ADC(50)
     
     if(reset)
@@ -488,42 +583,67 @@ void _chgr_pwm_isr(int8_t reset)
 	//
 	#define GAIN1_Q16     Q16(0, .50)
 
-	temp32.msw = 0;
-	//	The fixed sine-table is used for calculating shaping the PWM waveform.
-	//	To accommodate varying frequencies, specifically lower-frequency, means
-	//	more PWM clocks than table, we need to check the limits used here for
-	//	this calculation.  If we exceed the limits, just use the [0] value, 
-	//	which should be zero in all tables.
-	if(sine_table_index >= MAX_SINE)
+	//	A table of the profile for this _comp_q16 if the foreground has one 
+	//	ready; it is only a read and an interpolation. Otherwise the 
+	//	multiplies below, ~70 cycles more (see duty_table.h).
+	duty_tbl = dtbl_Take(&_chgr_DutyFill, _comp_q16);
+  #ifdef ENABLE_CHGR_PLL_SYNC
+	if(duty_tbl)
 	{
-		temp32.lsw = 0;
+		curr_duty.msw = dds_SampleTable(&g_pll.nco, duty_tbl);
 	}
 	else
 	{
-		temp32.lsw = _SineTableQ16[sine_table_index];
+		temp32.msw = 0;
+		//	The sine-table is used for shaping the PWM waveform. The phase comes
+		//	from the line PLL (pll.h), so the profile spans the line half-cycle 
+		//	at any frequency.
+		temp32.lsw = dds_Sample(&g_pll.nco, &sine_table_index);
+  #else
+	if(duty_tbl)
+	{
+		//	the last entry is the duty at sine=0
+		curr_duty.msw = (dds.phase >= DDS_PHASE_HALF) ? duty_tbl[MAX_SINE] : dds_SampleTable(&dds, duty_tbl);
 	}
+	else
+	{
+		temp32.msw = 0;
+		//	The sine-table is used for shaping the PWM waveform. The DDS step is
+		//	set at each zero-crossing from the measured half-cycle, so the profile
+		//	spans the line half-cycle at any frequency. If the half-cycle runs
+		//	longer than measured, just use zero.
+		if(dds.phase >= DDS_PHASE_HALF)
+		{
+			temp32.lsw = 0;
+		}
+		else
+		{
+			temp32.lsw = dds_Sample(&dds, &sine_table_index);
+		}
+  #endif
 	
-		//	Shape the profile of the PWM Duty cycle as an inverted sine-wave.
-	//	Calculate Inverse of the sine table (subtract from 1)
-	temp32.lsw = ~temp32.lsw;
-	temp32.msw = 0;
-
-	//	Multiply by the gain
-//	temp32.dword *= (_comp_q16 >> 1);
-	temp32.dword *= _comp_q16;
-	//	Move product to temp32.lsw
-	temp32.lsw = temp32.msw;	
-	temp32.msw = 0;
+			//	Shape the profile of the PWM Duty cycle as an inverted sine-wave.
+		//	Calculate Inverse of the sine table (subtract from 1)
+		temp32.lsw = ~temp32.lsw;
+		temp32.msw = 0;
+
+		//	Multiply by the gain
+	//	temp32.dword *= (_comp_q16 >> 1);
+		temp32.dword *= _comp_q16;
+		//	Move product to temp32.lsw
+		temp32.lsw = temp32.msw;	
+		temp32.msw = 0;
 	
-	//	Add the offset
-//	temp32.dword += (uint32_t)(_comp_q16 >> 1);	
-	temp32.dword += (uint32_t)_comp_q16;	
+		//	Add the offset
+	//	temp32.dword += (uint32_t)(_comp_q16 >> 1);	
+		temp32.dword += (uint32_t)_comp_q16;	
 	
-	//	Multiply by the Max Duty Cycle
-	temp32.dword *= MAX_DUTY;
+		//	Multiply by the Max Duty Cycle
+		temp32.dword *= MAX_DUTY;
 	
-	//	product is in temp21.msw
-	curr_duty.msw = temp32.msw;
+		//	product is in temp21.msw
+		curr_duty.msw = temp32.msw;
+	}
 
     //  Constrain the Duty Cycle ----------------------------------------------
     
@@ -544,13 +664,188 @@ void _chgr_pwm_isr(int8_t reset)
     }
 
 	//	save _duty_cycle at peak in sine table
-	if(sine_table_index == 96)	_duty_cycle = curr_duty.msw;
+  #ifdef ENABLE_CHGR_PLL_SYNC
+	if((g_pll.events & DDS_EV_PEAK) && (phase < DDS_PHASE_HALF))	_duty_cycle = curr_duty.msw;
+  #else
+	if((dds_events & DDS_EV_PEAK) && (dds.phase < DDS_PHASE_HALF))	_duty_cycle = curr_duty.msw;
+  #endif
 	
 	//	DEBUG - uncomment the following line to disable charger PWM output
 	//    curr_duty.msw = 0;
    
 	//	sigcap_save_data();
+
+  #ifdef ENABLE_CHGR_PLL_SYNC
+	//	Analog data is processed at the positive-to-negative crossing; every
+	//	cycle, whether or not we are locked.
+	if((g_pll.events & DDS_EV_HALF) && (phase >= DDS_PHASE_HALF))
+	{
+		an_ProcessAnalogData();
+		if(CHGR_PWM_INIT != chgr_pwm_isr_state)
+		{
+			chgr_pos_neg_zc = 1;	//	this flag is cleared in _chgr_Driver
+		}
+	}
+
+	//	Drivers are off for a few PWM periods around each zero-crossing
+	blank = ((half_pos < CHGR_ZC_BLANK_AFTER) || (half_pos > (DDS_PHASE_HALF - CHGR_ZC_BLANK_BEFORE)));
+
+	if(!pll_IsLocked() || g_pll.dropout)
+	{
+		//	Lost the line: stop and wait for the PLL to lock again
+		chgr_pwm_isr_state = CHGR_PWM_INIT;
+	}
+	
+    switch(chgr_pwm_isr_state)
+    {
+	case CHGR_PWM_INIT:	//	Initial - wait for the PLL to lock on the line
+		chgr_resynch = 1;	//	chgr_resynch flag must be cleared by the driver
+				
+        SetChgrNotOutputting();
+
+        // Override L1 Drivers to be OFF (Low)
+        OVDCONbits.POUT1L = 0;      //  PWM1L = OFF --> Drive output is LOW
+        OVDCONbits.POVD1L = 0;      //  Override: 1L controlled by POUT1L
+
+        // Override L2 Drivers to be OFF (Low)
+        OVDCONbits.POUT2L = 0;      //  PWM2L = OFF --> Drive output is LOW
+        OVDCONbits.POVD2L = 0;      //  Override: 2L controlled by POUT2L
+
+		PDC1 = 0;
+		PDC2 = 0;
+		
+        if(pll_IsLocked() && !g_pll.dropout && (phase >= DDS_PHASE_HALF))
+        {
+			//	Start at the next negative-to-positive zero-crossing
+			_chgr_DutyReset();	//	reset duty-cycle so we soft-start.
+            chgr_pwm_isr_state = CHGR_PWM_CONFIRM_NEG_POS;
+        }
+        break;
+
+	////	CHARGER OUTPUT ACTIVE 	///////////////////////////////////////////
+
+    case CHGR_PWM_CONFIRM_NEG_POS:	//	Negative-to-Positive zero-crossing; drivers off
+        SetChgrOutputting();
+
+        // Override L1 Drivers to be OFF (Low)
+        OVDCONbits.POUT1L = 0;      //  PWM1L = OFF --> Drive output is LOW
+        OVDCONbits.POVD1L = 0;      //  Override: 1L controlled by POUT1L
+
+        // Override L2 Drivers to be OFF (Low)
+        OVDCONbits.POUT2L = 0;      //  PWM2L = OFF --> Drive output is LOW
+        OVDCONbits.POVD2L = 0;      //  Override: 2L controlled by POUT2L
+
+		PDC1 = 0;
+		PDC2 = 0;
+
+		if((phase < DDS_PHASE_HALF) && !blank)
+		{
+			chgr_pwm_isr_state = CHGR_PWM_POS_DETECT_OC;
+		}
+		break;
+		
+    case CHGR_PWM_POS_DETECT_OC:    //  We are in the positive half-cycle
+		if((phase >= DDS_PHASE_HALF) || blank)
+		{
+			//	Coming up on the zero-crossing
+			// Override L1 Drivers to be OFF (Low)
+			OVDCONbits.POUT1L = 0;      //  PWM1L = OFF --> Drive output is LOW
+			OVDCONbits.POVD1L = 0;      //  Override: 1L controlled by POUT1L
+			
+			// Override L2 Drivers to be OFF (Low)
+			OVDCONbits.POUT2L = 0;      //  PWM2L = OFF --> Drive output is LOW
+			OVDCONbits.POVD2L = 0;      //  Override: L2 controlled by POUT2L
+			
+			PDC1 = 0;
+			chgr_pwm_isr_state = CHGR_PWM_CONFIRM_POS_NEG;
+		}
+		else if(VacRaw() < (g_pll.offset - VAC_SPIKE_TOLERANCE))
+		{
+			//	Spike of the wrong polarity: drivers off for this period only;
+			//	the PLL rides through it.
+			OVDCONbits.POUT1L = 0;      //  PWM1L = OFF --> Drive output is LOW
+			OVDCONbits.POVD1L = 0;      //  Override: 1L controlled by POUT1L
+			OVDCONbits.POUT2L = 0;      //  PWM2L = OFF --> Drive output is LOW
+			OVDCONbits.POVD2L = 0;      //  Override: L2 controlled by POUT2L
+			PDC1 = 0;
+		}
+		else
+		{
+          #if !defined(DEBUG_CHG_DISABLE_DRIVES)
+            //  Low Driver L1 controlled by PWM (Duty-Cycle)
+            OVDCONbits.POVD1L = 1;      //  L1 controlled by PWM
+            
+            // Override the L2 Driver to be ON (High)
+            OVDCONbits.POUT2L = 1;      //  PWM2L = ON --> Drive output is High
+            OVDCONbits.POVD2L = 0;      //  Override: L2 controlled by POUT2L
+            
+            PDC1 = curr_duty.msw;
+          #endif
+		}
+        break;
+
+
+    case CHGR_PWM_CONFIRM_POS_NEG:	//	Positive-to-Negative zero-crossing; drivers off
+        SetChgrOutputting();
+
+        // Override L1 Drivers to be OFF (Low)
+        OVDCONbits.POUT1L = 0;      //  PWM1L = OFF --> Drive output is LOW
+        OVDCONbits.POVD1L = 0;      //  Override: 1L controlled by POUT1L
+
+        // Override L2 Drivers to be OFF (Low)
+        OVDCONbits.POUT2L = 0;      //  PWM2L = OFF --> Drive output is LOW
+        OVDCONbits.POVD2L = 0;      //  Override: 2L controlled by POUT2L
+
+		PDC1 = 0;
+		PDC2 = 0;
+
+		if((phase >= DDS_PHASE_HALF) && !blank)
+		{
+			chgr_pwm_isr_state = CHGR_PWM_NEG_DECT_OC;
+		}
+		break;
+
+    case CHGR_PWM_NEG_DECT_OC:    //  We are in the negative half-cycle
+		if((phase < DDS_PHASE_HALF) || blank)
+		{
+			//	Coming up on the zero-crossing
+			// Override L1 Drivers to be OFF (Low)
+			OVDCONbits.POUT1L = 0;      //  PWM1L = OFF --> Drive output is LOW
+			OVDCONbits.POVD1L = 0;      //  Override: 1L controlled by POUT1L
+			
+			// Override L2 Drivers to be OFF (Low)
+			OVDCONbits.POUT2L = 0;      //  PWM2L = OFF --> Drive output is LOW
+			OVDCONbits.POVD2L = 0;      //  Override: L2 controlled by POUT2L
+			
+			PDC2 = 0;
+			chgr_pwm_isr_state = CHGR_PWM_CONFIRM_NEG_POS;
+		}
+		else if(VacRaw() > (g_pll.offset + VAC_SPIKE_TOLERANCE))
+		{
+			//	Spike of the wrong polarity: drivers off for this period only;
+			//	the PLL rides through it.
+			OVDCONbits.POUT1L = 0;      //  PWM1L = OFF --> Drive output is LOW
+			OVDCONbits.POVD1L = 0;      //  Override: 1L controlled by POUT1L
+			OVDCONbits.POUT2L = 0;      //  PWM2L = OFF --> Drive output is LOW
+			OVDCONbits.POVD2L = 0;      //  Override: L2 controlled by POUT2L
+			PDC2 = 0;
+		}
+		else
+		{
+          #if !defined(DEBUG_CHG_DISABLE_DRIVES)
+            //  Low Driver L2 controlled by PWM (Duty-Cycle)
+            OVDCONbits.POVD2L = 1;      //  L2 controlled by PWM
+            
+            // Override the L1 Driver to be ON (High)
+            OVDCONbits.POUT1L = 1;      //  PWM1L = ON --> Drive output is High
+            OVDCONbits.POVD1L = 0;      //  Override: L1 controlled by POUT1L
+            
+            PDC2 = curr_duty.msw;
+          #endif
+		}
+        break;
    
+  #else	//	edge detector
     //  Update VAC History for detecting zero-crossing
     hist[3] = hist[2];
     hist[2] = hist[1];
@@ -756,7 +1051,8 @@ void _chgr_pwm_isr(int8_t reset)
 			//	avg[2] is the latest average sample.
 			//	(avg[2] >= ZcThreshold)	--> positive half-cycle
 			
-			sine_table_index = 0;
+			dds.phase = 0;
+			dds.step = dds_StepSamples(pos_count);
 			chgr_pwm_isr_state = CHGR_PWM_POS_DETECT_OC;
 		}
 		break;
@@ -769,7 +1065,7 @@ void _chgr_pwm_isr(int8_t reset)
 		//			_comp_gain = PDC_10;	
 		//		}
 	
-		sine_table_index++;
+		dds_events = dds_Advance(&dds);
 		++count;
 		if(count > (pos_count + ZC_DET_WIN_END))
 		{
@@ -857,7 +1153,8 @@ void _chgr_pwm_isr(int8_t reset)
 			
 			chgr_pos_neg_zc = 1;	//	this flag is cleared in _chgr_Driver
 			
-			sine_table_index = 0;
+			dds.phase = 0;
+			dds.step = dds_StepSamples(neg_count);
 			chgr_pwm_isr_state = CHGR_PWM_NEG_DECT_OC;
 		}
 		break;
@@ -869,7 +1166,7 @@ void _chgr_pwm_isr(int8_t reset)
 		//			_comp_gain = PDC_10;	
 		//		}
 		
-		sine_table_index++;
+		dds_events = dds_Advance(&dds);
 		if(++count > (neg_count + ZC_DET_WIN_END))
 		{
 			//	we have not seen the zero-crossing within the budgeted time
@@ -931,6 +1228,8 @@ void _chgr_pwm_isr(int8_t reset)
 		}
         break;
    
+  #endif	//	ENABLE_CHGR_PLL_SYNC
+
     default :
         SetChgrNotOutputting();
 
@@ -0,0 +1,64 @@
+// <><><><><><><><><><><><><> crc.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Table driven CRC-16 and CRC-32
+//
+//  CRC-16  CCITT (poly 0x1021, init 0xFFFF, no reflection)  NVM copies and journal
+//  CRC-32  IEEE 802.3 (poly 0x04C11DB7 reflected)           firmware images; staged pages
+//                                                           and the image code (bootloader.h)
+//
+//  The SPI display packets keep their 8 bit byte sum (spi_CalcChecksum()):
+//  the remote displays in the field check that sum and are not updated with
+//  this firmware, so changing it would break every display. The packets are
+//  short, checked end to end and resent, unlike data stored in flash.
+//
+//  The update functions continue a running crc, so data can be fed a page or
+//  a frame at a time:
+//      crc = CRC16_INIT;
+//      crc = crc16_Update(crc, page1, 32);
+//      crc = crc16_Update(crc, page2, 32);
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _CRC_H_    // include only once
+#define _CRC_H_
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ---------
+// constants
+// ---------
+#define CRC16_INIT          (0xFFFF)
+#define CRC32_INIT          (0xFFFFFFFFUL)
+#define CRC32_FINAL(crc)    ((crc) ^ 0xFFFFFFFFUL)    // apply once after the last update
+
+// --------------------
+// Function Prototyping
+// --------------------
+uint16_t crc16_Update(uint16_t crc, const uint8_t* data, uint16_t nbytes);
+uint32_t crc32_Update(uint32_t crc, const uint8_t* data, uint16_t nbytes);
+
+// --------------------------
+// Inline Functions for Speed
+// --------------------------
+
+// crc-16 of one buffer
+INLINE uint16_t crc16_Calc(const uint8_t* data, uint16_t nbytes)
+{
+    return(crc16_Update(CRC16_INIT, data, nbytes));
+}
+
+// crc-32 of one buffer
+INLINE uint32_t crc32_Calc(const uint8_t* data, uint16_t nbytes)
+{
+    return(CRC32_FINAL(crc32_Update(CRC32_INIT, data, nbytes)));
+}
+
+#endif  //  _CRC_H_
+
+// <><><><><><><><><><><><><> crc.h <><><><><><><><><><><><><><><><><><><><><><>
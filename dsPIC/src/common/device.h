@@ -84,6 +84,7 @@ typedef enum
   #define DEVICE_DFLT_AUX_MODE			  (AUX_DISABLED)
 #endif
 
+#define DEVICE_DFLT_FAST_XFER_ENABLE    (0)
 #define DEVICE_DFLT_TMR_SHUTDOWN_DELAY 	((int16_t)(60*60))	// 60-min as seconds
 #define DEVICE_DFLT_AC_LINE_QUAL_DELAY	((int16_t)(OPTION_AC_LINE_QUAL_SECS*1000))	// milliseconds
 
@@ -163,8 +164,8 @@ typedef struct
 	{
 	    struct
 		{
-			unsigned all_flags			: 10;
-			unsigned unused             : 6;
+			unsigned all_flags			: 11;
+			unsigned unused             : 5;
 		};
 		struct
 		{
@@ -186,7 +187,8 @@ typedef struct
 			
 			unsigned pushbutton_enabled		: 1; // push button enable (LPC only)
 			unsigned batt_temp_sense_present: 1; // 0=disabled, 1=enabled (NP and LPC)
-			unsigned unused2				: 6;
+			unsigned fast_xfer_enabled		: 1; // phase synchronized transfer (NP and LPC)
+			unsigned unused2				: 5;
         };
     };
     int16_t	tmr_shutdown_delay;	    //  Delay before Timer Shutdown [Seconds]
@@ -199,7 +201,7 @@ typedef struct
 #define BITF2(name, bitno)  (( (((uint16_t)name)&0x3)<<(bitno) )) // two bits
 
 // macro used to generate device.config.all_flags for initialization since compiler has problems
-#define DEVICE_CFG_ALL_FLAGS(inv_enable, chg_enable, pass_enable, tmr_enable, rmt_mode, aux_mode, push_btn, temp_sns)  \
+#define DEVICE_CFG_ALL_FLAGS(inv_enable, chg_enable, pass_enable, tmr_enable, rmt_mode, aux_mode, push_btn, temp_sns, fast_xfer)  \
     BITF1(inv_enable, 0) | \
     BITF1(chg_enable, 1) | \
     BITF1(pass_enable,2) | \
@@ -207,7 +209,8 @@ typedef struct
     BITF2(rmt_mode,   4) | \
     BITF2(aux_mode,   6) | \
     BITF1(push_btn,   8) | \
-    BITF1(temp_sns,   9)
+    BITF1(temp_sns,   9) | \
+    BITF1(fast_xfer, 10)
 
 //-----------------------------------------------------------------------------
 //                     D E V I C E   E R R O R S
@@ -341,7 +344,8 @@ int dev_MainState(void);	// return main state
 			DEVICE_DFLT_REMOTE_MODE,
 			DEVICE_DFLT_AUX_MODE,
 			DEVICE_DFLT_PUSHBUTTON_ENABLE,
-			DEVICE_DFLT_TEMP_SENSOR_PRESENT
+			DEVICE_DFLT_TEMP_SENSOR_PRESENT,
+			DEVICE_DFLT_FAST_XFER_ENABLE
             )
 		}},
 		DEVICE_DFLT_TMR_SHUTDOWN_DELAY,
@@ -0,0 +1,60 @@
+// <><><><><><><><><><><><><> duty_table.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Half-cycle PWM duty tables (see duty_table.h)
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "duty_table.h"
+
+// ------------
+// Global Data
+// ------------
+DUTY_TABLES_t g_dtbl;
+
+
+//-----------------------------------------------------------------------------
+//  dtbl_Task()
+//-----------------------------------------------------------------------------
+//  Fills and publishes the table last asked for. A table takes well under a
+//  msec; a half-cycle is 8 msec or more.
+//-----------------------------------------------------------------------------
+
+void dtbl_Task(void)
+{
+    uint8_t       saved_ipl;
+    uint8_t       seq;
+    DTBL_FILL_t   fill;
+    uint16_t      key;
+    DUTY_TABLE_t* front;
+    DUTY_TABLE_t* back;
+
+    SET_AND_SAVE_CPU_IPL(saved_ipl, 7); //  Start of Protected Code
+    seq   = g_dtbl.seq;
+    fill  = g_dtbl.wantFill;
+    key   = g_dtbl.wantKey;
+    front = g_dtbl.front;
+    RESTORE_CPU_IPL(saved_ipl); //  End of Protected Code
+
+    if ((seq == g_dtbl.done) || (0 == fill)) return;
+    g_dtbl.done = seq;
+    if (front && (fill == front->fill) && (key == front->key)) return;
+
+    back = (front == &g_dtbl.buf[0]) ? &g_dtbl.buf[1] : &g_dtbl.buf[0];
+    back->fill = fill;
+    back->key  = key;
+    (*fill)(back->duty, key);
+
+    // not if the ISR has moved on; it may be using the other buffer
+    SET_AND_SAVE_CPU_IPL(saved_ipl, 7); //  Start of Protected Code
+    if (seq == g_dtbl.seq) g_dtbl.front = back;
+    RESTORE_CPU_IPL(saved_ipl); //  End of Protected Code
+}
+
+// <><><><><><><><><><><><><> duty_table.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,111 @@
+// <><><><><><><><><><><><><> duty_table.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Half-cycle PWM duty tables, computed in the foreground
+//
+//  Where the amplitude of the output is held over a half-cycle (inverter
+//  soft start, ping and soft stop) or changes only now and then (charger),
+//  the duty for each sine table entry is a fixed function of the sine.
+//  Rather than the 32 bit multiplies of the amplitude by the sine every PWM
+//  period, the foreground fills a table of that function for the amplitude
+//  and the PWM ISR reads it with dds_SampleTable(): one 16x16 multiply for
+//  the interpolation, then the limits.
+//
+//  A table is known by its fill function and a 16 bit key (the amplitude).
+//  There are two buffers. The ISR asks for the key it wants next with
+//  dtbl_Request(); dtbl_Task() fills the buffer that is not published and
+//  publishes it, unless another request came in meanwhile. The ISR gets the
+//  published table with dtbl_Take(), or NULL if it is not for that key, in
+//  which case it does the multiplies as before.
+//
+//  The multiplies are never the ISR's worst case; estimated at -O0:
+//    - inverter: the closed loop (PWM_STATE_NORMAL) has no table, as its
+//      amplitude moves every period, so the multiply is its steady state
+//      and is in the TIMING estimate of _inv_PwmIsr(). Tables are taken
+//      only in soft start, ping and soft stop, which skip the loop, the
+//      harmonic term and the trims; their first half-cycle has no table
+//      yet. There the one 32 bit multiply costs about what the table's
+//      interpolation does (~40 cycles), so these periods stay under
+//      ~800 of the 1736.
+//    - charger: the multiplies are its steady state while the regulation
+//      moves _comp_q16. They are the path measured at 6.2 usec (248
+//      cycles) in 2016 (pwm.c), about 70 cycles more than the table; with
+//      pll_Isr() (~200 locked) the period is ~500 cycles.
+//
+//  The inverter takes a table at each zero crossing and keeps it for the
+//  half-cycle, having asked for the next half-cycle's amplitude. It asks
+//  once per half-cycle, so the foreground never writes a table the ISR is
+//  reading: the one in use is the published one until the next request.
+//  The charger asks from the foreground once the duty has held for a while
+//  (CHGR_DTBL_HOLD_MSEC, charger_isr.c), and the ISR takes the table afresh
+//  every PWM period.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __DUTY_TABLE_H    // include only once
+#define __DUTY_TABLE_H
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "sine_table.h"
+
+// ----------
+// data types
+// ----------
+
+// fills MAX_SINE+1 duties, for each sine table entry and sine=0 after the last
+typedef void (*DTBL_FILL_t)(int16_t* duty, uint16_t key);
+
+typedef struct
+{
+    DTBL_FILL_t fill;
+    uint16_t    key;
+    int16_t     duty[MAX_SINE+1];
+} DUTY_TABLE_t;
+
+typedef struct
+{
+    DUTY_TABLE_t  buf[2];
+    DUTY_TABLE_t* volatile front;   // published; NULL=none
+    DTBL_FILL_t   volatile wantFill;
+    uint16_t      volatile wantKey;
+    uint8_t       volatile seq;     // bumped by each new request
+    uint8_t       done;             // seq of the last request dtbl_Task() served
+} DUTY_TABLES_t;
+
+// ------------
+// Global Data
+// ------------
+extern DUTY_TABLES_t g_dtbl;        // the inverter and the charger never run together
+
+// --------------------
+// Function Prototyping
+// --------------------
+extern void dtbl_Task(void);        // foreground; every msec while the inverter or charger runs
+
+//-----------------------------------------------------------------------------
+// the table for the next half-cycle (inverter ISR) or from now on (charger)
+INLINE void dtbl_Request(DTBL_FILL_t fill, uint16_t key)
+{
+    if ((fill == g_dtbl.wantFill) && (key == g_dtbl.wantKey)) return;
+    g_dtbl.wantFill = fill;
+    g_dtbl.wantKey  = key;
+    g_dtbl.seq++;
+}
+
+//-----------------------------------------------------------------------------
+// the published table, if it is for fill and key; else NULL
+INLINE const int16_t* dtbl_Take(DTBL_FILL_t fill, uint16_t key)
+{
+    DUTY_TABLE_t* t = g_dtbl.front;
+
+    return((t && (fill == t->fill) && (key == t->key)) ? t->duty : 0);
+}
+
+#endif  //  __DUTY_TABLE_H
+
+// <><><><><><><><><><><><><> duty_table.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,304 @@
+// <><><><><><><><><><><><><> evlog.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Persistent fault and event log (see evlog.h)
+//
+//  The log is a ring of EVLOG_RECS slots. The newest record is found by a
+//  background scan after startup; the record with the highest sequence number
+//  wins and the next one goes in the slot after it. A page write cut short by
+//  a power loss leaves a record that fails its check byte and is passed over.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "charger.h"
+#include "crc.h"
+#include "device.h"
+#include "dsPIC33_CAN.h"
+#include "evlog.h"
+#include "hs_temp.h"
+#include "inverter.h"
+#include "J1939.h"
+#include "nvm.h"
+#include "sensata_can.h"
+
+// ------------
+// global data
+// ------------
+EVLOG_t g_evlog = { 0 };
+
+// ------------------
+// Inline Functions
+// ------------------
+#define evlog_NextSeq(seq)     ((uint16_t)((seq)+1) == 0xFFFF ? 0 : (uint16_t)((seq)+1))
+#define evlog_SlotAddr(slot)   (NVM_OFFSET_EVLOG + (slot)*sizeof(EVLOG_REC_t))
+#define evlog_CalcChk(pRec)    LOBYTE(crc16_Calc((uint8_t*)(pRec), EVLOG_CHK_BYTES))
+#define evlog_IsRecValid(pRec) ((pRec)->seq != 0xFFFF && (pRec)->type != EVT_NONE && (pRec)->chk == evlog_CalcChk(pRec))
+
+// ------------------------------------------------------------------------------------
+// queue an event with a snapshot of the analog readings
+// foreground only; the nvm driver empties the queue
+void evlog_Add(EVLOG_TYPE_t type, uint8_t code)
+{
+    EVLOG_REC_t* pRec;
+
+    if (g_evlog.qCount >= EVLOG_QUEUE)
+    {
+        g_evlog.dropped++;
+        return;
+    }
+    pRec = &g_evlog.queue[(g_evlog.qHead + g_evlog.qCount) & (EVLOG_QUEUE-1)];
+    pRec->type    = (uint8_t)type;
+    pRec->code    = code;
+    pRec->msec    = GetSysTicks();
+    pRec->vbatt   = VBattCycleAvg();
+    pRec->vac     = VacRMS();
+    pRec->imeas   = IMeasRMS();
+    pRec->hsTempC = (int8_t)HeatSinkTempC();
+    g_evlog.qCount++;
+}
+
+// ------------------------------------------------------------------------------------
+// queue an event for each bit in flags
+static void evlog_AddBits(EVLOG_TYPE_t type, uint16_t flags)
+{
+    uint8_t bitNo;
+
+    for (bitNo=0; flags; bitNo++, flags >>= 1)
+    {
+        if (flags & 1) evlog_Add(type, bitNo);
+    }
+}
+
+// ------------------------------------------------------------------------------------
+// record the error flags as they get set and the charger state changes
+// called every millisecond from the main control task
+void evlog_Watch(void)
+{
+    static uint16_t s_invErr    = 0;
+    static uint16_t s_devErr    = 0;
+    static uint16_t s_chgrErr   = 0;
+    static uint8_t  s_chgrState = CS_INVALID;
+    uint16_t flags;
+
+    // overload, battery low/high shutdowns
+    flags = Inv.error.all_flags;
+    if (flags != s_invErr) evlog_AddBits(EVT_INV_ERROR, flags & ~s_invErr);
+    s_invErr = flags;
+
+    // over-temperatures, battery low
+    flags = Device.error.all_flags;
+    if (flags != s_devErr) evlog_AddBits(EVT_DEV_ERROR, flags & ~s_devErr);
+    s_devErr = flags;
+
+    // charger over-current
+    flags = Chgr.error.all_flags;
+    if (flags != s_chgrErr) evlog_AddBits(EVT_CHGR_ERROR, flags & ~s_chgrErr);
+    s_chgrErr = flags;
+
+    if ((uint8_t)ChgrState() != s_chgrState)
+    {
+        s_chgrState = (uint8_t)ChgrState();
+        evlog_Add(EVT_CHGR_STATE, s_chgrState);
+    }
+}
+
+// ------------------------------------------------------------------------------------
+// check the page just read for the newest record
+static void evlog_Scanned(void)
+{
+    EVLOG_REC_t* pRec = g_evlog.page;
+    uint8_t i;
+
+    for (i=0; i<EVLOG_PAGE_RECS; i++, pRec++)
+    {
+        if (!evlog_IsRecValid(pRec)) continue;
+        if (g_evlog.found && (int16_t)(pRec->seq - g_evlog.seq) <= 0) continue;
+        g_evlog.found = 1;
+        g_evlog.seq   = pRec->seq;
+        g_evlog.slot  = g_evlog.scan + i + 1;
+    }
+    g_evlog.scan += EVLOG_PAGE_RECS;
+    if (g_evlog.scan < EVLOG_RECS) return;
+
+    // whole log scanned
+    if (g_evlog.slot >= EVLOG_RECS) g_evlog.slot = 0;
+    if (!g_evlog.found) g_evlog.seq = 0xFFFF;  // first record gets 0
+    g_evlog.state = EVLOG_ST_IDLE;
+    LOG(SS_NVM, SV_INFO, "Event log: slot=%u seq=%u", g_evlog.slot, g_evlog.seq);
+}
+
+// ------------------------------------------------------------------------------------
+// write the queued events that fit in the page of the next slot
+static void evlog_BeginWrite(void)
+{
+    EVLOG_REC_t* pRec;
+    uint8_t i, n;
+
+    n = EVLOG_PAGE_RECS - (g_evlog.slot % EVLOG_PAGE_RECS);
+    if (n > g_evlog.qCount) n = g_evlog.qCount;
+    for (i=0; i<n; i++)
+    {
+        pRec = &g_evlog.page[i];
+        memcpy(pRec, &g_evlog.queue[g_evlog.qHead], sizeof(EVLOG_REC_t));
+        g_evlog.qHead = (g_evlog.qHead + 1) & (EVLOG_QUEUE-1);
+        g_evlog.qCount--;
+        g_evlog.seq = evlog_NextSeq(g_evlog.seq);
+        pRec->seq = g_evlog.seq;
+        pRec->chk = evlog_CalcChk(pRec);
+    }
+    g_evlog.nPage = n;
+    nvm_L0_BegWriteBuf(evlog_SlotAddr(g_evlog.slot), n*sizeof(EVLOG_REC_t), (uint8_t*)g_evlog.page);
+    g_evlog.state = EVLOG_ST_WRITE;
+}
+
+// ------------------------------------------------------------------------------------
+// read the next slots of a bulk read up to the end of their page
+static void evlog_BeginRead(void)
+{
+    uint8_t n;
+
+    n = EVLOG_PAGE_RECS - (g_evlog.rdSlot % EVLOG_PAGE_RECS);
+    if (n > g_evlog.rdLeft) n = (uint8_t)g_evlog.rdLeft;
+    g_evlog.nPage = n;
+    nvm_L0_BegReadBuf(evlog_SlotAddr(g_evlog.rdSlot), n*sizeof(EVLOG_REC_t), (uint8_t*)g_evlog.page);
+    g_evlog.state = EVLOG_ST_READ;
+}
+
+// ------------------------------------------------------------------------------------
+// hand the valid records read to the can task
+static void evlog_EndRead(void)
+{
+    uint8_t i, n = 0;
+
+    if (g_evlog.rdLeft == 0) return;    // restarted while the read was in progress
+
+    for (i=0; i<g_evlog.nPage; i++)
+    {
+        if (!evlog_IsRecValid(&g_evlog.page[i])) continue;
+        memcpy(&g_evlog.rdBuf[n++], &g_evlog.page[i], sizeof(EVLOG_REC_t));
+    }
+    g_evlog.rdSlot += g_evlog.nPage;
+    if (g_evlog.rdSlot >= EVLOG_RECS) g_evlog.rdSlot = 0;
+    g_evlog.rdLeft -= g_evlog.nPage;
+    if (g_evlog.rdLeft == 0) g_evlog.rdEnd = 1;
+    g_evlog.rdIdx = 0;
+    g_evlog.rdOfs = 0;
+    g_evlog.rdLen = n;  // last; releases rdBuf to the can task
+}
+
+// ------------------------------------------------------------------------------------
+// drive the event log; one nvm operation at a time
+// called by the nvm driver only when it has nothing else to do
+void evlog_Driver(void)
+{
+    switch (g_evlog.state)
+    {
+    default:
+    case EVLOG_ST_SCAN:
+        g_evlog.state = EVLOG_ST_SCANNED;
+        nvm_L0_BegReadBuf(evlog_SlotAddr(g_evlog.scan), NVM_PAGE_BYTES, (uint8_t*)g_evlog.page);
+        break;
+
+    case EVLOG_ST_SCANNED:
+        g_evlog.state = EVLOG_ST_SCAN;
+        evlog_Scanned();
+        break;
+
+    case EVLOG_ST_WRITE:
+        g_evlog.slot += g_evlog.nPage;
+        if (g_evlog.slot >= EVLOG_RECS) g_evlog.slot = 0;
+        g_evlog.state = EVLOG_ST_IDLE;
+        break;
+
+    case EVLOG_ST_READ:
+        evlog_EndRead();
+        g_evlog.state = EVLOG_ST_IDLE;
+        break;
+
+    case EVLOG_ST_IDLE:
+        // batch events a page at a time; a part page goes once the oldest has waited long enough
+        if (g_evlog.qCount >= EVLOG_PAGE_RECS - (g_evlog.slot % EVLOG_PAGE_RECS)
+         || (g_evlog.qCount && IsTimedOut(EVLOG_FLUSH_MSEC, g_evlog.queue[g_evlog.qHead].msec)))
+        {
+            evlog_BeginWrite();
+            break;
+        }
+
+        // bulk read
+        if (g_evlog.rdReq)
+        {
+            g_evlog.rdLeft = (g_evlog.rdReq > EVLOG_RECS) ? EVLOG_RECS : g_evlog.rdReq;
+            g_evlog.rdSlot = (g_evlog.slot + EVLOG_RECS - g_evlog.rdLeft) % EVLOG_RECS;
+            g_evlog.rdReq  = 0;
+        }
+        if (g_evlog.rdLeft && g_evlog.rdLen == 0) evlog_BeginRead();
+        break;
+    } // switch
+}
+
+// ------------------------------------------------------------------------------------
+// start a bulk read of the nrecs most recent records; restarts one in progress
+void evlog_StartRead(uint16_t nrecs)
+{
+    g_evlog.rdLen  = 0;
+    g_evlog.rdLeft = 0;
+    g_evlog.rdSent = 0;
+    g_evlog.rdEnd  = (nrecs == 0) ? 1 : 0;
+    g_evlog.rdReq  = nrecs;
+
+    LOG(SS_CAN, SV_INFO, "Event log read n=%u", nrecs);
+}
+
+// ------------------------------------------------------------------------------------
+// send the records read as fast as the transmit queue takes them
+// called from the can task
+void evlog_Poll(void)
+{
+    CAN_DATA data[8];
+    uint8_t* src;
+    uint8_t  i;
+
+    while (g_evlog.rdLen && can_TxQueueFree() > EVLOG_TX_RESERVE)
+    {
+        src = (uint8_t*)&g_evlog.rdBuf[g_evlog.rdIdx];
+        data[0] = LOBYTE(g_evlog.rdSent);
+        data[1] = g_evlog.rdOfs;
+        for (i=0; i<6; i++)
+        {
+            data[2+i] = (g_evlog.rdOfs+i < sizeof(EVLOG_REC_t)) ? src[g_evlog.rdOfs+i] : 0xFF;
+        }
+        J1939_SendMessage(SENSATA_CUSTOM_EVLOG_DATA_DGN, sizeof(data), data);
+
+        g_evlog.rdOfs += 6;
+        if (g_evlog.rdOfs < sizeof(EVLOG_REC_t)) continue;
+        g_evlog.rdOfs = 0;
+        g_evlog.rdSent++;
+        if (++g_evlog.rdIdx >= g_evlog.rdLen)
+        {
+            g_evlog.rdLen = 0;  // release rdBuf to the nvm driver
+        }
+    }
+
+    if (g_evlog.rdEnd && g_evlog.rdLen == 0 && can_TxQueueFree() > EVLOG_TX_RESERVE)
+    {
+        data[0] = LOBYTE(g_evlog.rdSent);
+        data[1] = 0xFF;
+        data[2] = LOBYTE(g_evlog.rdSent);
+        data[3] = HIBYTE(g_evlog.rdSent);
+        data[4] = LOBYTE(g_evlog.dropped);
+        data[5] = HIBYTE(g_evlog.dropped);
+        data[6] = 0xFF;
+        data[7] = 0xFF;
+        J1939_SendMessage(SENSATA_CUSTOM_EVLOG_DATA_DGN, sizeof(data), data);
+        g_evlog.rdEnd = 0;
+    }
+}
+
+// <><><><><><><><><><><><><> evlog.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,144 @@
+// <><><><><><><><><><><><><> evlog.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Persistent fault and event log (flight recorder)
+//
+//  Events are stamped with the time since reset and an analog snapshot and
+//  queued in RAM. The nvm driver writes them a page at a time into a circular
+//  log in NVM (NVM_OFFSET_EVLOG) only when it has nothing else to do, so the
+//  log never holds up a settings save. A power cycle starts with EVT_BOOT.
+//
+//  Recorded:
+//    EVT_BOOT        code = RCON reset flags (lo byte)
+//    EVT_MAIN_STATE  code = new main state; from SetMainState()
+//    EVT_TRAP        code = TRAP_ERROR_CODE_t
+//    EVT_INV_ERROR   code = bit number in Inv.error that was set
+//    EVT_DEV_ERROR   code = bit number in Device.error that was set
+//    EVT_CHGR_ERROR  code = bit number in Chgr.error that was set
+//    EVT_CHGR_STATE  code = new CHARGER_STATE_t
+//
+//  Bulk read:   SENSATA_CUSTOM_EVLOG_DGN
+//    data[0]    instance
+//    data[1..2] number of most recent records to send (lsb first); 0xFFFF=all
+//
+//  Records:     SENSATA_CUSTOM_EVLOG_DATA_DGN; oldest first, 3 frames per record
+//    data[0]    record count in this transfer (lo byte)
+//    data[1]    byte offset in EVLOG_REC_t of data[2]; 0, 6 or 12
+//    data[2..7] record bytes; 0xFF past the end of the record
+//  The transfer ends with data[1] = 0xFF
+//    data[2..3] records sent
+//    data[4..5] events dropped since reset; RAM queue was full
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _EVLOG_H_    // include only once
+#define _EVLOG_H_
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "nvm.h"
+#include "structsz.h"
+
+// -----------
+// event types
+// -----------
+typedef enum
+{
+    EVT_NONE        = 0,
+    EVT_BOOT        = 1,
+    EVT_MAIN_STATE  = 2,
+    EVT_TRAP        = 3,
+    EVT_INV_ERROR   = 4,
+    EVT_DEV_ERROR   = 5,
+    EVT_CHGR_ERROR  = 6,
+    EVT_CHGR_STATE  = 7
+} EVLOG_TYPE_t;
+
+// ------------
+// event record
+// ------------
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    uint16_t  seq;          // log sequence number; never 0xFFFF (erased)
+    uint8_t   type;         // EVLOG_TYPE_t
+    uint8_t   code;         // depends upon type
+    uint32_t  msec;         // time since reset
+    int16_t   vbatt;        // VBattCycleAvg()
+    int16_t   vac;          // VacRMS()
+    int16_t   imeas;        // IMeasRMS()
+    int8_t    hsTempC;      // HeatSinkTempC()
+    uint8_t   chk;          // lo byte of the crc-16 of the bytes above
+} EVLOG_REC_t;
+#pragma pack()  // restore packing setting
+STRUCT_SIZE_CHECK(EVLOG_REC_t,16);  // must divide NVM_PAGE_BYTES
+#define EVLOG_CHK_BYTES    (sizeof(EVLOG_REC_t) - 1)   // bytes covered by chk
+
+#define EVLOG_RECS         (NVM_EVLOG_BYTES/sizeof(EVLOG_REC_t))   // 224 record slots
+#define EVLOG_PAGE_RECS    (NVM_PAGE_BYTES/sizeof(EVLOG_REC_t))    // records per page write
+#define EVLOG_QUEUE        (8)      // events waiting in RAM for the nvm driver
+#define EVLOG_FLUSH_MSEC   (250)    // write a part page once the oldest event has waited this long
+#define EVLOG_TX_RESERVE   (4)      // tx queue slots left free for other traffic
+
+// driver states
+#define EVLOG_ST_SCAN      0        // read the next page to scan; events queue up until the scan is done
+#define EVLOG_ST_SCANNED   1        // check the page read for the newest record
+#define EVLOG_ST_IDLE      2
+#define EVLOG_ST_WRITE     3        // page write in progress
+#define EVLOG_ST_READ      4        // page read for a bulk read in progress
+
+// -------------
+// log state
+// -------------
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    uint8_t     state;          // EVLOG_ST_xxx
+    uint8_t     found;          // scan found a valid record
+    uint16_t    scan;           // scan: first slot of the page being read
+    uint16_t    slot;           // slot the next record goes in
+    uint16_t    seq;            // last sequence number written
+    uint16_t    dropped;        // events lost; queue was full
+
+    // queue; filled by evlog_Add(), emptied by the nvm driver
+    EVLOG_REC_t queue[EVLOG_QUEUE];
+    uint8_t     qHead;          // oldest event
+    uint8_t     qCount;         // events waiting
+    uint8_t     nPage;          // records in page being written or read
+
+    // bulk read; the nvm driver fills rdBuf, the can task sends it
+    uint16_t    rdReq;          // records requested; picked up when the driver is idle
+    uint16_t    rdLeft;         // slots left to read; 0=none
+    uint16_t    rdSlot;         // next slot to read
+    uint16_t    rdSent;         // records sent
+    uint8_t     rdLen;          // records in rdBuf to send; 0=empty
+    uint8_t     rdIdx;          // next record to send
+    uint8_t     rdOfs;          // next byte offset to send
+    uint8_t     rdEnd;          // 1=send the end of transfer frame
+
+    EVLOG_REC_t page[EVLOG_PAGE_RECS];    // page being written or read
+    EVLOG_REC_t rdBuf[EVLOG_PAGE_RECS];   // records being sent
+} EVLOG_t;
+#pragma pack()  // restore packing setting
+
+// ------------------
+// access global data
+// ------------------
+extern EVLOG_t g_evlog;
+
+// --------------------
+// Function Prototyping
+// --------------------
+void evlog_Add(EVLOG_TYPE_t type, uint8_t code);  // foreground only
+void evlog_Watch(void);         // record error and charger state changes; call every msec
+void evlog_Driver(void);        // nvm driver calls when it has nothing else to do
+void evlog_StartRead(uint16_t nrecs);
+void evlog_Poll(void);          // can task; send the bulk read
+
+#endif  //  _EVLOG_H_
+
+// <><><><><><><><><><><><><> evlog.h <><><><><><><><><><><><><><><><><><><><><><>
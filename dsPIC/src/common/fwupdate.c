@@ -0,0 +1,425 @@
+// <><><><><><><><><><><><><> fwupdate.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Firmware update over CAN (see fwupdate.h)
+//
+//  Stages the image in program flash for the bootloader to swap in.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "bootloader.h"
+#include "charger.h"
+#include "crc.h"
+#include "dsPIC33_CAN.h"
+#include "fwupdate.h"
+#include "inverter.h"
+#include "J1939.h"
+#include "sensata_can.h"
+#ifdef __linux__
+ #include "fwup_sim.h"  // host: program flash stand-in
+#endif
+
+// -----------
+// Constants
+// -----------
+#define STAGE_PAGE_ADDRESS(n)   (FW_STAGE_ADDRESS + (uint32_t)(n)*FLASH_PAGE_SIZE)
+
+// image header and code; instructions from FW_BASE_ADDRESS
+#define IMG_LENGTH_INSTR        ((FW_LENGTH_ADDRESS   - FW_BASE_ADDRESS)/2)
+#define IMG_CODE_INSTR          ((FW_CODE_ADDRESS     - FW_BASE_ADDRESS)/2)
+
+// NVMCON operations; no page erase, see fwupdate.h
+#define NVMOP_ROW_WRITE         0x4001
+
+// ------------
+// global data
+// ------------
+FWUP_t g_fwup = { 0 };
+
+// ------------------
+// access global data
+// ------------------
+extern char _sysShutDown;   // 0=run, 1=shutdown system
+
+#if !defined(WIN32) && !defined(__linux__)
+// keeps the linker from placing firmware in the staging area and the swap record
+__prog__ const uint16_t s_fwStage[FW_STAGE_PAGES*FLASH_PAGE_SIZE/2] __attribute__((space(prog), address(FW_STAGE_ADDRESS), noload));
+#endif
+
+// -----------------------------------------------------------------------------
+//            P R O G R A M    F L A S H
+// -----------------------------------------------------------------------------
+// the cpu stalls until a row write is done; interrupts wait
+
+#if !defined(WIN32) && !defined(__linux__)
+// -----------------------------------------------------------------------------
+static void fwup_FlashOp(uint16_t nvmop)
+{
+    NVMCON = nvmop;
+
+    // unlock sequence
+    __builtin_disi(5);      // Disable interrupts for 5 cycles
+    NVMKEY = 0x55;          // Write requisite KEY values for FLASH access
+    NVMKEY = 0xAA;
+    NVMCONbits.WR = 1;      // Start the operation
+    __builtin_nop();        // Requires two nops for time delay
+    __builtin_nop();
+    while (NVMCONbits.WR) ; // done
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// write FLASH_ROW_INSTR instructions; 3 bytes each lsb first
+static void fwup_WriteRow(uint32_t addr, const uint8_t* src)
+{
+#ifdef __linux__
+    fwsim_WriteRow(addr, src);
+#else
+    uint16_t saveTblPag = TBLPAG;
+    uint16_t offset = (uint16_t)addr;
+    uint16_t i;
+
+    TBLPAG = (uint16_t)(addr >> 16);
+    for (i=0; i<FLASH_ROW_INSTR; i++, offset+=2, src+=3)
+    {
+        __builtin_tblwtl(offset, MKWORD(src[0], src[1]));  // load the write latches
+        __builtin_tblwth(offset, src[2]);
+    }
+    fwup_FlashOp(NVMOP_ROW_WRITE);
+    ClrWdt();
+    TBLPAG = saveTblPag;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// read ninstr instructions; 3 bytes each lsb first
+static void fwup_Read(uint32_t addr, uint16_t ninstr, uint8_t* buf)
+{
+#ifdef __linux__
+    fwsim_Read(addr, ninstr, buf);
+#else
+    uint16_t saveTblPag = TBLPAG;
+    uint16_t lo, hi;
+
+    while (ninstr--)
+    {
+        TBLPAG = (uint16_t)(addr >> 16);
+        lo = __builtin_tblrdl((uint16_t)addr);
+        hi = __builtin_tblrdh((uint16_t)addr);
+        *buf++ = LOBYTE(lo);
+        *buf++ = HIBYTE(lo);
+        *buf++ = LOBYTE(hi);
+        addr += 2;
+    }
+    TBLPAG = saveTblPag;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// returns: 1=every byte read back erased, 0=not
+static int16_t fwup_IsBlank(const uint8_t* buf, uint16_t nbytes)
+{
+    while (nbytes--)
+    {
+        if (*buf++ != ERASED_BYTE_VALUE) return(0);
+    }
+    return(1);
+}
+
+// -----------------------------------------------------------------------------
+//            U P D A T E
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+static void fwup_SendStatus(void)
+{
+    CAN_DATA data[8];
+
+    data[0] = g_can.MyInstance;
+    data[1] = g_fwup.state;
+    data[2] = g_fwup.next;
+    data[3] = g_fwup.error;
+    data[4] = g_fwup.nextRow;
+    data[5] = 0xFF;
+    data[6] = 0xFF;
+    data[7] = 0xFF;
+    J1939_SendMessage(SENSATA_CUSTOM_FWUP_STATUS_DGN, sizeof(data), data);
+}
+
+// -----------------------------------------------------------------------------
+static void fwup_Fail(uint8_t error)
+{
+    LOG(SS_SYS, SV_ERR, "FwUpdate failed err=%u page=%u", error, g_fwup.next);
+    J1939_DisarmMultiPacketRx();
+    g_fwup.state = FWUP_ST_ERROR;
+    g_fwup.error = error;
+    g_fwup.step  = FWUP_STEP_NONE;
+    fwup_SendStatus();
+}
+
+// -----------------------------------------------------------------------------
+// a row transfer is complete; tell the tool which row to send next before
+// the flash work stalls the cpu; the work is done on the next poll, once the
+// status is on its way
+static void fwup_RowIn(uint16_t len)
+{
+    if (len != FWUP_ROW_MSG_BYTES || g_fwup.row[0] != g_fwup.next || g_fwup.row[1] != g_fwup.nextRow)
+    {
+        // repeat or skipped row; ask for the one we need
+        LOG(SS_SYS, SV_WARN, "FwUpdate page=%u row=%u len=%u expected=%u/%u",
+            g_fwup.row[0], g_fwup.row[1], len, g_fwup.next, g_fwup.nextRow);
+        g_fwup.error = FWUP_ERR_SEQUENCE;
+        J1939_ArmMultiPacketRx(SENSATA_CUSTOM_FWUP_DATA_DGN, g_fwup.row, sizeof(g_fwup.row));
+        fwup_SendStatus();
+        return;
+    }
+    g_fwup.error = FWUP_ERR_NONE;
+    if (++g_fwup.nextRow >= FLASH_PAGE_ROWS)
+    {
+        g_fwup.nextRow = 0;
+        g_fwup.next++;
+    }
+    g_fwup.lastTicks = GetSysTicks();
+    g_fwup.step = FWUP_STEP_PROGRAM;
+    if (g_fwup.next < g_fwup.npages) fwup_SendStatus();
+}
+
+// -----------------------------------------------------------------------------
+// program the row received into the erased stage and check it
+static void fwup_ProgramRow(void)
+{
+    uint8_t  buf[FLASH_ROW_BYTES];
+    uint32_t addr = STAGE_PAGE_ADDRESS(g_fwup.row[0]) + (uint32_t)g_fwup.row[1]*FLASH_ROW_INSTR*2;
+    uint8_t* src  = &g_fwup.row[2];
+
+    fwup_Read(addr, FLASH_ROW_INSTR, buf);
+    if (!fwup_IsBlank(buf, FLASH_ROW_BYTES))
+    {
+        g_fwup.next    = g_fwup.row[0];
+        g_fwup.nextRow = g_fwup.row[1];
+        fwup_Fail(FWUP_ERR_NOT_BLANK);
+        return;
+    }
+    fwup_WriteRow(addr, src);
+    fwup_Read(addr, FLASH_ROW_INSTR, buf);
+    if (memcmp(buf, src, FLASH_ROW_BYTES))
+    {
+        g_fwup.next    = g_fwup.row[0];
+        g_fwup.nextRow = g_fwup.row[1];
+        fwup_Fail(FWUP_ERR_PROGRAM);
+        return;
+    }
+    g_fwup.step = FWUP_STEP_NONE;
+
+    if (g_fwup.next < g_fwup.npages)
+    {
+        J1939_ArmMultiPacketRx(SENSATA_CUSTOM_FWUP_DATA_DGN, g_fwup.row, sizeof(g_fwup.row));
+        return;
+    }
+
+    // all in; read it all back
+    LOG(SS_SYS, SV_INFO, "FwUpdate %u pages staged", g_fwup.npages);
+    g_fwup.state    = FWUP_ST_VERIFY;
+    g_fwup.next     = 0;
+    g_fwup.nextRow  = 0;
+    g_fwup.rxCrc32  = CRC32_INIT;
+    g_fwup.imgCrc32 = CRC32_INIT;
+    g_fwup.imgInstr = 0;
+    fwup_SendStatus();
+}
+
+// -----------------------------------------------------------------------------
+// continue the firmware image check (bootloader.h) over ninstr instructions read
+// back; instr is the image instruction of buf[0]. Only the code counts: from
+// FW_CODE_ADDRESS for the image length, which the header gives before the code.
+static uint32_t fwup_ImageCrcUpdate(uint32_t crc, uint32_t instr, const uint8_t* buf, uint16_t ninstr)
+{
+    uint32_t end = IMG_CODE_INSTR + (uint32_t)g_fwup.imgInstr;
+
+    if (instr + ninstr <= IMG_CODE_INSTR || instr >= end) return(crc);
+    if (instr < IMG_CODE_INSTR)
+    {
+        buf    += (IMG_CODE_INSTR - instr)*3;
+        ninstr -= (uint16_t)(IMG_CODE_INSTR - instr);
+        instr   = IMG_CODE_INSTR;
+    }
+    if (instr + ninstr > end) ninstr = (uint16_t)(end - instr);
+    return(crc32_Update(crc, buf, ninstr*3));
+}
+
+// -----------------------------------------------------------------------------
+// read back one staged page into the image checks
+static void fwup_VerifyPage(void)
+{
+    uint8_t  buf[FLASH_ROW_BYTES];
+    uint32_t addr = STAGE_PAGE_ADDRESS(g_fwup.next);
+    uint32_t instr = (uint32_t)g_fwup.next * FLASH_PAGE_INSTR;   // image instruction of buf[0]
+    uint16_t r;
+
+    for (r=0; r<FLASH_PAGE_ROWS; r++, addr+=FLASH_ROW_INSTR*2, instr+=FLASH_ROW_INSTR)
+    {
+        fwup_Read(addr, FLASH_ROW_INSTR, buf);
+        g_fwup.rxCrc32 = crc32_Update(g_fwup.rxCrc32, buf, FLASH_ROW_BYTES);
+
+        // image header; precedes the code
+        if (instr <= IMG_LENGTH_INSTR && IMG_LENGTH_INSTR < instr + FLASH_ROW_INSTR)
+        {
+            g_fwup.imgInstr = MKWORD(buf[(IMG_LENGTH_INSTR  -instr)*3], buf[(IMG_LENGTH_INSTR  -instr)*3+1]);
+        }
+        g_fwup.imgCrc32 = fwup_ImageCrcUpdate(g_fwup.imgCrc32, instr, buf, FLASH_ROW_INSTR);
+    }
+
+    if (++g_fwup.next < g_fwup.npages) return;
+
+    // the image must end inside the staged pages
+    if (g_fwup.imgInstr == 0 || IMG_CODE_INSTR + (uint32_t)g_fwup.imgInstr > (uint32_t)g_fwup.npages * FLASH_PAGE_INSTR)
+    {
+        fwup_Fail(FWUP_ERR_IMAGE);
+    }
+    else if (CRC32_FINAL(g_fwup.rxCrc32) != g_fwup.crc32)
+    {
+        fwup_Fail(FWUP_ERR_CRC);
+    }
+    else
+    {
+        g_fwup.imgCrc32 = CRC32_FINAL(g_fwup.imgCrc32);
+        LOG(SS_SYS, SV_INFO, "FwUpdate verified instr=%u crc=%08lX code crc=%08lX", g_fwup.imgInstr, g_fwup.crc32, g_fwup.imgCrc32);
+        g_fwup.state = FWUP_ST_READY;
+        fwup_SendStatus();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// hand the verified image to the bootloader
+static void fwup_Commit(void)
+{
+    uint8_t* row = g_fwup.row;      // free now; FLASH_ROW_BYTES needed
+
+    memset(row, ERASED_BYTE_VALUE, FLASH_ROW_BYTES);
+    row[0]  = LOBYTE(FW_SWAP_MAGIC);
+    row[1]  = HIBYTE(FW_SWAP_MAGIC);
+    row[3]  = g_fwup.npages;
+    row[4]  = 0;
+    row[6]  = LOBYTE(g_fwup.crc32);
+    row[7]  = HIBYTE(g_fwup.crc32);
+    row[9]  = LOBYTE(g_fwup.crc32 >> 16);
+    row[10] = HIBYTE(g_fwup.crc32 >> 16);
+    row[12] = LOBYTE(g_fwup.imgCrc32);
+    row[13] = HIBYTE(g_fwup.imgCrc32);
+    row[15] = LOBYTE(g_fwup.imgCrc32 >> 16);
+    row[16] = HIBYTE(g_fwup.imgCrc32 >> 16);
+    fwup_WriteRow(FW_SWAP_ADDRESS, row);
+
+    LOG(SS_SYS, SV_INFO, "FwUpdate commit; entering bootloader");
+    g_fwup.state = FWUP_ST_IDLE;
+    _sysShutDown = 1;   // set system shutdown flag
+}
+
+// -----------------------------------------------------------------------------
+// returns: 0=ok, 1=refused
+int16_t fwup_Cmd(CAN_DATA* data)
+{
+    switch (data[1])
+    {
+    case FWUP_CMD_START:
+        J1939_DisarmMultiPacketRx();
+        g_fwup.state     = FWUP_ST_IDLE;
+        g_fwup.step      = FWUP_STEP_NONE;
+        g_fwup.next      = 0;
+        g_fwup.nextRow   = 0;
+        g_fwup.npages    = data[2];
+        g_fwup.crc32     = ((uint32_t)MKWORD(data[5], data[6]) << 16) | MKWORD(data[3], data[4]);
+        g_fwup.lastTicks = GetSysTicks();
+        if (IsInvActive() || IsChgrActive())
+        {
+            fwup_Fail(FWUP_ERR_BUSY);
+            return(1);
+        }
+        if (g_fwup.npages == 0 || g_fwup.npages > FW_STAGE_MAX_PAGES)
+        {
+            fwup_Fail(FWUP_ERR_SIZE);
+            return(1);
+        }
+      #ifndef BL_HAS_STAGE_SWAP
+        // the bootloader would not copy it in
+        fwup_Fail(FWUP_ERR_NO_SWAP);
+        return(1);
+      #endif
+        // left erased by the bootloader; the stage rows are checked as they go in
+        fwup_Read(FW_SWAP_ADDRESS, FLASH_ROW_INSTR, g_fwup.row);
+        if (!fwup_IsBlank(g_fwup.row, FLASH_ROW_BYTES))
+        {
+            fwup_Fail(FWUP_ERR_NOT_BLANK);
+            return(1);
+        }
+        LOG(SS_SYS, SV_INFO, "FwUpdate start pages=%u crc=%08lX", g_fwup.npages, g_fwup.crc32);
+        g_fwup.error = FWUP_ERR_NONE;
+        g_fwup.state = FWUP_ST_RECEIVE;
+        J1939_ArmMultiPacketRx(SENSATA_CUSTOM_FWUP_DATA_DGN, g_fwup.row, sizeof(g_fwup.row));
+        fwup_SendStatus();
+        return(0);
+
+    case FWUP_CMD_COMMIT:
+        if (g_fwup.state != FWUP_ST_READY)
+        {
+            g_fwup.error = FWUP_ERR_STATE;
+            fwup_SendStatus();
+            return(1);
+        }
+        fwup_Commit();
+        return(0);
+
+    case FWUP_CMD_ABORT:
+        J1939_DisarmMultiPacketRx();
+        g_fwup.state = FWUP_ST_IDLE;
+        g_fwup.step  = FWUP_STEP_NONE;
+        return(0);
+    } // switch
+    return(1);
+}
+
+// -----------------------------------------------------------------------------
+// called from the can task
+void fwup_Poll(void)
+{
+    uint16_t len;
+
+    if (g_fwup.state != FWUP_ST_RECEIVE && g_fwup.state != FWUP_ST_VERIFY) return;
+
+    // flash work stalls the cpu; power stages must stay off
+    if (IsInvActive() || IsChgrActive())
+    {
+        fwup_Fail(FWUP_ERR_BUSY);
+        return;
+    }
+
+    if (g_fwup.state == FWUP_ST_VERIFY)
+    {
+        fwup_VerifyPage();
+        return;
+    }
+
+    if (g_fwup.step == FWUP_STEP_PROGRAM)
+    {
+        fwup_ProgramRow();
+        return;
+    }
+
+    len = J1939_MultiPacketRxDone();
+    if (len)
+    {
+        fwup_RowIn(len);
+    }
+    else if (IsTimedOut(FWUP_TIMEOUT_MSEC, g_fwup.lastTicks))
+    {
+        fwup_Fail(FWUP_ERR_TIMEOUT);
+    }
+}
+
+// <><><><><><><><><><><><><> fwupdate.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,142 @@
+// <><><><><><><><><><><><><> fwupdate.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Firmware update over CAN
+//
+//  A new image is sent a flash row per multi-packet (BAM) transfer into the
+//  staging area (FW_STAGE_ADDRESS; see bootloader.h). Once all pages are
+//  in, the staged image is read back and checked: crc-32 of the pages against
+//  the one the tool announced, and the image length in its header against
+//  the pages staged. The same read back works out the firmware image check,
+//  the crc-32 of the code from FW_CODE_ADDRESS, which commit puts in the swap
+//  record for the bootloader to check its copy against. The checksum in the
+//  header is left to the bootloader, which checks it at boot as it always has.
+//  Only then does commit write the swap record and shut down into the
+//  bootloader, which copies the stage over the running firmware.
+//
+//  The stage is the top half of the firmware pages, less the page for the
+//  swap record, so an image is at most FW_STAGE_MAX_PAGES (34) pages and the
+//  firmware is linked below FW_STAGE_ADDRESS. A 70 page image cannot be
+//  staged beside the one running; that takes a bootloader that receives it.
+//  The swap is bootloader work that is not in this tree (the stage contract
+//  in bootloader.h): until BL_HAS_STAGE_SWAP is defined an update is refused
+//  at start, rather than stream an image that cannot be swapped in.
+//
+//  Nothing here erases flash. A page erase stalls the cpu for 20 msec, past
+//  the 8 msec watchdog, and the watchdog stays on. The bootloader leaves the
+//  stage and the swap record erased; a row that is not is refused
+//  (FWUP_ERR_NOT_BLANK), and entering the bootloader clears it.
+//
+//  A row write stalls the cpu for 1.6 msec, so nothing runs and only the
+//  first frame to arrive is kept meanwhile. The inverter and charger must be
+//  off. A row is programmed right after its last packet, in the gap the tool
+//  leaves between the announce of the next row and its first packet; the
+//  announce waits in the ECAN buffer. A row per transfer keeps the receive
+//  buffer to FWUP_ROW_MSG_BYTES.
+//
+//  Command:  SENSATA_CUSTOM_FWUP_DGN
+//    data[0]    instance
+//    data[1]    FWUP_CMD_xxx
+//    start:     data[2] pages, data[3..6] crc-32 of the pages (lsb first)
+//  ACK, or NAK when refused; the status frame tells why
+//
+//  Row:      SENSATA_CUSTOM_FWUP_DATA_DGN, multi-packet broadcast
+//    [0]        page number; 0 = FW_BASE_ADDRESS
+//    [1]        row in the page; 0 to FLASH_PAGE_ROWS-1
+//    [2..193]   FLASH_ROW_BYTES image bytes; 3 per instruction lsb first
+//  The tool either waits for the status asking for the row, or sends it
+//  straight on and waits FWUP_ROW_GAP_MSEC between the announce and packet 1.
+//
+//  Status:   SENSATA_CUSTOM_FWUP_STATUS_DGN; at start, after each row and at the end
+//    data[0]    instance
+//    data[1]    FWUP_ST_xxx
+//    data[2]    next page expected
+//    data[3]    FWUP_ERR_xxx
+//    data[4]    next row expected
+//    data[5..7] 0xFF
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _FWUPDATE_H_    // include only once
+#define _FWUPDATE_H_
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "bootloader.h"
+#include "dsPIC33_CAN.h"
+
+// ---------
+// constants
+// ---------
+#define FWUP_ROW_MSG_BYTES      (2 + FLASH_ROW_BYTES)   // page and row number + row
+#define FWUP_ROW_GAP_MSEC       (3)     // tool; announce to first packet; covers a poll and a row write
+#define FWUP_TIMEOUT_MSEC       (5000)  // give up when no page arrives for this long
+
+// commands
+#define FWUP_CMD_START          1
+#define FWUP_CMD_COMMIT         2       // swap in the verified image and reboot
+#define FWUP_CMD_ABORT          3
+
+// states
+#define FWUP_ST_IDLE            0
+#define FWUP_ST_RECEIVE         1       // pages coming in
+#define FWUP_ST_VERIFY          2       // reading back the staged image
+#define FWUP_ST_READY           3       // verified; waiting for commit
+#define FWUP_ST_ERROR           4
+
+// errors
+#define FWUP_ERR_NONE           0
+#define FWUP_ERR_BUSY           1       // inverter or charger running
+#define FWUP_ERR_SIZE           2       // too many pages for the stage
+#define FWUP_ERR_SEQUENCE       3       // row out of order
+#define FWUP_ERR_PROGRAM        4       // read back does not match
+#define FWUP_ERR_CRC            5       // crc-32 of the staged pages
+#define FWUP_ERR_IMAGE          6       // image length in its header does not fit the pages
+#define FWUP_ERR_TIMEOUT        7
+#define FWUP_ERR_STATE          8       // command not valid now
+#define FWUP_ERR_NO_SWAP        9       // start; the bootloader cannot swap (BL_HAS_STAGE_SWAP)
+#define FWUP_ERR_NOT_BLANK      10      // stage or swap record not erased; enter the bootloader
+
+// flash work steps; done from the can task
+#define FWUP_STEP_NONE          0
+#define FWUP_STEP_PROGRAM       1       // program the row just received
+
+// -----------
+// update data
+// -----------
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    uint8_t   state;            // FWUP_ST_xxx
+    uint8_t   error;            // FWUP_ERR_xxx
+    uint8_t   step;             // FWUP_STEP_xxx
+    uint8_t   npages;           // pages in the image
+    uint8_t   next;             // next page expected; page being verified
+    uint8_t   nextRow;          // next row expected in it
+    uint32_t  crc32;            // announced by the tool
+    uint32_t  rxCrc32;          // running crc-32 of the verify read back
+    uint32_t  imgCrc32;         // running crc-32 of the image code; firmware image check (bootloader.h)
+    uint16_t  imgInstr;         // image length in instructions; from its header
+    SYSTICKS  lastTicks;        // last page or command
+    CAN_DATA  row[FWUP_ROW_MSG_BYTES];   // multi-packet receive buffer
+} FWUP_t;
+#pragma pack()  // restore packing setting
+
+// ------------------
+// access global data
+// ------------------
+extern FWUP_t g_fwup;
+
+// --------------------
+// Function Prototyping
+// --------------------
+int16_t fwup_Cmd(CAN_DATA* data);   // returns 0=ok, 1=refused
+void    fwup_Poll(void);            // can task
+
+#endif  //  _FWUPDATE_H_
+
+// <><><><><><><><><><><><><> fwupdate.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -97,8 +97,10 @@
     //  RC13 (pin-47)
     #if IS_PCB_BDC
        #define AC_LINE_PHASE()         (0) // not available
+       #define HAS_AC_LINE_PHASE       (0)
     #else
        #define AC_LINE_PHASE()         (1==PORTCbits.RC13)
+       #define HAS_AC_LINE_PHASE       (1)
     #endif
 
     //  RC14 (pin-48)       TP36 
@@ -196,6 +198,7 @@
     // -------------------------------------------------------------------------- 
 
     #define AC_LINE_PHASE()     (0)     //  NOT available
+    #define HAS_AC_LINE_PHASE   (0)
 
     // -------------------------------------------
     // Programming Header pins used for debugging
@@ -303,7 +306,12 @@ void RB7_NumToScope(uint8_t num);
 //  Fcy == MIPS == (Fosc * PLLx)/4      4 Q-clocks per instruction
 #define FCY 40000000
 
-#define CPU_Reboot()  { asm("RESET"); } // need to shutdown any hardware first?
+#ifdef __linux__
+  extern void host_Reboot(void);    // host build; see host/host_stubs.c
+  #define CPU_Reboot()  { host_Reboot(); }
+#else
+  #define CPU_Reboot()  { asm("RESET"); } // need to shutdown any hardware first?
+#endif
 
 #endif // _HW_H_
 
@@ -0,0 +1,69 @@
+// <><><><><><><><><><><><><> inv_deadtime.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Inverter bridge dead time compensation (see inv_deadtime.h)
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "inv_deadtime.h"
+
+#ifdef OPTION_INV_DTC_DUTY
+
+// ---------
+// constants
+// ---------
+
+// 32/16 divide; the quotient must fit 16 bits
+#ifdef __linux__
+  #define DTC_DIV(num, den)     ((int16_t)((num) / (den)))
+#else
+  #define DTC_DIV(num, den)     __builtin_divsd((num), (den))
+#endif
+
+// ------------
+// Global Data
+// ------------
+const int16_t  g_invDtcDuty[] = { OPTION_INV_DTC_DUTY };
+const uint16_t g_invDtcLast   = (sizeof(g_invDtcDuty) / sizeof(g_invDtcDuty[0])) - 1;
+INV_DTC_t      g_invDtc       = { 0, 0, 0, 0 };
+
+
+//-----------------------------------------------------------------------------
+//  inv_DeadTimeCycle()
+//-----------------------------------------------------------------------------
+//  Learns the sense polarity from the mean current with the drive over the
+//  cycle; see inv_deadtime.h. One 32/16 divide.
+//-----------------------------------------------------------------------------
+
+void inv_DeadTimeCycle(void)
+{
+    int16_t mean;
+
+    if (g_invDtc.samples && (0 == g_invDtc.sign))
+    {
+        mean = DTC_DIV(g_invDtc.sum, (int16_t)g_invDtc.samples);
+        if (mean > INV_DTC_SIGN_MEAN)
+            g_invDtc.agree = (g_invDtc.agree > 0) ? g_invDtc.agree + 1 :  1;
+        else if (mean < -INV_DTC_SIGN_MEAN)
+            g_invDtc.agree = (g_invDtc.agree < 0) ? g_invDtc.agree - 1 : -1;
+        else
+            g_invDtc.agree = 0;
+
+        if (g_invDtc.agree >= INV_DTC_SIGN_CYCLES)
+            g_invDtc.sign = 1;
+        else if (g_invDtc.agree <= -INV_DTC_SIGN_CYCLES)
+            g_invDtc.sign = -1;
+    }
+    g_invDtc.sum     = 0;
+    g_invDtc.samples = 0;
+}
+
+#endif  //  OPTION_INV_DTC_DUTY
+
+// <><><><><><><><><><><><><> inv_deadtime.c <><><><><><><><><><><><><><><><><><><><><><>
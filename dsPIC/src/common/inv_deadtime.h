@@ -0,0 +1,148 @@
+// <><><><><><><><><><><><><> inv_deadtime.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Inverter bridge dead time compensation
+//
+//  The leg that pulses in each half-cycle has its dead time (DTCON1) ahead
+//  of the high side turning on. While the primary current flows with the
+//  drive, the low side diode carries it through the dead time and the
+//  pulse comes out short by the dead time; while it flows against the
+//  drive (reactive and capacitive loads, near the zero crossings) the high
+//  side diode carries it and the pulse comes out long. The error is
+//  largest in proportion where the duty is smallest, so the output is
+//  flattened at the zero crossings, and the voltage loop hardly sees it
+//  there because its error is sine-weighted.
+//
+//  inv_DeadTimeComp() gives the duty counts to add for the output current,
+//  signed with the drive: IMeasRaw() less IMeasCycleAvg(), turned round for
+//  the negative half-cycle. The counts come from a per-model table
+//  (OPTION_INV_DTC_DUTY, in the Models header) at 0, 1, 2 ...
+//  OPTION_INV_DTC_AMPS_STEP output amps, interpolated and held at the last
+//  entry. The table goes through zero at no current, so the compensation
+//  does not chatter as the current crosses zero, and it levels off at the
+//  dead time: the I*R drop of the FETs and copper is not added back, as
+//  more duty for more current is positive feedback into a low impedance
+//  load. The voltage loop takes the drop up. With no table for the model
+//  the compensation is not built.
+//
+//  Which way IMeas goes with the drive is learnt, not assumed: the real
+//  power out of the inverter is positive, so over an a/c cycle the current
+//  signed with the drive averages positive with the right sense polarity.
+//  inv_DeadTimeSample() sums it every PWM period and inv_DeadTimeCycle()
+//  sets the polarity once INV_DTC_SIGN_CYCLES cycles in a row agree at more
+//  than INV_DTC_SIGN_AMPS; until then nothing is added. The polarity is
+//  kept for as long as the power is on.
+//
+//  The host harness checks the THD of the output with and without it on a
+//  PC, with the sense either way round (dsPIC/host, 'make check', check
+//  "deadtime"). It has not been checked on a unit.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __INV_DEADTIME_H    // include only once
+#define __INV_DEADTIME_H
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+
+#ifdef OPTION_INV_DTC_DUTY
+
+// ---------
+// constants
+// ---------
+
+// table step; imeas counts
+#define INV_DTC_STEP        (IMEAS_INV_AMPS_ADC(OPTION_INV_DTC_AMPS_STEP) - IMEAS_INV_AMPS_ADC(0))
+
+// table index per imeas count; Q16
+#define INV_DTC_SCALE       ((uint16_t)(65536.0 / INV_DTC_STEP))
+
+// sense polarity; mean current with the drive over a cycle (output amps), cycles in a row
+#define INV_DTC_SIGN_AMPS   (0.5)
+#define INV_DTC_SIGN_MEAN   (IMEAS_INV_AMPS_ADC(INV_DTC_SIGN_AMPS) - IMEAS_INV_AMPS_ADC(0))
+#define INV_DTC_SIGN_CYCLES (8)
+
+// ----------
+// data types
+// ----------
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    int32_t  sum;       // imeas with the drive, as measured, over the a/c cycle
+    uint16_t samples;   // in sum
+    int8_t   sign;      // +1: IMeas goes up while VECTOR2 drives, -1: down; 0=not known
+    int8_t   agree;     // cycles in a row for a sign: > 0 for +1, < 0 for -1
+} INV_DTC_t;
+#pragma pack()  // restore packing setting
+
+// ------------
+// Global Data
+// ------------
+extern const int16_t  g_invDtcDuty[];   // duty counts at 0, 1, 2 ... table steps
+extern const uint16_t g_invDtcLast;     // index of the last entry
+extern INV_DTC_t      g_invDtc;
+
+// --------------------
+// Function Prototyping
+// --------------------
+extern void inv_DeadTimeCycle(void);    // end of each a/c cycle while running closed loop
+
+//-----------------------------------------------------------------------------
+// duty counts to add, for imeas counts of current with the drive (< 0 against)
+
+INLINE int16_t inv_DeadTimeComp(int16_t imeas)
+{
+    uint16_t mag = (imeas < 0) ? -imeas : imeas;
+    uint32_t pos;   // table index; Q8
+    uint16_t k;
+    int16_t  duty;
+
+    pos = ((uint32_t)mag * INV_DTC_SCALE) >> 8;
+    k   = (pos > 0xFFFF) ? 0xFF : (uint16_t)(pos >> 8);
+    if (k >= g_invDtcLast)
+    {
+        duty = g_invDtcDuty[g_invDtcLast];
+    }
+    else
+    {
+        duty = g_invDtcDuty[k] +
+               (int16_t)(((int32_t)(g_invDtcDuty[k+1] - g_invDtcDuty[k]) * (pos & 0xFF)) >> 8);
+    }
+    return((imeas < 0) ? -duty : duty);
+}
+
+//-----------------------------------------------------------------------------
+// a new output; the sense polarity is kept
+
+INLINE void inv_DeadTimeRestart(void)
+{
+    g_invDtc.sum     = 0;
+    g_invDtc.samples = 0;
+    g_invDtc.agree   = 0;
+}
+
+//-----------------------------------------------------------------------------
+// every PWM period; imeas_ac is IMeasRaw() less IMeasCycleAvg(), vector2 is
+// 1 while VECTOR2 drives. Returns the duty counts to add; 0 until the sense
+// polarity is known
+
+INLINE int16_t inv_DeadTimeSample(int16_t imeas_ac, uint8_t vector2)
+{
+    int16_t imeas = vector2 ? imeas_ac : -imeas_ac;
+
+    g_invDtc.sum += imeas;
+    g_invDtc.samples++;
+    if (0 == g_invDtc.sign) return(0);
+    return(inv_DeadTimeComp((g_invDtc.sign < 0) ? -imeas : imeas));
+}
+
+#endif  //  OPTION_INV_DTC_DUTY
+
+#endif  //  __INV_DEADTIME_H
+
+// <><><><><><><><><><><><><> inv_deadtime.h <><><><><><><><><><><><><><><><><><><><><><>
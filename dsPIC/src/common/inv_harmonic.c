@@ -0,0 +1,184 @@
+// <><><><><><><><><><><><><> inv_harmonic.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Inverter voltage loop harmonic compensation (see inv_harmonic.h)
+//
+//  Runs in the inverter PWM ISR, once per PWM period.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "inverter.h"
+#include "inv_harmonic.h"
+
+// ---------
+// constants
+// ---------
+#define RC_FRAC_BITS    (4)             // rc memory holds duty counts x16
+#define PR_HARMONICS    (3)
+#define PR_FRAC_BITS    (17)            // resonant integrators; duty counts x2^17 spread over the cycle
+
+// 16x16 multiplies; one mul.ss on the target
+#ifdef __linux__
+  #define HC_MULSS(a, b)    ((int32_t)(int16_t)(a) * (int16_t)(b))
+#else
+  #define HC_MULSS(a, b)    __builtin_mulss((a), (b))
+#endif
+
+// ----------
+// local data
+// ----------
+static int16_t  _RcMem[INV_HC_BINS];    // repetitive correction per bin (duty counts x16)
+static int16_t  _RcWipeIndex = 0;       // clears _RcMem one entry per PWM period when not in use
+static uint16_t _RcLastBin = INV_HC_BINS;   // bin of the previous PWM period
+static int32_t  _PrSin[PR_HARMONICS];   // resonant integrators
+static int32_t  _PrCos[PR_HARMONICS];
+static uint8_t  _PrTurn = 0;            // the resonant integrator that learns this PWM period
+static const uint8_t _PrHarmonic[PR_HARMONICS] = { 3, 5, 7 };    // not the 1st; see inv_harmonic.h
+
+//-----------------------------------------------------------------------------
+// sine of the full a/c cycle; index 0..INV_HC_BINS-1; Q15
+INLINE int16_t _inv_SineQ15(uint16_t index)
+{
+    if (index < MAX_SINE) return((int16_t)(_SineTableQ16[index] >> 1));
+    return(-(int16_t)(_SineTableQ16[index-MAX_SINE] >> 1));
+}
+
+//-----------------------------------------------------------------------------
+INLINE void _inv_ClampQ(int32_t* val, int32_t limit)
+{
+    if (*val >  limit) *val =  limit;
+    if (*val < -limit) *val = -limit;
+}
+
+//-----------------------------------------------------------------------------
+// repetitive term for bin k of the a/c cycle; error in a/d counts
+// returns: duty cycle correction (magnitude domain)
+static int16_t _inv_RepetitiveTerm(uint16_t k, int16_t error, uint8_t learn)
+{
+    uint16_t lead = Inv.config.rc_lead;
+    uint16_t j, jm, jp;
+    int32_t  acc;
+
+    if (learn)
+    {
+        // the bin whose duty cycle this error comes from
+        j  = (k >= lead) ? (k - lead) : (k + INV_HC_BINS - lead);
+        jm = (j > 0) ? (j - 1) : (INV_HC_BINS - 1);
+        jp = (j < (INV_HC_BINS - 1)) ? (j + 1) : 0;
+
+        acc  = ((int32_t)_RcMem[jm] + 2*(int32_t)_RcMem[j] + (int32_t)_RcMem[jp]) >> 2;
+        acc  = (acc * (int32_t)Inv.config.rc_forget) >> 16;
+        acc += ((int32_t)error * Inv.config.rc_gain) >> (16 - RC_FRAC_BITS);
+        _inv_ClampQ(&acc, (int32_t)Inv.config.rc_limit << RC_FRAC_BITS);
+        _RcMem[j] = (int16_t)acc;
+    }
+    return(_RcMem[k] >> RC_FRAC_BITS);
+}
+
+//-----------------------------------------------------------------------------
+// resonant term for bin k of the a/c cycle; error in a/d counts; fresh is 
+// 1 on the first PWM period of a bin
+// returns: duty cycle correction (magnitude domain)
+static int16_t _inv_ResonantTerm(uint16_t k, int16_t error, uint8_t learn, uint8_t fresh)
+{
+    int32_t  limit = (int32_t)Inv.config.rc_limit << PR_FRAC_BITS;
+    int32_t  gerr, out = 0;
+    uint16_t p, pl, c, h;
+
+    // the integrators work on the signed waveform; one learns a period, in
+    // turn, at PR_HARMONICS times the gain
+    if (k >= MAX_SINE) error = -error;
+    gerr = (((int32_t)error * Inv.config.rc_gain) >> 8) * PR_HARMONICS;
+    _inv_ClampQ(&gerr, 32767);
+
+    for (h=0; h<PR_HARMONICS; h++)
+    {
+        p = k * _PrHarmonic[h];
+        while (p >= INV_HC_BINS) p -= INV_HC_BINS;
+
+        if (learn && (h == _PrTurn))
+        {
+            // phase of the bin whose duty cycle this error comes from
+            pl = Inv.config.rc_lead * _PrHarmonic[h];
+            pl = (p >= pl) ? (p - pl) : (p + INV_HC_BINS - pl);
+            c  = pl + INV_HC_BINS/4;
+            if (c >= INV_HC_BINS) c -= INV_HC_BINS;
+            _PrSin[h] += HC_MULSS(gerr, _inv_SineQ15(pl)) >> 15;
+            _PrCos[h] += HC_MULSS(gerr, _inv_SineQ15(c))  >> 15;
+            _inv_ClampQ(&_PrSin[h], limit);
+            _inv_ClampQ(&_PrCos[h], limit);
+        }
+
+        c = p + INV_HC_BINS/4;
+        if (c >= INV_HC_BINS) c -= INV_HC_BINS;
+        out += (HC_MULSS(_PrSin[h] >> PR_FRAC_BITS, _inv_SineQ15(p)) +
+                HC_MULSS(_PrCos[h] >> PR_FRAC_BITS, _inv_SineQ15(c))) >> 15;
+
+        // forget once per cycle, one integrator a bin a quarter-cycle in, away
+        // from the periods the inverter holds the term through
+        if (((INV_HC_BINS/4 + h) == k) && fresh)
+        {
+            uint16_t leak = (uint16_t)(0 - Inv.config.rc_forget);
+            _PrSin[h] -= ((_PrSin[h] >> 8) * (int32_t)leak) >> 8;
+            _PrCos[h] -= ((_PrCos[h] >> 8) * (int32_t)leak) >> 8;
+        }
+    }
+    if (learn && (++_PrTurn >= PR_HARMONICS)) _PrTurn = 0;
+    _inv_ClampQ(&out, Inv.config.rc_limit);
+    return((int16_t)((k >= MAX_SINE) ? -out : out));
+}
+
+//-----------------------------------------------------------------------------
+//  inv_HarmonicWipe()
+//-----------------------------------------------------------------------------
+//  Forgets the learned corrections a mode (INV_VLOOP_xxx) does not use; one
+//  repetitive entry per call. Called every PWM period, with INV_VLOOP_PID
+//  outside normal operation so nothing learned survives a stop.
+//-----------------------------------------------------------------------------
+
+void inv_HarmonicWipe(uint8_t mode)
+{
+    if (INV_VLOOP_REPETITIVE != mode)
+    {
+        _RcMem[_RcWipeIndex] = 0;
+        if (++_RcWipeIndex >= INV_HC_BINS) _RcWipeIndex = 0;
+    }
+    if (INV_VLOOP_RESONANT != mode)
+    {
+        _PrSin[0] = _PrSin[1] = _PrSin[2] = 0;
+        _PrCos[0] = _PrCos[1] = _PrCos[2] = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//  inv_HarmonicTerm()
+//-----------------------------------------------------------------------------
+//  Correction in duty counts (magnitude domain) for phase bin 'bin' of the
+//  a/c cycle and the voltage error (a/d counts, before sine weighting) of
+//  this PWM period. Learns when 'learn' and the bin is new.
+//-----------------------------------------------------------------------------
+
+int16_t inv_HarmonicTerm(uint8_t mode, uint16_t bin, int16_t error, uint8_t learn)
+{
+    uint8_t fresh = (bin != _RcLastBin) ? 1 : 0;
+    int16_t adj   = 0;
+
+    _RcLastBin = bin;
+    if (INV_VLOOP_REPETITIVE == mode)
+    {
+        adj = _inv_RepetitiveTerm(bin, error, (learn && fresh));
+    }
+    else if (INV_VLOOP_RESONANT == mode)
+    {
+        adj = _inv_ResonantTerm(bin, error, (learn && fresh), fresh);
+    }
+    return(adj);
+}
+
+// <><><><><><><><><><><><><> inv_harmonic.c <><><><><><><><><><><><><><><><><><><><><><>
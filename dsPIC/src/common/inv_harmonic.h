@@ -0,0 +1,69 @@
+// <><><><><><><><><><><><><> inv_harmonic.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Inverter voltage loop harmonic compensation (Inv.config.vloop_mode)
+//
+//  The PID loop adjusts one amplitude per half-cycle and resets its integral
+//  at every zero crossing, so distortion that repeats every a/c cycle
+//  (rectifier loads, motor starts) is never corrected; only the RMS setpoint
+//  offset slowly pulls the RMS back. These terms learn the periodic error
+//  and add a correction in duty counts on top of the PID output for each
+//  phase bin of the cycle: the sine table entry dds_Sample() gives for the
+//  output phase, plus MAX_SINE in the VECTOR2 half, so INV_HC_BINS bins.
+//
+//    Repetitive:  one correction per bin; mem[k] += rc_gain * error once per
+//                 cycle, through a [1 2 1]/4 smoothing and the rc_forget
+//                 factor so noise and the highest harmonics do not build up.
+//    Resonant:    sine/cosine integrators at the 3rd, 5th and 7th harmonic;
+//                 the same gain spread over the cycle. Each learns every
+//                 third PWM period in turn, at three times the gain, so a
+//                 period has one learning multiply pair, not three. Less
+//                 RAM, more multiplies.
+//
+//  The amplitude is left to the PID and the RMS setpoint offset
+//  (_inv_AdjustRmsSetpoint()). Into a load that clamps the peaks the
+//  corrections take the RMS down, and the offset then drives the peaks
+//  harder into the clamp; a 1st harmonic integrator works against the
+//  offset on the same fundamental and ends up at its limit, so the
+//  resonant terms leave it out. With the RMS held at the setpoint the THD
+//  comes down by about a third in either mode, not more: the peaks above
+//  the clamp are at MAX_DUTY whatever is learned.
+//
+//  The error is used before sine weighting and in the half-cycle magnitude
+//  domain like the PID. rc_lead shifts the error back to the bin whose duty
+//  caused it. At 60 Hz each bin comes round once per cycle; at 50 Hz some
+//  come round twice in a row, and only the first of those learns, so the
+//  gain per bin does not depend on the output frequency.
+//
+//  The host harness checks the THD and the RMS into a rectifier load with
+//  each mode, the RMS setpoint offset running, on a PC (dsPIC/host, 'make
+//  check', check "vloop"). The ISR time has not been measured on a unit;
+//  _inv_PwmIsr() gives the estimate and how to measure it.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __INV_HARMONIC_H    // include only once
+#define __INV_HARMONIC_H
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "sine_table.h"
+
+// ---------
+// constants
+// ---------
+#define INV_HC_BINS     (MAX_SINE*2)    // phase bins per a/c cycle
+
+// --------------------
+// Function Prototyping
+// --------------------
+extern void    inv_HarmonicWipe(uint8_t mode);  // every PWM period; forgets what the mode does not use
+extern int16_t inv_HarmonicTerm(uint8_t mode, uint16_t bin, int16_t error, uint8_t learn);
+
+#endif  //  __INV_HARMONIC_H
+
+// <><><><><><><><><><><><><> inv_harmonic.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,129 @@
+// <><><><><><><><><><><><><> inv_thermal.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Inverter I2t thermal overload model (see inv_thermal.h)
+//
+//  Runs once per a/c cycle, in the PWM ISR; 32/16 hardware divides only, two
+//  per model.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "hs_temp.h"
+#include "inverter.h"
+#include "inv_thermal.h"
+
+// a/c cycles per 0.1 sec
+#define INV_TH_CYCLES_X10       (OPTION_AC_OUT_HZ / 10)
+
+// 32/16 divides; the quotient must fit 16 bits
+#ifdef __linux__
+  #define TH_DIV(num, den)      ((int16_t)((num) / (den)))
+  #define TH_DIVU(num, den)     ((uint16_t)((num) / (den)))
+#else
+  #define TH_DIV(num, den)      __builtin_divsd((num), (den))
+  #define TH_DIVU(num, den)     __builtin_divud((num), (den))
+#endif
+
+// ------------
+// Global Data
+// ------------
+INV_THERMAL_t g_invThermal = { 0, 0, 0, 0, 0 };
+
+
+//-----------------------------------------------------------------------------
+//  inv_ThermalReset()
+//-----------------------------------------------------------------------------
+//  Everything at ambient. Not for an inverter stop; the hardware is still warm.
+//-----------------------------------------------------------------------------
+
+void inv_ThermalReset(void)
+{
+    g_invThermal.fet      = 0;
+    g_invThermal.xfmr     = 0;
+    g_invThermal.fetLimit = (int16_t)Inv.config.ovl_fet_limit;
+    g_invThermal.fetHot   = 0;
+    g_invThermal.xfmrHot  = 0;
+}
+
+//-----------------------------------------------------------------------------
+// one step of a first order rise toward sq (% of rated) with time constant
+// tau_x10 (0.1 sec); at most 0xFFFF a/c cycles (18 min at 60 Hz)
+
+static int32_t _inv_ThermalStep(int32_t rise, int16_t sq, uint16_t tau_x10)
+{
+    uint32_t cycles = (uint32_t)tau_x10 * INV_TH_CYCLES_X10;
+    int32_t  diff   = ((int32_t)sq << 16) - rise;
+    uint32_t mag    = (diff < 0) ? -diff : diff;
+    uint16_t den, hi, q;
+
+    if (cycles < 1) cycles = 1;
+    den = (cycles > 0xFFFF) ? 0xFFFF : (uint16_t)cycles;
+
+    // mag / den as two 32/16 divides; each quotient fits 16 bits
+    hi  = TH_DIVU(mag >> 16, den);
+    q   = TH_DIVU(((mag >> 16) - (uint32_t)hi * den) << 16 | (mag & 0xFFFF), den);
+    mag = ((uint32_t)hi << 16) | q;
+
+    rise += (diff < 0) ? -(int32_t)mag : (int32_t)mag;
+    return((rise < 0) ? 0 : rise);
+}
+
+//-----------------------------------------------------------------------------
+//  inv_ThermalCycle()
+//-----------------------------------------------------------------------------
+//  Called at the end of each a/c cycle with the output current of the cycle
+//  and the heat sink temperature. Updates fetHot and xfmrHot.
+//-----------------------------------------------------------------------------
+
+void inv_ThermalCycle(int16_t imeas_rms, int16_t hs_temp_c)
+{
+    int32_t ratio;
+    int16_t sq;
+    int16_t limit;
+    int16_t span;
+
+    // per-unit current squared; 100 = rated
+    if (Inv.config.ovl_rated_rms <= 0)
+        ratio = 1000;
+    else if (imeas_rms <= 0)
+        ratio = 0;
+    else if (((int32_t)imeas_rms * 1000) >= ((int32_t)Inv.config.ovl_rated_rms * INV_TH_RATIO_MAX))
+        ratio = INV_TH_RATIO_MAX;
+    else
+        ratio = TH_DIV((int32_t)imeas_rms * 1000, Inv.config.ovl_rated_rms);
+    sq = TH_DIV(ratio * ratio, 10000);
+
+    g_invThermal.fet  = _inv_ThermalStep(g_invThermal.fet,  sq, Inv.config.ovl_fet_tau);
+    g_invThermal.xfmr = _inv_ThermalStep(g_invThermal.xfmr, sq, Inv.config.ovl_xfmr_tau);
+
+    // the heat sink takes the surge headroom away; rated is always allowed
+    limit = (int16_t)Inv.config.ovl_fet_limit;
+    span  = Inv.config.ovl_hs_temp_max - ROOM_TEMP_C;
+    if ((limit > 100) && (hs_temp_c > ROOM_TEMP_C))
+    {
+        if ((span <= 0) || (hs_temp_c >= Inv.config.ovl_hs_temp_max))
+            limit = 100;
+        else
+            limit = 100 + TH_DIV((int32_t)(limit - 100) * (Inv.config.ovl_hs_temp_max - hs_temp_c), span);
+    }
+    g_invThermal.fetLimit = limit;
+
+    if (inv_ThermalFetPct() >= limit)
+    {
+        g_invThermal.fetHot = 1;
+    }
+    else if (inv_ThermalFetPct() < TH_DIV((int32_t)limit * INV_TH_FET_RECOVER_PCT, 100))
+    {
+        g_invThermal.fetHot = 0;
+    }
+
+    g_invThermal.xfmrHot = (inv_ThermalXfmrPct() >= (int16_t)Inv.config.ovl_xfmr_limit) ? 1 : 0;
+}
+
+// <><><><><><><><><><><><><> inv_thermal.c <><><><><><><><><><><><><><><><><><><><><><>
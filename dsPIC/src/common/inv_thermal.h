@@ -0,0 +1,80 @@
+// <><><><><><><><><><><><><> inv_thermal.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Inverter I2t thermal overload model
+//
+//  Two first order models of temperature rise, in percent of the rise at
+//  rated output (100 = IMeasRMS() at Inv.config.ovl_rated_rms, continuous),
+//  fed with the square of the per-unit output current once per a/c cycle:
+//
+//    FETs:         Inv.config.ovl_fet_tau, a few seconds. At ovl_fet_limit
+//                  the 200% (VDS) peak limit is taken away and the output is
+//                  clipped at Inv.config.ovl_imeas_threshold until the model
+//                  cools to INV_TH_FET_RECOVER_PCT of the limit. The limit
+//                  above rated is derated to nothing as the heat sink warms
+//                  from ROOM_TEMP_C to ovl_hs_temp_max.
+//
+//    transformer:  Inv.config.ovl_xfmr_tau, about a minute. At ovl_xfmr_limit
+//                  the inverter latches off (overload_shutdown).
+//
+//  A motor start at 200% runs for as long as the FETs can take it from
+//  where they are, not a fixed second; a long 125% load runs until the
+//  transformer has had enough. With the defaults, from cold:
+//      200%: clipped after ~3 sec;    125%: off after ~80 sec;
+//      108%: off after ~5 min;       <=107%: runs on
+//
+//  The models are stepped from the inverter PWM ISR at the end of each a/c
+//  cycle, idle as well as running, so they cool between loads. They keep
+//  their state through an inverter stop; while the charger runs they are
+//  not stepped, which errs on the safe side. The host harness checks the
+//  figures above on a PC (dsPIC/host, 'make check', check "thermal").
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __INV_THERMAL_H    // include only once
+#define __INV_THERMAL_H
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+
+// ---------
+// constants
+// ---------
+#define INV_TH_RATIO_MAX        (4000)  // per-unit current x 1000 is clamped here
+#define INV_TH_FET_RECOVER_PCT  (70)    // 200% peaks given back; % of the FET limit
+#define INV_TH_XFMR_WARN_PCT    (90)    // overload_detected; % of the transformer limit
+
+// ----------
+// data types
+// ----------
+typedef struct
+{
+    int32_t  fet;           // FET rise; % of rated x 65536
+    int32_t  xfmr;          // transformer rise; % of rated x 65536
+    int16_t  fetLimit;      // FET limit after heat sink derating; % of rated
+    uint8_t  fetHot;        // 1=FETs at their limit; clip at the imeas threshold
+    uint8_t  xfmrHot;       // 1=transformer at its limit; shut down
+} INV_THERMAL_t;
+
+// ------------
+// Global Data
+// ------------
+extern INV_THERMAL_t g_invThermal;
+
+// --------------------
+// Function Prototyping
+// --------------------
+extern void inv_ThermalReset(void);                              // cold, as at power up
+extern void inv_ThermalCycle(int16_t imeas_rms, int16_t hs_temp_c); // once per a/c cycle
+
+// rise in % of rated; for telemetry
+INLINE int16_t inv_ThermalFetPct(void)   { return((int16_t)(g_invThermal.fet  >> 16)); }
+INLINE int16_t inv_ThermalXfmrPct(void)  { return((int16_t)(g_invThermal.xfmr >> 16)); }
+
+#endif  //  __INV_THERMAL_H
+
+// <><><><><><><><><><><><><> inv_thermal.h <><><><><><><><><><><><><><><><><><><><><><>
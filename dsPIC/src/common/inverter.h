@@ -27,6 +27,9 @@
 //
 //  inv_Start() Configures and starts the Inverter function.
 //
+//  inv_StartSync() As inv_Start(), but starts at the PLL phase and the last
+//          line amplitude; takes over from the a/c line (see xfer.h).
+//
 //  inv_StartBootCharge()   Configures and starts the Boot Charging (Cold-Start)
 //          function. Includes timer for the boot-charge period.
 //
@@ -49,6 +52,7 @@
 #include "device.h"
 #include "inv_check_supply.h"
 #include "Q16.h"
+#include "sine_table.h"
 
 
 #if IS_PCB_LPC
@@ -143,6 +147,19 @@
     //	   It does NOT alter the PWM pulse output to limit current.
     //-----------------------------------------------------------------------------
     #define OVL_RMS_THRESHOLD    IMEAS_INV_AMPS_ADC(13.5)  // 108% RMS OVL no clipping at 13.5Aac output) (ADC=738)
+
+    //-----------------------------------------------------------------------------
+    //  I2t THERMAL MODEL (see inv_thermal.h)
+    //     How long an overload may last. The RMS output current heats a FET and a
+    //     transformer model; rises are in % of the rise at rated output, time
+    //     constants in 0.1 sec. OVL_RMS_THRESHOLD above only arms the 200% limit.
+    //-----------------------------------------------------------------------------
+    #define INV_DFLT_OVL_RATED_RMS      IMEAS_INV_AMPS_ADC(12.5)  // 100% RMS; 1500W at 120Vac
+    #define INV_DFLT_OVL_FET_TAU        ((uint16_t)(30))    //   3 sec
+    #define INV_DFLT_OVL_FET_LIMIT      ((uint16_t)(250))   // 200% for ~3 sec from cold
+    #define INV_DFLT_OVL_XFMR_TAU       ((uint16_t)(600))   //  60 sec
+    #define INV_DFLT_OVL_XFMR_LIMIT     ((uint16_t)(115))   // ~107% continuous
+    #define INV_DFLT_OVL_HS_TEMP_MAX    ((int16_t)(100))    // Celsius; no surge left at this heat sink temperature
     
 #endif
 
@@ -160,6 +177,7 @@
 #define INV_DFLT_LOAD_SENSE_DELAY       ((uint16_t)(60*2))	//	30-seconds 
 #define INV_DFLT_LOAD_SENSE_INTERVAL    ((uint16_t)(1*2))	//	one-second
 #define INV_DFLT_LOAD_SENSE_THRESHOLD   ((int16_t)(8))		//	A2D counts
+#define INV_DFLT_LOAD_SENSE_INTERVAL_MAX ((uint16_t)(8*2))	//	eight-seconds; see load_sense.h
 
 //-----------------------------------------------------------------------------
 // CLOSED LOOP CONTROL
@@ -179,6 +197,26 @@
     #define INV_DFLT_ISUM_LIMIT  ((int16_t)(3000))
 #endif
 
+//-----------------------------------------------------------------------------
+// HARMONIC COMPENSATION
+//  The PID loop above sets the amplitude once per half-cycle; it cannot fix
+//  the shape of the waveform. A repetitive or resonant term learns the error 
+//  that repeats every a/c cycle and adds a correction to each duty cycle.
+//-----------------------------------------------------------------------------
+#define INV_VLOOP_PID           (0)     // PID only
+#define INV_VLOOP_REPETITIVE    (1)     // PID + correction per sample of the a/c cycle
+#define INV_VLOOP_RESONANT      (2)     // PID + resonant terms at the 3rd, 5th and 7th harmonic
+
+#define INV_DFLT_VLOOP_MODE     INV_VLOOP_PID
+#define INV_DFLT_RC_GAIN_Q16    Q16(1, .000)
+#define INV_DFLT_RC_FORGET_Q16  ((uint16_t)0xFEB8)   // .995
+#define INV_DFLT_RC_LIMIT       ((int16_t)(800))    // ~23% of MAX_DUTY
+#define INV_DFLT_RC_LEAD        ((uint16_t)(1))
+#define INV_RC_LEAD_MAX         ((uint16_t)(48))    // 45 degrees of the a/c cycle
+
+// output frequency trim; see inv_SetFreqTrim()
+#define INV_FREQ_TRIM_MAX_MHZ   ((int16_t)(2000))   // +/- 2 Hz
+
 
 //-----------------------------------------------------------------------------
 //
@@ -335,6 +373,7 @@ typedef struct
     uint16_t load_sense_delay;      //  delay before load-sense (pinging) [resolution = .5-sec] 
     uint16_t load_sense_interval;   //  delay between pings [resolution = .5-sec] 
     int16_t  load_sense_threshold;  //  Iload RMS threshold [ADC counts]
+    uint16_t load_sense_interval_max; //  longest delay between pings with no load [resolution = .5-sec] 
 
 	//	Inverter Supply Detection
     int16_t supply_low_shutdown;
@@ -352,10 +391,25 @@ typedef struct
 	int16_t i_limit;				//	integral sum limit (prevent wind-up)
     int32_t d_gain;                 //	differential gain
 
+    // Inverter Voltage Loop Harmonic Compensation; see inv_harmonic.h
+    uint16_t vloop_mode;            //  INV_VLOOP_xxx
+    int32_t  rc_gain;               //  Q16 learning gain; duty counts per error count per a/c cycle
+    uint16_t rc_forget;             //  Q16 fraction of the learned correction kept each a/c cycle
+    int16_t  rc_limit;              //  largest correction (duty counts)
+    uint16_t rc_lead;               //  phase lead (PWM periods) for the delay from duty to feedback
+
   #if IS_PCB_LPC
     // overload thresholds for LPC
     int16_t ovl_vds_threshold;
     int16_t ovl_imeas_threshold;
+
+    // I2t thermal model; see inv_thermal.h
+    int16_t  ovl_rated_rms;         //  IMeasRMS() at 100% output
+    uint16_t ovl_fet_tau;           //  FET time constant (0.1 sec)
+    uint16_t ovl_fet_limit;         //  FET rise limit (% of the rise at rated output)
+    uint16_t ovl_xfmr_tau;          //  transformer time constant (0.1 sec)
+    uint16_t ovl_xfmr_limit;        //  transformer rise limit (% of the rise at rated output)
+    int16_t  ovl_hs_temp_max;       //  heat sink temperature (Celsius) with no FET surge headroom left
   #endif
 } INVERTER_CONFIG_t;
 #pragma pack()  // restore packing setting
@@ -438,6 +492,7 @@ extern INVERTER_t  Inv;
 		INV_DFLT_LOAD_SENSE_DELAY,
 		INV_DFLT_LOAD_SENSE_INTERVAL,
 		INV_DFLT_LOAD_SENSE_THRESHOLD,
+		INV_DFLT_LOAD_SENSE_INTERVAL_MAX,
 		//	Inverter Supply Detection
 		INV_DFLT_SUPPLY_LOW_SHUTDOWN,
 		INV_DFLT_SUPPLY_LOW_THRESHOLD,
@@ -452,10 +507,23 @@ extern INVERTER_t  Inv;
 		INV_DFLT_IGAIN_Q16,  
 		INV_DFLT_ISUM_LIMIT,
 		INV_DFLT_DGAIN_Q16,
+		//	Inverter Voltage Loop Harmonic Compensation
+		INV_DFLT_VLOOP_MODE,
+		INV_DFLT_RC_GAIN_Q16,
+		INV_DFLT_RC_FORGET_Q16,
+		INV_DFLT_RC_LIMIT,
+		INV_DFLT_RC_LEAD,
 	  #if IS_PCB_LPC
 		//	LP/LPC-style Overload Detection
 		OVL_VDS_THRESHOLD,
 		OVL_IMEAS_THRESHOLD,
+		//	I2t Thermal Model
+		INV_DFLT_OVL_RATED_RMS,
+		INV_DFLT_OVL_FET_TAU,
+		INV_DFLT_OVL_FET_LIMIT,
+		INV_DFLT_OVL_XFMR_TAU,
+		INV_DFLT_OVL_XFMR_LIMIT,
+		INV_DFLT_OVL_HS_TEMP_MAX,
 	  #endif
 	};
 #endif 	// ALLOCATE_SPACE_ROM_DEFAULTS
@@ -469,6 +537,7 @@ extern void  inv_CheckOverload(void);
 extern void  inv_ClearFeedbackErrors(void);
 extern void  inv_ClearOverload(void);
 extern void  inv_Start(void);
+extern void  inv_StartSync(void);
 extern void  inv_StartBootCharge(void);
 extern void  inv_StartDegauss(void);
 extern void  inv_StartSSR(void);
@@ -478,6 +547,8 @@ extern const char* inv_StateToStr(uint16_t invState);
 extern const char* inv_PwmStateToStr(uint16_t pwmState);
 extern void  TASK_inv_Driver(void);
 extern void  inv_CheckForOverload(void);
+extern void  inv_SetFreqTrim(int16_t trim_mhz);
+extern const DDS_t* inv_OutputDds(void);
 
 
 #endif  //  __INVERTER_H
@@ -221,6 +221,96 @@ void inv_SetDGain(uint8_t * val)
     nvm_SetDirty();
 }
 
+// voltage loop harmonic compensation; INV_VLOOP_xxx
+void inv_SetVLoopMode(uint16_t mode)
+{
+    if (mode > INV_VLOOP_RESONANT) mode = INV_VLOOP_PID;
+    LOG(SS_INVCMD, SV_INFO, "Inverter VLoop Mode: %u", mode);
+    g_nvm.settings.inv.vloop_mode = Inv.config.vloop_mode = mode;
+    nvm_SetDirty();
+}
+
+void inv_SetRcGain(uint8_t * val)
+{
+    LOG(SS_INVCMD, SV_INFO, "Inverter RC-Gain Q16: %X%X.%X%X", *val, *(val+1), *(val+2), *(val+3));
+    memcpy((uint8_t *)&Inv.config.rc_gain, val, 4);
+	g_nvm.settings.inv.rc_gain = Inv.config.rc_gain;
+    nvm_SetDirty();
+}
+
+void inv_SetRcForget(uint16_t forget)
+{
+    LOG(SS_INVCMD, SV_INFO, "Inverter RC-Forget Q16: %04X", forget);
+    g_nvm.settings.inv.rc_forget = Inv.config.rc_forget = forget;
+    nvm_SetDirty();
+}
+
+void inv_SetRcLimit(int16_t limit)
+{
+    if (limit < 0) limit = 0;
+    LOG(SS_INVCMD, SV_INFO, "Inverter RC-Limit: %d", limit);
+    g_nvm.settings.inv.rc_limit = Inv.config.rc_limit = limit;
+    nvm_SetDirty();
+}
+
+void inv_SetRcLead(uint16_t lead)
+{
+    if (lead > INV_RC_LEAD_MAX) lead = INV_RC_LEAD_MAX;
+    LOG(SS_INVCMD, SV_INFO, "Inverter RC-Lead: %u", lead);
+    g_nvm.settings.inv.rc_lead = Inv.config.rc_lead = lead;
+    nvm_SetDirty();
+}
+
+#if IS_PCB_LPC
+// I2t thermal overload model; see inv_thermal.h
+void inv_SetOvlRatedRms(int16_t adc_count)
+{
+    if (adc_count < 1) adc_count = 1;
+    LOG(SS_INVCMD, SV_INFO, "Inverter OVL Rated RMS: %d", adc_count);
+    g_nvm.settings.inv.ovl_rated_rms = Inv.config.ovl_rated_rms = adc_count;
+    nvm_SetDirty();
+}
+
+void inv_SetOvlFetTau(uint16_t tau_x10)
+{
+    if (tau_x10 < 1) tau_x10 = 1;
+    LOG(SS_INVCMD, SV_INFO, "Inverter OVL FET Tau: %u", tau_x10);
+    g_nvm.settings.inv.ovl_fet_tau = Inv.config.ovl_fet_tau = tau_x10;
+    nvm_SetDirty();
+}
+
+void inv_SetOvlFetLimit(uint16_t pct)
+{
+    if (pct < 100) pct = 100;
+    LOG(SS_INVCMD, SV_INFO, "Inverter OVL FET Limit: %u", pct);
+    g_nvm.settings.inv.ovl_fet_limit = Inv.config.ovl_fet_limit = pct;
+    nvm_SetDirty();
+}
+
+void inv_SetOvlXfmrTau(uint16_t tau_x10)
+{
+    if (tau_x10 < 1) tau_x10 = 1;
+    LOG(SS_INVCMD, SV_INFO, "Inverter OVL Xfmr Tau: %u", tau_x10);
+    g_nvm.settings.inv.ovl_xfmr_tau = Inv.config.ovl_xfmr_tau = tau_x10;
+    nvm_SetDirty();
+}
+
+void inv_SetOvlXfmrLimit(uint16_t pct)
+{
+    if (pct < 100) pct = 100;
+    LOG(SS_INVCMD, SV_INFO, "Inverter OVL Xfmr Limit: %u", pct);
+    g_nvm.settings.inv.ovl_xfmr_limit = Inv.config.ovl_xfmr_limit = pct;
+    nvm_SetDirty();
+}
+
+void inv_SetOvlHsTempMax(int16_t temp_c)
+{
+    LOG(SS_INVCMD, SV_INFO, "Inverter OVL Heat Sink Max: %d", temp_c);
+    g_nvm.settings.inv.ovl_hs_temp_max = Inv.config.ovl_hs_temp_max = temp_c;
+    nvm_SetDirty();
+}
+#endif  //  IS_PCB_LPC
+
 
 // ----------------------------------------------------------------------
 //                   L O A D  -  S E N S E
@@ -260,6 +350,13 @@ void inv_SetLoadSenseThreshold(int16_t threshold)
 	nvm_SetDirty();
 }
 
+void inv_SetLoadSenseIntervalMax(uint16_t interval)
+{
+    LOG(SS_INVCMD, SV_INFO, "Inverter LoadSense Interval Max: %d", interval);
+	g_nvm.settings.inv.load_sense_interval_max = Inv.config.load_sense_interval_max = interval;
+	nvm_SetDirty();
+}
+
 
 // ----------------------------------------------------------------------
 //            D E V I C E  
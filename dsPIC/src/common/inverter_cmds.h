@@ -32,12 +32,26 @@ extern void		inv_SetPGain(uint8_t * val);
 extern void		inv_SetIGain(uint8_t * val);
 extern void		inv_SetDGain(uint8_t * val);
 extern void		inv_SetILimit(int16_t limit);
+extern void		inv_SetVLoopMode(uint16_t mode);
+extern void		inv_SetRcGain(uint8_t * val);
+extern void		inv_SetRcForget(uint16_t forget);
+extern void		inv_SetRcLimit(int16_t limit);
+extern void		inv_SetRcLead(uint16_t lead);
+#if IS_PCB_LPC
+extern void		inv_SetOvlRatedRms(int16_t adc_count);
+extern void		inv_SetOvlFetTau(uint16_t tau_x10);
+extern void		inv_SetOvlFetLimit(uint16_t pct);
+extern void		inv_SetOvlXfmrTau(uint16_t tau_x10);
+extern void		inv_SetOvlXfmrLimit(uint16_t pct);
+extern void		inv_SetOvlHsTempMax(int16_t temp_c);
+#endif
 
 extern void     inv_SetLoadSenseEnabled(int enable);
 extern void 	inv_SetLoadSenseDelay(uint16_t delay);
 extern void     inv_SetLoadSenseEnabledOnStartup(int enable);
 extern void 	inv_SetLoadSenseInterval(uint16_t interval);
 extern void 	inv_SetLoadSenseThreshold(int16_t threshold);
+extern void 	inv_SetLoadSenseIntervalMax(uint16_t interval);
 
 extern void		inv_SetSupplyLowShutdown(uint16_t adc_count);
 extern void		inv_SetSupplyLowThreshold(uint16_t adc_count);
@@ -0,0 +1,115 @@
+// <><><><><><><><><><><><><> load_sense.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Inverter load-sense search mode (see load_sense.h)
+//
+//  The probe sums are taken by the PWM ISR; everything else runs from the
+//  inverter driver, once per probe and once per 0.5 sec.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "inverter.h"
+#include "load_sense.h"
+
+// ------------
+// Global Data
+// ------------
+LOAD_SENSE_t g_lsense = { 0, 0, 0, INV_DFLT_LOAD_SENSE_INTERVAL, 0xFFFF, 0, 0, 0, 0, 0 };
+
+
+//-----------------------------------------------------------------------------
+//  lsense_Reset()
+//-----------------------------------------------------------------------------
+//  Next probe after the shortest interval. Call on entering load sensing.
+//-----------------------------------------------------------------------------
+
+void lsense_Reset(void)
+{
+    g_lsense.interval = Inv.config.load_sense_interval;
+}
+
+//-----------------------------------------------------------------------------
+//  lsense_ProbeDone()
+//-----------------------------------------------------------------------------
+//  Call when the PWM ISR is back to idle after a probe. Returns 1 if the
+//  probe found a load, and sets the interval to the next one.
+//-----------------------------------------------------------------------------
+
+int8_t lsense_ProbeDone(void)
+{
+    float    g;
+    int32_t  vi;
+    uint16_t max;
+    int8_t   found;
+
+    if (0 == g_lsense.samples) return(0);  // nothing was sent
+
+    vi = (g_lsense.sumVI < 0) ? -g_lsense.sumVI : g_lsense.sumVI;
+
+    if (g_lsense.sumVV < (int32_t)g_lsense.samples * LSENSE_VAC_RMS_MIN * LSENSE_VAC_RMS_MIN)
+    {
+        // held down
+        g_lsense.ohms = 0;
+        found = 1;
+    }
+    else
+    {
+        // in-phase admittance; IMeas counts per VAC count
+        g = (float)vi / (float)g_lsense.sumVV;
+        found = ((g * LSENSE_VAC_RMS_FULL) >= Inv.config.load_sense_threshold) ? 1 : 0;
+
+        g = g * (VAC_SLOPE / IMEAS_INV_SLOPE);  // siemens
+        g_lsense.ohms = (g > (1.0 / 65535.0)) ? (uint16_t)(1.0 / g) : 0xFFFF;
+    }
+
+    // energy
+    g_lsense.viRem  += (uint32_t)vi;
+    g_lsense.mjHour += LSENSE_PROBE_NL_MJ + (g_lsense.viRem / LSENSE_VI_PER_MJ);
+    g_lsense.viRem  %= LSENSE_VI_PER_MJ;
+    g_lsense.probes++;
+
+    // next probe
+    max = Inv.config.load_sense_interval_max;
+    if (max < Inv.config.load_sense_interval) max = Inv.config.load_sense_interval;
+
+    if (found || (g_lsense.interval < Inv.config.load_sense_interval))
+        g_lsense.interval = Inv.config.load_sense_interval;
+    else
+        g_lsense.interval = (g_lsense.interval >= (max >> 1)) ? max : (g_lsense.interval << 1);
+
+    if (found)
+    {
+        LOG(SS_INV, SV_INFO, "load sense: load found, %u ohms, %u samples", g_lsense.ohms, g_lsense.samples);
+    }
+    return(found);
+}
+
+//-----------------------------------------------------------------------------
+//  lsense_HalfSecTick()
+//-----------------------------------------------------------------------------
+//  Call every 0.5 sec of load sensing. Closes off the hour.
+//-----------------------------------------------------------------------------
+
+void lsense_HalfSecTick(void)
+{
+    uint32_t joules;
+
+    if (++g_lsense.hourTicks >= LSENSE_HOUR_TICKS)
+    {
+        joules = g_lsense.mjHour / 1000;
+        g_lsense.joulesPerHour = (joules > 0xFFFF) ? 0xFFFF : (uint16_t)joules;
+        LOG(SS_INV, SV_INFO, "load sense: %u probes, ~%u J (est) in the last hour", g_lsense.probes, g_lsense.joulesPerHour);
+
+        g_lsense.hourTicks = 0;
+        g_lsense.mjHour    = 0;
+        g_lsense.probes    = 0;
+    }
+}
+
+// <><><><><><><><><><><><><> load_sense.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,139 @@
+// <><><><><><><><><><><><><> load_sense.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Inverter load-sense search mode
+//
+//  While load sensing (Inv.status.load_sense_mode) the output is off and a
+//  probe is sent every so often to see if anything has been switched on:
+//  one a/c cycle at 1/LSENSE_PROBE_FRACTION of the soft start amplitude,
+//  about a third of the output voltage, starting and ending on a zero crossing so it leaves no flux behind.
+//
+//  For each PWM period of the probe the ISR sums, about their zeros,
+//      v*v     output voltage (VacRaw) squared
+//      v*i     output voltage times output current (IMeasRaw)
+//  and at the end  G = sum(v*i) / sum(v*v)  is the in-phase admittance of
+//  whatever is on the output. Reactive current (the output capacitor,
+//  a transformer's magnetizing current) and an IMeas zero error sum to
+//  nothing over the whole cycle, so the probe can be small and still see a
+//  load of Inv.config.load_sense_threshold (RMS IMeas at the full output
+//  voltage). Resistive loads and rectifier loads, which draw at the peaks,
+//  both show in G. An output that does not come up at all is taken as a
+//  load; the normal start and the overload protection deal with it.
+//
+//  Each probe that finds nothing doubles the time to the next one, from
+//  Inv.config.load_sense_interval up to load_sense_interval_max; finding
+//  a load, or leaving load sensing, starts again from the shortest. Longer
+//  intervals save energy at the cost of the time a load waits for power.
+//
+//  The energy of the probes is estimated and kept per hour of load
+//  sensing: the no-load loss of the power stage at the probe amplitude
+//  (the model's OPTION_INV_NO_LOAD_WATTS at the full output, scaling with
+//  the square of the amplitude) plus what went into the load, sum(v*i).
+//  The bias supply boost around each probe is not counted, and there is no
+//  battery current sense to check the no-load figure against, so the
+//  result (SENFLD_INV_LOADSENSE_JOULES_PER_HR) is only as good as the
+//  model header's figure.
+//  The host harness puts figures on the energy against the latency on a
+//  PC (dsPIC/host, 'make check', check "lsense").
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __LOAD_SENSE_H    // include only once
+#define __LOAD_SENSE_H
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "inverter.h"
+#include "sine_table.h"
+
+// ---------
+// constants
+// ---------
+#define LSENSE_PROBE_FRACTION   (3)     // probe amplitude is 1/n of the soft start amplitude
+#define LSENSE_PROBE_HALF_CYCLES (2)    // one a/c cycle
+#define LSENSE_IMEAS_CLAMP      (1000)  // per-sample current (IMeas counts) is clamped here
+
+// no-load draw of the power stage at the full output, watts; per model
+#if defined(OPTION_INV_NO_LOAD_WATTS)
+  #define LSENSE_NO_LOAD_WATTS  (OPTION_INV_NO_LOAD_WATTS)
+#elif IS_DEV_INVERTER
+  #error 'OPTION_INV_NO_LOAD_WATTS' is not defined for this model!
+#else
+  #define LSENSE_NO_LOAD_WATTS  (0.0)   // no inverter
+#endif
+
+// output voltage (VAC counts from the zero) at the full output, RMS
+#define LSENSE_VAC_RMS_FULL     ((int16_t)(VAC_SLOPE * INV_RMS_VAC_SETPOINT_VOLTS))
+
+// v*i sum per millijoule
+#define LSENSE_VI_PER_MJ        ((uint32_t)(VAC_SLOPE * IMEAS_INV_SLOPE * FPWM / 1000.0))
+
+// no-load energy of one probe, millijoules
+#define LSENSE_PROBE_NL_MJ      ((uint16_t)(LSENSE_NO_LOAD_WATTS * 1000.0 * LSENSE_PROBE_HALF_CYCLES / \
+                                 (2.0 * OPTION_AC_OUT_HZ * LSENSE_PROBE_FRACTION * LSENSE_PROBE_FRACTION)))
+
+// an output under 1/4 of the expected probe voltage did not come up
+#define LSENSE_VAC_RMS_MIN      (LSENSE_VAC_RMS_FULL / (4 * LSENSE_PROBE_FRACTION))
+
+#define LSENSE_HOUR_TICKS       (3600*2)    // 0.5 sec ticks per hour
+
+// ----------
+// data types
+// ----------
+typedef struct
+{
+    // probe sums; written by the PWM ISR while probing
+    int32_t  sumVV;         // sum of v*v
+    int32_t  sumVI;         // sum of v*i
+    uint16_t samples;       // PWM periods summed
+
+    // results
+    uint16_t interval;      // to the next probe (0.5 sec)
+    uint16_t ohms;          // in-phase load resistance of the last probe; 0xFFFF=open
+    uint16_t probes;        // this hour
+    uint32_t mjHour;        // probe energy this hour (millijoules)
+    uint32_t viRem;         // v*i sum not yet a whole millijoule
+    uint16_t hourTicks;     // 0.5 sec ticks of load sensing this hour
+    uint16_t joulesPerHour; // probe energy over the last full hour of load sensing
+} LOAD_SENSE_t;
+
+// ------------
+// Global Data
+// ------------
+extern LOAD_SENSE_t g_lsense;
+
+// --------------------
+// Function Prototyping
+// --------------------
+extern void   lsense_Reset(void);           // back to the shortest interval
+extern int8_t lsense_ProbeDone(void);       // after a probe; 1=load found
+extern void   lsense_HalfSecTick(void);     // every 0.5 sec of load sensing
+
+//-----------------------------------------------------------------------------
+// PWM ISR: before the first sample of a probe
+INLINE void lsense_ProbeStart(void)
+{
+    g_lsense.sumVV   = 0;
+    g_lsense.sumVI   = 0;
+    g_lsense.samples = 0;
+}
+
+//-----------------------------------------------------------------------------
+// PWM ISR: each sample of a probe; output voltage and current about their zeros
+INLINE void lsense_ProbeSample(int16_t v, int16_t i)
+{
+    if (i >  LSENSE_IMEAS_CLAMP) i =  LSENSE_IMEAS_CLAMP;
+    if (i < -LSENSE_IMEAS_CLAMP) i = -LSENSE_IMEAS_CLAMP;
+    g_lsense.sumVV += (int32_t)v * v;
+    g_lsense.sumVI += (int32_t)v * i;
+    g_lsense.samples++;
+}
+
+#endif  //  __LOAD_SENSE_H
+
+// <><><><><><><><><><><><><> load_sense.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -23,9 +23,14 @@
 #include "config.h"
 #include "converter.h"
 #include "converter_cmds.h"
+#include "crc.h"
 #include "dsPIC33_CAN.h"
+#include "evlog.h"
 #include "inverter.h"
 #include "nvm.h"
+#ifdef __linux__
+ #include "nvm_sim.h"   // host: 24LC64 simulator stands in for the I2C master
+#endif
 
 // --------------------------
 // Conditional Debug Compiles
@@ -48,7 +53,24 @@
 // ---------------------------------------------------------
 // NVM Chip is on I2C channel 1 or 2 depending upon hardware
 // ---------------------------------------------------------
-#if (OPTION_NVM == OPTION_NVM_I2C1)
+#if defined(__linux__)
+    // host build; see nvm_sim.h
+	#define _MI2CxInterrupt _MI2CSimInterrupt
+	#define _MI2CxIF		nvmsim_IF
+	#define _I2CxMD			nvmsim_MD
+	#define _MI2CxIE		nvmsim_IE
+	
+	#define _I2CxTRN 		nvmsim_TRN
+	#define _I2CxRCV 		nvmsim_RCV
+	#define _I2CxBRG		nvmsim_BRG
+	#define _I2CxADD		nvmsim_ADD
+	#define _I2CxCONbits	nvmsim_CONbits
+	#define _I2CxSTATbits	nvmsim_STATbits
+	
+	#define NVM_ISR         // host: called from nvmsim_Poll()
+	#define nvm_HostWait()  nvmsim_Poll(1)  // blocking waits let simulated time pass
+
+#elif (OPTION_NVM == OPTION_NVM_I2C1)
     // NVM is on I2C channel 1
 	#define _MI2CxInterrupt _MI2C1Interrupt
 	#define _MI2CxIF		IFS1bits.MI2C1IF
@@ -80,6 +102,11 @@
 	#error 'OPTION_NVM' is not defined... 
 #endif
 
+#ifndef NVM_ISR
+	#define NVM_ISR         __attribute__((interrupt, no_auto_psv))
+	#define nvm_HostWait()  
+#endif
+
 
 
 // -------------
@@ -124,12 +151,11 @@ NVM_DRV_t  g_nvm;
 // -----------
 // NVM data addresses are zero based
 int  nvm_L0_BegWritePage(uint16_t addr, uint8_t  nbytes, uint8_t* data); // hw limits writes to a page or less
-int  nvm_L0_BegReadBuf  (uint16_t addr, uint16_t nbytes, uint8_t* data);
-int  nvm_L0_BegWriteBuf (uint16_t addr, uint16_t nbytes, uint8_t* data);
+int  nvm_L0_BegWritePages(uint16_t addr, uint16_t nbytes, uint8_t* data, uint16_t pageMask);
 int  nvm_IsSigValid(NVM_HDR_BLK_t* pHdr);
 void nvm_InitHeader(NVM_HDR_BLK_t* pHdr);
 void nvm_RunUnitTest(void);
-uint16_t nvm_CalcChecksum(uint8_t* data, int16_t len);
+static int  nvm_IsPagesValid(NVM_LAYOUT_t* pLayout);
 static void nvm_EraseAll(void);
 static void nvm_VerifyErased(void);
 
@@ -143,6 +169,13 @@ static void nvm_VerifyErased(void);
 #define nvm_IsCmdInProg() (g_nvm.curCmd != NVM_CMD_NONE)    // is command in progress
 #define nvm_IsReqCmd()    (g_nvm.reqCmd)                    // is a requested command pending
 #define nvm_IsDirty()     (g_nvm.isDirty)                   // is a nvm need saving
+// next journal sequence number; skips the erased value
+#define nvm_JrnlNextSeq(seq)   ((uint16_t)((seq)+1) == 0xFFFF ? 0 : (uint16_t)((seq)+1))
+// settings pages touched by a journal record
+#define nvm_JrnlRecPages(pRec) ((uint8_t)((1u << ((pRec)->offset/NVM_PAGE_BYTES)) | \
+                                          (1u << (((pRec)->offset+(pRec)->len-1)/NVM_PAGE_BYTES))))
+// is address a record slot in the journal
+#define nvm_JrnlIsHeadValid(a) ((a) >= NVM_OFFSET_JOURNAL && (a) < NVM_OFFSET_COPY2 && ((a)&(sizeof(NVM_JRNL_REC_t)-1)) == 0)
 
 
 // ---------
@@ -158,7 +191,7 @@ static void nvm_VerifyErased(void);
 
 // I2C Master Interrupt Service Routine
 // Performs bytes transfers to/from hardware
-void __attribute__((interrupt, no_auto_psv)) _MI2CxInterrupt(void)
+void NVM_ISR _MI2CxInterrupt(void)
 {
     switch (g_nvm.isr.state)
     {
@@ -440,12 +473,22 @@ int nvm_L0_BegReadBuf(uint16_t addr, uint16_t  nbytes, uint8_t* data)
 // multi-page write
 // returns: 0=ok, 1=input error
 int nvm_L0_BegWriteBuf(uint16_t addr, uint16_t  nbytes, uint8_t* data)
+{
+    return(nvm_L0_BegWritePages(addr, nbytes, data, 0xFFFF));
+}
+
+// -----------------------------------------------------------------------------
+// multi-page write of only the pages in pageMask
+// bit n selects the nth page the buffer touches; pages past the 16th are always written
+// returns: 0=ok, 1=input error
+int nvm_L0_BegWritePages(uint16_t addr, uint16_t  nbytes, uint8_t* data, uint16_t pageMask)
 {
     if (nbytes < 1)
     {
         LOG(SS_NVM, SV_ERR, "BegWrByf n=%u", (uint16_t)nbytes);
         return(1);
     }
+    g_nvm.mpwr.pageMask = pageMask;
     g_nvm.mpwr.nToWrite = 0;
     g_nvm.mpwr.nWritten = 0;
     g_nvm.mpwr.nLeft    = nbytes;
@@ -464,11 +507,18 @@ int nvm_L0_BegWriteBuf(uint16_t addr, uint16_t  nbytes, uint8_t* data)
 
 // this flag resides in flash and is rewritten to 0 during execution
 // note that changing a 1 to a 0 does not require erasing flash memory
+#ifdef __linux__
+static uint16_t s_isJustFlashed = 1;
+#else
 __prog__ uint16_t s_isJustFlashed __attribute__((space(prog),aligned(4))) = 1;
+#endif
 
 // -----------------------------------------------------------------------------
 void flash_ClearRomFlag()
 {
+#ifdef __linux__
+    s_isJustFlashed = 0;
+#else
     unsigned int tbloffset;
     unsigned int zero = 0; // set value 
 
@@ -486,6 +536,7 @@ void flash_ClearRomFlag()
     __builtin_nop();        // Requires two nops for time delay
     __builtin_nop();
     NVMCONbits.WR = 0;      // Clear the write action bit
+#endif // __linux__
 }
 
 // -----------------------------------------------------------------------------
@@ -494,8 +545,12 @@ void flash_ClearRomFlag()
 // initialize I2C bus 2 which is used for NVM transport
 static void I2C_init()
 {
+  #ifdef __linux__
+    nvmsim_Open();
+  #else
     TRISFbits.TRISF4 = 1;   //  RF4/CN17/U2RX   pin-31 i/o      SDA2 (NVM)
     TRISFbits.TRISF5 = 0;   //  RF5/CN18/U2TX   pin-32 output   SCL2 (NVM)
+  #endif
     _I2CxMD  = 0;   		// enable peripheral
 
     _I2CxCONbits.I2CEN  = 0; // disable while configuring
@@ -518,6 +573,7 @@ void nvm_Config()
 
     // load nvm rom settings into active settings
     nvm_LoadRomSettings();
+    g_nvm.jrnlHead = NVM_OFFSET_JOURNAL;
 
     // initialize hardware transport
     I2C_init();
@@ -534,12 +590,72 @@ static int nvm_WaitIsrDone()
     SYSTICKS startTicks = GetSysTicks();
     for (;;)
     {
+        nvm_HostWait();
         if (!nvm_IsIsrBusy()) break;
         if (IsTimedOut(25,startTicks)) return(1);  // 12 msec nominal
     }
     return(0);
 }
 
+// -----------------------------------------------------------------------------
+// replay the journal records written after the copy that was loaded
+// seq and head come from the loaded copy header
+// CAUTION! this is blocking and is called only on startup
+static void nvm_JrnlReplay(uint16_t seq, uint16_t head)
+{
+    NVM_JRNL_REC_t* pRec;
+    uint16_t addr = head;
+    uint16_t nrecs = 0;
+    uint16_t next;
+    int      i, n, isEnd = 0;
+
+    if (!nvm_JrnlIsHeadValid(head))
+    {
+        // copy written before the journal existed
+        LOG(SS_NVM, SV_INFO, "Journal: none");
+        g_nvm.jrnlSeq  = seq;
+        g_nvm.jrnlHead = NVM_OFFSET_JOURNAL;
+        return;
+    }
+
+    // records follow the head back to back; stop at the first one out of sequence
+    // read a scratch buffer of records at a time; reads are not limited to a page
+    while (!isEnd && nrecs < NVM_JRNL_RECS)
+    {
+        n = (sizeof(g_nvm.scratch)/sizeof(NVM_JRNL_REC_t))*sizeof(NVM_JRNL_REC_t);
+        if (n > NVM_OFFSET_COPY2 - addr) n = NVM_OFFSET_COPY2 - addr;
+        nvm_L0_BegReadBuf(addr, n, (uint8_t*)&g_nvm.scratch);
+        if (nvm_WaitIsrDone() || nvm_IsError())
+        {
+            LOG(SS_NVM, SV_ERR, "Journal: Read FAILED addr=%u", addr);
+            break;
+        }
+        pRec = (NVM_JRNL_REC_t*)&g_nvm.scratch;
+        for (i=0; i<n/(int)sizeof(NVM_JRNL_REC_t); i++, pRec++)
+        {
+            next = nvm_JrnlNextSeq(seq);
+            if (pRec->seq != next
+             || pRec->crc != crc16_Calc((uint8_t*)pRec, NVM_JRNL_CRC_BYTES)
+             || pRec->len < 1 || pRec->len > sizeof(pRec->data)
+             || pRec->offset + pRec->len > sizeof(NVM_SETTINGS_t))
+            {
+                isEnd = 1;
+                break;
+            }
+            memcpy((uint8_t*)&g_nvm.settings + pRec->offset, pRec->data, pRec->len);
+            g_nvm.copyDirty |= nvm_JrnlRecPages(pRec);
+            seq = next;
+            nrecs++;
+            addr += sizeof(NVM_JRNL_REC_t);
+        }
+        if (addr >= NVM_OFFSET_COPY2) addr = NVM_OFFSET_JOURNAL;
+    }
+    g_nvm.jrnlSeq  = seq;
+    g_nvm.jrnlHead = addr;
+    g_nvm.jrnlLive = nrecs;
+    LOG(SS_NVM, SV_INFO, "Journal: %u records replayed head=%u", nrecs, addr);
+}
+
 // -----------------------------------------------------------------------------
 // validate that NVM has two good copies
 // CAUTION! this is blocking and is called only on startup
@@ -549,7 +665,9 @@ static void nvm_ValidateNVM()
 {
     int      rc, cs1ok, cs2ok, alg, rev1, rev2, useCopy1=0, needToSave=1;
     uint16_t csCalc1, csRead1, csCalc2, csRead2;
+    uint16_t jseq1, jhead1, jseq2, jhead2;
     SYSTICKS startTicks = GetSysTicks();
+    NVM_LAYOUT_t* pUse = 0;     // copy to load
 
     LOG(SS_NVM, SV_INFO, "Validate: newFW=%u", s_isJustFlashed);
 
@@ -560,8 +678,11 @@ static void nvm_ValidateNVM()
         flash_ClearRomFlag();
         nvm_EraseAll();
         nvm_VerifyErased();
+        g_nvm.copyDirty = 0xFF;
         nvm_ReqSaveConfig();
         nvm_ApplySettings();
+        memcpy(&g_nvm.committed, &g_nvm.settings, sizeof(g_nvm.committed));
+        g_nvm.loadMsec = (uint16_t)(GetSysTicks()-startTicks);
         return;
     }
 
@@ -576,31 +697,38 @@ static void nvm_ValidateNVM()
         LOG(SS_NVM, SV_ERR, "VAL: Read Copy1 FAILED");
         LOGX(SS_NVM, SV_ERR, "[1] ", (uint8_t*)&g_nvm.scratch, sizeof(g_nvm.scratch));
     }
+
+    // stream copy 2 in behind copy 1 while copy 1 is checked
+  #ifdef DEBUG_NVM_VALIDATE
+    LOG(SS_NVM, SV_INFO, "VAL: Read Copy2 offset=%u", NVM_OFFSET_COPY2);
+  #endif
+    nvm_L0_BegReadBuf(NVM_OFFSET_COPY2, sizeof(g_nvm.boot), (uint8_t*)&g_nvm.boot);
+
     rev1    = g_nvm.scratch.hdr.revNum;
-    csCalc1 = nvm_CalcChecksum((uint8_t*)&g_nvm.scratch.hdr.nBytes, NVM_CHECKSUM_SIZE);
+    jseq1   = g_nvm.scratch.hdr.jrnlSeq;
+    jhead1  = g_nvm.scratch.hdr.jrnlHead;
+    csCalc1 = crc16_Calc((uint8_t*)&g_nvm.scratch.hdr.nBytes, NVM_CHECKSUM_SIZE);
     csRead1 = g_nvm.scratch.hdr.chksumCfg;
-    cs1ok   = (nvm_IsSigValid(&g_nvm.scratch.hdr) && (csCalc1 == csRead1)) ? 1 : 0;
+    cs1ok   = (nvm_IsSigValid(&g_nvm.scratch.hdr) && (csCalc1 == csRead1) && nvm_IsPagesValid(&g_nvm.scratch)) ? 1 : 0;
   #ifdef DEBUG_NVM_VALIDATE
     LOGX(SS_NVM, SV_INFO, "[1] ", (uint8_t*)&g_nvm.scratch, sizeof(g_nvm.scratch));
   #endif
     
-    // read copy 2 into scratch
-  #ifdef DEBUG_NVM_VALIDATE
-    LOG(SS_NVM, SV_INFO, "VAL: Read Copy2 offset=%u", NVM_OFFSET_COPY2);
-  #endif
-    nvm_L0_BegReadBuf(NVM_OFFSET_COPY2, sizeof(g_nvm.scratch), (uint8_t*)&g_nvm.scratch);
+    // copy 2 has been streaming in
     rc = nvm_WaitIsrDone();
     if (rc) 
     {
         LOG(SS_NVM, SV_ERR, "VAL: Read Copy2 FAILED");
-        LOGX(SS_NVM, SV_INFO, "[2] ", (uint8_t*)&g_nvm.scratch, sizeof(g_nvm.scratch));
+        LOGX(SS_NVM, SV_INFO, "[2] ", (uint8_t*)&g_nvm.boot, sizeof(g_nvm.boot));
     }
-    rev2    = g_nvm.scratch.hdr.revNum;
-    csCalc2 = nvm_CalcChecksum((uint8_t*)&g_nvm.scratch.hdr.nBytes, NVM_CHECKSUM_SIZE);
-    csRead2 = g_nvm.scratch.hdr.chksumCfg;
-    cs2ok   = (nvm_IsSigValid(&g_nvm.scratch.hdr) && (csCalc2 == csRead2)) ? 2 : 0;
+    rev2    = g_nvm.boot.hdr.revNum;
+    jseq2   = g_nvm.boot.hdr.jrnlSeq;
+    jhead2  = g_nvm.boot.hdr.jrnlHead;
+    csCalc2 = crc16_Calc((uint8_t*)&g_nvm.boot.hdr.nBytes, NVM_CHECKSUM_SIZE);
+    csRead2 = g_nvm.boot.hdr.chksumCfg;
+    cs2ok   = (nvm_IsSigValid(&g_nvm.boot.hdr) && (csCalc2 == csRead2) && nvm_IsPagesValid(&g_nvm.boot)) ? 2 : 0;
   #ifdef DEBUG_NVM_VALIDATE
-    LOGX(SS_NVM, SV_INFO, "[2] ", (uint8_t*)&g_nvm.scratch, sizeof(g_nvm.scratch));
+    LOGX(SS_NVM, SV_INFO, "[2] ", (uint8_t*)&g_nvm.boot, sizeof(g_nvm.boot));
   #endif
 
     // determine copy algorithm
@@ -623,14 +751,12 @@ static void nvm_ValidateNVM()
         break;
     case 2:
         LOG(SS_NVM, SV_WARN, "NVM Copy 2 Good; Copy 1 Bad; Using Copy 2");
-        memcpy(&g_nvm.settings, &g_nvm.scratch.settings, sizeof(g_nvm.settings) );
         g_nvm.revNum = rev2;
         break;
     case 3: // both NVM copies are good; use highest revision
         if (rev1 == rev2)
         {
             LOG(SS_NVM, SV_INFO, "Both NVM Copies Good");
-            memcpy(&g_nvm.settings, &g_nvm.scratch.settings, sizeof(g_nvm.settings) );
             needToSave = 0; // both copies are good and the same; no need to save
             g_nvm.revNum = rev1;
             break;
@@ -638,7 +764,6 @@ static void nvm_ValidateNVM()
         if (rev1 < rev2)
         {
             LOG(SS_NVM, SV_WARN, "NVM Copy 1 older than Copy 2; Using Copy 2");
-            memcpy(&g_nvm.settings, &g_nvm.scratch.settings, sizeof(g_nvm.settings) );
             g_nvm.revNum = rev2;
         }
         else
@@ -650,32 +775,36 @@ static void nvm_ValidateNVM()
         break;
     } // switch
 
-    // may have to reread copy1; we only have one scratch buffer
-    if (useCopy1)
-    {
-        // red copy 1
-        nvm_L0_BegReadBuf(NVM_OFFSET_COPY1, sizeof(g_nvm.scratch), (uint8_t*)&g_nvm.scratch);
-        rc = nvm_WaitIsrDone();
-        if (rc)
-        {
-            LOG(SS_NVM, SV_ERR, "VAL: Read Copy1 ReRead FAILED");
-        }
-        else
-        {
-            // make it active
-            memcpy(&g_nvm.settings, &g_nvm.scratch.settings, sizeof(g_nvm.settings) );
-        }
-    }
+    // both copies are in memory; make the chosen one active
+    if (alg == 2 || (alg == 3 && !useCopy1))
+        pUse = &g_nvm.boot;
+    else if (alg)
+        pUse = &g_nvm.scratch;
+    if (pUse)
+        memcpy(&g_nvm.settings, &pUse->settings, sizeof(g_nvm.settings));
+
+    // bring the loaded copy up to date from the journal
+    if (pUse == &g_nvm.boot)
+        nvm_JrnlReplay(jseq2, jhead2);
+    else if (pUse)
+        nvm_JrnlReplay(jseq1, jhead1);
+    memcpy(&g_nvm.committed, &g_nvm.settings, sizeof(g_nvm.committed));
+    if (g_nvm.jrnlLive > NVM_JRNL_COMPACT) needToSave = 1;
 
     // set the active flags from the configuration values
     nvm_ApplySettings();
 
-    // show results
-    LOG(SS_NVM, SV_INFO, "Rev=%u Validate Done %lu msec", g_nvm.revNum, GetSysTicks()-startTicks);  // 13 msec for 242 size
+    // show results; settings are in effect from here on
+    g_nvm.loadMsec = (uint16_t)(GetSysTicks()-startTicks);
+    LOG(SS_NVM, SV_INFO, "Rev=%u Settings applied in %u msec (%lu msec after reset)",
+        g_nvm.revNum, g_nvm.loadMsec, GetSysTicks());
 
-    // set save flag if need be
+    // set save flag if need be; rewrite every page so the copies match again
     if (needToSave)
+    {
+        g_nvm.copyDirty = 0xFF;
         nvm_ReqSaveConfig();
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -738,18 +867,34 @@ void nvm_Test(void)
 */
 
 // -----------------------------------------------------------------------------
-// calculate checksum for nvm purposes
-uint16_t nvm_CalcChecksum(uint8_t* data, int16_t len)
+// settings pages that differ between two settings images
+// returns: bit n set for each differing page n
+static uint8_t nvm_DiffPages(NVM_SETTINGS_t* pA, NVM_SETTINGS_t* pB)
 {
-	uint16_t cs;
-	int i;
-	
-	for (cs=0,i=0; i<len; i++)
-	{
-		cs += (uint16_t)data[i];
-	}
-	return (cs);
-} 
+    uint8_t mask = 0;
+    int pg;
+
+    for (pg=0; pg<NVM_SETTING_PAGES; pg++)
+    {
+        if (memcmp((uint8_t*)pA + pg*NVM_PAGE_BYTES, (uint8_t*)pB + pg*NVM_PAGE_BYTES, NVM_PAGE_BYTES))
+            mask |= (1u << pg);
+    }
+    return(mask);
+}
+
+// -----------------------------------------------------------------------------
+// returns 0=no, 1=every settings page matches its crc in the header
+static int nvm_IsPagesValid(NVM_LAYOUT_t* pLayout)
+{
+    int pg;
+
+    for (pg=0; pg<NVM_SETTING_PAGES; pg++)
+    {
+        if (pLayout->hdr.pageCrc[pg] != crc16_Calc((uint8_t*)&pLayout->settings + pg*NVM_PAGE_BYTES, NVM_PAGE_BYTES))
+            return(0);
+    }
+    return(1);
+}
 
 // -----------------------------------------------------------------------------
 // initialize nvm header block
@@ -774,6 +919,8 @@ int nvm_IsSigValid(NVM_HDR_BLK_t* pHdr)
 // drive multi-packet writes in background
 static void nvm_DriveMultiPacketWrites()
 {
+    uint16_t pg;
+
     switch (g_nvm.mpwr.state)
     {
     default:
@@ -801,9 +948,24 @@ static void nvm_DriveMultiPacketWrites()
         g_nvm.mpwr.state = 1;
         // fall thru
     case 1:
-        g_nvm.mpwr.nToWrite = NVM_BYTES_TO_PAGE_END(g_nvm.mpwr.addr);
-        if (g_nvm.mpwr.nToWrite > g_nvm.mpwr.nLeft) 
-            g_nvm.mpwr.nToWrite = g_nvm.mpwr.nLeft;
+        for (;;)
+        {
+            g_nvm.mpwr.nToWrite = NVM_BYTES_TO_PAGE_END(g_nvm.mpwr.addr);
+            if (g_nvm.mpwr.nToWrite > g_nvm.mpwr.nLeft) 
+                g_nvm.mpwr.nToWrite = g_nvm.mpwr.nLeft;
+            pg = g_nvm.mpwr.addr/NVM_PAGE_BYTES - (g_nvm.mpwr.addr-g_nvm.mpwr.nWritten)/NVM_PAGE_BYTES;
+            if (pg >= 16 || (g_nvm.mpwr.pageMask & (1u << pg))) break;
+            // page is unchanged; pass over it
+            g_nvm.mpwr.nWritten += g_nvm.mpwr.nToWrite;
+            g_nvm.mpwr.addr     += g_nvm.mpwr.nToWrite;
+            g_nvm.mpwr.nLeft    -= g_nvm.mpwr.nToWrite;
+            if (g_nvm.mpwr.nLeft < 1) break;
+        }
+        if (g_nvm.mpwr.nLeft < 1)
+        {
+            g_nvm.mpwr.state = 0;   // done; nothing left selected
+            break;
+        }
       #ifdef DEBUG_NVM_MP_WRITES
         LOG(SS_NVM, SV_INFO, "MPWR[1] nToWrite=%u", g_nvm.mpwr.nToWrite);
       #endif
@@ -819,6 +981,8 @@ static void nvm_DriveMultiPacketWrites()
 // save configuration to nvm state machine
 void nvm_SaveConfig()
 {
+    int n;
+
     switch (g_nvm.cmdState)
     {
     default:
@@ -831,19 +995,32 @@ void nvm_SaveConfig()
         g_nvm.revNum++; // bump rev number when writing
         nvm_InitHeader(&g_nvm.scratch.hdr);
         g_nvm.scratch.hdr.revNum = g_nvm.revNum;
+        // the copies now hold everything journaled so far
+        g_nvm.scratch.hdr.jrnlSeq  = g_nvm.jrnlSeq;
+        g_nvm.scratch.hdr.jrnlHead = g_nvm.jrnlHead;
+        g_nvm.jrnlLive = 0;
         memcpy(&g_nvm.scratch.settings, &g_nvm.settings, sizeof(g_nvm.settings));
         memset(&g_nvm.scratch.settings.future_use, NVM_FILL_BYTE, sizeof(g_nvm.scratch.settings.future_use));
-        g_nvm.scratch.hdr.chksumCfg = nvm_CalcChecksum((uint8_t*)&g_nvm.scratch.hdr.nBytes, NVM_CHECKSUM_SIZE);
-        LOG(SS_NVM, SV_INFO, "Save copy1");
+        // only the header and the pages that changed since the copies were written
+        g_nvm.copyDirty |= nvm_DiffPages(&g_nvm.scratch.settings, &g_nvm.committed);
+        g_nvm.savePages  = 1 | ((uint16_t)g_nvm.copyDirty << 1);
+        g_nvm.copyDirty  = 0;
+        memcpy(&g_nvm.committed, &g_nvm.scratch.settings, sizeof(g_nvm.committed));
+        for (n=0; n<NVM_SETTING_PAGES; n++)
+        {
+            g_nvm.scratch.hdr.pageCrc[n] = crc16_Calc((uint8_t*)&g_nvm.scratch.settings + n*NVM_PAGE_BYTES, NVM_PAGE_BYTES);
+        }
+        g_nvm.scratch.hdr.chksumCfg = crc16_Calc((uint8_t*)&g_nvm.scratch.hdr.nBytes, NVM_CHECKSUM_SIZE);
+        LOG(SS_NVM, SV_INFO, "Save copy1 pages=%03X", g_nvm.savePages);
         // start copy1 write
-        nvm_L0_BegWriteBuf(NVM_OFFSET_COPY1, sizeof(g_nvm.scratch), (uint8_t*)&g_nvm.scratch);
+        nvm_L0_BegWritePages(NVM_OFFSET_COPY1, sizeof(g_nvm.scratch), (uint8_t*)&g_nvm.scratch, g_nvm.savePages);
         g_nvm.cmdState = 2;
         // caution! do not fall thru here
         break;
 
     case 2:
         // start copy2 write
-        nvm_L0_BegWriteBuf(NVM_OFFSET_COPY2, sizeof(g_nvm.scratch), (uint8_t*)&g_nvm.scratch);
+        nvm_L0_BegWritePages(NVM_OFFSET_COPY2, sizeof(g_nvm.scratch), (uint8_t*)&g_nvm.scratch, g_nvm.savePages);
         LOG(SS_NVM, SV_INFO, "Save copy2");
         g_nvm.saveTicks = GetSysTicks();    // time statmp
         g_nvm.cmdState = 0; // done
@@ -853,7 +1030,105 @@ void nvm_SaveConfig()
 }
 
 // -----------------------------------------------------------------------------
-// erase all of NVM memory to FF's
+// build journal records for the settings bytes that differ from what is stored
+// returns: number of records in jrnlBuf, -1=too many changes for one batch
+static int nvm_JrnlBuild()
+{
+    uint8_t* pNew = (uint8_t*)&g_nvm.settings;
+    uint8_t* pOld = (uint8_t*)&g_nvm.committed;
+    NVM_JRNL_REC_t* pRec;
+    uint16_t seq = g_nvm.jrnlSeq;
+    int i, n = 0;
+
+    for (i=0; i<(int)sizeof(NVM_SETTINGS_t); i++)
+    {
+        if (pNew[i] == pOld[i]) continue;
+        if (n >= NVM_JRNL_BATCH) return(-1);
+
+        // two bytes covers the int16 fields in one record
+        pRec = &g_nvm.jrnlBuf[n++];
+        seq = nvm_JrnlNextSeq(seq);
+        pRec->seq    = seq;
+        pRec->offset = (uint8_t)i;
+        pRec->len    = (i+1 < (int)sizeof(NVM_SETTINGS_t)) ? 2 : 1;
+        pRec->data[0] = pNew[i];
+        pRec->data[1] = (pRec->len > 1) ? pNew[i+1] : NVM_ERASE_BYTE;
+        pRec->crc    = crc16_Calc((uint8_t*)pRec, NVM_JRNL_CRC_BYTES);
+        i += pRec->len - 1;
+    }
+
+    // what is being written is now the stored value; the copies fall behind
+    for (i=0; i<n; i++)
+    {
+        pRec = &g_nvm.jrnlBuf[i];
+        memcpy(pOld + pRec->offset, pRec->data, pRec->len);
+        g_nvm.copyDirty |= nvm_JrnlRecPages(pRec);
+    }
+    g_nvm.jrnlSeq = seq;
+    return(n);
+}
+
+// -----------------------------------------------------------------------------
+// append changed settings to the journal state machine
+// compacts (full save of both copies) when the journal is too full
+static void nvm_SaveJournal()
+{
+    int n;
+
+    switch (g_nvm.cmdState)
+    {
+    default:
+    case 0:
+        g_nvm.curCmd = NVM_CMD_NONE;
+        break;
+
+    case 1:
+        n = nvm_JrnlBuild();
+        if (n == 0)
+        {
+            g_nvm.cmdState = 0; // nothing changed
+            break;
+        }
+        if (n < 0 || g_nvm.jrnlLive + n > NVM_JRNL_COMPACT)
+        {
+            LOG(SS_NVM, SV_INFO, "Journal compact live=%u", g_nvm.jrnlLive);
+            g_nvm.curCmd   = NVM_CMD_SAVE_CFG;
+            g_nvm.cmdState = 1;
+            break;
+        }
+        g_nvm.jrnlN  = (uint8_t)n;
+        g_nvm.jrnlNA = (uint8_t)((NVM_OFFSET_COPY2 - g_nvm.jrnlHead)/sizeof(NVM_JRNL_REC_t));
+        if (g_nvm.jrnlNA > g_nvm.jrnlN) g_nvm.jrnlNA = g_nvm.jrnlN;
+      #ifdef DEBUG_NVM_CMDS
+        LOG(SS_NVM, SV_INFO, "Journal append n=%u head=%u seq=%u", n, g_nvm.jrnlHead, g_nvm.jrnlSeq);
+      #endif
+        nvm_L0_BegWriteBuf(g_nvm.jrnlHead, g_nvm.jrnlNA*sizeof(NVM_JRNL_REC_t), (uint8_t*)g_nvm.jrnlBuf);
+        g_nvm.cmdState = 2;
+        break;
+
+    case 2:
+        // remainder wraps to the start of the journal
+        if (g_nvm.jrnlNA < g_nvm.jrnlN)
+        {
+            nvm_L0_BegWriteBuf(NVM_OFFSET_JOURNAL, (g_nvm.jrnlN-g_nvm.jrnlNA)*sizeof(NVM_JRNL_REC_t),
+                               (uint8_t*)&g_nvm.jrnlBuf[g_nvm.jrnlNA]);
+            g_nvm.jrnlHead = NVM_OFFSET_JOURNAL + (g_nvm.jrnlN-g_nvm.jrnlNA)*sizeof(NVM_JRNL_REC_t);
+        }
+        else
+        {
+            g_nvm.jrnlHead += g_nvm.jrnlN*sizeof(NVM_JRNL_REC_t);
+            if (g_nvm.jrnlHead >= NVM_OFFSET_COPY2) g_nvm.jrnlHead = NVM_OFFSET_JOURNAL;
+        }
+        g_nvm.jrnlLive += g_nvm.jrnlN;
+        g_nvm.saveTicks = GetSysTicks();    // time stamp
+        g_nvm.cmdState = 0; // done
+        break;
+    } // switch
+}
+
+// -----------------------------------------------------------------------------
+// erase the settings copies and the journal to FF's; the event log from
+// NVM_OFFSET_EVLOG on is kept across new firmware
 // CAUTION! this test is blocking; run during startup only
 static void nvm_EraseAll()
 {
@@ -868,11 +1143,11 @@ static void nvm_EraseAll()
     // fill buffer with erase pattern
     memset(testBuf, NVM_ERASE_BYTE, sizeof(testBuf));
     startTicks = GetSysTicks(); // start timer
-    for (np=0; np<NVM_PAGES; np++)
+    for (np=0; np<NVM_OFFSET_EVLOG/NVM_PAGE_BYTES; np++)
     {
         // chip needs delay for writing
         delayTicks = GetSysTicks();
-        while (!IsTimedOut(NVM_WRITE_DELAY,delayTicks)) { }
+        while (!IsTimedOut(NVM_WRITE_DELAY,delayTicks)) { nvm_HostWait(); }
 
         // begin the writing of page
         nvm_L0_BegWritePage(addr, NVM_PAGE_BYTES, testBuf);
@@ -882,6 +1157,7 @@ static void nvm_EraseAll()
         delayTicks = GetSysTicks();
         while (nvm_IsIsrBusy())
         { 
+            nvm_HostWait();
             if (IsTimedOut(20,delayTicks))
             {
                 LOG(SS_NVM, SV_ERR, "EraseAll Timed-out page=%u", np);
@@ -896,7 +1172,7 @@ static void nvm_EraseAll()
 
     // delay to finish the write
     delayTicks = GetSysTicks();
-    while (!IsTimedOut(NVM_WRITE_DELAY,delayTicks)) { }
+    while (!IsTimedOut(NVM_WRITE_DELAY,delayTicks)) { nvm_HostWait(); }
 #if !defined(OPTION_NO_LOGGING)
     if (nwerrs==0)
         LOG(SS_NVM, SV_INFO, "Erase All ok");
@@ -906,7 +1182,7 @@ static void nvm_EraseAll()
 }
 
 // -----------------------------------------------------------------------------
-// verify erased
+// verify what nvm_EraseAll() erased
 // CAUTION! this test is blocking; run during startup only
 static void nvm_VerifyErased()
 {
@@ -918,7 +1194,7 @@ static void nvm_VerifyErased()
     LOG(SS_NVM, SV_INFO, "Verify Erasure");
     addr = nrerrs = 0;
     startTicks = GetSysTicks(); // start timer
-    for (np=0; np<NVM_PAGES; np++)
+    for (np=0; np<NVM_OFFSET_EVLOG/NVM_PAGE_BYTES; np++)
     {
         memset(testBuf,0,sizeof(testBuf)); // clear so it does not match
         // begin the reading of page
@@ -929,6 +1205,7 @@ static void nvm_VerifyErased()
         delayTicks = GetSysTicks();
         while (nvm_IsIsrBusy()) 
         { 
+            nvm_HostWait();
             if (IsTimedOut(10,delayTicks))
             {
                 LOG(SS_NVM, SV_ERR, "Verify Erase: Read Timed-out page=%u", np);
@@ -996,6 +1273,10 @@ void nvm_ApplySettings()
 // needs to be called periodically to keep state machine running
 void TASK_nvm_Driver()
 {
+  #ifdef __linux__
+    nvmsim_Poll(0);
+  #endif
+
     // allow isr level 0 activity to complete
     if (nvm_IsIsrBusy()) return;
 
@@ -1017,6 +1298,9 @@ void TASK_nvm_Driver()
         case NVM_CMD_SAVE_CFG:
             nvm_SaveConfig();
             break;
+        case NVM_CMD_SAVE_JRNL:
+            nvm_SaveJournal();
+            break;
         } // switch
         return;
     }
@@ -1028,8 +1312,9 @@ void TASK_nvm_Driver()
         switch(g_nvm.reqCmd)
         {
         case NVM_CMD_SAVE_CFG:    // write cfg to nvm
+        case NVM_CMD_SAVE_JRNL:   // append changes to journal
           #ifdef DEBUG_NVM_CMDS
-            LOG(SS_NVM, SV_INFO, "Save NVM requested");
+            LOG(SS_NVM, SV_INFO, "Save NVM requested cmd=%u", g_nvm.reqCmd);
           #endif
             g_nvm.curCmd = g_nvm.reqCmd;
             g_nvm.cmdState = 1;  // start at beginning
@@ -1043,8 +1328,12 @@ void TASK_nvm_Driver()
     if (nvm_IsDirty())
     {
         g_nvm.isDirty = 0;
-        nvm_ReqSaveConfig();
+        g_nvm.reqCmd = NVM_CMD_SAVE_JRNL;
+        return;
     }
+
+    // nothing else to do; the event log gets the bus
+    evlog_Driver();
 }
 
 // -----------------------------------------------------------------------------
@@ -12,6 +12,12 @@
 // 32 byte page writes
 // full memory reads
 //
+// Memory map
+//   0x0000  copy 1   (NVM_LAYOUT_t)
+//   0x0200  settings journal (NVM_JRNL_REC_t)
+//   0x1000  copy 2   (NVM_LAYOUT_t)
+//   0x1200  event log (EVLOG_REC_t; see evlog.h)
+//
 //-----------------------------------------------------------------------------
 
 #ifndef __NVM_H__    // include only once
@@ -39,6 +45,12 @@
 // byte offsets for two configuration copies
 #define  NVM_OFFSET_COPY1    (0)
 #define  NVM_OFFSET_COPY2    (NVM_BYTES_TOTAL/2)
+// settings journal between the copies; see NVM_JRNL_REC_t
+#define  NVM_OFFSET_JOURNAL  (16*NVM_PAGE_BYTES)
+#define  NVM_JOURNAL_BYTES   (NVM_OFFSET_COPY2 - NVM_OFFSET_JOURNAL)
+// event log after copy 2 to the end of the chip
+#define  NVM_OFFSET_EVLOG    (NVM_OFFSET_COPY2 + 16*NVM_PAGE_BYTES)
+#define  NVM_EVLOG_BYTES     (NVM_BYTES_TOTAL - NVM_OFFSET_EVLOG)
 // number of bytes to page end
 #define  NVM_BYTES_TO_PAGE_END(addr)   (NVM_PAGE_BYTES - ((addr)&(NVM_PAGE_BYTES-1)))
 
@@ -68,6 +80,7 @@
 
 
 #define NVM_SETTING_SIZE  (256)
+#define NVM_SETTING_PAGES (NVM_SETTING_SIZE/NVM_PAGE_BYTES)  // 8 pages follow the header page
 
 #define NVM_UNUSED_SIZE 	(NVM_SETTING_SIZE - sizeof(CAN_CONFIG_t) - \
 	sizeof(DEVICE_CONFIG_t)  - sizeof(INVERTER_CONFIG_t) - \
@@ -96,17 +109,20 @@ typedef struct
 {
     uint8_t   sigA;         // NVM_SIGA
     uint8_t   sigB;         // NVM_SIGB
-    uint16_t  chksumCfg;    // cfg checksum
-    // checksum starts here thru end of layout.cfg data
+    uint16_t  chksumCfg;    // header crc-16
+    // checksum starts here thru end of header; settings pages are covered by pageCrc
     uint16_t  nBytes;       // num cfg bytes
     // nBytes is sizeof of layout.cfg
     uint16_t  revNum;       // revision number lo byte
-    uint8_t   reserved[24]; // reserved for future use; set to zero
+    uint16_t  jrnlSeq;      // last journal sequence number included in this copy
+    uint16_t  jrnlHead;     // journal address where the next record goes
+    uint16_t  pageCrc[NVM_SETTING_PAGES]; // crc of each settings page; detects a partially updated copy
+    uint8_t   reserved[4];  // reserved for future use; set to zero
 } NVM_HDR_BLK_t;
 STRUCT_SIZE_CHECK(NVM_HDR_BLK_t,32);  // must be 32 bytes for NVM
 #pragma pack()  // restore packing setting
 
-#define NVM_CHECKSUM_SIZE  (sizeof(NVM_SETTINGS_t) + sizeof(NVM_HDR_BLK_t) - 4)
+#define NVM_CHECKSUM_SIZE  (sizeof(NVM_HDR_BLK_t) - 4)
 
 // ----------
 // NVM Layout
@@ -123,6 +139,30 @@ typedef struct
 } NVM_LAYOUT_t;
 #pragma pack()  // restore packing setting
 
+// --------------------------
+// NVM Settings Journal Record
+// --------------------------
+// A save appends the changed settings bytes as records instead of rewriting both copies.
+// Boot loads the newest copy then replays records from its jrnlHead while each
+// record has the next sequence number and a good crc. A full save (compaction)
+// folds the journal into both copies once it is too full for the next batch.
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    uint16_t  seq;          // journal sequence number; never 0xFFFF (erased)
+    uint8_t   offset;       // settings byte offset (field id)
+    uint8_t   len;          // valid data bytes 1-2
+    uint8_t   data[2];      // settings bytes
+    uint16_t  crc;          // crc-16 of the bytes above
+} NVM_JRNL_REC_t;
+#pragma pack()  // restore packing setting
+STRUCT_SIZE_CHECK(NVM_JRNL_REC_t,8);  // must divide NVM_PAGE_BYTES
+#define NVM_JRNL_CRC_BYTES   (sizeof(NVM_JRNL_REC_t) - 2)   // bytes covered by crc
+
+#define NVM_JRNL_RECS        (NVM_JOURNAL_BYTES/sizeof(NVM_JRNL_REC_t)) // 448 record slots
+#define NVM_JRNL_BATCH       (16)                   // most records in one save; more changes compact
+#define NVM_JRNL_COMPACT     (NVM_JRNL_RECS*3/4)    // live records that force a compaction
+
 // ----------------------
 // Level 0 driver state
 // ----------------------
@@ -155,6 +195,7 @@ typedef struct
     uint16_t  nToWrite;   // number of bytes to write for this page
     uint16_t  nWritten;   // number of bytes written in this block
     uint16_t  nLeft;      // number of bytes left to write (0=nothing to do)
+    uint16_t  pageMask;   // pages to program; bit n is the nth page of the buffer
     uint8_t   state;      // 1=start write, 2=wait for delay, 3=advance
     SYSTICKS  startTicks; // wait timer delay between packet writes
 } NVM_MP_L0_t;
@@ -165,7 +206,8 @@ typedef struct
 // NVM Commands
 // ------------
 #define NVM_CMD_NONE       0  // no command (do not set directly)
-#define NVM_CMD_SAVE_CFG   1  // save config to nvm
+#define NVM_CMD_SAVE_CFG   1  // save config to nvm; both copies (compacts journal)
+#define NVM_CMD_SAVE_JRNL  2  // append changed settings to the journal
 
 
 // ---------------------
@@ -184,6 +226,21 @@ typedef struct
     NVM_MP_L0_t    mpwr;      // multi-page writes (level 0)
     NVM_LAYOUT_t   scratch;   // scratch buffer for reading and writing
     NVM_SETTINGS_t settings;  // active settings
+    uint8_t   copyDirty;      // settings pages that differ from the copies; bit n is page n
+    uint16_t  savePages;      // layout pages being written to each copy; bit 0 is the header
+    // journal
+    uint16_t  jrnlSeq;        // last sequence number written
+    uint16_t  jrnlHead;       // address of next record
+    uint16_t  jrnlLive;       // records since the last compaction
+    uint8_t   jrnlN;          // records in jrnlBuf being written
+    uint8_t   jrnlNA;         // of which fit before the end of the journal
+    union
+    {
+        NVM_JRNL_REC_t jrnlBuf[NVM_JRNL_BATCH];  // records being written
+        NVM_LAYOUT_t   boot;  // startup only; copy 2 streams in here while copy 1 is checked
+    };
+    NVM_SETTINGS_t committed; // settings as stored (copies plus journal)
+    uint16_t  loadMsec;       // startup time from validate to settings applied
 } NVM_DRV_t;
 #pragma pack()  // restore packing setting
 
@@ -198,6 +255,9 @@ void TASK_nvm_Driver(void);      // call this periodically to drive the nvm stat
 void nvm_ReqSaveConfig(void);
 void nvm_LoadRomSettings(void);
 void nvm_ApplySettings(void);
+// level 0; start only when TASK_nvm_Driver hands over the bus (see evlog.c)
+int  nvm_L0_BegReadBuf  (uint16_t addr, uint16_t nbytes, uint8_t* data);
+int  nvm_L0_BegWriteBuf (uint16_t addr, uint16_t nbytes, uint8_t* data);
 
 
 // ------------------
@@ -210,6 +270,7 @@ extern NVM_DRV_t  g_nvm;
 // Inlines for Speed
 //-------------------
 // set dirty bit when config changes to indicate needs saving
+// the changed bytes are appended to the journal
 INLINE void nvm_SetDirty()
 {
     g_nvm.isDirty=1; 
@@ -162,6 +162,7 @@
 // ------------------------------------------------------------------------------------------------------------
 //  Optional Settings (any device type)
 //      OPTION_AC_LINE_QUAL_SECS   - A/C line qualification time in seconds (30 secs if not specified)
+//      OPTION_AC_OUT_HZ           - inverter output frequency; 50 or 60 (60 if not specified)
 //      OPTION_SSR                 - use Solid State Relay clamp
 //      OPTION_HAS_CLAMP           - has output clamping functionality
 //      OPTION_CAN_BAUD_500K       - use 500K baud for CAN else 250KB
@@ -177,6 +178,8 @@
 //        must select one of these:
 //      	OPTION_CHARGE_3STEP    - use 3 step charging algorithm
 //          OPTION_CHARGE_LION     - charging Lithium Ion battery
+//      OPTION_INV_DTC_DUTY        - inverter dead time compensation table; duty counts
+//      OPTION_INV_DTC_AMPS_STEP   -   at 0, 1, 2 ... steps of output amps (see inv_deadtime.h)
 //      OPTION_VOLTA_UI            - provide lcd user interface in Volta format
 //      OPTION_NO_CONDITIONAL_DBG  - turn off all local file conditional debugging flags
 //                                       set via BUILD_DVT and BUILD_RELEASE
@@ -431,6 +434,14 @@
       #define OPTION_AC_LINE_QUAL_SECS  30  // default if not specified
     #endif
 
+    // inverter output frequency
+    #if !defined(OPTION_AC_OUT_HZ)
+      #define OPTION_AC_OUT_HZ  60  // default if not specified
+    #endif
+    #if (OPTION_AC_OUT_HZ != 50) & (OPTION_AC_OUT_HZ != 60)
+      #error 'OPTION_AC_OUT_HZ' must be 50 or 60 in 'models.h'
+    #endif
+
     // --------------------------
     // DC+DC Converter Validation
     // --------------------------
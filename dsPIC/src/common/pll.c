@@ -0,0 +1,261 @@
+// <><><><><><><><><><><><><> pll.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Software phase locked loop on the a/c line (see pll.h)
+//
+//  Cost per PWM period is one table look up, one multiply and the DDS
+//  advance; the divide and loop filter run once per half-cycle.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "pll.h"
+#include "sine_table.h"
+
+#ifdef __linux__
+ #include "xfer_sim.h"  // host: line phase input stand-in
+ #define PLL_LINE_PHASE()       xsim_LinePhase()
+#else
+ #define PLL_LINE_PHASE()       AC_LINE_PHASE()
+#endif
+
+// 32/16 divides; the quotient must fit 16 bits
+#ifdef __linux__
+  #define PLL_DIV(num, den)     ((int16_t)((num) / (den)))
+  #define PLL_DIVU(num, den)    ((uint16_t)((num) / (den)))
+#else
+  #define PLL_DIV(num, den)     __builtin_divsd((num), (den))
+  #define PLL_DIVU(num, den)    __builtin_divud((num), (den))
+#endif
+
+// free running step
+#define PLL_STEP_NOMINAL        DDS_STEP_HZ(OPTION_AC_OUT_HZ)
+
+// instantaneous |sample| at a peak of a PLL_DROPOUT_VOLTS line
+#define PLL_DROPOUT_PEAK        (VAC_VOLTS_ADC(PLL_DROPOUT_VOLTS * 1.414) - VAC_VOLTS_ADC(0))
+#define PLL_DROPOUT_AMP         (VAC_VOLTS_ADC(PLL_DROPOUT_VOLTS * 0.900) - VAC_VOLTS_ADC(0))   // mean |sample|
+#define PLL_COS_30              (28378)     // Q15; |sine| > 1/2 inside
+
+// line phase edges closer than 3/4 cycle at PLL_FREQ_HZ_MAX are noise
+#define PLL_LINE_TICKS_MIN      ((uint16_t)((FPWM * 0.75) / PLL_FREQ_HZ_MAX))
+
+// step to centi-Hz: ((step >> 6) * PLL_CHZ_Q16) >> 16
+#define PLL_CHZ_Q16             ((uint32_t)(((FPWM*100.0)*64.0*65536.0)/4294967296.0 + 0.5))
+
+// ------------
+// Global Data
+// ------------
+PLL_t g_pll = { { 0, PLL_STEP_NOMINAL }, 0, 0, 0, VAC_ZERO_CROSS_A2D, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, NULL };
+
+
+//-----------------------------------------------------------------------------
+//  pll_Reset()
+//-----------------------------------------------------------------------------
+//  Back to the nominal frequency, unlocked. Call with the PWM interrupt
+//  disabled or from the PWM ISR.
+//-----------------------------------------------------------------------------
+
+void pll_Reset(void)
+{
+    g_pll.nco.step  = PLL_STEP_NOMINAL;
+    g_pll.locked    = 0;
+    g_pll.lockCount = 0;
+    g_pll.err       = 0;
+    g_pll.amp       = 0;
+    g_pll.lineAmp   = 0;
+    g_pll.integ     = 0;
+    g_pll.sumErr    = 0;
+    g_pll.sumAbs    = 0;
+    g_pll.nSamples  = 0;
+    g_pll.lowCount  = 0;
+    g_pll.dropout   = 0;
+}
+
+//-----------------------------------------------------------------------------
+// loop filter and lock detect; end of each oscillator half-cycle
+
+static void _pll_HalfCycle(void)
+{
+    int32_t  step;
+    int16_t  abs_err;
+    uint16_t amp_last = g_pll.amp;
+
+    g_pll.amp = (g_pll.nSamples) ? PLL_DIVU((uint32_t)g_pll.sumAbs, g_pll.nSamples) : 0;
+
+    // a whole half-cycle of line, not falling away, ends a dropout. The
+    // phase held through it is not the line's if the line came back off
+    // frequency, and noise can hold the amplitude up, so lock again.
+    if ((g_pll.amp >= PLL_DROPOUT_AMP) && (g_pll.amp >= amp_last - (amp_last >> 2)))
+    {
+        if (g_pll.dropout)
+        {
+            g_pll.locked    = 0;
+            g_pll.lockCount = 0;
+        }
+        g_pll.dropout = 0;
+    }
+
+    if (g_pll.dropout || (g_pll.locked && (g_pll.amp < amp_last - (amp_last >> 2))))
+    {
+        // the line is going away; the samples of this half-cycle would pull
+        // the phase, so hold the oscillator as it is. Unlock once it is gone.
+        g_pll.err = 0;
+        if (g_pll.amp < PLL_MIN_AMP)
+        {
+            g_pll.locked    = 0;
+            g_pll.lockCount = 0;
+        }
+    }
+    else if (g_pll.amp < PLL_MIN_AMP)
+    {
+        // no line; free run at the nominal frequency
+        g_pll.nco.step  = PLL_STEP_NOMINAL;
+        g_pll.integ     = 0;
+        g_pll.err       = 0;
+        g_pll.locked    = 0;
+        g_pll.lockCount = 0;
+    }
+    else
+    {
+        // sumAbs >= PLL_MIN_AMP * samples, so the divisor is not zero;
+        // |sumErr| <= (pi/4) * 256 * sumAbs, so the quotient fits
+        g_pll.err = PLL_DIV(g_pll.sumErr << 2, (int16_t)(g_pll.sumAbs >> 2));
+
+        g_pll.integ += (int32_t)PLL_KI * g_pll.err;
+        if (g_pll.integ > (int32_t)(PLL_STEP_MAX - PLL_STEP_NOMINAL)) g_pll.integ = (int32_t)(PLL_STEP_MAX - PLL_STEP_NOMINAL);
+        if (g_pll.integ < (int32_t)(PLL_STEP_MIN - PLL_STEP_NOMINAL)) g_pll.integ = (int32_t)(PLL_STEP_MIN - PLL_STEP_NOMINAL);
+
+        step = (int32_t)PLL_STEP_NOMINAL + g_pll.integ + (int32_t)PLL_KP * g_pll.err;
+        if (step > (int32_t)PLL_STEP_MAX) step = (int32_t)PLL_STEP_MAX;
+        if (step < (int32_t)PLL_STEP_MIN) step = (int32_t)PLL_STEP_MIN;
+        g_pll.nco.step = (uint32_t)step;
+
+        // the half-cycle before was whole if this one did not fall away;
+        // the one the line goes in does not count
+        if (g_pll.locked) g_pll.lineAmp = amp_last;
+
+        // lock detect; the integral is the line frequency
+        step = (int32_t)PLL_STEP_NOMINAL + g_pll.integ;
+        abs_err = (g_pll.err < 0) ? -g_pll.err : g_pll.err;
+        if (g_pll.locked)
+        {
+            if ((abs_err <= PLL_UNLOCK_ERR) &&
+                (step >= (int32_t)DDS_STEP_HZ(PLL_FREQ_HZ_MIN)) && (step <= (int32_t)DDS_STEP_HZ(PLL_FREQ_HZ_MAX)))
+            {
+                g_pll.lockCount = 0;
+            }
+            else if (++g_pll.lockCount >= PLL_UNLOCK_HALVES)
+            {
+                g_pll.locked    = 0;
+                g_pll.lockCount = 0;
+            }
+        }
+        else
+        {
+            if ((abs_err > PLL_LOCK_ERR) ||
+                (step < (int32_t)DDS_STEP_HZ(PLL_FREQ_HZ_MIN)) || (step > (int32_t)DDS_STEP_HZ(PLL_FREQ_HZ_MAX)))
+            {
+                g_pll.lockCount = 0;
+            }
+            else if (++g_pll.lockCount >= PLL_LOCK_HALVES)
+            {
+                g_pll.locked    = 1;
+                g_pll.lockCount = 0;
+            }
+        }
+    }
+
+    // dc offset from the analog cycle average, as the inverter does
+    g_pll.offset   = IsCycleAvgValid() ? VacCycleAvg() : VAC_ZERO_CROSS_A2D;
+    g_pll.sumErr   = 0;
+    g_pll.sumAbs   = 0;
+    g_pll.nSamples = 0;
+}
+
+//-----------------------------------------------------------------------------
+//  pll_Isr()
+//-----------------------------------------------------------------------------
+//  Called every PWM period from the PWM ISR, before the inverter or charger
+//  ISR, so they see the phase for this period.
+//-----------------------------------------------------------------------------
+
+void pll_Isr(void)
+{
+    int16_t  v = (int16_t)VacRaw() - g_pll.offset;
+    uint32_t phase = g_pll.nco.phase + DDS_PHASE_QUARTER;  // cosine
+    int16_t  c = (int16_t)(_SineTableQ16[(uint16_t)(dds_Position(phase) >> 16)] >> 1);
+
+    if (phase & DDS_PHASE_HALF) c = -c;
+
+    // phase detector; Q15 cosine >> 7 keeps a half-cycle sum in 32 bits
+    g_pll.sumErr += ((int32_t)v * c) >> 7;
+    g_pll.sumAbs += (v < 0) ? -v : v;
+    g_pll.nSamples++;
+
+  #if PLL_HAS_LINE_PHASE
+    {
+        uint8_t pin = PLL_LINE_PHASE() ? 1 : 0;
+
+        if (g_pll.lineTicks < 0xFFFF) g_pll.lineTicks++;
+        if (pin && !g_pll.linePin && (g_pll.lineTicks >= PLL_LINE_TICKS_MIN))
+        {
+            const DDS_t* ref = (g_pll.lineRef) ? g_pll.lineRef : &g_pll.nco;
+
+            g_pll.lineErr   = (int16_t)((uint32_t)(PLL_LINE_EDGE_PHASE - ref->phase) >> 16);
+            g_pll.lineTicks = 0;
+            g_pll.lineEdges++;
+        }
+        g_pll.linePin = pin;
+    }
+  #endif
+
+    // dropout; well under a PLL_DROPOUT_VOLTS line where the sine is over
+    // half its peak
+    if (g_pll.locked && (c < PLL_COS_30) && (c > -PLL_COS_30))
+    {
+        if (((v < 0) ? -v : v) >= (PLL_DROPOUT_PEAK/2))
+        {
+            g_pll.lowCount = 0;
+        }
+        else if (++g_pll.lowCount >= PLL_DROPOUT_SAMPLES)
+        {
+            g_pll.dropout = 1;
+        }
+    }
+    else
+    {
+        g_pll.lowCount = 0;
+    }
+
+    g_pll.events = dds_Advance(&g_pll.nco);
+    if (g_pll.events & DDS_EV_HALF)
+    {
+        _pll_HalfCycle();
+    }
+}
+
+//-----------------------------------------------------------------------------
+//  pll_FreqCentiHz()
+//-----------------------------------------------------------------------------
+//  Line frequency in 0.01 Hz from the loop filter integral.
+//-----------------------------------------------------------------------------
+
+uint16_t pll_FreqCentiHz(void)
+{
+    uint32_t step;
+    uint8_t  saved_ipl;
+
+    SET_AND_SAVE_CPU_IPL(saved_ipl, 7); //  Start of Protected Code
+    step = (uint32_t)((int32_t)PLL_STEP_NOMINAL + g_pll.integ);
+    RESTORE_CPU_IPL(saved_ipl); //  End of Protected Code
+
+    return((uint16_t)(((step >> 6) * PLL_CHZ_Q16) >> 16));
+}
+
+// <><><><><><><><><><><><><> pll.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,149 @@
+// <><><><><><><><><><><><><> pll.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Software phase locked loop on the a/c line
+//
+//  Runs every PWM period from the PWM ISR and tracks the phase and frequency
+//  of the a/c voltage (VacRaw) with a DDS (see sine_table.h) as oscillator:
+//
+//  Phase detector:  the a/c sample, less its dc offset, is multiplied by the
+//    cosine of the oscillator phase and summed over the oscillator half-cycle.
+//    Summing over exactly a half-cycle cancels the 2x line frequency term of
+//    the product. Dividing by the sum of |sample| removes the amplitude, so
+//    the error is (pi/4)*sin(phase error), scaled PLL_ERR_PER_RAD.
+//
+//  Loop filter:  proportional + integral, once per half-cycle; the output is
+//    the oscillator step, so the integral is the line frequency.
+//
+//  A single spike or a missing half-cycle moves the phase by a fraction of
+//  the error, where the edge detectors it replaces would re-synchronize.
+//
+//  Phase 0 is the negative to positive zero-crossing of the line. The lock
+//  flag is set after PLL_LOCK_HALVES half-cycles in a row with a small error,
+//  frequency within PLL_FREQ_HZ_MIN..MAX and enough amplitude; it is cleared
+//  on PLL_UNLOCK_HALVES half-cycles with a large error, or at once when the
+//  amplitude is gone.
+//
+//  Line dropout:  while locked, PLL_DROPOUT_SAMPLES samples in a row under
+//    half the peak of a PLL_DROPOUT_VOLTS line, between 30 and 150 degrees,
+//    set the dropout flag; a few msec after the line goes away, longer at
+//    a zero-crossing. The oscillator holds its frequency, phase and the
+//    line amplitude (lineAmp) through a dropout. A half-cycle with the mean
+//    of a PLL_DROPOUT_VOLTS line that is not falling away clears it,
+//    unlocked.
+//
+//  Line phase:  where there is a line phase input (HAS_AC_LINE_PHASE) its
+//    rising edge is timed against the inverter output oscillator given to
+//    pll_SetLineRef() (NULL: this one), so lineErr is the phase of the line
+//    ahead of the output; it is what the transfer back to the line slews to
+//    zero. The loop itself is not used for this: while inverting it is
+//    locked on the output and would lag the output as its frequency is
+//    trimmed.
+//
+//  The charger takes its zero-crossings from it (ENABLE_CHGR_PLL_SYNC in
+//  charger_isr.c, on by default). The host harness runs it on synthetic lines (dsPIC/host,
+//  'make check', check "pll"); it has not been run on a unit.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __PLL_H    // include only once
+#define __PLL_H
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "hw.h"
+#include "sine_table.h"
+
+// ---------
+// constants
+// ---------
+#define PLL_ERR_PER_RAD     (3217)  // phase error units per radian: (pi/4) * 4096
+
+#define PLL_FREQ_HZ_MIN     (47)    // lock range; a 50 Hz line and its generator hunting
+#define PLL_FREQ_HZ_MAX     (70)
+#define PLL_STEP_MIN        DDS_STEP_HZ(45)     // oscillator range
+#define PLL_STEP_MAX        DDS_STEP_HZ(75)
+
+#define PLL_KP              (256)   // step per error unit
+#define PLL_KI              (24)    // step per error unit per half-cycle
+
+#define PLL_MIN_AMP         (8)     // mean |sample| (a/d counts) for a line to be there
+#define PLL_LOCK_ERR        (280)   // ~5 degrees
+#define PLL_UNLOCK_ERR      (840)   // ~15 degrees
+#define PLL_LOCK_HALVES     (12)
+#define PLL_UNLOCK_HALVES   (4)
+
+// phase either side of an oscillator zero-crossing where the line's may be
+// while locked: more than PLL_LOCK_ERR and the error on a hunting generator
+#define PLL_ZC_GUARD        (6*DDS_STEP_HZ(60))     // ~5.6 degrees
+
+#define PLL_DROPOUT_VOLTS   (60)    // rms volts; line gone when below
+#define PLL_DROPOUT_SAMPLES (8)     // ~350 usec
+
+// output phase at the rising edge of the line phase input; trims the opto
+// delay. lineErr is in 1/65536 of a cycle, 182 per degree.
+#define PLL_LINE_EDGE_PHASE (0UL)
+#define PLL_LINE_ERR_DEG    (182)
+
+// the host simulator stands in for the line phase input
+#ifdef __linux__
+  #define PLL_HAS_LINE_PHASE    (1)
+#else
+  #define PLL_HAS_LINE_PHASE    HAS_AC_LINE_PHASE
+#endif
+
+// -------------
+// pll data
+// -------------
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    DDS_t     nco;          // oscillator; phase 0 = line negative to positive
+    uint8_t   events;       // DDS_EV_xxx of the last advance
+    uint8_t   locked;       // 1=locked on the line
+    uint8_t   lockCount;    // half-cycles in a row toward lock/unlock
+    int16_t   offset;       // dc offset of the samples; a/d counts
+    int16_t   err;          // phase error of the last half-cycle
+    uint16_t  amp;          // mean |sample| of the last half-cycle
+    uint16_t  lineAmp;      // amp of the last half-cycle followed by another while locked; kept through a dropout
+    int32_t   integ;        // loop filter integral; step
+    int32_t   sumErr;       // phase detector sums over the half-cycle
+    int32_t   sumAbs;
+    uint16_t  nSamples;
+    uint8_t   lowCount;     // samples in a row under the dropout level
+    uint8_t   dropout;      // 1=line went away while locked
+    uint8_t   linePin;      // last line phase input
+    uint8_t   lineEdges;    // count of line phase rising edges
+    int16_t   lineErr;      // line phase less lineRef phase at the last edge
+    uint16_t  lineTicks;    // PWM periods since the last edge
+    const DDS_t* lineRef;   // output oscillator; NULL=this one
+} PLL_t;
+#pragma pack()  // restore packing setting
+
+// ------------------
+// access global data
+// ------------------
+extern PLL_t g_pll;
+
+// --------------------
+// Function Prototyping
+// --------------------
+extern void     pll_Reset(void);
+extern void     pll_Isr(void);          // every PWM period
+extern uint16_t pll_FreqCentiHz(void);  // task level
+
+// PWM ISR level; the phase is current only there
+INLINE uint8_t  pll_IsLocked(void)  { return(g_pll.locked);    }
+INLINE uint32_t pll_Phase(void)     { return(g_pll.nco.phase); }
+INLINE uint8_t  pll_IsHalfCycle(void) { return(g_pll.events & DDS_EV_HALF); }  // pll_Isr() did its half-cycle work
+
+// task level, with the PWM interrupt running; a pointer write is atomic
+INLINE void     pll_SetLineRef(const DDS_t* dds) { g_pll.lineRef = dds; }
+
+#endif  //  __PLL_H
+
+// <><><><><><><><><><><><><> pll.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -47,15 +47,12 @@
 #include "fan_ctrl.h"	// fan timer called from PWM ISR
 #include "hw.h"
 #include "inverter.h"
+#include "pll.h"
 #include "pwm.h"
 #include "sine_table.h"
 #include "timer3.h"
 #include "tasker.h"
-
-// ------------
-// Global Data
-// ------------
-int16_t ac_sync_pulse_count = 0;
+#include "telemetry.h"
 
 // ----------
 // local data
@@ -103,98 +100,6 @@ void pwm_DefaultIsr(void)
     return;
 }
 
-//-----------------------------------------------------------------------------
-//  _ac_line_synchronize
-//-----------------------------------------------------------------------------
-//
-//  This function will monitor the AC-Line Synch signal so that the inverter can 
-//  start sychronous to the AC-Line.
-//
-//  The incoming AC_LINE_PHASE signal is not a 50% duty-cycle.  
-//
-//  The AC_LINE_PHASE signal is generated from the incoming AC-line through an 
-//  opto-coupler.  The positive-going half of the sine-wave turns on the photo-
-//  diode (LED) which turns on the photo transistor pulling the output low.
-//
-//  Forward voltage drop across the opto-coupler's LED results in a slight delay
-//  for turn-on and premature turn off.  This results in a somewhat shorter 
-//  negative half to the AC_LINE_PHASE signal.
-//
-//  In theory, these discrepancies are stable. Applying a delay to the premature 
-//  turn-off is more reliable than predicting the delayed turn-on. Therefore, we
-//  synchronize to the falling edge of the AC_LINE_PHASE signal.  
-//
-//  The falling edge of the AC_LINE_PHASE signal corresponds to the positive to 
-//  negative transition of the incoming AC sine wave.
-//
-//  The exact zero-crossing is offset from this signal by 1/2 the difference 
-//  between the positive and negative halves of the AC_LINE_PHASE.
-//-----------------------------------------------------------------------------
-
-
-static void _ac_line_synchronize(void)
-{
-    static int16_t state = 0;
-
-	//-----------------------------------------------------------------------------
-    //  We need to detect phase even if the AC Signal is NOT (No longer) 
-    //  qualified. For example, the charger is running and we lose AC power. 
-    //  In that case we should start within one AC-cycle.
-    //  We also have to prevent overflow of the ac_sync_pulse_count to prevent
-    //  false triggers.
-	//-----------------------------------------------------------------------------
-
-    //  One AC-cycle = (MAX_SINE * 2)
-    if(ac_sync_pulse_count < (MAX_SINE * 3))
-    {
-        ac_sync_pulse_count++;
-    }
-    else if(!AC_LINE_VALID())    
-    {
-        state = 0;
-        return;
-    }
-  
-  
-    switch(state)
-    {
-    default:
-    case 0 :    // determine where we are relative to the PHASE signal
-        if(0 == PORTCbits.RC13)
-        {
-            //  we are in the positive half
-            state = 2;
-        }
-        else 
-        {
-            //  we are in the negative half
-            state = 1;
-        }
-        break;
-    
-    case 1 :    // negative half of PHASE signal
-        if(0 == AC_LINE_PHASE()) 
-        {
-            //  This is falling-edge transition of the PHASE Signal, which  
-            //  corresponds to the negative-to-positive transition of the 
-            //  AC Signal, which we will call zero-degrees.
-
-            //  Synchronize to this edge!
-            ac_sync_pulse_count = 0;    //  reset the pulse count
-            
-            state = 2;
-        }
-        break;
-    
-    case 2 :    // positive half of PHASE signal
-        if(1 == AC_LINE_PHASE()) 
-        {
-            state = 1;
-        }
-        break;
-    } // switch state
-}
-
 //-----------------------------------------------------------------------------
 //  _PWMInterrupt()
 //-----------------------------------------------------------------------------
@@ -223,29 +128,34 @@ static void _ac_line_synchronize(void)
 
 void __attribute__((interrupt, no_auto_psv)) _PWMInterrupt (void)
 {
+  #ifdef  ENABLE_TASK_TIMING
+    TMR7 = 0;  // clear timer; the pwm timing is the whole isr
+  #endif
+
     T3_Start();      //  Timer3 is used to trigger ADC
 
-    _ac_line_synchronize();
+    pll_Isr();       //  a/c line phase; ahead of the inverter/charger isr
 
   #ifdef  ENABLE_TASK_TIMING
+    uint16_t fan_start = TMR7;
     g_fanTiming.count++; // one more isr
-    TMR7 = 0;  // clear timer
   #endif
  
     fan_Timer(); // perform fan timing for duty cycle
 
   #ifdef  ENABLE_TASK_TIMING
     {
-    uint16_t ticks = TMR7;
+    uint16_t ticks = TMR7 - fan_start;
     g_fanTiming.tsum += ticks;  // add to sum
     if (ticks < g_fanTiming.tmin) g_fanTiming.tmin = ticks;  // min value
     if (ticks > g_fanTiming.tmax) g_fanTiming.tmax = ticks;  // max value
-    g_pwmTiming.count++; // one more isr
     }
   #endif
 
     _pwm_isr();
 
+    tlm_Sample();   // telemetry streaming; see telemetry.h
+
  #ifdef  ENABLE_TASK_TIMING
     uint16_t ticks = TMR7;
     g_pwmTiming.tsum += ticks;  // add to sum
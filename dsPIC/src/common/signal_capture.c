@@ -27,6 +27,8 @@
 //	only temporarily while debugging.  It is not intended that this code be 
 //	used in production firmware.
 //
+//	For capture in the field over CAN, without a debugger, see telemetry.c.
+//
 // =============================================================================
 
 
@@ -50,6 +50,124 @@ typedef enum
 extern const uint16_t _SineTableQ16[MAX_SINE];
 
 
+//-----------------------------------------------------------------------------
+//  DDS (direct digital synthesis) sine generator
+//
+//  A 32-bit phase accumulator advances by 'step' every PWM period; 2^32 is 
+//  one a/c cycle, so the output frequency is step * FPWM / 2^32 and can be 
+//  set or trimmed by a fraction of a milli-hertz. Bit 31 selects the half-
+//  cycle (VECTOR1/VECTOR2); bits 30..0 are the position within the half-
+//  cycle, scaled exactly onto the MAX_SINE table entries (the index is
+//  ((phase & 0x7FFFFFFF) * MAX_SINE) >> 31) with linear interpolation 
+//  between them. At 60 Hz the step is 2^31/MAX_SINE rounded up, so each 
+//  entry is visited once per half-cycle; the rounding walks the samples 
+//  across an entry over ~24 minutes and the half-cycle in which they cross 
+//  visits one entry fewer. At 50 Hz the step is 0.83 of an entry, so
+//  entries repeat and equality tests against an index must be replaced
+//  with the events returned by dds_Advance(). The host harness checks
+//  both (dsPIC/host, 'make check', check "dds").
+//-----------------------------------------------------------------------------
+
+#define DDS_PHASE_HALF      ((uint32_t)0x80000000)
+#define DDS_PHASE_QUARTER   ((uint32_t)0x40000000)
+
+// phase step for a frequency; compile-time constant
+#define DDS_STEP_HZ(hz)     ((uint32_t)(((hz)*4294967296.0)/FPWM + 0.5))
+
+// dds_Advance() events
+#define DDS_EV_HALF         (0x01)  // the next sample starts a half-cycle
+#define DDS_EV_PEAK         (0x02)  // the next sample is the first at or past 90 (270) degrees
+
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    uint32_t  phase;    // 2^32 = one a/c cycle
+    uint32_t  step;     // phase advance per PWM period
+} DDS_t;
+#pragma pack()  // restore packing setting
+
+//-----------------------------------------------------------------------------
+// position of a phase within its half-cycle in table entries; Q16. 
+// ((phase & 0x7FFFFFFF) * MAX_SINE) >> 15 from two 16x16 multiplies; the 
+// product does not fit 32 bits
+INLINE uint32_t dds_Position(uint32_t phase)
+{
+    uint16_t hi = (uint16_t)(phase >> 16) & 0x7FFF;
+    uint16_t lo = (uint16_t)phase;
+
+  #ifdef __linux__
+    return((((uint32_t)hi * MAX_SINE) << 1) + (((uint32_t)lo * MAX_SINE) >> 15));
+  #else
+    return((__builtin_muluu(hi, MAX_SINE) << 1) + (__builtin_muluu(lo, MAX_SINE) >> 15));
+  #endif
+}
+
+//-----------------------------------------------------------------------------
+// interpolated sine magnitude (Q16) at the current phase; *index gets the 
+// table entry within the half-cycle
+INLINE uint16_t dds_Sample(const DDS_t* dds, int16_t* index)
+{
+    uint32_t pos = dds_Position(dds->phase);
+    uint16_t i   = (uint16_t)(pos >> 16);
+    uint16_t a   = _SineTableQ16[i];
+    uint16_t b   = (i < (MAX_SINE-1)) ? _SineTableQ16[i+1] : 0;
+
+    *index = (int16_t)i;
+    return(a + (int16_t)(((int32_t)(int16_t)(b - a) * (uint16_t)pos) >> 16));
+}
+
+//-----------------------------------------------------------------------------
+// as dds_Sample(), from a table of MAX_SINE+1 values of a linear function of 
+// the sine (see duty_table.h); one more 16x16 multiply
+INLINE int16_t dds_SampleTable(const DDS_t* dds, const int16_t* table)
+{
+    uint32_t pos = dds_Position(dds->phase);
+    uint16_t i   = (uint16_t)(pos >> 16);
+    int16_t  a   = table[i];
+
+    return(a + (int16_t)(((int32_t)(table[i+1] - a) * (uint16_t)pos) >> 16));
+}
+
+//-----------------------------------------------------------------------------
+INLINE VECTOR_CYCLE dds_Vector(const DDS_t* dds)
+{
+    return((dds->phase & DDS_PHASE_HALF) ? VECTOR2 : VECTOR1);
+}
+
+//-----------------------------------------------------------------------------
+// phase step so that n PWM periods span a half-cycle: 2^31 / n
+// done in two 16 bit divides; the quotient does not fit one
+INLINE uint32_t dds_StepSamples(uint16_t n)
+{
+    uint16_t hi, r, lo;
+
+    if (0 == n) return(DDS_PHASE_HALF);
+    hi = 0x8000u / n;
+    r  = 0x8000u - (hi * n);
+  #ifdef __linux__
+    lo = (uint16_t)(((uint32_t)r << 16) / n);
+  #else
+    lo = __builtin_divud((uint32_t)r << 16, n);
+  #endif
+
+    return(((uint32_t)hi << 16) | lo);
+}
+
+//-----------------------------------------------------------------------------
+// advance one PWM period
+// returns: DDS_EV_xxx
+INLINE uint8_t dds_Advance(DDS_t* dds)
+{
+    uint16_t prev = (uint16_t)(dds->phase >> 16);
+    uint16_t next;
+
+    dds->phase += dds->step;
+    next = (uint16_t)(dds->phase >> 16);
+    return((((prev ^ next) & 0x8000) ? DDS_EV_HALF : 0) |
+           (((~prev & next) & 0x4000) ? DDS_EV_PEAK : 0));
+}
+
+
 #endif  //  __SINE_TABLE_H
 
 // <><><><><><><><><><><><><> sine_table.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -5,6 +5,13 @@
 //
 //  SPI Remote LCD Communications Driver
 //
+//  Bytes move under interrupt; the task only runs the packet protocol.
+//    - Timer4 paces the transmitter at one byte per SPI_TX_PACE_USEC and
+//      sends keep-alive sync bytes when there is nothing to send
+//    - the SPI2 interrupt takes each byte clocked in as the transfer
+//      completes, so a long task cannot cause a receive overrun
+//  The display refresh rate therefore does not depend on the main loop.
+//
 //-----------------------------------------------------------------------------
 
 // -------
@@ -13,6 +20,7 @@
 #include "options.h"    // must be first include
 #include "hw.h"
 #include "spi.h"
+#include "timer1.h"
 #include "nvm.h"
 #include "sensata_can.h"
 #include "rv_can.h"
@@ -25,6 +33,9 @@
 #define SPI_RX_BUF_LEN     (2*SPI_MAX_PKT_LEN)  // sizeof of receive  buffer (120 bytes) 
 #define SPI_TX_BUF_LEN     (2*SPI_MAX_PKT_LEN)  // sizeof of transmit buffer (120 bytes)
 #define BCR_DEBOUNCE_CNTS  (10)                 // consecutive counts need to detect legacy BCR command
+#define SPI_TX_PACE_USEC   (1000)               // one byte per msec; the display cannot take them faster
+#define SPI_T4_PERIOD      (SPI_TX_PACE_USEC*5) // Timer4 counts at 5.000 MHz (40 MIPS, 1:8)
+#define EMPTY_TX_THRESHOLD (10)                 // transmit sync byte if idle this many bytes times
 
 // -----------
 // Structures
@@ -36,16 +47,18 @@ typedef struct SPI_DATA_t
     uint8_t  isRmtEnhanced;          // 0=legacy, 1=remote display uses enhanced menuing protocol
     uint8_t  handshakeDone;          // 0=no, 1=handshake with LCD complete
     uint8_t  handshakeCnt;           // count legacy BCR
+    uint8_t  rmtCaps;                // SPI_RMT_CAP_xxx; from SPI_CMD_REMOTE_CAPS
 
-    // circular receive buffer
+    // circular receive buffer; filled by the SPI2 interrupt
     uint8_t  RxBuf[SPI_RX_BUF_LEN];  // circular receive buffer
-    uint16_t RxPutIn;                // index into RxBuf[] to put next byte received from remote
+    volatile uint16_t RxPutIn;       // index into RxBuf[] to put next byte received from remote
     uint16_t RxTakeOut;              // index into RxBuf[] to take out next byte via getter
+    volatile uint16_t RxOverruns;    // bytes lost; SPIROV or RxBuf[] full
 
-    // circular transmit buffer      
+    // circular transmit buffer; emptied by the Timer4 interrupt
     uint8_t  TxBuf[SPI_TX_BUF_LEN];  // circular transmit buffer
     uint16_t TxPutIn;                // index into TxBuf[] to put next byte via setter
-    uint16_t TxTakeOut;              // index into TxBuf[] to take out next byte for transmission
+    volatile uint16_t TxTakeOut;     // index into TxBuf[] to take out next byte for transmission
 
     // high level command protocol
     uint16_t RxCmdBytes;             // number of bytes in RxCmd[]
@@ -58,7 +71,15 @@ typedef struct SPI_DATA_t
 
     // sync word state
     uint8_t  SyncWordState;          // 0=idle, 1=rx sync, 2=rx data
-    uint8_t  EmptyTxCnts;            // number of consequtive non=transmit counts (milliseconds)
+    uint8_t  EmptyTxCnts;            // number of consequtive non-transmit byte times
+
+    // LCD frame; the protocol has no acknowledge so a frame counts as sent once it is
+    // in TxBuf[]; the keep-alive resend covers a frame the remote missed
+    uint8_t  LcdFrame [SPI_LEGACY_MSG_LEN]; // latest frame from the UI with indicator bits
+    uint8_t  LcdShadow[SPI_LEGACY_MSG_LEN]; // last frame sent to the remote
+    uint8_t  LcdPending;             // 1=LcdFrame[] differs from LcdShadow[]
+    uint8_t  LcdSent;                // 0=nothing sent yet
+    SYSTICKS LcdSentTicks;           // when the last frame went out
 
 } SPI_DATA;
 #pragma pack() // restore packing
@@ -75,6 +96,9 @@ typedef struct SPI_DATA_t
 // ------------
 static void spi_processRxPktCmd(SPI_HDR* hdr, uint8_t* data);
 static void spi_processBcrByte(uint8_t bcrByte);
+static void spi_processRxByte(uint8_t byte);
+static void spi_LcdFlush(void);
+int spi_PutPktCmd(uint8_t cmdNum, uint8_t* parms, int16_t nparms, uint8_t* data, uint8_t ndata);
 
 // ----
 // Data
@@ -120,6 +144,15 @@ void spi_Config(void)
     // init interrupts
     SPI2BUF = 0;                // clear
 
+    // Timer4 paces the transmitter
+    T4CONbits.TON   = 0;        // Disable Timer4
+    T4CONbits.TCS   = 0;        // Internal clock (Tcy)
+    T4CONbits.TGATE = 0;        // Disable Gated Timer mode
+    T4CONbits.T32   = 0;        // 16 bit; not paired with Timer5
+    T4CONbits.TCKPS = 0b01;     // 1:8 --> (40/8) 5.000 MHz clock
+    TMR4 = 0;
+    PR4  = SPI_T4_PERIOD;
+
 #endif // WIN32
 }
 
@@ -131,16 +164,117 @@ void spi_Start(void)
     //  The SPIxBUF must be read before new data is completely shifted in
     rx_data = SPI2BUF;          // Read byte from buffer to make it empty/ready
     SPI2STATbits.SPIROV = 0;    // Clear the Buffer Overflow flag
+    IFS2bits.SPI2IF = 0;        // Clear SPI2 Interrupt Flag
+    IEC2bits.SPI2IE = 1;        // Enable Interrupts for SPI2; a byte has been exchanged
     SPI2STATbits.SPIEN  = 1;    // Enable the SPI module
+
+    IFS1bits.T4IF = 0;          // Clear Timer4 Interrupt Flag
+    IEC1bits.T4IE = 1;          // Enable Interrupts for Timer4
+    T4CONbits.TON = 1;          // turn on Timer4
 }
 
 //-----------------------------------------------------------------------------
 void spi_Stop(void)
 {
+    T4CONbits.TON = 0;          // turn off Timer4
+    IEC1bits.T4IE = 0;          // Disable Interrupts for Timer4
+    IEC2bits.SPI2IE = 0;        // Disable Interrupts for SPI2
     SPI2STATbits.SPIROV = 0;    // Clear the Buffer Overflow flag
     SPI2STATbits.SPIEN  = 0;    // Disable the SPI module
 }
 
+//-----------------------------------------------------------------------------
+// returns number of received bytes lost since spi_Config()
+uint16_t spi_GetRxOverruns(void)
+{
+    return(g_spi.RxOverruns);
+}
+
+//-----------------------------------------------------------------------------
+//  Timer4 interrupt; send the next byte or a keep-alive
+//-----------------------------------------------------------------------------
+
+void __attribute__((interrupt, no_auto_psv)) _T4Interrupt(void)
+{
+    IFS1bits.T4IF = 0;  // end-of-interrupt
+
+    // previous byte still shifting out
+    if (SPI2STATbits.SPITBF) return;
+
+    if (IS_TXBUF_EMPTY())
+    {
+        // nothing to send; send periodically to keep receiver running
+        g_spi.EmptyTxCnts++;
+        if (g_spi.EmptyTxCnts > EMPTY_TX_THRESHOLD)
+        {
+            // send legacy sync byte to keep receiver running
+            g_spi.EmptyTxCnts = 0;
+            SPI2BUF = SPI_LEGACY_SYNC_BYTE;
+        }
+        return;
+    }
+
+    // data is in circular transmit buffer; send one byte
+    SPI2BUF = g_spi.TxBuf[g_spi.TxTakeOut];
+    g_spi.TxTakeOut = (g_spi.TxTakeOut+1 >= SPI_TX_BUF_LEN) ? 0 : g_spi.TxTakeOut+1;
+    g_spi.EmptyTxCnts = 0;
+}
+
+//-----------------------------------------------------------------------------
+//  SPI2 interrupt; a byte has been exchanged with the remote
+//-----------------------------------------------------------------------------
+
+void __attribute__((interrupt, no_auto_psv)) _SPI2Interrupt(void)
+{
+    uint8_t  byte, gotbyte = 0;
+    uint16_t next;
+
+    IFS2bits.SPI2IF = 0;  // end-of-interrupt
+
+    if (SPI2STATbits.SPIROV)
+    {
+        // byte overflow; data is trash
+        SPI2STATbits.SPIROV = 0;
+        byte = SPI2BUF;
+        g_spi.RxOverruns++;
+        return;
+    }
+    byte = (uint8_t)SPI2BUF;
+
+    switch(g_spi.SyncWordState)
+    {
+    default:
+    case 0: // first byte of word
+        switch (byte)
+        {
+        default:
+            if (IS_POSSIBLE_LEGACY_BCR(byte)) gotbyte = 1;
+            break;
+        case SPI_TXWORD_SYNC_BYTE:  // transmit word; sync byte received; wait for data byte
+            g_spi.SyncWordState = 1;
+            break;
+        case SPI_RMT2_IDLE_BYTE:    // ignore idle bytes
+            break;
+        } // switch byte
+        break;
+    case 1: // second byte of word transfer
+        gotbyte = 1;
+        g_spi.SyncWordState = 0;
+        break;
+    } // switch sync word state
+    if (!gotbyte) return;
+
+    next = (g_spi.RxPutIn+1 >= SPI_RX_BUF_LEN) ? 0 : g_spi.RxPutIn+1;
+    if (next == g_spi.RxTakeOut)
+    {
+        // task has fallen a whole buffer behind
+        g_spi.RxOverruns++;
+        return;
+    }
+    g_spi.RxBuf[g_spi.RxPutIn] = byte;
+    g_spi.RxPutIn = next;   // last; releases the byte to the task
+}
+
 //-----------------------------------------------------------------------------
 // return number of bytes available in transmit buffer
 int16_t spi_TxFreeSpace()
@@ -185,12 +319,14 @@ int spi_PutBuf(uint8_t* data, int16_t ndata)
 
 //-----------------------------------------------------------------------------
 // put Lcd message to spi transmitter buffer using legacy protocol
-// returns: 0=ok, 1=no room
+// the frame goes out when it differs from the last one sent, no sooner than
+// SPI_LCD_MIN_MSEC after it; TASK_spi_Driver sends one held back
+// returns: 0=ok
 int spi_PutLcdMsg(uint8_t* data, int16_t ndata, uint8_t lcd_red, uint8_t lcd_exit)
 {
-    uint8_t pkt[SPI_LEGACY_PKT_BYTES];
+    uint8_t* pkt = g_spi.LcdFrame;
 
-    // build the packet
+    // build the frame
     // load the ASCII message
     if (ndata>SPI_LEGACY_MSG_LEN) ndata = SPI_LEGACY_MSG_LEN;
     memcpy(pkt,data,ndata);
@@ -219,12 +355,54 @@ int spi_PutLcdMsg(uint8_t* data, int16_t ndata, uint8_t lcd_red, uint8_t lcd_exi
         //   (unsigned)chg_mode, (unsigned)pkt[LCD_CHG_BIT_INDEX ]);
     }
 
-    // load checksum
-    pkt[SPI_LEGACY_MSG_LEN] = spi_CalcChecksum(pkt,SPI_LEGACY_MSG_LEN);
-    // load sync byte
-    pkt[SPI_LEGACY_MSG_LEN+1] = SPI_LEGACY_SYNC_BYTE;
+    g_spi.LcdPending = (memcmp(g_spi.LcdFrame, g_spi.LcdShadow, SPI_LEGACY_MSG_LEN) != 0) ? 1 : 0;
+    spi_LcdFlush();
+    return(0);
+}
+
+//-----------------------------------------------------------------------------
+// send the LCD frame if it changed or the keep-alive is due
+// a remote that takes SPI_CMD_LCD_REGION gets only the changed characters
+// between keep-alives
+static void spi_LcdFlush(void)
+{
+    uint8_t  pkt[SPI_LEGACY_PKT_BYTES];
+    uint8_t  parms[SPI_NPARMS];
+    uint8_t  first, last, n, ndata;
+    uint8_t  isKeepAlive;
 
-    return(spi_PutBuf(pkt, SPI_LEGACY_PKT_BYTES));
+    isKeepAlive = (!g_spi.LcdSent || IsTimedOut(SPI_LCD_KEEPALIVE_MSEC, g_spi.LcdSentTicks)) ? 1 : 0;
+    if (!g_spi.LcdPending && !isKeepAlive) return;
+    if (g_spi.LcdSent && !IsTimedOut(SPI_LCD_MIN_MSEC, g_spi.LcdSentTicks)) return;   // rate limit
+
+    if (IsRmtEnhanced() && (g_spi.rmtCaps & SPI_RMT_CAP_LCD_REGION) && !isKeepAlive)
+    {
+        // changed region only
+        for (first=0; g_spi.LcdFrame[first] == g_spi.LcdShadow[first]; first++) ;
+        for (last=SPI_LEGACY_MSG_LEN-1; g_spi.LcdFrame[last] == g_spi.LcdShadow[last]; last--) ;
+        n = last - first + 1;
+        ndata = (n > SPI_NPARMS-2) ? n-(SPI_NPARMS-2) : 0;   // characters past those in parms[]
+        memset(parms, 0, sizeof(parms));
+        parms[0] = first;
+        parms[1] = n;
+        memcpy(&parms[2], &g_spi.LcdFrame[first], n-ndata);
+        if (spi_PutPktCmd(SPI_CMD_LCD_REGION, parms, SPI_NPARMS, &g_spi.LcdFrame[first+n-ndata], ndata)) return;  // no room; try again
+    }
+    else
+    {
+        // full legacy packet
+        memcpy(pkt, g_spi.LcdFrame, SPI_LEGACY_MSG_LEN);
+        // load checksum
+        pkt[SPI_LEGACY_MSG_LEN] = spi_CalcChecksum(pkt,SPI_LEGACY_MSG_LEN);
+        // load sync byte
+        pkt[SPI_LEGACY_MSG_LEN+1] = SPI_LEGACY_SYNC_BYTE;
+        if (spi_PutBuf(pkt, SPI_LEGACY_PKT_BYTES)) return;  // no room; try again
+    }
+
+    memcpy(g_spi.LcdShadow, g_spi.LcdFrame, SPI_LEGACY_MSG_LEN);
+    g_spi.LcdPending   = 0;
+    g_spi.LcdSent      = 1;
+    g_spi.LcdSentTicks = GetSysTicks();
 }
 
 //-----------------------------------------------------------------------------
@@ -288,6 +466,7 @@ int spi_PutPktCmd(uint8_t cmdNum, uint8_t* parms, int16_t nparms, uint8_t* data,
 
 //-----------------------------------------------------------------------------
 // calculate checksum by summing bytes
+// the remote display checks this same sum, so it stays a sum; see crc.h
 uint8_t spi_CalcChecksum(uint8_t* buf, uint16_t nbytes)
 {
     uint8_t cs = 0;
@@ -312,118 +491,49 @@ void spi_ClearHandshake()
 {
     g_spi.handshakeCnt  = 0;
     g_spi.handshakeDone = 0;
+    g_spi.rmtCaps       = 0;    // the remote may have been swapped
     LOG(SS_UI, SV_INFO, "Start LCD handshake");
 }
 
 //-----------------------------------------------------------------------------
 //  spi_Driver()
 //-----------------------------------------------------------------------------
-//  spi_Driver is called repeatedly to transmit data.
+//  spi_Driver runs the packet protocol on the bytes the SPI2 interrupt has
+//  received. The bytes themselves move under interrupt (see top of file).
 //
-//	2015-12-17 - The SPI Driver task is scheduled each 1-millisecond. Attempts
-//	were made to use interrupts and DMA, for faster transfer times. However, 
-//	it was determined that increasing the data rates overwhelmed the display.
-//	
-//	It was also noticed that at 1-millisecond per character, there are problems 
-//	with display stability.  Therefore, after a delay was implemented after 
-//	each message has been transmitted, to allow the display time to process 
-//	the data.
+//	2015-12-17 - Attempts were made to use interrupts and DMA, for faster 
+//	transfer times. However, it was determined that increasing the data rates
+//	overwhelmed the display. It was also noticed that at 1-millisecond per 
+//	character, there are problems with display stability. Timer4 therefore
+//	keeps the one byte per millisecond pace, and no longer stretches it
+//	whenever the main loop runs long.
 //
-//  spi_Driver uses double-buffering, so that the data will not change while 
-//  transmitting.  Data is copied from the global buffer '_LcdBuf' to the local
-//  private buffer 'buf' before transmission starts.
-//  Application code should call spi_PutBuf to load the global buffer.
+//  Application code should call spi_PutBuf to load the transmit buffer.
 //-----------------------------------------------------------------------------
 
-#define EMPTY_TX_THRESHOLD   (10)  // transmit sync byte if idle this long
-
 void TASK_spi_Driver(void)
 {
-    uint8_t  byte,cs,validPacket=0, gotbyte;
-    uint16_t index;
-
-    // ----------------------
-    // drive the transmitter
-    // ----------------------
-
-    if (SPI2STATbits.SPIROV)
-    {
-        // byte overflow; data is trash
-        SPI2STATbits.SPIROV = 0;
-        byte = SPI2BUF;
-     // LOG(SS_UI, SV_ERR, "SPI RxOverflow Byte=%02X", byte);
-    }
-    else if (SPI2STATbits.SPIRBF)
-    {
-        gotbyte=0;
-        byte = (uint8_t)SPI2BUF;
-     // LOG(SS_UI, SV_INFO, "RxRawByte=%02X", byte);
-        switch(g_spi.SyncWordState)
-        {
-        default:
-        case 0: // first byte of word
-            switch (byte)
-            {
-            default:
-                if (IS_POSSIBLE_LEGACY_BCR(byte)) gotbyte = 1;
-                break;
-            case SPI_TXWORD_SYNC_BYTE:  // transmit word; sync byte received; wait for data byte
-                g_spi.SyncWordState = 1;
-                break;
-            case SPI_RMT2_IDLE_BYTE:    // ignore idle bytes
-                break;
-            } // switch byte
-            break;
-        case 1: // second byte of word transfer
-            gotbyte = 1;
-            g_spi.SyncWordState = 0;
-            break;
-        } // switch sync word state
-        if (gotbyte)
-        {
-            g_spi.RxBuf[g_spi.RxPutIn] = byte;
-            g_spi.RxPutIn++;  // advance pointer
-            if (g_spi.RxPutIn >= SPI_RX_BUF_LEN) g_spi.RxPutIn = 0; // wrap
-         // LOG(SS_UI, SV_INFO, "RxCookedByte=%02X", (unsigned)byte);
-        }
-    }
+    uint8_t byte;
 
-    // check if SPI transmitter hardware is ready
-    if (!SPI2STATbits.SPITBF)
+    // take every byte received since the last pass
+    while (!IS_RXBUF_EMPTY())
     {
-        // SPI transmitter hardware is ready
-        if (IS_TXBUF_EMPTY())
-        {
-            // nothing to send; send periodically to keep receiver running
-            g_spi.EmptyTxCnts++;
-            if (g_spi.EmptyTxCnts > EMPTY_TX_THRESHOLD)
-            {
-                // send legacy sync byte to keep receiver running
-                g_spi.EmptyTxCnts = 0;
-                SPI2BUF = SPI_LEGACY_SYNC_BYTE;
-            }
-        }
-        else
-        {
-            // data is in circular transmit buffer; send one byte
-            SPI2BUF = g_spi.TxBuf[g_spi.TxTakeOut];
-            g_spi.TxTakeOut++;
-            if (g_spi.TxTakeOut >= SPI_TX_BUF_LEN) g_spi.TxTakeOut = 0; // wrap
-            g_spi.EmptyTxCnts = 0;
-        }
+        byte = g_spi.RxBuf[g_spi.RxTakeOut];
+        g_spi.RxTakeOut = (g_spi.RxTakeOut+1 >= SPI_RX_BUF_LEN) ? 0 : g_spi.RxTakeOut+1;
+        spi_processRxByte(byte);
     }
 
-    // -------------------
-    // drive the receiver
-    // -------------------
+    // LCD frame held back by the rate limit, or the keep-alive
+    if (g_spi.LcdSent) spi_LcdFlush();
+}
 
-    // check for any bytes in receiver
-    if (IS_RXBUF_EMPTY()) return; // no data
+//-----------------------------------------------------------------------------
+// run the packet protocol on one received byte
+static void spi_processRxByte(uint8_t byte)
+{
+    uint8_t  cs, validPacket=0;
+    uint16_t index;
 
-    // retrieve a byte from the receiver
-    byte = g_spi.RxBuf[g_spi.RxTakeOut];
-    g_spi.RxTakeOut++;
-    if (g_spi.RxTakeOut >= SPI_RX_BUF_LEN) g_spi.RxTakeOut = 0; // wrap
     g_spi.RxCmd[g_spi.RxCmdBytes] = byte; // save in command buffer
     g_spi.RxCmdBytes++;
 
@@ -461,6 +571,11 @@ void TASK_spi_Driver(void)
             break;
         }
         g_spi.RxCmdBytesNeeded = SPI_HDR_BYTES + g_spi.RxCmd[SPI_NDATA_OFFSET] + 1;
+        if (g_spi.RxCmdBytesNeeded > SPI_MAX_PKT_LEN)
+        {
+            LOG(SS_UI, SV_ERR, "SPI PKT TOO LONG ndata=%u", (unsigned)g_spi.RxCmd[SPI_NDATA_OFFSET]);
+            g_spi.RxCmdBytes = 0; // reset counter; would overrun RxCmd[]
+        }
         break;
 
     default:
@@ -472,12 +587,12 @@ void TASK_spi_Driver(void)
         if (g_spi.RxCmdBytes < SPI_HDR_BYTES) break;  // need to have at least a full header
         if (g_spi.RxCmdBytes < g_spi.RxCmdBytesNeeded) break; // data payload
         // payload packet
-        cs = spi_CalcChecksum((uint8_t*)&g_spi.RxBuf[SPI_HDR_BYTES], g_spi.RxCmd[SPI_NDATA_OFFSET]);
+        cs = spi_CalcChecksum(&g_spi.RxCmd[SPI_HDR_BYTES], g_spi.RxCmd[SPI_NDATA_OFFSET]);
         index = SPI_HDR_BYTES + g_spi.RxCmd[SPI_NDATA_OFFSET];  // offset to payload checksum
-        if (cs != g_spi.RxBuf[index])
+        if (cs != g_spi.RxCmd[index])
         {
             // bad payload checksum
-            LOG(SS_UI, SV_INFO, "SPI PAYLOAD CS FAILED calc=%02X rx=%02X", cs, g_spi.RxBuf[index]);
+            LOG(SS_UI, SV_INFO, "SPI PAYLOAD CS FAILED calc=%02X rx=%02X", cs, g_spi.RxCmd[index]);
             g_spi.RxCmdBytes = 0; // reset counter
             break;
         }
@@ -551,6 +666,7 @@ static void spi_processBcrByte(uint8_t bcrByte)
             {
                 g_spi.isRmtEnhanced = 0;
                 g_spi.handshakeDone = 1;
+                g_spi.rmtCaps       = 0;
                 LOG(SS_UI, SV_INFO, "Legacy Remote LCD detected");
             }
         }
@@ -605,6 +721,14 @@ static void spi_processRxPktCmd(SPI_HDR* hdr, uint8_t* indata)
         LOG(SS_SYS, SV_INFO, "SPI %s Inverter", hdr->parms[0]?"Enable":"Disable");
         break;
 
+    case SPI_CMD_REMOTE_CAPS:
+        if (g_spi.rmtCaps != hdr->parms[0])
+        {
+            LOG(SS_UI, SV_INFO, "Remote LCD caps=%02X", (unsigned)hdr->parms[0]);
+        }
+        g_spi.rmtCaps = hdr->parms[0];
+        break;
+
     } // switch
 }
 
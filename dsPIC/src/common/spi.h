@@ -32,6 +32,10 @@
 #define SPI_LEGACY_PKT_BYTES   (34)    // #bytes including sync byte
 // checksum is the sum of 32 ASCII characters
 
+// frames are only sent when they change (SPI_CMD_LCD_REGION to a remote that supports it)
+#define SPI_LCD_MIN_MSEC       (50)    // least time between frames; a packet takes 34 msec to send
+#define SPI_LCD_KEEPALIVE_MSEC (500)   // resend the full frame at least this often
+
 // offset into LcdBuf; top bits are turned on as indicators
 #define LCD_HANDSHAKE_BIT_INDEX   (15)  // indicates to the LCD that the device is enhanced    
 #define LCD_INV_BIT_INDEX         (28)  // indicates invertering
@@ -161,6 +165,20 @@ STRUCT_SIZE_CHECK(SPI_HDR, 13);
    // parm[6]=0
    // parm[7]=0
 
+#define SPI_CMD_REMOTE_CAPS     (0x06) // remote tells what it supports beyond the base protocol
+   // ndata = 0
+   // parm[0]=SPI_RMT_CAP_xxx bits
+   // parm[1]=0
+   // parm[2]=0
+   // parm[3]=0
+   // parm[4]=0
+   // parm[5]=0
+   // parm[6]=0
+   // parm[7]=0
+   // remotes that do not send it get only full legacy frames
+
+#define SPI_RMT_CAP_LCD_REGION  0x01   // takes SPI_CMD_LCD_REGION
+
 // ----------------------
 // Device to LCD Packets
 // ----------------------
@@ -186,6 +204,19 @@ STRUCT_SIZE_CHECK(SPI_HDR, 13);
    // parm[6]=  * * *
    // parm[7]=value MSB
 
+#define SPI_CMD_LCD_REGION      0x83 // update part of the LCD frame (SPI_RMT_CAP_LCD_REGION)
+   // ndata = count-6 when count > 6; characters after the first six
+   // parm[0]=first character index in the 32 character frame
+   // parm[1]=count; number of characters
+   // parm[2]=first character
+   // parm[3]=  * * *
+   // parm[4]=  * * *
+   // parm[5]=  * * *
+   // parm[6]=  * * *
+   // parm[7]=sixth character (0 if count < 6)
+   // characters carry the indicator bits the same as the legacy packet
+   // the full legacy packet is still sent at the keep-alive interval
+
 // longest SPI message to expect or send
 #define SPI_MAX_PKT_LEN   (60)   // sizeof(SPI_HDR) + SENFLD_MAX_BYTES  // 13 + 41 = 54
 
@@ -201,6 +232,7 @@ int     spi_PutBuf(uint8_t* buf, int16_t len);
 int     spi_PutLcdMsg(uint8_t* data, int16_t ndata, uint8_t led_red, uint8_t lcd_exit);
 void    spi_TxByte(uint8_t tx_byte);
 uint8_t spi_CalcChecksum(uint8_t* buf, uint16_t nbytes);
+uint16_t spi_GetRxOverruns(void);
 void    TASK_spi_Driver(void);
 
 
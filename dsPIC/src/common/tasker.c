@@ -14,6 +14,7 @@
 #include "tasker.h"
 #include "dsPIC33_CAN.h"
 #include "dspic_serial.h"
+#include "evlog.h"
 
 // ---------------------------
 // Conditional Debug Compiles
@@ -250,6 +251,7 @@ void task_Execute(void)
         // clear to allow new trap to hit
         g_trapErr     = 0;  // clear trap flag
         g_trapErrLoc  = 0;  // clear trap address
+        evlog_Add(EVT_TRAP, (uint8_t)g_trapLast);
         switch (g_trapLast)
         {
         default:
@@ -0,0 +1,134 @@
+// <><><><><><><><><><><><><> telemetry.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  High-rate telemetry streaming over CAN (see telemetry.h)
+//
+//  Replaces signal_capture.c for in-field use: no debugger is needed.
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "telemetry.h"
+#include "dsPIC33_CAN.h"
+#include "J1939.h"
+#include "sensata_can.h"
+
+// ------------
+// global data
+// ------------
+TELEMETRY_t g_tlm = { 0 };
+
+// ------------------------------------------------------------------------------------
+// start streaming the signals in mask; every decimation pwm interrupts
+void tlm_Start(uint8_t mask, uint16_t decimation)
+{
+    uint8_t n = 0;
+    uint8_t bits;
+
+    tlm_Stop();
+    if (mask == 0) return;
+    if (decimation == 0) decimation = 1;
+
+    for (bits = mask & 0x7F; bits; bits >>= 1) n += (bits & 1);
+
+    g_tlm.nsig       = n;
+    g_tlm.decimation = decimation;
+    g_tlm.decCount   = decimation;
+    g_tlm.fillBuf    = 0;
+    g_tlm.fill       = 0;
+    g_tlm.overruns   = 0;
+    g_tlm.sendLen    = 0;
+    g_tlm.sendIdx    = 0;
+    g_tlm.mask       = mask & 0x7F;   // last; arms the pwm interrupt
+
+    LOG(SS_CAN, SV_INFO, "Telemetry start mask=%02X decimation=%u", (int)g_tlm.mask, decimation);
+}
+
+// ------------------------------------------------------------------------------------
+void tlm_Stop(void)
+{
+    if (g_tlm.mask) LOG(SS_CAN, SV_INFO, "Telemetry stop overruns=%u", g_tlm.overruns);
+    g_tlm.mask    = 0;    // first; disarms the pwm interrupt
+    g_tlm.sendLen = 0;
+}
+
+// ------------------------------------------------------------------------------------
+// store one sample of the selected signals; called from the pwm interrupt
+void _tlm_Store(void)
+{
+    int16_t* p = &g_tlm.buf[g_tlm.fillBuf][g_tlm.fill];
+    uint8_t  mask = g_tlm.mask;
+
+    if (mask & TLM_SIG_VAC)   *p++ = VacRaw();
+    if (mask & TLM_SIG_IMEAS) *p++ = IMeasRaw();
+    if (mask & TLM_SIG_VBATT) *p++ = VBattRaw();
+    if (mask & TLM_SIG_DUTY)  *p++ = (int16_t)PDC1 - (int16_t)PDC2;
+    if (mask & TLM_SIG_PTERM) *p++ = g_tlm.pterm;
+    if (mask & TLM_SIG_ITERM) *p++ = g_tlm.iterm;
+    if (mask & TLM_SIG_DTERM) *p++ = g_tlm.dterm;
+    g_tlm.fill += g_tlm.nsig;
+
+    // room for another sample?
+    if (g_tlm.fill + g_tlm.nsig <= TLM_BUF_WORDS) return;
+
+    if (g_tlm.sendLen)
+    {
+        // other half still going out; drop this one
+        g_tlm.overruns++;
+    }
+    else
+    {
+        // hand this half to the can task and fill the other
+        g_tlm.sendBuf = g_tlm.fillBuf;
+        g_tlm.sendSeq = g_tlm.bufSeq;
+        g_tlm.sendIdx = 0;
+        g_tlm.sendLen = g_tlm.fill;   // last; releases the half to the can task
+        g_tlm.fillBuf ^= 1;
+    }
+    g_tlm.bufSeq++;
+    g_tlm.fill = 0;
+}
+
+// ------------------------------------------------------------------------------------
+// stream a full buffer half as fast as the transmit queue takes it
+// called from the can task
+void tlm_Poll(void)
+{
+    CAN_DATA data[8];
+    int16_t* src;
+    uint8_t  i;
+
+    while (g_tlm.sendLen && can_TxQueueFree() > CAN_TX_QUEUE_SIZE - TLM_TX_DEPTH)
+    {
+        src = &g_tlm.buf[g_tlm.sendBuf][g_tlm.sendIdx];
+        data[0] = g_tlm.sendSeq;
+        data[1] = g_tlm.sendIdx;
+        for (i=0; i<3; i++)
+        {
+            if (g_tlm.sendIdx+i < g_tlm.sendLen)
+            {
+                data[2+i*2] = LOBYTE(src[i]);
+                data[3+i*2] = HIBYTE(src[i]);
+            }
+            else
+            {
+                data[2+i*2] = 0xFF;  // unused
+                data[3+i*2] = 0xFF;
+            }
+        }
+        J1939_SendMessage(SENSATA_CUSTOM_TELEMETRY_DATA_DGN, sizeof(data), data);
+
+        g_tlm.sendIdx += 3;
+        if (g_tlm.sendIdx >= g_tlm.sendLen)
+        {
+            g_tlm.sendLen = 0;  // release the half to the pwm interrupt
+        }
+    }
+}
+
+// <><><><><><><><><><><><><> telemetry.c <><><><><><><><><><><><><><><><><><><><><><>
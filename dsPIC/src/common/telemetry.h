@@ -0,0 +1,116 @@
+// <><><><><><><><><><><><><> telemetry.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  High-rate telemetry streaming over CAN
+//
+//  Selected signals are sampled from the PWM interrupt at a configurable
+//  decimation into one half of a double buffer. Each full half is streamed
+//  as Sensata proprietary frames while the PWM interrupt fills the other.
+//
+//  Start/stop:  SENSATA_CUSTOM_TELEMETRY_DGN
+//    data[0]    instance
+//    data[1]    signal mask TLM_SIG_xxx (0=stop)
+//    data[2..3] decimation; sample every N PWM interrupts (lsb first, min 1)
+//
+//  Stream:      SENSATA_CUSTOM_TELEMETRY_DATA_DGN
+//    data[0]    buffer sequence number; a gap means a buffer was lost (overrun)
+//    data[1]    word index in the buffer of data[2]; a gap means a frame was lost
+//    data[2..7] 3 x int16 (lsb first); samples are the selected signals in mask bit order
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _TELEMETRY_H_    // include only once
+#define _TELEMETRY_H_
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+
+// -------------------
+// signal mask bits
+// -------------------
+#define TLM_SIG_VAC      0x01   // VacRaw()
+#define TLM_SIG_IMEAS    0x02   // IMeasRaw()
+#define TLM_SIG_VBATT    0x04   // VBattRaw()
+#define TLM_SIG_DUTY     0x08   // PWM duty; + PDC1, - PDC2
+#define TLM_SIG_PTERM    0x10   // voltage loop proportional term
+#define TLM_SIG_ITERM    0x20   // voltage loop integral     term
+#define TLM_SIG_DTERM    0x40   // voltage loop differential term
+
+#define TLM_BUF_WORDS    (63)   // words per buffer half; multiple of 3 fills whole frames
+#define TLM_TX_DEPTH     (8)    // most frames kept queued; other traffic waits at most this many
+
+// ---------------
+// telemetry state
+// ---------------
+#pragma pack(1)  // structure packing on byte alignment
+typedef struct
+{
+    // settings
+    volatile uint8_t  mask;         // TLM_SIG_xxx; 0=off
+    uint8_t           nsig;         // number of signals in mask
+    uint16_t          decimation;   // pwm interrupts per sample
+
+    // control loop terms published by the inverter pwm interrupt
+    int16_t           pterm;
+    int16_t           iterm;
+    int16_t           dterm;
+
+    // filled by pwm interrupt
+    uint16_t          decCount;     // counts down to next sample
+    uint8_t           fillBuf;      // buffer half being filled
+    uint8_t           fill;         // words filled
+    uint8_t           bufSeq;       // sequence number of the buffer being filled
+    uint16_t          overruns;     // buffers dropped; previous one still sending
+
+    // handed to the can task
+    volatile uint8_t  sendLen;      // words to send from sendBuf; 0=nothing ready
+    uint8_t           sendBuf;      // buffer half being sent
+    uint8_t           sendSeq;      // its sequence number
+    uint8_t           sendIdx;      // next word to send
+
+    int16_t           buf[2][TLM_BUF_WORDS];
+} TELEMETRY_t;
+#pragma pack()  // restore packing setting
+
+// -----------------
+// access global data
+// -----------------
+extern TELEMETRY_t g_tlm;
+
+// --------------------
+// Function Prototyping
+// --------------------
+void tlm_Start(uint8_t mask, uint16_t decimation);
+void tlm_Stop(void);
+void tlm_Poll(void);
+void _tlm_Store(void);
+
+// --------------------------
+// Inline Functions for Speed
+// --------------------------
+
+// publish the voltage loop terms; called from the inverter pwm interrupt
+INLINE void tlm_SetLoopTerms(int16_t pterm, int16_t iterm, int16_t dterm)
+{
+    g_tlm.pterm = pterm;
+    g_tlm.iterm = iterm;
+    g_tlm.dterm = dterm;
+}
+
+// take a sample when due; called from the pwm interrupt
+INLINE void tlm_Sample(void)
+{
+    if (g_tlm.mask == 0) return;
+    if (--g_tlm.decCount != 0) return;
+    g_tlm.decCount = g_tlm.decimation;
+    _tlm_Store();
+}
+
+#endif  //  _TELEMETRY_H_
+
+// <><><><><><><><><><><><><> telemetry.h <><><><><><><><><><><><><><><><><><><><><><>
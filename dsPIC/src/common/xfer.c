@@ -0,0 +1,139 @@
+// <><><><><><><><><><><><><> xfer.c <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Phase synchronized transfer between the a/c line and the inverter
+//  (see xfer.h)
+//
+//-----------------------------------------------------------------------------
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "inverter.h"
+#include "pll.h"
+#include "xfer.h"
+
+#ifdef __linux__
+ #include "xfer_sim.h"  // host: inverter stand-in
+ #define XFER_SET_TRIM(mhz)     xsim_SetFreqTrim(mhz)
+ #define XFER_OUTPUT_DDS()      xsim_OutputDds()
+#else
+ #define XFER_SET_TRIM(mhz)     inv_SetFreqTrim(mhz)
+ #define XFER_OUTPUT_DDS()      inv_OutputDds()
+#endif
+
+// line phase error in step
+#define XFER_SYNC_ERR           ((int16_t)(XFER_SYNC_ERR_DEG * PLL_LINE_ERR_DEG))
+
+// loop filter integral limit; mHz x 256
+#define XFER_INTEG_MAX          ((int32_t)INV_FREQ_TRIM_MAX_MHZ << 8)
+
+// ----------
+// local data
+// ----------
+static int32_t  s_integ;        // loop filter integral; mHz x 256
+static int16_t  s_msec;         // since xfer_SyncStart()
+static int16_t  s_edgeMsec;     // since the last line phase edge
+static uint8_t  s_edges;        // g_pll.lineEdges last seen
+static uint8_t  s_inStep;       // line cycles in a row within XFER_SYNC_ERR
+
+
+//-----------------------------------------------------------------------------
+//  xfer_SyncStart()
+//-----------------------------------------------------------------------------
+//  Starts pulling the inverter output into step with the line.
+//-----------------------------------------------------------------------------
+
+void xfer_SyncStart(void)
+{
+    LOG(SS_SYS, SV_INFO, "xfer_SyncStart()");
+
+    pll_SetLineRef(XFER_OUTPUT_DDS());  // line phase against the output
+    s_integ    = 0;
+    s_msec     = 0;
+    s_edgeMsec = 0;
+    s_edges    = g_pll.lineEdges;
+    s_inStep   = 0;
+}
+
+//-----------------------------------------------------------------------------
+//  xfer_SyncPoll()
+//-----------------------------------------------------------------------------
+//  Call every msec after xfer_SyncStart(). Returns XFER_SYNC_DONE when the
+//  output has been in step with the line for XFER_SYNC_CYCLES; the frequency
+//  trim is left as it is, so it stays in step while the relay closes.
+//  Returns XFER_SYNC_FAIL on a time out or when the line phase edges stop.
+//-----------------------------------------------------------------------------
+
+int8_t xfer_SyncPoll(void)
+{
+    uint8_t saved_ipl;
+    uint8_t edges;
+    int16_t err;
+    int32_t trim;
+
+    if (++s_msec >= XFER_SYNC_TIMEOUT_MSEC)
+    {
+        LOG(SS_SYS, SV_INFO, "xfer: line not in step, err=%d", g_pll.lineErr);
+        return(XFER_SYNC_FAIL);
+    }
+
+    SET_AND_SAVE_CPU_IPL(saved_ipl, 7); //  Start of Protected Code
+    edges = g_pll.lineEdges;
+    err   = g_pll.lineErr;
+    RESTORE_CPU_IPL(saved_ipl); //  End of Protected Code
+
+    if (edges == s_edges)
+    {
+        if (++s_edgeMsec >= XFER_SYNC_EDGE_MSEC)
+        {
+            LOG(SS_SYS, SV_INFO, "xfer: no line phase");
+            return(XFER_SYNC_FAIL);
+        }
+        return(XFER_SYNC_BUSY);
+    }
+    s_edges    = edges;
+    s_edgeMsec = 0;
+
+    // once a line cycle; the integral ends up as the line frequency offset
+    s_integ += (int32_t)XFER_SYNC_KI * err;
+    if (s_integ >  XFER_INTEG_MAX) s_integ =  XFER_INTEG_MAX;
+    if (s_integ < -XFER_INTEG_MAX) s_integ = -XFER_INTEG_MAX;
+
+    trim = (s_integ + (int32_t)XFER_SYNC_KP * err) >> 8;
+    if (trim >  INV_FREQ_TRIM_MAX_MHZ) trim =  INV_FREQ_TRIM_MAX_MHZ;
+    if (trim < -INV_FREQ_TRIM_MAX_MHZ) trim = -INV_FREQ_TRIM_MAX_MHZ;
+    XFER_SET_TRIM((int16_t)trim);
+
+    if ((err <= XFER_SYNC_ERR) && (err >= -XFER_SYNC_ERR))
+    {
+        if (++s_inStep >= XFER_SYNC_CYCLES)
+        {
+            LOG(SS_SYS, SV_INFO, "xfer: in step, %d msec, trim=%ld mHz", s_msec, (long)trim);
+            return(XFER_SYNC_DONE);
+        }
+    }
+    else
+    {
+        s_inStep = 0;
+    }
+    return(XFER_SYNC_BUSY);
+}
+
+//-----------------------------------------------------------------------------
+//  xfer_SyncStop()
+//-----------------------------------------------------------------------------
+//  Back to the nominal output frequency; the line phase is timed against
+//  the PLL again.
+//-----------------------------------------------------------------------------
+
+void xfer_SyncStop(void)
+{
+    XFER_SET_TRIM(0);
+    pll_SetLineRef(NULL);
+}
+
+// <><><><><><><><><><><><><> xfer.c <><><><><><><><><><><><><><><><><><><><><><>
@@ -0,0 +1,101 @@
+// <><><><><><><><><><><><><> xfer.h <><><><><><><><><><><><><><><><><><><><><><>
+//-----------------------------------------------------------------------------
+//  Copyright(C) 2018 - Sensata Technologies, Inc.  All rights reserved.
+//-----------------------------------------------------------------------------
+//
+//  Phase synchronized transfer between the a/c line and the inverter
+//
+//  Enabled by Device.config.fast_xfer_enabled. The main control state
+//  machine (task_main.c) does the sequencing; this holds the parts that
+//  look at the PLL (see pll.h), so the host simulator (xfer_sim.h) runs them.
+//
+//  Line to inverter:  the PLL tracks the line while the transfer relay is
+//    closed. When it reports a dropout the charger stops, the relay is
+//    turned off and after XFER_RELAY_OPEN_DELAY_MSEC the inverter starts at
+//    the PLL phase, with no soft start. Its amplitude starts at the line's
+//    last amplitude (xfer_LineAmp()) and moves to the output setpoint over a
+//    few cycles. RELAY_OPEN_DELAY_MSEC allows for the contacts breaking load
+//    current, which arcs to the next current zero; with the line gone they
+//    carry none, so the bridge is driven once they have parted, before the
+//    full open delay. If they are still closed onto a line side that loads
+//    the output, the overload limit holds the current. The output is dead
+//    for the dropout detection and the parting: ~10.5 msec, 13 at most,
+//    under a cycle (host check "xfer"). The delay is the relay's release time with
+//    margin; ### to be confirmed on a unit with the contacts on a scope.
+//
+//  Inverter to line:  needs the line phase input (PLL_HAS_LINE_PHASE). Once
+//    a line cycle, xfer_SyncPoll() trims the inverter frequency by a PI on
+//    the line phase ahead of the output; after XFER_SYNC_CYCLES cycles in a
+//    row within XFER_SYNC_ERR_DEG the relay closes onto the line and the
+//    inverter stops once it is closed. The line phase is timed against the
+//    inverter output only between xfer_SyncStart() and xfer_SyncStop().
+//    Without the input (the LPC board has none), or if the line does not
+//    come into step by XFER_SYNC_TIMEOUT_MSEC, the inverter soft stops
+//    first as before.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef __XFER_H    // include only once
+#define __XFER_H
+
+// -------
+// headers
+// -------
+#include "options.h"    // must be first include
+#include "analog.h"
+#include "pll.h"
+
+// ---------
+// constants
+// ---------
+#define XFER_SYNC_KP            (59)    // mHz per line error unit; x 1/256
+#define XFER_SYNC_KI            (8)     // mHz per line error unit per cycle; x 1/256
+#define XFER_SYNC_ERR_DEG       (3)     // in step
+#define XFER_SYNC_CYCLES        (6)     // line cycles in a row in step
+#define XFER_SYNC_EDGE_MSEC     (50)    // no line phase edge; line gone
+#define XFER_SYNC_TIMEOUT_MSEC  (3000)  // give up on an in phase transfer
+
+// inverter start amplitude; the line's, within these
+#define XFER_START_VRMS_MIN     (100.0)
+#define XFER_START_VRMS_MAX     (130.0)
+#define XFER_START_DECAY        (3)     // 1/8 of the way to the setpoint each cycle
+
+// mean |sample| of a line; a/d counts
+#define XFER_AMP(vrms)          ((uint16_t)(VAC_VOLTS_ADC((vrms) * 0.9003) - VAC_VOLTS_ADC(0)))
+
+// xfer_SyncPoll() results
+#define XFER_SYNC_BUSY          (0)
+#define XFER_SYNC_DONE          (1)
+#define XFER_SYNC_FAIL          (-1)
+
+// --------------------
+// Function Prototyping
+// --------------------
+extern void   xfer_SyncStart(void);
+extern int8_t xfer_SyncPoll(void);      // every msec
+extern void   xfer_SyncStop(void);
+
+// the line went away while the PLL was locked on it
+INLINE int8_t xfer_LineLost(void)   { return(g_pll.dropout); }
+
+// mean |sample| of the line before it went; for the inverter start
+INLINE uint16_t xfer_LineAmp(void)
+{
+    if (g_pll.lineAmp < XFER_AMP(XFER_START_VRMS_MIN)) return(XFER_AMP(XFER_START_VRMS_MIN));
+    if (g_pll.lineAmp > XFER_AMP(XFER_START_VRMS_MAX)) return(XFER_AMP(XFER_START_VRMS_MAX));
+    return(g_pll.lineAmp);
+}
+
+// one a/c cycle of the start amplitude going to the setpoint; 0 once small
+INLINE int16_t xfer_StartDecay(int16_t adj)
+{
+    adj -= adj / (1 << XFER_START_DECAY);
+    return(((adj < (1 << XFER_START_DECAY)) && (adj > -(1 << XFER_START_DECAY))) ? 0 : adj);
+}
+
+// an in phase transfer to the line can be tried
+INLINE int8_t xfer_CanSync(void)    { return(PLL_HAS_LINE_PHASE); }
+
+#endif  //  __XFER_H
+
+// <><><><><><><><><><><><><> xfer.h <><><><><><><><><><><><><><><><><><><><><><>
@@ -16,13 +16,22 @@
 #include "config.h"
 #include "hw.h"
 #include "fan_Ctrl.h"
+#include "hs_temp.h"
 #include "inv_check_supply.h"
 #include "inverter.h"
 #include "inverter_cmds.h"
+#include "inv_deadtime.h"
+#include "inv_harmonic.h"
+#include "inv_thermal.h"
+#include "load_sense.h"
 #include "charger.h"
+#include "duty_table.h"
+#include "pll.h"
 #include "pwm.h"
 #include "sine_table.h"
 #include "tasker.h"
+#include "telemetry.h"
+#include "xfer.h"
 #include "lpc_cfg.h"
 
 #include <stdint.h>
@@ -148,11 +157,39 @@ INLINE int16_t ScaleByVBatt(uint16_t value) // ~ 1 usec
     return((int16_t)value32);
 }
 
+//-----------------------------------------------------------------------------
+// duty table for an amplitude (multiplier) held for a half-cycle; soft start,
+// ping and soft stop (see duty_table.h)
+static void _inv_DutyFill(int16_t* duty, uint16_t key)
+{
+    int16_t i;
+
+    for (i = 0; i < MAX_SINE; i++)
+    {
+        duty[i] = (int16_t)(((uint32_t)_SineTableQ16[i] * key) >> 16);
+    }
+    duty[MAX_SINE] = 0;
+}
+
+//-----------------------------------------------------------------------------
+// PWM ISR, at a zero crossing: the table for the half-cycle starting at
+// amplitude 'now', and ask for 'next' (< 0: none) for the one after
+INLINE const int16_t* _inv_DutyTableHalf(int32_t now, int32_t next)
+{
+    if ((next >= 0) && (next <= 0xFFFF)) dtbl_Request(&_inv_DutyFill, (uint16_t)next);
+    return(((now >= 0) && (now <= 0xFFFF)) ? dtbl_Take(&_inv_DutyFill, (uint16_t)now) : 0);
+}
+
 //-----------------------------------------------------------------------------
 //  _StopRequest is a signal from inv_Stop() to TASK_inv_Driver. 
 //-----------------------------------------------------------------------------
 static int8_t _StopRequest;
 
+//-----------------------------------------------------------------------------
+//  _SyncStart is a signal from inv_StartSync() to TASK_inv_Driver. 
+//-----------------------------------------------------------------------------
+static int8_t _SyncStart = 0;
+
 //-----------------------------------------------------------------------------
 // OVERLOAD PROCESSING
 //
@@ -163,7 +200,7 @@ static int8_t _StopRequest;
 //
 //	_OvlOccurred - set within inv_CheckForOverload to indicate that an overload
 //		has occurred.  It is used/cleared by the function 
-//		_inv_ProcessOverloadCounters.
+//		_inv_ProcessOverload.
 //-----------------------------------------------------------------------------
 int8_t _OvlOccurred = 0;
 
@@ -187,6 +224,12 @@ static int16_t _IntegralSum = 0;
 static int16_t _SavedIntegralSum = 0; // save when flat topping starts, and restore when exiting flat topping
 static int32_t _RmsVacSetpointOffset = 0;
 
+//  Taking over from the line (INV_ISR_REQ_START): the duty and the setpoint
+//  start at the line's last amplitude, less what the loop gives at its own
+//  setpoint, and are taken down XFER_START_DECAY each a/c cycle (see xfer.h).
+static int16_t _XferDutyAdj = 0;
+static int16_t _XferSetpointAdj = 0;
+
 //-----------------------------------------------------------------------------
 //  U.L. Requires that we detect problems with the feedback winding, these 
 //  include:
@@ -212,6 +255,13 @@ static int16_t _FeedbackErrorCount = 0;
 static int16_t _BootChargeCycles = 0;
 
 
+//-----------------------------------------------------------------------------
+//  _InvDds generates the output sine; see sine_table.h. The step sets the
+//  output frequency: OPTION_AC_OUT_HZ, trimmed by inv_SetFreqTrim().
+//-----------------------------------------------------------------------------
+static DDS_t _InvDds = { 0, DDS_STEP_HZ(OPTION_AC_OUT_HZ) };
+
+
 //-----------------------------------------------------------------------------
 //                     D E B U G G I N G      S T A R T
 //-----------------------------------------------------------------------------
@@ -401,12 +451,12 @@ void inv_CheckForOverload(void)
 }
 
 //-----------------------------------------------------------------------------
-//  _inv_ProcessOverloadCounters
+//  _inv_ProcessOverload
 //-----------------------------------------------------------------------------
-//  Process Overload Detection Counters.  This needs to be checked once per 
-//  zero-crossing. Timing is not critical, so it is done in the foreground.
-//
-//  This is implemented as a separate function to reduce clutter.
+//  Process Overload Detection.  This needs to be checked once per a/c cycle,
+//  at the zero-crossing. Timing is not critical; the PWM ISR runs it in the
+//  PWM period after the one that ends the a/c cycle, which has the rest of
+//  the once-a-cycle work (see _inv_PwmIsr() TIMING).
 //
 //	OVERVIEW:
 //	The flag '_OvlVdsThresActive' determines what method will be used to detect 
@@ -417,131 +467,64 @@ void inv_CheckForOverload(void)
 //      imeas >= Inv.config.ovl_imeas_threshold (108%). 
 //		(imeas is the rectified, instantaneous value of iMeas).
 //
+//  How long either may last comes from the I2t thermal model (inv_thermal.h):
+//  200% is allowed once the RMS output reaches OVL_RMS_THRESHOLD, until the
+//  FET model reaches its limit, and again once it has cooled; the inverter 
+//  shuts down when the transformer model reaches its limit.
+//
 //-----------------------------------------------------------------------------
 
-void _inv_ProcessOverloadCounters(int8_t reset)
+void _inv_ProcessOverload(int8_t reset)
 {
 #if defined(OPTION_IGNORE_OVERLOAD)
     Inv.status.overload_detected = 0;
     Inv.error.overload_shutdown = 0;
     return;
 #else
-    
-    //  Timing is based on 60Hz zero-crossings.
-    #define OVL_VDS_RETRY_TIMEOUT   ((int16_t)(30 * 60))    //  30-sec  200% overload interval
-    #define OVL_VDS_TIMEOUT         ((int16_t)(1.5 * 60))   //  1.5-sec 200% overload allowed duration
-    #define OVL_IRMS_TIMEOUT        ((int16_t)(5 * 60))     //  5-sec overall overload duration
-    #define OVL_RESET_TIMEOUT       ((int16_t)(0.4 * 60))   //  ~400 mSec
-    
-    static int16_t cycle_count = 0;     //  up counter
-    static int16_t reset_count = 0;     //  up/down counter
-    static int16_t state = 0;
-    static int16_t vds_retry_count = 0; //  down counter
-    static int16_t last_state = -1;
+    static uint8_t last_fet_hot = 0;
 
     if (reset)
     {
-        LOG(SS_INV, SV_INFO, "*** _inv_ProcessOverloadCounters reset");
-        state = 0;
+        // the models keep their state; the hardware is still warm
+        LOG(SS_INV, SV_INFO, "*** _inv_ProcessOverload reset");
+        _OvlVdsThresActive = 0;
+        _OvlOccurred = 0;
         return;
     }
 
-    //  DEBUG - Start
-    if (last_state != state)
+    inv_ThermalCycle(IMeasRMS(), HeatSinkTempC());
+
+    if (last_fet_hot != g_invThermal.fetHot)
     {
-        LOG(SS_INV, SV_INFO, "*** _inv_ProcessOverloadCounters: %d --> %d", last_state, state);
-        last_state = state;
+        LOG(SS_INV, SV_INFO, "*** FET thermal limit %s: rise %d%% of %d%%", g_invThermal.fetHot ? "reached" : "clear",
+            inv_ThermalFetPct(), g_invThermal.fetLimit);
+        last_fet_hot = g_invThermal.fetHot;
     }
-    
-    if((vds_retry_count > 0) && (vds_retry_count % 60 == 0))
+
+    if (g_invThermal.fetHot)
     {
-        LOG(SS_INV, SV_INFO, "vds_retry_count: %d ", (vds_retry_count / 60));
+        //  FETs have had enough surge; switch to Iac Limiting
+        _OvlVdsThresActive = 0;
     }
-    //  DEBUG - End
-    
-    if(--vds_retry_count <= 0)
+    else if (IMeasRMS() >= (OVL_RMS_THRESHOLD))
     {
-        vds_retry_count = 0;
+        //  surge load; allow VDS (200%)
+        _OvlVdsThresActive = 1;
     }
-
-    switch (state)
+    else if (!_OvlOccurred)
     {
-    case 0:
-        //-------------------------------------------------------------------
-        //  Monitor for initial overload - allow 200% overload (based on VDS)
-        //  The flag '_OvlVdsThresActive' configures the function 
-        //  'inv_CheckForOverload' to truncate the PWM when VDS exceeds the 
-        //  threshold configured for 200% overload.
-        //-------------------------------------------------------------------
-        Inv.status.overload_detected = 0;
-        cycle_count = 0;
-        
-        if (IMeasRMS() >= (OVL_RMS_THRESHOLD))
-        {
-//            LOG(SS_INV, SV_INFO, "_inv_ProcessOverloadCounters IMeas: %d ", IMeasRMS());
-            if(0 == vds_retry_count)
-            {
-                //  If the timer is NOT running (zero) then allow VDS (200%)
-                //  else if the timer is running then remain at default (108%)
-                _OvlVdsThresActive = 1;
-            }
-            state++;
-        }
-        break;
-
-    case 1:
-        //  Limit at 200% for one-second.  (Timeout adjustable in #define above.)
-        if (++cycle_count >= (OVL_VDS_TIMEOUT))
-        {
-//            LOG(SS_INV, SV_INFO, "_inv_ProcessOverloadCounters IMeas: %d ", IMeasRMS());
-            // If we have ANY 200% overloads, then start the retry timer.
-            if(0 == vds_retry_count)
-            {
-                vds_retry_count = OVL_VDS_RETRY_TIMEOUT;
-            }
-            _OvlVdsThresActive = 0; //  switch to Iac Limiting  
-            state++;
-        }
-        break;
+        //  load is back within rating
+        _OvlVdsThresActive = 0;
+    }
 
-    case 2:
-        if ((IMeasRMS() >= (OVL_RMS_THRESHOLD)) || _OvlOccurred)
-        {
-            Inv.status.overload_detected = 1;
-            reset_count = OVL_RESET_TIMEOUT;
-            //  Allow 108% (based upon IMeas) for an additional 4-seconds 
-            //  NOTE: 'count' has already accumulated some time.
-            if (++cycle_count >= OVL_IRMS_TIMEOUT)
-            {
-                cycle_count = OVL_IRMS_TIMEOUT;     //  limit 
-                Inv.error.overload_shutdown = 1;
-                state++;
-            }
-        }
-        else
-        {
-            //  If we are below the overload threshold, then count-down and 
-            //  reset this state machine.
-            --cycle_count;
-            --reset_count;
-            if ((cycle_count <= 0) || (reset_count <= 0))
-            {
-//                LOG(SS_INV, SV_INFO, "_inv_ProcessOverloadCounters IMeas: %d ", IMeasRMS());
-                cycle_count = 0;
-                reset_count = 0;
-                Inv.status.overload_detected = 0;
-                state = 0;
-            }
-        }
-        break;
+    Inv.status.overload_detected = (g_invThermal.fetHot || 
+        (inv_ThermalXfmrPct() >= __builtin_divsd((int32_t)Inv.config.ovl_xfmr_limit * INV_TH_XFMR_WARN_PCT, 100))) ? 1 : 0;
 
-    case 3: //  Overload shutdown
+    if (g_invThermal.xfmrHot && !Inv.error.overload_shutdown)
+    {
         //  No chance of restarting after a shutdown.. unless we are reset
-        break;
-
-    default:
-        state = 0;
-        break;
+        LOG(SS_INV, SV_INFO, "*** transformer thermal limit: rise %d%%, shutdown", inv_ThermalXfmrPct());
+        Inv.error.overload_shutdown = 1;
     }
     _OvlOccurred = 0; //	Just in case
 
@@ -606,53 +589,373 @@ static DWORD_t duty_cycle_sum = { {0} };
 
 
 // ---------------------------------------------------------------------------------------------------------
-// Transformer Saturation Compensation
+// Transformer Flux Balance
 // ---------------------------------------------------------------------------------------------------------
-// handle transformer saturation from line mode to inverter mode
-//   The saturation algorithm works on every a/c cycle for a given number of cycles (30) (same as flat-topping)
-//   The detection algorithm only operates when transitioning from line mode to inverter mode
+//   Any net volt-seconds on the primary walk the core toward saturation in one polarity: the magnetizing
+//   current then peaks at the end of that half-cycle, the battery dips with it and inv_CheckForOverload()
+//   trips on the peaks. It is worst just after line to inverter, where the charger left the core biased,
+//   but a half-wave load or unequal FET drops do it too.
+//
+//   Detection (once an a/c cycle, PWM_STATE_NORMAL):
+//      - dc current: mean of IMeasRaw() over the cycle less the sensor zero, which is learnt while idle
+//        with no a/c on the sense (_IMeasZero)
+//      - battery dip: vbatt over the last quarter of each half-cycle (from VBATT_START_PHASE) is lower
+//        in the half that saturates; scaled by FLUX_VBATT_GAIN into the same units
 //
-//   Saturation Detection:
-//      monitoring battery voltage and comparing 1st half cycle against 2nd half cycle works to detect
+//   Correction:
+//      _FluxTrim (Q15 fraction of the duty) integrates the imbalance and takes duty off the half that
+//      drives the dc current, so the bias is pulled back to zero and held there as the load changes.
+//      The trim is applied after the duty is summed for the _VacOffset re-balance, so the two do not
+//      fight. The safe i_gain still covers the first cycles after a transfer while the trim builds.
 //
-//   Saturation Compensation
-//      reducing the saturated half-cycle by a percent
-//      the percent reduction is scaled by the vbatt voltage difference
+//   Sense polarity:
+//      with the sense the wrong way round the dc current term would drive the core into saturation
+//      instead of out of it, so which way IMeas goes with the drive is learnt, as inv_deadtime.h does:
+//      the real power out of the inverter is positive, so the current signed with the drive averages
+//      positive over a cycle with the right polarity. _FluxSign is set once FLUX_SIGN_CYCLES cycles in
+//      a row agree at more than FLUX_SIGN_AMPS and kept for as long as the power is on. Until then only
+//      the battery dip term, which needs no polarity, builds the trim.
+//
+//   With ENABLE_FLUX_BALANCE commented out the earlier open loop detection runs instead: once a cycle
+//   after the charger, the vbatt difference between the halves flags the half that saturates and sets
+//   saturation_adj, which takes a percent off that half's duty when ENABLE_SATURATION_COMP is defined.
 // ---------------------------------------------------------------------------------------------------------
 
+// -----------------------
+// flux balance calibration
+// -----------------------
+#define ENABLE_FLUX_BALANCE     (1)                 // comment out to use the open loop saturation detection instead
+#define FLUX_SIGN_AMPS          (0.5)               // sense polarity; mean output amps with the drive over a cycle
+#define FLUX_SIGN_MEAN          (IMEAS_INV_AMPS_ADC(FLUX_SIGN_AMPS)-IMEAS_INV_AMPS_ADC(0))  // imeas counts
+#define FLUX_SIGN_CYCLES        (8)                 // sense polarity; a/c cycles in a row
+#define FLUX_VBATT_GAIN         (4)                 // imeas counts per vbatt count of half-cycle difference
+#define FLUX_DEADBAND           (IMEAS_INV_AMPS_ADC(0.25)-IMEAS_INV_AMPS_ADC(0))  // imeas counts; ignore noise and sense drift
+#define FLUX_KI_SHIFT           (3)                 // Q15 trim per imeas count per a/c cycle; 1/8
+#define FLUX_TRIM_MAX           ((int16_t)(32768L * 3 / 100))   // 3% of the duty
+#define FLUX_ZERO_SHIFT         (6)                 // idle IMeas zero filter; 2^n PWM periods
+#define FLUX_ZERO_RANGE         (64)                // imeas counts from IMEAS_ZERO_CROSS_A2D
+#define FLUX_ZERO_VAC_RMS       (VAC_VOLTS_ADC(10.0)-VAC_VOLTS_ADC(0))  // learn the zero only below
+
+#define VBATT_START_PHASE       ((3*MAX_SINE)/4)    // (3/4 into half-cycle) where to start vbatt summing for average
+
+#ifndef ENABLE_FLUX_BALANCE
 // -----------------------
 // saturation calibration
 // -----------------------
 //#define ENABLE_SATURATION_COMP     (1)  // comment out to disable saturation compensation
 #define SATURATION_THRESHOLD   (VBATT_VOLTS_ADC(0.15)-VBATT_VOLTS_ADC(0)) // 1st vbatt vs 2nd half vbatt average (A2D counts)
 #define SATURATION_DUTY_GAIN    ((int16_t)(500))   // 10 x %duty_cycle / vbatt_volts_diff;  10=1.0% 100=10.0%)
-#define VBATT_START_PHASE       ((3*MAX_SINE)/4)   // (3/4 into half-cycle) where to start vbatt summing for average
+#endif  //  ENABLE_FLUX_BALANCE
 
 // reduce the i_gain on the PID loop during this time to INV_SAFE_IGAIN_Q16; prevents oscillation if xfmr is saturated
 #define ENABLE_SAFE_IGAIN           (1)  // comment out to not use safe i_gain 
 #define IGAIN_TRANSITION_AC_CYCLES  (8)  // A/C cycle counts (16.667 msecs) 5 no work, 7 works, 8 works, 10 works
 
+// scale the closed loop duty by nominal_vbatt/vbatt every PWM period, so the PID does not have to chase battery sag and ripple
+#define ENABLE_VBATT_FEED_FORWARD   (1)  // comment out to not use battery voltage feed-forward
+
+// add the dead time back onto the duty by the current direction, where the model has a table
+#ifdef OPTION_INV_DTC_DUTY
+#define ENABLE_DEAD_TIME_COMP       (1)  // comment out to not compensate
+#endif
+
 // debugging
+//#define ENABLE_FLUX_BALANCE_DEBUG    (1)  // uncomment to enable debugging; RB6 high while the trim is at its limit for scope monitoring
 //#define ENABLE_SATURATION_DEBUG      (1)  // uncomment to enable debugging; shows sat comp cycles via pin RB6 for scope monitoring
 
 // ----------
 // variables
 // ----------
 // batt voltage summation for 1st and 2nd half cycles
-uint8_t  is_xfrm_saturated = 0;  // 0=no, 1=transformer is saturated based upon vbatt differential (calculated on each a/c cycle)
-uint8_t  xfrm_2half_sat    = 0;  // 0=1st half saturated, 1=2nd half saturated; only valid if:  is_xfrm_saturated != 0
 uint32_t vbatt_sum_1half   = 0;  // battery voltage sum of a/d counts first  half cycle
 uint32_t vbatt_sum_2half   = 0;  // battery voltage sum of a/d counts second half cycle
+uint16_t vbatt_samples     = 0;  // samples in vbatt_sum_2half; depends on the output frequency
+
+static int32_t  _FluxImeasSum = 0;  // IMeasRaw() less _IMeasZero over the a/c cycle
+static uint16_t _FluxSamples  = 0;  // samples in _FluxImeasSum
+static int16_t  _FluxTrim     = 0;  // Q15; > 0 takes duty off VECTOR2, < 0 off VECTOR1
+static int32_t  _FluxDriveSum = 0;  // as _FluxImeasSum, turned round while VECTOR1 drives
+static int8_t   _FluxSign     = 0;  // +1: IMeasRaw() goes up while VECTOR2 drives, -1: down; 0=not known
+static int8_t   _FluxAgree    = 0;  // cycles in a row for a sign: > 0 for +1, < 0 for -1
+static int32_t  _IMeasZero    = ((int32_t)IMEAS_ZERO_CROSS_A2D << FLUX_ZERO_SHIFT);
+
+#ifndef ENABLE_FLUX_BALANCE
+uint8_t  is_xfrm_saturated = 0;  // 0=no, 1=transformer is saturated based upon vbatt differential (calculated on each a/c cycle)
+uint8_t  xfrm_2half_sat    = 0;  // 0=1st half saturated, 1=2nd half saturated; only valid if:  is_xfrm_saturated != 0
 uint16_t vbatt_diff_a2d    = 0;  // vbatt volt difference 1st vs 2nd cycle (+ 1st half > 2nd half)
 uint16_t saturation_adj    = 0;  // percent x 10  adjustment decrease if saturated  (0-1000: 10=1% 100=10%)
 
 // constants; don't change
 // duty cycle is reduced by a percentage scaled to the vbatt voltage differential of 1st and 2nd half cycles
 #define VBATT_1VOLT_A2D    (VBATT_VOLTS_ADC(1.0)-VBATT_VOLTS_ADC(0)) // one delta vbatt volt (A2D counts)
-#define VBAT_AVG_SAMPLES   (MAX_SINE-VBATT_START_PHASE)   // number of vbatt samples per half sub cycle
+
+//-----------------------------------------------------------------------------
+// duty of the saturated half-cycle less saturation_adj
+
+INLINE int16_t _inv_SaturationDuty(int16_t duty)
+{
+    int16_t new_duty = duty - (int16_t)(((uint32_t)duty*(uint32_t)saturation_adj)/1000);
+
+    if (new_duty < MIN_DUTY) new_duty = MIN_DUTY;
+  #ifdef ENABLE_SATURATION_COMP
+    return(new_duty);
+  #else
+    return(duty);
+  #endif
+}
+
+//-----------------------------------------------------------------------------
+// end of each a/c cycle; updates is_xfrm_saturated, xfrm_2half_sat and saturation_adj
+
+static void _inv_SaturationCycle(PWM_STATE_t pwm_state)
+{
+    // only check for transformer saturation at begining of normal mode and charger has run
+    if (chgr_hasRun && (PWM_STATE_NORMAL == pwm_state) && vbatt_samples)
+    {
+        // check if transformer is saturated
+        uint32_t diff;
+        if (vbatt_sum_1half > vbatt_sum_2half)
+        {
+            diff = (vbatt_sum_1half - vbatt_sum_2half)/(uint32_t)vbatt_samples;
+            xfrm_2half_sat = 1;  // 2nd half saturated
+        }
+        else
+        {
+            diff = (vbatt_sum_2half - vbatt_sum_1half)/(uint32_t)vbatt_samples;
+            xfrm_2half_sat = 0;  // 1st half saturated
+        }
+        vbatt_diff_a2d = (uint16_t)diff;
+
+        if (vbatt_diff_a2d > SATURATION_THRESHOLD)
+        {
+            is_xfrm_saturated = 1;
+            saturation_adj   = (uint16_t)(((uint32_t)SATURATION_DUTY_GAIN * (uint32_t)vbatt_diff_a2d)/(uint32_t)VBATT_1VOLT_A2D);
+          #ifdef ENABLE_SATURATION_DEBUG
+            RB6_SET(1);
+          #endif
+        }
+        else
+        {
+            is_xfrm_saturated = 0;
+            saturation_adj   = 0;
+          #ifdef ENABLE_SATURATION_DEBUG
+            RB6_SET(0);
+          #endif
+        }
+    }
+    else
+    {
+        // Not Normal Mode: Soft Start, Soft Stop, etc
+        vbatt_diff_a2d    = 0;
+        is_xfrm_saturated = 0;
+      #ifdef ENABLE_SATURATION_DEBUG
+        RB6_SET(0);
+      #endif
+    }
+}
+#endif  //  ENABLE_FLUX_BALANCE
+
+//-----------------------------------------------------------------------------
+// learn the IMeas sensor zero; idle, outputs off
+
+INLINE void _inv_FluxZeroUpdate(void)
+{
+    int16_t zero;
+
+    if (VacRMS() >= FLUX_ZERO_VAC_RMS) return;  // line on the transformer
+
+    _IMeasZero += (int32_t)IMeasRaw() - (_IMeasZero >> FLUX_ZERO_SHIFT);
+    zero = (int16_t)(_IMeasZero >> FLUX_ZERO_SHIFT);
+    if (zero > (IMEAS_ZERO_CROSS_A2D + FLUX_ZERO_RANGE))
+        _IMeasZero = (int32_t)(IMEAS_ZERO_CROSS_A2D + FLUX_ZERO_RANGE) << FLUX_ZERO_SHIFT;
+    else if (zero < (IMEAS_ZERO_CROSS_A2D - FLUX_ZERO_RANGE))
+        _IMeasZero = (int32_t)(IMEAS_ZERO_CROSS_A2D - FLUX_ZERO_RANGE) << FLUX_ZERO_SHIFT;
+}
+
+#ifdef ENABLE_FLUX_BALANCE
+//-----------------------------------------------------------------------------
+// duty less trim (Q15 > 0) of it
+
+INLINE int16_t _inv_FluxTrimDuty(int16_t duty, int16_t trim)
+{
+    int16_t new_duty = duty - (int16_t)(((int32_t)duty * trim) >> 15);
+
+    if ((new_duty < MIN_DUTY) && (duty >= MIN_DUTY)) new_duty = MIN_DUTY;
+    return(new_duty);
+}
+#endif  //  ENABLE_FLUX_BALANCE
+
+#ifdef ENABLE_DEAD_TIME_COMP
+//-----------------------------------------------------------------------------
+// dead time compensation; duty counts for the current now, + where it flows
+// with the drive of the half-cycle. The sense polarity is learnt
+
+INLINE int16_t _inv_DeadTimeAdj(VECTOR_CYCLE vector)
+{
+    return(inv_DeadTimeSample((int16_t)IMeasRaw() - (int16_t)IMeasCycleAvg(), (VECTOR2 == vector) ? 1 : 0));
+}
+#endif
+
+#ifdef ENABLE_FLUX_BALANCE
+//-----------------------------------------------------------------------------
+// end of each a/c cycle in PWM_STATE_NORMAL; updates _FluxTrim
+
+static void _inv_FluxBalanceCycle(void)
+{
+    int16_t err = 0;
+    int16_t mean;
+    int32_t trim;
+
+    if (0 == _FluxSamples) return;
+
+    // means fit 16 bits; 32/16 divides, not the 32-bit library divide
+    if (0 == _FluxSign)
+    {
+        // sense polarity; mean current with the drive
+        mean = __builtin_divsd(_FluxDriveSum, _FluxSamples);
+        if (mean > FLUX_SIGN_MEAN)
+            _FluxAgree = (_FluxAgree > 0) ? _FluxAgree + 1 :  1;
+        else if (mean < -FLUX_SIGN_MEAN)
+            _FluxAgree = (_FluxAgree < 0) ? _FluxAgree - 1 : -1;
+        else
+            _FluxAgree = 0;
+
+        if (_FluxAgree >= FLUX_SIGN_CYCLES)
+            _FluxSign = 1;
+        else if (_FluxAgree <= -FLUX_SIGN_CYCLES)
+            _FluxSign = -1;
+    }
+    else
+    {
+        // dc current; + when VECTOR2 carries more
+        err = _FluxSign * __builtin_divsd(_FluxImeasSum, _FluxSamples);
+    }
+
+    // battery dip; + when vbatt is lower in the VECTOR2 half
+    if (vbatt_samples)
+    {
+        err += __builtin_divsd((int32_t)vbatt_sum_1half - (int32_t)vbatt_sum_2half, vbatt_samples) * FLUX_VBATT_GAIN;
+    }
+
+    if (err > FLUX_DEADBAND)
+        err -= FLUX_DEADBAND;
+    else if (err < -FLUX_DEADBAND)
+        err += FLUX_DEADBAND;
+    else
+        err = 0;
+
+    trim = (int32_t)_FluxTrim + (err >> FLUX_KI_SHIFT);
+    if (trim >  FLUX_TRIM_MAX) trim =  FLUX_TRIM_MAX;
+    if (trim < -FLUX_TRIM_MAX) trim = -FLUX_TRIM_MAX;
+    _FluxTrim = (int16_t)trim;
+
+  #ifdef ENABLE_FLUX_BALANCE_DEBUG
+    RB6_SET(((_FluxTrim == FLUX_TRIM_MAX) || (_FluxTrim == -FLUX_TRIM_MAX)) ? 1 : 0);
+  #endif
+}
+#endif  //  ENABLE_FLUX_BALANCE
+
+#ifdef ENABLE_VBATT_FEED_FORWARD
+//-----------------------------------------------------------------------------
+// BATTERY VOLTAGE FEED-FORWARD
+//
+//  The output voltage is proportional to duty x vbatt, so the duty from the
+//  PID is scaled by SUPPLY_NOMINAL/vbatt each PWM period. _VBattFFTable[] holds
+//  that reciprocal in Q12 at every VBATT_FF_STEP a/d counts; the ISR
+//  interpolates between entries (one multiply, no divide). Below half the
+//  nominal voltage the gain is held at VBATT_FF_GAIN_MAX so a bad reading
+//  cannot run the duty away. VBattRaw() is lightly filtered (about 4 PWM
+//  periods) to keep a/d noise off the output; that is still well inside a
+//  half-cycle, so the sag under a load step is followed.
+//-----------------------------------------------------------------------------
+#define VBATT_FF_SHIFT      (4)                     // a/d counts per table step; 2^n
+#define VBATT_FF_STEP       (1 << VBATT_FF_SHIFT)
+#define VBATT_FF_ENTRIES    ((1024 >> VBATT_FF_SHIFT) + 1)  // 10-bit a/d; one past the end
+#define VBATT_FF_Q          (12)                    // 4096 = 1.0
+#define VBATT_FF_GAIN_MAX   ((uint16_t)(2 << VBATT_FF_Q))
+#define VBATT_FF_FILT_SHIFT (2)
+
+#define _VFF(n)     ((((n) * VBATT_FF_STEP) <= (SUPPLY_NOMINAL / 2)) ? VBATT_FF_GAIN_MAX : \
+                     (uint16_t)(((uint32_t)SUPPLY_NOMINAL << VBATT_FF_Q) / ((n) ? (n) * VBATT_FF_STEP : 1)))
+#define _VFF8(n)    _VFF(n), _VFF(n+1), _VFF(n+2), _VFF(n+3), _VFF(n+4), _VFF(n+5), _VFF(n+6), _VFF(n+7)
+
+static const uint16_t _VBattFFTable[VBATT_FF_ENTRIES] =
+{
+    _VFF8(0),  _VFF8(8),  _VFF8(16), _VFF8(24), _VFF8(32), _VFF8(40), _VFF8(48), _VFF8(56), _VFF(64)
+};
+
+static uint16_t _VBattFilt = 0;     // VBattRaw() << VBATT_FF_FILT_SHIFT
+
+//-----------------------------------------------------------------------------
+// track the battery voltage; every PWM period, whatever the state, so the
+// filter is settled when the output starts
+
+INLINE void _inv_VBattFFUpdate(void)
+{
+    if (0 == _VBattFilt)
+        _VBattFilt = (uint16_t)VBattRaw() << VBATT_FF_FILT_SHIFT;
+    else
+        _VBattFilt += (uint16_t)VBattRaw() - (_VBattFilt >> VBATT_FF_FILT_SHIFT);
+}
+
+//-----------------------------------------------------------------------------
+// value x SUPPLY_NOMINAL/vbatt                                 ~ 1 usec
+
+INLINE int32_t _inv_VBattFeedForward(int32_t value)
+{
+    uint16_t vbatt = _VBattFilt >> VBATT_FF_FILT_SHIFT;
+    uint16_t ix    = vbatt >> VBATT_FF_SHIFT;
+    uint16_t gain;
+
+    if (ix >= (VBATT_FF_ENTRIES - 1))
+    {
+        gain = _VBattFFTable[VBATT_FF_ENTRIES - 1];
+    }
+    else
+    {
+        // table falls with vbatt
+        gain = _VBattFFTable[ix] - (uint16_t)(((uint32_t)(_VBattFFTable[ix] - _VBattFFTable[ix+1]) *
+                                               (vbatt & (VBATT_FF_STEP - 1))) >> VBATT_FF_SHIFT);
+    }
+    return((value * (int32_t)gain) >> VBATT_FF_Q);
+}
+#endif  //  ENABLE_VBATT_FEED_FORWARD
 
 //-----------------------------------------------------------------------------
 // inverter PWM interrupt service routine runs at 23 khz
+//
+//  TIMING: the PWM period is 1736 instruction cycles (43.4 usec). The PWM ISR
+//  in inverter mode measured 10.3 usec at -O0 in 2016 (see pwm.c), before the
+//  PLL, battery feed forward, harmonic compensation, flux balance and dead
+//  time compensation; with them it has not been measured. Estimated from the
+//  code at -O0 (the project setting) with vloop_mode INV_VLOOP_RESONANT,
+//  ENABLE_FLUX_BALANCE and ENABLE_DEAD_TIME_COMP, in cycles:
+//
+//      every PWM period:
+//        ISR as measured in 2016 (loop, duty, limits, fan)         412
+//        pll_Isr(), DDS, battery feed forward, telemetry          ~300
+//        resonant terms; 3 outputs, 1 learning pair               ~750
+//        flux balance trim and sums                                ~90
+//        dead time sample and table                               ~110
+//                                                                ~1660
+//      the period that ends the a/c cycle, harmonic term held:
+//        ~900 + flux balance, sense polarities, RMS offset,
+//        transfer decay, an_ProcessAnalogData() ~250             ~1150
+//      the period after it, harmonic term held:
+//        ~900 + overload and thermal models ~600                 ~1500
+//      a period with the PLL half-cycle work, harmonic term held:
+//        ~900 + ~100 (no line) to ~200 (locked)                  ~1100
+//
+//  So about 95% of the period at worst, every period, and an estimate is
+//  good to perhaps 20%: the once-a-cycle work is kept off the periods that
+//  work out the harmonic term, and is all 32/16 hardware divides, but
+//  INV_VLOOP_RESONANT with both trims must be measured on a unit before it
+//  is used on a -O0 build. -O1 took the 2016 ISR to 0.83 of the time.
+//  The repetitive term is about 150 cycles in place of the resonant ~750.
+//  To measure the worst case: build with ENABLE_TASK_TIMING (tasker.h),
+//  ENABLE_FLUX_BALANCE and ENABLE_DEAD_TIME_COMP, set vloop_mode to
+//  INV_VLOOP_RESONANT, run into a load and read the pwm max from the task
+//  timing dump: Timer7 ticks of 8 cycles, the whole PWM ISR, 217 = the period.
 
 static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
 {
@@ -660,8 +963,9 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
     static INV_ISR_REQUEST_t _my_request = INV_ISR_REQ_NUL;
 
     static DWORD_t temp32;
-    static int16_t sine_table_index = 0;
+    static int16_t sine_table_index = 0;        // table entry within the half-cycle; from _InvDds
     static VECTOR_CYCLE phase_vector = VECTOR1;
+    static uint8_t dds_events = DDS_EV_HALF;    // DDS_EV_xxx for this sample
 
     static int16_t curr_error = 0;
     static int16_t prev_error = 0;
@@ -672,6 +976,13 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
 
     static int16_t half_cycle_count = 0;
 
+    static int16_t rc_held = 0;                 // harmonic correction; held through the periods in TIMING
+    static uint8_t ovl_pending = 0;             // 1=_inv_ProcessOverload() in this period
+
+    // foreground duty table for the half-cycle, while multiplier is duty_tbl_key
+    static const int16_t* duty_tbl = 0;
+    static int32_t duty_tbl_key = 0;
+
     //-----------------------------------------------------------------------------
     //	The system has about a 250 nSec delay between the stimulus applied to 
     //	the transformer primary and the feedback signal. The elements below 
@@ -700,14 +1011,13 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
     static int16_t soft_start_cycles = SOFT_START_CYCLES;
     static int16_t soft_start_inc = SOFT_START_INC;
 
-#define PING_MAX_DUTY       (((MAX_DUTY * .853)*2)/3)
-#define PING_HALF_CYCLES    (2)
-#define PING_INC            (PING_MAX_DUTY/PING_HALF_CYCLES)
-
-    static int16_t ping_cycles = (2 * PING_HALF_CYCLES);
-    static int16_t ping_inc = PING_INC;
+    //  load-sense probe; see load_sense.h
+#define PING_DUTY           (SOFT_START_MAX_DUTY/LSENSE_PROBE_FRACTION)
 
     DWORD_t curr_duty = { {0L} };
+  #ifdef ENABLE_FLUX_BALANCE
+    int16_t imeas;                              // IMeasRaw() less the sensor zero
+  #endif
 
     //  2015-08-06 - AC output measurements with a DVM
     //    const int32_t MAX_DUTY_Q16 = (MAX_DUTY * .800);   // 119.68  Vrms
@@ -719,6 +1029,8 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
     //    const int32_t MAX_DUTY_Q16 = (MAX_DUTY * .853);   //  127.29 Vrms
     int32_t sine_table_val;
     int32_t i_gain;
+    int16_t rc_adj = 0;
+    uint8_t vloop_mode = (uint8_t)Inv.config.vloop_mode;
 
     switch (request)
     {
@@ -737,20 +1049,21 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
 #endif  //  INV_DEBUG_WAVEFORM_CAPTURE
 
         //  Initialize variables used by the ISR
-        sine_table_index = 0;
-        phase_vector = VECTOR1;
+        _InvDds.phase = 0;
+        dds_events = DDS_EV_HALF;
 
         half_cycle_count = 0;
         soft_start_cycles = SOFT_START_CYCLES;
         soft_start_inc = SOFT_START_INC;
 
-        _inv_ProcessOverloadCounters(1);
+        _inv_ProcessOverload(1);
 
         pwm_state = PWM_STATE_IDLE;
         return;
 
     case INV_ISR_REQ_PING:
     case INV_ISR_REQ_SOFT_START:
+    case INV_ISR_REQ_START:
     case INV_ISR_REQ_SOFT_STOP:
         _my_request = request;
         return;
@@ -763,7 +1076,23 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
         OVDCON = 0x3F00; //  Normal Operation
     }
 
-    sine_table_val = (int32_t) _SineTableQ16[sine_table_index];
+  #ifdef ENABLE_VBATT_FEED_FORWARD
+    _inv_VBattFFUpdate();
+  #endif
+
+    sine_table_val = (int32_t) dds_Sample(&_InvDds, &sine_table_index);
+    phase_vector   = dds_Vector(&_InvDds);
+
+    //  learned harmonic corrections only survive normal operation
+    inv_HarmonicWipe((PWM_STATE_NORMAL == pwm_state) ? vloop_mode : INV_VLOOP_PID);
+    if (PWM_STATE_NORMAL != pwm_state) rc_held = 0;
+
+    //  the overload step of the a/c cycle that ended last period
+    if (ovl_pending)
+    {
+        ovl_pending = 0;
+        _inv_ProcessOverload(0); //  _inv_ProcessOverload must be called directly - not a task
+    }
 
     switch (pwm_state)
     {
@@ -793,13 +1122,28 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
         i_adj = 0;
         d_adj = 0;
         _RmsVacSetpointOffset = 0;
+        _XferDutyAdj = 0;
+        _XferSetpointAdj = 0;
+        duty_tbl = 0;
 
-        // transformer saturation compensation
-        is_xfrm_saturated = 0;
+        // transformer flux balance
         vbatt_sum_1half   = 0;
         vbatt_sum_2half   = 0;
+        vbatt_samples     = 0;
+        _FluxImeasSum     = 0;
+        _FluxDriveSum     = 0;
+        _FluxSamples      = 0;
+        _FluxTrim         = 0;
+        _FluxAgree        = 0;
+        _inv_FluxZeroUpdate();
+      #ifdef ENABLE_DEAD_TIME_COMP
+        inv_DeadTimeRestart();
+      #endif
+      #ifndef ENABLE_FLUX_BALANCE
+        is_xfrm_saturated = 0;
         vbatt_diff_a2d    = 0;
         saturation_adj    = 0;
+      #endif
 
         //  The input signal should be zero VAC, use this as an offset that
         //  to can be applied to future calculations.
@@ -820,8 +1164,9 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
           
             // init values
             multiplier = (int32_t)soft_start_inc;
-            sine_table_index = 0;
-            sine_table_val = (int32_t)_SineTableQ16[sine_table_index];
+            _InvDds.phase  = 0;
+            dds_events     = DDS_EV_HALF;
+            sine_table_val = (int32_t) dds_Sample(&_InvDds, &sine_table_index);
             half_cycle_count = 0;
             phase_vector     = VECTOR1;
 
@@ -829,13 +1174,34 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
             _my_request = INV_ISR_REQ_NUL;
             pwm_state = PWM_STATE_SOFTSTART;
         }
+        else if (INV_ISR_REQ_START == _my_request)
+        {
+            //  Take over from the line: at the line phase and amplitude the
+            //  PLL kept while the relay was closed (see xfer.h). MAX_DUTY_Q16
+            //  gives 122.02 Vrms.
+            _XferDutyAdj = (int16_t)((MAX_DUTY_Q16 * ((int32_t)xfer_LineAmp() - XFER_AMP(122.02))) / XFER_AMP(122.02));
+            _XferSetpointAdj = (int16_t)((((uint32_t)xfer_LineAmp() * 51472) >> 15) - Inv.config.vac_setpoint);  // mean * pi/2 = peak
+            multiplier = ScaleByVBatt(MAX_DUTY_Q16 + _XferDutyAdj);
+            _InvDds.phase  = pll_Phase();
+            dds_events     = 0;
+            sine_table_val = (int32_t) dds_Sample(&_InvDds, &sine_table_index);
+            phase_vector   = dds_Vector(&_InvDds);
+            half_cycle_count = 0;
+            _VacOffset = VAC_ZERO_CROSS_A2D;
+            OVDCON = 0x3F00; // FETS now driven by PWM
+
+            // transition to next state
+            _my_request = INV_ISR_REQ_NUL;
+            pwm_state = PWM_STATE_NORMAL;
+        }
         else if (INV_ISR_REQ_PING == _my_request)
         {
             // init values
-            ping_inc = ScaleByVBatt(PING_INC);
-            multiplier = (int32_t) ping_inc;
-            sine_table_index = 0;
-            sine_table_val = (int32_t)_SineTableQ16[sine_table_index];
+            multiplier = ScaleByVBatt(PING_DUTY);
+            lsense_ProbeStart();
+            _InvDds.phase  = 0;
+            dds_events     = DDS_EV_HALF;
+            sine_table_val = (int32_t) dds_Sample(&_InvDds, &sine_table_index);
             half_cycle_count = 0;
             phase_vector     = VECTOR1;
 
@@ -847,38 +1213,33 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
 
     case PWM_STATE_PING:
         SetInvOutputting();
-        //  We are (re-)using half_cycle_count as a flag and counter, because
-        //  it is available, not necessarily to monitor half-cycles.
+        //  A constant, low amplitude for whole a/c cycles, from zero crossing
+        //  to zero crossing. The output voltage and current of each sample 
+        //  go to the load-sense sums.
 
         // wait for the zero crossing
-        if (0 == sine_table_index)
+        if (dds_events & DDS_EV_HALF)
         {
             // enable PWM drive on first time; over-load may modify this later
             if (0 == half_cycle_count) OVDCON = 0x3F00; // FETS now driven by PWM
 
-            half_cycle_count++;
-            if (half_cycle_count < (ping_cycles >> 1))
-            {
-                multiplier += (int32_t) ping_inc;
-            }
-            else if ((half_cycle_count > (ping_cycles >> 1)) &&
-                    (half_cycle_count < ping_cycles))
-            {
-                multiplier -= (int32_t) ping_inc;
-            }
-            else if (half_cycle_count == ping_cycles)
+            if (++half_cycle_count > LSENSE_PROBE_HALF_CYCLES)
             {
                 multiplier = 0;
                 pwm_state = PWM_STATE_IDLE;
+                break;
             }
+            duty_tbl = _inv_DutyTableHalf(multiplier, (half_cycle_count < LSENSE_PROBE_HALF_CYCLES) ? multiplier : -1);
+            duty_tbl_key = multiplier;
         }
+        lsense_ProbeSample(VacRaw() - _VacOffset, (int16_t)IMeasRaw() - (int16_t)(_IMeasZero >> FLUX_ZERO_SHIFT));
         break;
 
     case PWM_STATE_SOFTSTART:
         SetInvOutputting();
         //  Increase the amplitude of the output every half-cycle, at the 
         //  zero-crossing.
-        if (0 == sine_table_index)
+        if (dds_events & DDS_EV_HALF)
         {
             // enable PWM drive on first time; over-load may modify this later
             if (0 == half_cycle_count) OVDCON = 0x3F00; // FETS now driven by PWM
@@ -886,6 +1247,9 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
             if (++half_cycle_count < soft_start_cycles)
             {
                 multiplier += (int32_t) soft_start_inc;
+                duty_tbl = _inv_DutyTableHalf(multiplier, 
+                    ((half_cycle_count + 1) < soft_start_cycles) ? (multiplier + soft_start_inc) : -1);
+                duty_tbl_key = multiplier;
             }
             else
             {
@@ -899,7 +1263,7 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
         //  detect REVERSED SENSE WINDING at peaks
         //  VECTOR1 = Positive half-cycle
         //  VECTOR2 = Negative half-cycle
-        if (((MAX_SINE / 2) == sine_table_index) && (half_cycle_count > 2) &&
+        if ((dds_events & DDS_EV_PEAK) && (half_cycle_count > 2) &&
                 (((VECTOR1 == phase_vector) && (VacRaw() < (_VacOffset - soft_start_inc))) ||
                 ((VECTOR2 == phase_vector ) && (VacRaw() > (_VacOffset + soft_start_inc)))))
         {
@@ -910,6 +1274,7 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
 
     case PWM_STATE_NORMAL:
         SetInvOutputting();
+        duty_tbl = 0;   // the loop changes the amplitude every PWM period
         // If an overload occurred, the outputs have been overridden,
         // we are skipping this pulse.  
         if (_OvlSkipNextPulse > 0)
@@ -928,7 +1293,7 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
 
         //  TODO:  RMS Setpoint Compensation needs to be tweaked for LPC.       
         //        temp32.dword = sine_table_val * (int32_t)Inv.config.vac_setpoint;
-        temp32.dword = sine_table_val * (int32_t) (Inv.config.vac_setpoint + _RmsVacSetpointOffset);
+        temp32.dword = sine_table_val * (int32_t) (Inv.config.vac_setpoint + _RmsVacSetpointOffset + _XferSetpointAdj);
 
         vac_setpoint[vac_sp_ay_head++] = temp32.msw;
         vac_sp_ay_head &= VAC_SP_AY_MASK;
@@ -949,6 +1314,23 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
         vac_sp_ay_tail++;
         vac_sp_ay_tail &= VAC_SP_AY_MASK;
 
+        //  HARMONIC COMPENSATION
+        //  Learns from the error before sine-weighting; frozen while flat-topped.
+        //  Held in the periods that carry the once-a-cycle and PLL half-cycle
+        //  work, so no period has both (see TIMING above): the last of the
+        //  a/c cycle, the first of the next, and the PLL's.
+        if (INV_VLOOP_PID == vloop_mode)
+        {
+            rc_held = 0;
+        }
+        else if (!((VECTOR2 == phase_vector) && ((uint32_t)(_InvDds.phase + _InvDds.step) < _InvDds.phase)) &&
+                 !((VECTOR1 == phase_vector) && (dds_events & DDS_EV_HALF)) && !pll_IsHalfCycle())
+        {
+            rc_held = inv_HarmonicTerm(vloop_mode, sine_table_index + ((VECTOR2 == phase_vector) ? MAX_SINE : 0),
+                                       curr_error, (0 == flattop_end_index));
+        }
+        rc_adj = rc_held;
+
         //  We could scale the error here, but we should be able to produce the
         //  same results using the PID gain values.
 
@@ -993,14 +1375,18 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
         d_adj = temp32.msw;
 
         prev_error = curr_error;
+        tlm_SetLoopTerms(p_adj, i_adj, d_adj);
 
       #ifdef _ENABLE_OPEN_LOOP
         multiplier = MAX_DUTY_Q16;  //  Open-loop for DEBUG
       #else
-        multiplier = MAX_DUTY_Q16 + p_adj + i_adj + d_adj; // Closed loop
+        multiplier = MAX_DUTY_Q16 + _XferDutyAdj + p_adj + i_adj + d_adj; // Closed loop
+       #ifdef ENABLE_VBATT_FEED_FORWARD
+        multiplier = _inv_VBattFeedForward(multiplier);    // PID only sees what vbatt does not explain
+       #endif
       #endif
       
-        if ((0 == sine_table_index) && (VECTOR1 == phase_vector))
+        if ((dds_events & DDS_EV_HALF) && (VECTOR1 == phase_vector))
         {
             // start of new full a/c cycle
             if (flattop_allow_counter <= ALLOW_FLAT_TOP_AFTER_AC_CYLCES)
@@ -1036,7 +1422,7 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
 
     case PWM_STATE_SOFTSTOP:
         SetInvOutputting();
-        if (0 == sine_table_index)
+        if (dds_events & DDS_EV_HALF)
         {
             if (++half_cycle_count >= soft_start_cycles)
             {
@@ -1050,6 +1436,9 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
                 {
                     multiplier = 0;
                 }
+                duty_tbl = _inv_DutyTableHalf(multiplier, 
+                    ((half_cycle_count + 1) < soft_start_cycles) ? (multiplier - soft_start_inc) : -1);
+                duty_tbl_key = multiplier;
             }
         }
         break;
@@ -1058,7 +1447,27 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
         break;
     }
 
-    curr_duty.dword = sine_table_val * multiplier;
+    if (duty_tbl && (multiplier == duty_tbl_key))
+    {
+        // no multiply; the foreground worked out this half-cycle
+        curr_duty.lsw = 0;
+        curr_duty.msw = dds_SampleTable(&_InvDds, duty_tbl);
+    }
+    else
+    {
+        // the closed loop, and the first half-cycle of a start (duty_table.h)
+        curr_duty.dword = sine_table_val * multiplier;
+    }
+    curr_duty.msw  += rc_adj;
+
+  #ifdef ENABLE_DEAD_TIME_COMP
+    //  Dead time (see inv_deadtime.h); before the limits, so the
+    //  pulses either side of the zero crossing come out as asked for.
+    if (PWM_STATE_NORMAL == pwm_state)
+    {
+        curr_duty.msw += _inv_DeadTimeAdj(phase_vector);
+    }
+  #endif
 
     //  Check for duty-cycle limits (deadband)
     if (curr_duty.msw < MIN_THRES)
@@ -1110,7 +1519,9 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
         //  This is intended to prevent oscillation on the falling side of the sine-
         //	wave.  From 90(270) to 180(360) degrees. If we are in the falling side,
         //	and we attempt to increase the output, use the prior value instead.
-        else if ((sine_table_index > (MAX_SINE / 2)) && (curr_duty.msw > last_duty))
+        //  The harmonic compensation shapes the falling side itself.
+        else if ((INV_VLOOP_PID == vloop_mode) &&
+                 (sine_table_index > (MAX_SINE / 2)) && (curr_duty.msw > last_duty))
         {
             curr_duty.msw = last_duty;
         }
@@ -1124,21 +1535,17 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
     case VECTOR1:
         //  Drives energized for negative polarity
         //  The duty cycle written takes affect on the next PWM clock.
-        if (is_xfrm_saturated && !xfrm_2half_sat)
-        {
-            uint16_t delta_duty = (int16_t)(((uint32_t)curr_duty.msw*(uint32_t)saturation_adj)/1000);
-            int16_t  new_duty   = curr_duty.msw - delta_duty;  // reduce duty cycle
-            if (new_duty < MIN_DUTY) new_duty = MIN_DUTY;
-         // if ((sine_table_index&0x3F)==1) SLOG(SS_SYS, SV_DBG, "V1SAT", curr_duty.msw, new_duty, saturation_adj, VBATT_1VOLT_A2D);
-          #ifdef ENABLE_SATURATION_COMP
-            curr_duty.msw = new_duty;
-          #endif
-        }
-        PDC1 = curr_duty.msw;
+      #ifdef ENABLE_FLUX_BALANCE
+        PDC1 = (_FluxTrim < 0) ? _inv_FluxTrimDuty(curr_duty.msw, -_FluxTrim) : curr_duty.msw;
+      #else
+        PDC1 = (is_xfrm_saturated && !xfrm_2half_sat) ? _inv_SaturationDuty(curr_duty.msw) : curr_duty.msw;
+      #endif
         PDC2 = 0;
 
-        if (0 == sine_table_index)
+        if (dds_events & DDS_EV_HALF)
         {
+            vbatt_sum_1half = 0;
+
             //  Re-balance VAC Offset once per cycle
             if ((duty_cycle_sum.msw == 0) &&
                 (duty_cycle_sum.lsw > (int16_t) DUTY_CYCLE_SUM_POS_THRES))
@@ -1175,104 +1582,83 @@ static void _inv_PwmIsr(INV_ISR_REQUEST_t request)
         {
             // battery voltage detects transformer saturation
             if (sine_table_index >= VBATT_START_PHASE)
-            {
-                if (sine_table_index == VBATT_START_PHASE)
-                    vbatt_sum_1half  = (uint32_t)An.Status.VBatt.raw_val; // initial
-                else
-                    vbatt_sum_1half += (uint32_t)An.Status.VBatt.raw_val; // summing
-            }
+                vbatt_sum_1half += (uint32_t)An.Status.VBatt.raw_val; // summing
             duty_cycle_sum.dword += curr_duty.msw;
         }
+      #ifdef ENABLE_FLUX_BALANCE
+        imeas = (int16_t)IMeasRaw() - (int16_t)(_IMeasZero >> FLUX_ZERO_SHIFT);
+        _FluxImeasSum += imeas;
+        _FluxDriveSum -= imeas;
+        _FluxSamples++;
+      #endif
 
-        if (++sine_table_index > (MAX_SINE - 1))
+        dds_events = dds_Advance(&_InvDds);
+        if (dds_events & DDS_EV_HALF)
         {
             //  setup for next phase:
-            sine_table_index = 0;
-            phase_vector = VECTOR2;
             _IntegralSum = 0;
         }
         break;
 
     case VECTOR2:
         //  Drives energized for positive polarity
-        if (is_xfrm_saturated && xfrm_2half_sat)
-        {
-            uint16_t delta_duty = (int16_t)(((uint32_t)curr_duty.msw*(uint32_t)saturation_adj)/1000);
-            int16_t  new_duty   = curr_duty.msw - delta_duty;
-            if (new_duty < MIN_DUTY) new_duty = MIN_DUTY;
-         // if ((sine_table_index&0x3F)==1) SLOG(SS_SYS, SV_DBG, "V2SAT", curr_duty.msw, new_duty, saturation_adj, VBATT_1VOLT_A2D);
-          #ifdef ENABLE_SATURATION_COMP
-            curr_duty.msw = new_duty;
-          #endif
-        }
         PDC1 = 0;
-        PDC2 = curr_duty.msw;
+      #ifdef ENABLE_FLUX_BALANCE
+        PDC2 = (_FluxTrim > 0) ? _inv_FluxTrimDuty(curr_duty.msw, _FluxTrim) : curr_duty.msw;
+      #else
+        PDC2 = (is_xfrm_saturated && xfrm_2half_sat) ? _inv_SaturationDuty(curr_duty.msw) : curr_duty.msw;
+      #endif
         duty_cycle_sum.dword -= curr_duty.msw;
+      #ifdef ENABLE_FLUX_BALANCE
+        imeas = (int16_t)IMeasRaw() - (int16_t)(_IMeasZero >> FLUX_ZERO_SHIFT);
+        _FluxImeasSum += imeas;
+        _FluxDriveSum += imeas;
+        _FluxSamples++;
+      #endif
 
         // battery voltage detects transformer saturation
+        if (dds_events & DDS_EV_HALF)
+        {
+            vbatt_sum_2half = 0;
+            vbatt_samples   = 0;
+        }
         if (sine_table_index >= VBATT_START_PHASE)
         {
-            if (sine_table_index == VBATT_START_PHASE)
-                vbatt_sum_2half  = (uint32_t)An.Status.VBatt.raw_val; // initial
-            else
-                vbatt_sum_2half += (uint32_t)An.Status.VBatt.raw_val; // summing
+            vbatt_sum_2half += (uint32_t)An.Status.VBatt.raw_val; // summing
+            vbatt_samples++;
         }
 
-        if (++sine_table_index > (MAX_SINE - 1))
+        dds_events = dds_Advance(&_InvDds);
+        if (dds_events & DDS_EV_HALF)
         {
-            // only check for transformer saturation at begining of normal mode and charger has run
-            if (chgr_hasRun && (PWM_STATE_NORMAL == pwm_state))
+            // transformer flux balance; once a cycle while running closed loop
+          #ifdef ENABLE_FLUX_BALANCE
+            if (PWM_STATE_NORMAL == pwm_state)
             {
-                // check if transformer is saturated
-                uint32_t diff;
-                if (vbatt_sum_1half > vbatt_sum_2half)
-                {
-                    diff = (vbatt_sum_1half - vbatt_sum_2half)/(uint32_t)(VBAT_AVG_SAMPLES);
-                    xfrm_2half_sat = 1;  // 2nd half saturated
-                }
-                else
-                {
-                    diff = (vbatt_sum_2half - vbatt_sum_1half)/(uint32_t)(VBAT_AVG_SAMPLES);
-                    xfrm_2half_sat = 0;  // 1st half saturated
-                }
-                vbatt_diff_a2d = (uint16_t)diff;
-
-                if (vbatt_diff_a2d > SATURATION_THRESHOLD)
-                {
-                    is_xfrm_saturated = 1;
-                    saturation_adj   = (uint16_t)(((uint32_t)SATURATION_DUTY_GAIN * (uint32_t)vbatt_diff_a2d)/(uint32_t)VBATT_1VOLT_A2D);
-                  #ifdef ENABLE_SATURATION_DEBUG
-                    RB6_SET(1);
-                  #endif
-                  // SLOG(SS_SYS, SV_DBG, "SAT", vbatt_diff_a2d, saturation_adj, xfrm_2half_sat, VBATT_1VOLT_A2D);
-                }
-                else
-                {
-                    is_xfrm_saturated = 0;
-                    saturation_adj   = 0;
-                  #ifdef ENABLE_SATURATION_DEBUG
-                    RB6_SET(0);
-                  #endif
-                }
+                _inv_FluxBalanceCycle();
             }
+          #else
+            _inv_SaturationCycle(pwm_state);
+          #endif
+          #ifdef ENABLE_DEAD_TIME_COMP
+            if (PWM_STATE_NORMAL == pwm_state)
+                inv_DeadTimeCycle();
             else
-            {
-                // Not Normal Mode: Soft Start, Soft Stop, etc
-                vbatt_diff_a2d    = 0;
-                is_xfrm_saturated = 0;
-              #ifdef ENABLE_SATURATION_DEBUG
-                RB6_SET(0);
-              #endif
-            }
+                inv_DeadTimeRestart();
+          #endif
+            _FluxImeasSum = 0;
+            _FluxDriveSum = 0;
+            _FluxSamples  = 0;
+
             an_ProcessAnalogData(); //  an_ProcessAnalogData starts a task
 
             //  setup for next phase:
-            sine_table_index = 0;
-            phase_vector = VECTOR1;
             _IntegralSum = 0;
 
             _inv_AdjustRmsSetpoint(); //  TBD - This was needed in LP for flat-top regulation
-            _inv_ProcessOverloadCounters(0); //  _inv_processOverloadCounters must be called directly - not a task
+            _XferDutyAdj     = xfer_StartDecay(_XferDutyAdj);
+            _XferSetpointAdj = xfer_StartDecay(_XferSetpointAdj);
+            ovl_pending = 1;  //  next period; see TIMING above
         }
         break;
     }
@@ -1293,6 +1679,37 @@ static void _inv_PwmIsrRequest(INV_ISR_REQUEST_t request)
 }
 
 
+//-----------------------------------------------------------------------------
+//  inv_SetFreqTrim()
+//-----------------------------------------------------------------------------
+//  Trims the output frequency by trim_mhz milli-Hz from OPTION_AC_OUT_HZ;
+//  limited to +/- INV_FREQ_TRIM_MAX_MHZ. Takes effect on the next PWM period
+//  without a phase step, so it can be used to pull the output onto the line.
+//
+//-----------------------------------------------------------------------------
+
+void inv_SetFreqTrim(int16_t trim_mhz)
+{
+    uint8_t saved_ipl;
+    uint32_t step;
+
+    if (trim_mhz >  INV_FREQ_TRIM_MAX_MHZ) trim_mhz =  INV_FREQ_TRIM_MAX_MHZ;
+    if (trim_mhz < -INV_FREQ_TRIM_MAX_MHZ) trim_mhz = -INV_FREQ_TRIM_MAX_MHZ;
+    step = DDS_STEP_HZ(OPTION_AC_OUT_HZ) + ((int32_t)trim_mhz * (int32_t)DDS_STEP_HZ(1)) / 1000;
+
+    SET_AND_SAVE_CPU_IPL(saved_ipl, 7); //  Start of Protected Code
+    _InvDds.step = step;
+    RESTORE_CPU_IPL(saved_ipl); //  End of Protected Code
+}
+
+//-----------------------------------------------------------------------------
+// the output oscillator; the line phase is timed against it (see xfer.h)
+
+const DDS_t* inv_OutputDds(void)
+{
+    return(&_InvDds);
+}
+
 //-----------------------------------------------------------------------------
 //  inv_PwmIsr()
 //-----------------------------------------------------------------------------
@@ -1487,7 +1904,8 @@ static void _inv_Driver(int8_t reset)
         Inv.error.feedback_problem = 0;
         _FeedbackErrorCount = 0;
 
-        _inv_PwmIsrRequest(INV_ISR_REQ_SOFT_START);
+        _inv_PwmIsrRequest(_SyncStart ? INV_ISR_REQ_START : INV_ISR_REQ_SOFT_START);
+        _SyncStart = 0;
         SetInvState(INV_STARTUP_WAIT);
         break;
 
@@ -1531,6 +1949,7 @@ static void _inv_Driver(int8_t reset)
         {
             msec_ticks = 0; //	init for next state
             half_sec_ticks = 0;
+            lsense_Reset();
             SetInvState(INV_LOAD_SENSE);
         }
         break;
@@ -1556,13 +1975,15 @@ static void _inv_Driver(int8_t reset)
             {
                 msec_ticks = 0;
                 half_sec_ticks++;
+                lsense_HalfSecTick();
             }
 
             //	Load-Sense interval should account for PING_PRE_DELAY_MS and 
             //	PING_POST_DELAY_MS. However, these values are relatively 
             //	insignificant in magnitude, therefore they are ignored.
+            //  The interval backs off while nothing is found (load_sense.h).
 
-            if (half_sec_ticks >= Inv.config.load_sense_interval)
+            if (half_sec_ticks >= (int16_t)g_lsense.interval)
             {
                 BIAS_BOOSTING_INACTIVE(); //	Full-power
                 msec_ticks = 0; //	init for next state
@@ -1590,6 +2011,12 @@ static void _inv_Driver(int8_t reset)
         //  Wait for PWM ISR to execute the command
         if (PWM_STATE_IDLE == _PwmState)
         {
+            if (lsense_ProbeDone())
+            {
+                //  as _inv_CheckLoad(); starts up from INV_LOAD_SENSE
+                Inv.status.load_present = 1;
+                Inv.status.load_sense_timer = Inv.config.load_sense_delay;
+            }
             msec_ticks = 0;
             SetInvState(INV_PING_WAIT2);
         }
@@ -1666,6 +2093,7 @@ void TASK_inv_Driver(void)
     {
         return;
     }
+    dtbl_Task();    // duty tables for the PWM ISR
 
     switch (_InvMode)
     {
@@ -1764,6 +2192,26 @@ void inv_Start(void)
     SetInvActive();
 }
 
+//-----------------------------------------------------------------------------
+//  inv_StartSync()
+//-----------------------------------------------------------------------------
+//  Like inv_Start(), but the output starts at full amplitude at the PLL phase
+//  instead of soft starting from zero; used to take over from a line that
+//  has just gone away.
+//-----------------------------------------------------------------------------
+
+void inv_StartSync(void)
+{
+    LOG(SS_INV, SV_INFO, "inv_StartSync()");
+
+    _VacOffset = VAC_ZERO_CROSS_A2D;
+    _InvMode = INV_MODE_NORMAL;
+    _inv_start();
+    _StopRequest = 0;
+    _SyncStart = 1;
+    SetInvActive();
+}
+
 //-----------------------------------------------------------------------------
 
 void inv_StartBootCharge(void)
@@ -30,6 +30,7 @@
 #define INVERTER_IDLE_TIMEOUT_SEC	      (30)  // 30-seconds
 #define RELAY_CLOSE_DELAY_MSEC	          (16)  // milliseconds
 #define RELAY_OPEN_DELAY_MSEC	          (16)  // milliseconds
+#define XFER_RELAY_OPEN_DELAY_MSEC         (8)  // milliseconds; line lost, see xfer.h
 #define BOOT_CHARGE_DELAY_MSEC            (50)  // milliseconds
 
 // Charger Over-Current Check parameters TODO ### readjust values via testing
@@ -74,7 +74,9 @@
 #include "pwm.h"
 #include "device.h"
 #include "inverter.h"
+#include "inv_thermal.h"
 #include "converter.h" 
+#include "evlog.h"
 #include "nvm.h"
 
 // ----------------------------------------
@@ -244,7 +246,7 @@ static void _HwConfig(void)
     //      Timer1 - General Purpose 1-mSec interrupt.
     //      Timer2 - Input Capture - Temperature sensor pulse duty-cycle
     //      Timer3 - Used to trigger ADC conversions.
-    //      Timer4 - [LPC Only] Inverter Mode: OVL Signal Gating   //  TODO: ?
+    //      Timer4 - Remote display SPI transmit pacing (spi.c)
     //      Timer5 - [LPC Only] Inverter Mode: OVL Signal Gating   //  TODO: ?
     //      Timer6 - DEBUG: used to toggle test pin with state information
     //      Timer7 - DEBUG: used to toggle test pin with state information
@@ -252,13 +254,14 @@ static void _HwConfig(void)
 
 //  IPC0bits.INT0IP = 7;    //  Extern. Int. 0  natural = 0 (highest)
     IPC7bits.T5IP = 6;      //  Timer 5         natural = 28
-    IPC6bits.T4IP = 5;      //  Timer 4         natural = 27
 //  IPC1bits.T2IP = 6;      //  Timer 2         natural = 7
     IPC2bits.T3IP = 4;      //  Timer 3         natural = 8
 //  IPC2bits.ADIP = 4;      //  A/D Converter   natural = 13
     IPC14bits.PWMIP = 3;    //  PWM Module      natural = 57
 //  Timer1, SPI and UART (U1RX and U1TX) should be lowest priority
     IPC0bits.T1IP = 1;      //  Timer 1         natural = 3
+    IPC6bits.T4IP = 1;      //  Timer 4         natural = 27   SPI pacing
+    IPC8bits.SPI2IP = 1;    //  SPI2            natural = 33
 
     #ifdef OPTION_UART2
         IPC7bits.U2RXIP = 1;    //  U2RX            natural = 30
@@ -386,6 +389,7 @@ int main(void)
     // need nvm driver to load configuration early on
     nvm_Config();	// 	nvm_Config loads NVM ROM settings into RAM active settings
     nvm_Start();	//	nvm_Start monitors active settings for changes
+    evlog_Add(EVT_BOOT, LOBYTE(RCON_saved));  // written once the nvm driver has found the end of the log
 
 	// not configurable LPC hardware options
 	Device.status.chgr_enable_time = 1; // set only at this point
@@ -465,6 +469,9 @@ int main(void)
 	Device.status.chgr_enable_can 	= Device.config.chgr_enabled;
 	Inv.status.load_sense_enabled 	= Inv.config.load_sense_enabled;
 
+    // overload models start cold; needs the inverter configuration
+    inv_ThermalReset();
+
   #ifdef REDUCE_AC_QUAL_TIME   // reduce A/C line qual time for testing
     Device.config.ac_line_qual_delay = REDUCED_AC_QUAL_TIME_MSECS;
     g_nvm.settings.dev.ac_line_qual_delay = Device.config.ac_line_qual_delay;
@@ -37,6 +37,7 @@
 #include "tasker.h"
 #include "timer3.h"
 #include "device.h"
+#include "evlog.h"
 #include "inverter.h"
 #include "converter.h" 
 #include "bootloader.h"
@@ -45,6 +46,7 @@
 #include "fan_ctrl.h"
 #include "ui.h"
 #include "lpc_cfg.h"
+#include "xfer.h"
 
 
 // ----------------------------------------
@@ -108,6 +110,10 @@ typedef enum
     MS_SHUTDOWN            = 14,
 
     MS_PURGATORY,
+
+    MS_XFER_TO_INV,         // fast transfer: relay opening, inverter takes over
+    MS_XFER_SYNC,           // fast transfer: inverter pulled into step with the line
+    MS_XFER_TO_LINE,        // fast transfer: relay closing onto the line
     
     NUM_MAIN_STATE_t  //  this has to be last
 } MAIN_STATE_t;
@@ -141,7 +147,10 @@ const char * main_state_str[NUM_MAIN_STATE_t] =
     "ERROR",			  
     "ERROR_WAIT",		  
     "SHUTDOWN",
-    "PURGATORY"
+    "PURGATORY",
+    "XFER_TO_INV",
+    "XFER_SYNC",
+    "XFER_TO_LINE"
 };
 
 const char* MainStateToString(MAIN_STATE_t main_state)
@@ -162,6 +171,7 @@ INLINE void SetMainState(MAIN_STATE_t newState)
     LOG(SS_SYS, SV_INFO, "MS: %s->%s", MainStateToString(main_state), MainStateToString(newState));
   #endif
     main_state = newState;
+    evlog_Add(EVT_MAIN_STATE, (uint8_t)newState);
 //  RB6_NumToScope(main_state); // debugging
 }
 
@@ -640,6 +650,14 @@ INLINE int8_t IsBattTempSensorOK(void)
 //
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// the inverter can take over from the line without a break (see xfer.h)
+INLINE int8_t _xfer_IsArmed(int8_t boot_charge_needed)
+{
+    return(Device.config.fast_xfer_enabled && HasInvRequest() && IsInvEnabled() &&
+           !HasInvAnyErrors() && !boot_charge_needed);
+}
+
 // gets called once per millisecond
 void TASK_MainControl(void)
 {
@@ -650,6 +668,7 @@ void TASK_MainControl(void)
   
   
     device_CheckBattery();
+    evlog_Watch();  // record shutdowns and charger state changes
 	if((MS_SHUTDOWN != main_state) && (MS_PURGATORY != main_state))
     {
         //  2018-04-05: Changes to address issue: 'Charger timers indicate 
@@ -780,6 +799,15 @@ void TASK_MainControl(void)
         //  If there are any 'common' errors then go to the error state.
             SetMainState(MS_ERROR);
         }
+        else if(IS_XFER_CHG_RELAY_ON() && _xfer_IsArmed(boot_charge_needed) &&
+            (!HasRelayRequest() || xfer_LineLost()))
+        {
+            //  The line went away with the relay closed. Open it and let the
+            //  inverter take over at the line phase, without a soft start.
+            XFER_CHG_RELAY_OFF();
+            timer_msec = XFER_RELAY_OPEN_DELAY_MSEC;
+            SetMainState(MS_XFER_TO_INV);
+        }
         else if(HasRelayRequest() && IS_XFER_CHG_RELAY_ON())
         {
             //  The relay is closed.  We have AC on the transformer, so degauss
@@ -907,7 +935,15 @@ void TASK_MainControl(void)
     case MS_CHARGER :
 		//	The charger is running.  
 		//	Determine if we should stop the charger
-		if (!IsBattTempSensorOK() || IsBattOverTemp() || !HasChgrRequest() || HasChgrAnyErrors())
+		if (_xfer_IsArmed(boot_charge_needed) && (!HasRelayRequest() || xfer_LineLost()))
+		{
+			//	The line went away; see MS_CHECK_RELAY_REQUEST
+			chgr_StopNow();
+			XFER_CHG_RELAY_OFF();
+			timer_msec = RELAY_OPEN_DELAY_MSEC;
+			SetMainState(MS_XFER_TO_INV);
+		}
+		else if (!IsBattTempSensorOK() || IsBattOverTemp() || !HasChgrRequest() || HasChgrAnyErrors())
 		{
 			chgr_StopNow();
 			SetMainState(MS_CHGR_STOP_WAIT);
@@ -929,6 +965,16 @@ void TASK_MainControl(void)
 			}
         }
         break;
+
+    case MS_XFER_TO_INV :
+        //  Wait for the relay contacts to part, then start the inverter where 
+        //  the line left off (see xfer.h).
+        if (--timer_msec <= 0)
+        {
+            inv_StartSync();
+            SetMainState(MS_INVERTER);
+        }
+        break;
 		
 	// -------------------------------------------------------------------------
   	//	         I N V E R T E R   O P E R A T I N G    S T A T E S
@@ -940,9 +986,70 @@ void TASK_MainControl(void)
         if(HasInvAnyErrors() || HasRelayRequest() || !HasInvRequest() || 
             !IsInvEnabled() || Device.status.tmr_shutdown) 
         {                 
+            if(HasRelayRequest() && _xfer_IsArmed(0) && 
+                !Device.status.tmr_shutdown && xfer_CanSync())
+            {
+                //  Back to the line without a break in the output
+                xfer_SyncStart();
+                SetMainState(MS_XFER_SYNC);
+            }
+            else
+            {
+                inv_Stop();
+                SetMainState(MS_INV_STOP_WAIT);
+            }
+        }
+        break;
+
+    case MS_XFER_SYNC :
+        //  The inverter is running; pull the output into step with the line,
+        //  then close the relay.
+        if(!_xfer_IsArmed(0) || Device.status.tmr_shutdown) 
+        {
+            xfer_SyncStop();
             inv_Stop();
             SetMainState(MS_INV_STOP_WAIT);
         }
+        else if(!HasRelayRequest())
+        {
+            //  The line went away again
+            xfer_SyncStop();
+            SetMainState(MS_INVERTER);
+        }
+        else
+        {
+            switch(xfer_SyncPoll())
+            {
+            case XFER_SYNC_DONE :
+                XFER_CHG_RELAY_ON();
+                xfer_relay_oc_ignore_timer_msec = XFER_RELAY_OC_IGNORE_DELAY_MSEC;
+                timer_msec = RELAY_CLOSE_DELAY_MSEC;
+                SetMainState(MS_XFER_TO_LINE);
+                break;
+                
+            case XFER_SYNC_FAIL :
+                //  Soft-stop and close the relay as usual
+                xfer_SyncStop();
+                inv_Stop();
+                SetMainState(MS_INV_STOP_WAIT);
+                break;
+                
+            default :
+                break;
+            }
+        }
+        break;
+
+    case MS_XFER_TO_LINE :
+        //  Wait for the relay contacts to close onto the line, in step with 
+        //  the output, then drop the inverter.
+        if (--timer_msec <= 0)
+        {
+            inv_StopNow();
+            xfer_SyncStop();
+            degauss_needed = 0;		//	the line is on the transformer
+            SetMainState(MS_CHECK_RELAY_REQUEST);
+        }
         break;
 
     case MS_INV_STOP_WAIT :